@@ -1,7 +1,7 @@
 @echo off
 echo Building PDS-T1000-TSA24 PERFORMANCE OPTIMIERT...
 
-g++ -std=c++17 -O3 -DNDEBUG -Wall -Iexternal/raylib/src -Iinclude -Isrc/pybind11/include -I"C:/Program Files/Python311/include" src/main.cpp src/py_runner.cpp src/car_simulation.cpp src/auto.cpp src/point.cpp src/renderer.cpp src/coordinate_filter.cpp src/coordinate_filter_fast.cpp src/test_window.cpp src/path_system.cpp src/segment_manager.cpp src/vehicle_controller.cpp -Lexternal/raylib/src -lraylib -lopengl32 -lgdi32 -lwinmm -lcomctl32 -L"C:/Program Files/Python311/libs" -lpython311 -o main
+g++ -std=c++17 -O3 -DNDEBUG -Wall -Iexternal/raylib/src -Iinclude -Isrc/pybind11/include -I"C:/Program Files/Python311/include" src/main.cpp src/py_runner.cpp src/car_simulation.cpp src/auto.cpp src/point.cpp src/renderer.cpp src/coordinate_filter.cpp src/coordinate_filter_fast.cpp src/test_window.cpp src/path_system.cpp src/segment_manager.cpp src/segment_statistics.cpp src/segment_queue.cpp src/vehicle_store.cpp src/task_scheduler.cpp src/event_journal.cpp src/journal_replay.cpp src/vehicle_controller.cpp src/factory_layout.cpp src/traffic_benchmark.cpp src/headless_simulation.cpp src/job_dispatcher.cpp src/route_planner.cpp src/vehicle_spatial_hash.cpp src/vehicle_events.cpp src/marker_id.cpp src/detection_ring.cpp src/marker_class_lut.cpp src/run_length_labeller.cpp src/marker_detector.cpp src/floor_calibration.cpp src/latency_trace.cpp src/detector_benchmark.cpp -Lexternal/raylib/src -lraylib -lopengl32 -lgdi32 -lwinmm -lcomctl32 -L"C:/Program Files/Python311/libs" -lpython311 -o main
 
 if %ERRORLEVEL% EQU 0 (
     echo Build successful! MAXIMALE PERFORMANCE aktiviert
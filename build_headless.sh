@@ -0,0 +1,12 @@
+#!/bin/sh
+# Headless-Simulation ohne raylib, Kamera und Python (Linux/macOS)
+echo "Building PDS-T1000-TSA24 headless simulator..."
+
+g++ -std=c++17 -O3 -DNDEBUG -Wall -pthread -Iinclude src/headless_main.cpp src/headless_simulation.cpp src/auto.cpp src/point.cpp src/coordinate_filter.cpp src/path_system.cpp src/segment_manager.cpp src/segment_statistics.cpp src/segment_queue.cpp src/vehicle_store.cpp src/task_scheduler.cpp src/event_journal.cpp src/vehicle_controller.cpp src/factory_layout.cpp src/traffic_benchmark.cpp src/job_dispatcher.cpp src/route_planner.cpp src/vehicle_spatial_hash.cpp src/vehicle_events.cpp src/marker_id.cpp src/detection_ring.cpp src/marker_class_lut.cpp src/run_length_labeller.cpp src/marker_detector.cpp src/floor_calibration.cpp src/latency_trace.cpp src/detector_benchmark.cpp -o headless_sim
+
+if [ $? -eq 0 ]; then
+    echo "Build successful! ./headless_sim --help"
+else
+    echo "Build failed!"
+    exit 1
+fi
@@ -1,4 +1,6 @@
 #pragma once
+#include "frame_stamp.h"
+#include "marker_id.h"
 #include <string>
 
 // 2D Punkt für Koordinaten
@@ -11,14 +13,15 @@ struct Point2D {
 // Struktur für ein erkanntes Objekt aus der Farberkennung
 struct DetectedObject {
     int id;                     // Objekt-ID
-    std::string color;          // Erkannte Farbe (Front, Heck1, Heck2, Heck3, Heck4)
+    MarkerId marker;            // Erkannter Marker (Front, Heck1, Heck2, Heck3, Heck4)
     Point2D coordinates;        // Normalisierte Koordinaten (0-crop_width, 0-crop_height)
     float area;                 // Fläche des erkannten Objekts
     float crop_width;           // Breite des Crop-Bereichs
     float crop_height;          // Höhe des Crop-Bereichs
+    FrameStamp stamp;           // Kamera-Frame (Sequenz, Aufnahmezeit) für die Latenz-Messung
     
     // Standardkonstruktor
-    DetectedObject() : id(0), color(""), coordinates(0, 0), area(0), crop_width(0), crop_height(0) {}
+    DetectedObject() : id(0), marker(MARKER_NONE), coordinates(0, 0), area(0), crop_width(0), crop_height(0) {}
 };
 
 // Vereinfachte Datenstruktur für Fahrzeugerkennung (falls noch benötigt)
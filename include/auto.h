@@ -32,7 +32,6 @@ private:
     static int nextId;
 
     void calculateCenterAndDirection();
-    int extractIdFromColor(const std::string& color);
 
 public:
     // Original detection-based constructor
@@ -61,7 +60,8 @@ public:
     // State management
     VehicleState state;
     Direction currentDirection;
-    float speed;
+    float speed;                         // px per second
+    float jobUrgency;                    // Urgency of the current job for the segment queue policies (0 = none)
     
     // Movement flags
     bool isMoving;
@@ -70,13 +70,15 @@ public:
     
     // Real-world integration
     Point realWorldCoordinates;    // Position from camera detection
-    std::string colorValue;        // Vehicle color for identification
+    MarkerId marker;               // Heck marker of the detection (vehicle identity)
+    FrameStamp stamp;              // Camera frame of the older of the two points
 
     // Position and movement methods
     void setPosition(const Point& pos);
     void setTargetPosition(const Point& target);
     void updatePosition(float deltaTime);
     void calculateDirection();
+    void setDirection(float degrees) { direction = degrees; }
 
     // Getters (original)
     Point getCenter() const { return center; }
@@ -9,8 +9,10 @@
 #include "path_system.h"
 #include "segment_manager.h"
 #include "vehicle_controller.h"
+#include "job_dispatcher.h"
 #include <vector>
 #include <memory>
+#include <random>
 
 // Forward declaration for Renderer
 class Renderer;
@@ -52,12 +54,19 @@ private:
     PathSystem pathSystem;
     SegmentManager* segmentManager;
     VehicleController* vehicleController;
+    std::unique_ptr<EventJournal> journal;   // Reservierungs-Journal (reservation_journal.bin)
+    std::unique_ptr<TaskScheduler> taskScheduler;
+    unsigned workerThreadCount;              // 0 = alle Hardware-Threads
+    std::unique_ptr<RoutePlanner> routePlanner;     // Routenplanung im Hintergrund
+    std::unique_ptr<JobDispatcher> jobDispatcher;   // Transportaufträge (Abholung -> Abgabe)
+    std::mt19937 jobRng;
     bool pathSystemInitialized;
 
     // Input handling
     int selectedVehicle;
     void handleVehicleSelection();
     void handleTargetAssignment();
+    void handleJobInput();
 
 public:
     // Constructor and Destructor
@@ -82,6 +91,7 @@ public:
     // Configuration methods
     void setCarPointDistance(float distance);
     void setDistanceBuffer(float buffer);
+    void setWorkerThreadCount(unsigned threads) { workerThreadCount = threads; }   // Vor initialize() aufrufen
 
     // New path system methods
     void initializePathSystem();
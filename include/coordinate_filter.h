@@ -5,7 +5,6 @@
 #include "point.h"
 #include <vector>
 #include <chrono>
-#include <string>
 #include <map>
 
 struct FilteredPoint {
@@ -14,7 +13,7 @@ struct FilteredPoint {
     std::chrono::steady_clock::time_point creationTime;
     bool isValid;
     bool isStable;
-    std::string color;
+    MarkerId marker;
     int consecutiveValidDetections;
     int totalDetections;
     float stabilityRadius;  // Radius in dem Detektionen als "gleich" gelten
@@ -27,14 +26,14 @@ struct FilteredPoint {
     bool hasPrediction;       // Hat gültige Vorhersage
     int missedDetections;     // Anzahl verpasster Detektionen
     
-    FilteredPoint() : isValid(false), isStable(false), consecutiveValidDetections(0), 
+    FilteredPoint() : isValid(false), isStable(false), marker(MARKER_NONE), consecutiveValidDetections(0), 
                      totalDetections(0), stabilityRadius(50.0f), velocity(0.0f, 0.0f),
                      acceleration(0.0f, 0.0f), predictedPosition(0.0f, 0.0f), 
                      hasPrediction(false), missedDetections(0) {}
-    FilteredPoint(const Point& p, const std::string& c) 
+    FilteredPoint(const Point& p, MarkerId m) 
         : point(p), lastUpdate(std::chrono::steady_clock::now()), 
           creationTime(std::chrono::steady_clock::now()),
-          isValid(false), isStable(false), color(c), 
+          isValid(false), isStable(false), marker(m), 
           consecutiveValidDetections(0), totalDetections(1), stabilityRadius(50.0f),
           velocity(0.0f, 0.0f), acceleration(0.0f, 0.0f), predictedPosition(p),
           hasPrediction(false), missedDetections(0) {
@@ -44,7 +43,10 @@ struct FilteredPoint {
 
 class CoordinateFilter {
 private:
-    std::map<std::string, FilteredPoint> stablePoints;  // Ein Punkt pro Farbe
+    // Ein Punkt pro Heck-Marker (Schlüssel = MarkerId) und bis zu 4 Front-Punkte
+    // (Schlüssel = FRONT_KEY_BASE + laufende Nummer, alle Fronts melden denselben Marker)
+    std::map<int, FilteredPoint> stablePoints;
+    static const int FRONT_KEY_BASE = 256;
     float detectionRadius;         // Radius für neue Detektionen
     float validityTimeout;         // Sekunden bis Punkt ungültig wird
     int minDetectionsForStability; // Mindest-Detektionen für Stabilität
@@ -63,16 +65,14 @@ public:
     
     // Hauptfunktion: Filtert neue Erkennungen und gibt stabile Punkte zurück
     std::vector<Point> filterAndSmooth(const std::vector<Point>& newDetections, 
-                                      const std::vector<std::string>& colors);
+                                      const std::vector<MarkerId>& markers);
     
     // Hilfsfunktionen
-    void processDetection(const Point& newPoint, const std::string& color);
+    void processDetection(const Point& newPoint, MarkerId marker);
     void removeExpiredPoints();
     void updatePointStability(FilteredPoint& fp);
     Point calculateClusterCenter(const std::vector<Point>& detections) const;
     bool isWithinMovementThreshold(const Point& oldPos, const Point& newPos) const;
-    std::string getVehiclePartType(const std::string& color) const;
-    std::string extractHeckNumber(const std::string& color) const;
     
     // Prediction methods
     void updateMotionModel(FilteredPoint& fp, const Point& newPosition);
@@ -0,0 +1,101 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include "py_runner.h"
+
+// Detection stream in shared memory, replacing the per-frame coordinates.json write.
+// One writer (the detection thread of the main process or Farberkennung.py running on its
+// own) publishes every camera frame into a fixed ring of slots; any number of readers in
+// other processes follow it without file I/O and without blocking the writer.
+//
+// Layout: DetectionRingHeader followed by slotCount DetectionRingSlot. Frame n (from 1) goes
+// to slot n % slotCount. Each slot is a seqlock: the writer sets its sequence to 0, writes
+// the frame, then stores n; a reader copies the slot and accepts it only if the sequence was
+// n before and after the copy. A reader that falls more than slotCount frames behind skips
+// ahead and counts the frames it missed. Must match src/detection_ring.py.
+//
+// POSIX shared memory object (shm_open) or, on Windows, a named file mapping; both are what
+// Python's multiprocessing.shared_memory uses for the same name. The object is not unlinked
+// when the writer exits, so a restarted writer continues the stream for running readers.
+
+const char* const DETECTION_RING_NAME = "pds_detections";
+const uint32_t DETECTION_RING_MAGIC = 0x44535050;   // "PPSD"
+const uint32_t DETECTION_RING_VERSION = 1;
+const int DETECTION_RING_SLOTS = 64;
+const int DETECTION_RING_MAX_OBJECTS = 16;          // Per frame; further detections are dropped
+
+struct DetectionRingHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotSize;
+    std::atomic<uint64_t> writeSequence;             // Last completed frame, 0 = none yet
+};
+
+struct DetectionRingSlot {
+    std::atomic<uint64_t> sequence;                  // Frame number, 0 while being written
+    int64_t captureNanos;                            // Steady clock (CLOCK_MONOTONIC / QueryPerformanceCounter)
+    int64_t publishNanos;
+    int32_t count;
+    int32_t reserved;
+    PackedDetection objects[DETECTION_RING_MAX_OBJECTS];
+};
+static_assert(sizeof(DetectionRingHeader) == 24, "DetectionRingHeader must match detection_ring.HEADER");
+static_assert(sizeof(DetectionRingSlot) == 32 + 32 * DETECTION_RING_MAX_OBJECTS,
+              "DetectionRingSlot must match detection_ring.SLOT_HEADER + RECORD");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "Shared-memory atomics must be lock-free");
+
+// Steady clock time point <-> nanoseconds as stored in the ring (same clock in every process)
+int64_t toRingNanos(std::chrono::steady_clock::time_point time);
+std::chrono::steady_clock::time_point fromRingNanos(int64_t nanos);
+
+// Shared memory mapping of the ring (common part of writer and reader)
+class DetectionRingMapping {
+public:
+    DetectionRingMapping() = default;
+    ~DetectionRingMapping();
+    DetectionRingMapping(const DetectionRingMapping&) = delete;
+    DetectionRingMapping& operator=(const DetectionRingMapping&) = delete;
+
+    bool isOpen() const { return header != nullptr; }
+    void close();
+
+protected:
+    // Writer: create and map read-write; readers map read-only (any user can follow the stream)
+    bool map(const std::string& name, bool create);
+    DetectionRingSlot& slot(uint64_t sequence) const;
+
+    DetectionRingHeader* header = nullptr;
+    size_t size = 0;
+    void* handle = nullptr;                          // Windows mapping handle
+};
+
+// The one writer. open() creates the ring (or takes over an existing one and continues its
+// sequence, so readers stay monotonic); publish() never blocks.
+class DetectionRingWriter : public DetectionRingMapping {
+public:
+    bool open(const std::string& name = DETECTION_RING_NAME);
+    void publish(const DetectionFrame& frame);
+    uint64_t getWriteSequence() const;
+};
+
+// Follows the stream from the frame after the newest one at open(). next() returns each frame
+// once, oldest first; frames overwritten before they were read are counted, not returned.
+class DetectionRingReader : public DetectionRingMapping {
+public:
+    bool open(const std::string& name = DETECTION_RING_NAME);
+
+    // False if no new frame is available (or the ring is not open)
+    bool next(DetectionFrame& frame);
+
+    // Newest frame only, skipping (and counting) everything older
+    bool latest(DetectionFrame& frame);
+
+    uint64_t getDroppedFrames() const { return droppedFrames; }
+
+private:
+    uint64_t nextSequence = 1;
+    uint64_t droppedFrames = 0;
+};
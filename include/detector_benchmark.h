@@ -0,0 +1,42 @@
+#pragma once
+#include <string>
+#include <vector>
+
+// Native MarkerDetector on synthetic camera frames (640x480 up to 1920x1080, four vehicles
+// with Front and Heck marker each): time per frame against the 30 fps camera period, frames
+// with every marker found and the centroid error against the drawn marker centers
+void runMarkerDetectorBenchmark();
+
+// Per-pixel HSV conversion and range check against the MarkerClassLut lookup on the same
+// synthetic frames (identical class masks), plus first-build and trackbar-rebuild times
+void runMarkerClassLutBenchmark();
+
+// Connected components of the opened class image: per-pixel flood fill against the
+// run-length labeller (identical components, time per frame for all colors)
+void runMarkerLabellerBenchmark();
+
+// MarkerDetector::measureBlob area and perimeter of filled rectangles and discs against the
+// cv2.contourArea / cv2.arcLength values of the same shapes (OpenCV 4, RETR_EXTERNAL contour)
+void runMarkerContourCheck();
+
+// Four vehicles circling at 6 px per frame, paced at 30 fps: full-frame detection against
+// MarkerDetector's tracking mode on the same frames (time per frame, pixels searched per
+// window frame and in total, full sweeps, frames with every marker found, centroid error)
+void runMarkerTrackingBenchmark();
+
+// Full sweeps at full resolution against pyramid mode at 1/4 and 1/8 (time and searched pixels
+// per frame, largest centroid difference to the full-resolution path). Runs on recorded camera
+// frames (binary PPM, e.g. cv2.imwrite("frame.ppm", frame) of the crop) if given, otherwise on
+// synthetic frames of three camera resolutions.
+void runMarkerPyramidBenchmark(const std::vector<std::string>& framePaths = std::vector<std::string>());
+
+// Crop -> floor conversion on a simulated distorted, tilted camera: least-squares scale/offset
+// (the trackbar model) against FloorCalibration fitted from 20 noisy reference markers, exact
+// and through FloorRemapTable with 1, 4 and 8 px cells (mean/max error against the true
+// mapping, cost per point, table build time and size)
+void runFloorCalibrationBenchmark();
+
+// Recording stage latencies from one and four threads into a LatencyHistogram against a
+// mutex-guarded sample vector (cost per record, memory), and the histogram's p50/p99/p99.9
+// against the exact percentiles of the same samples
+void runLatencyTraceBenchmark();
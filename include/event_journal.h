@@ -0,0 +1,110 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Binary journal of reservation, queue and planning events.
+// record() is lock-free (bounded MPSC ring buffer, never blocks; events are
+// dropped and counted when the ring is full). A background thread drains the
+// ring and appends fixed-size records to the journal file.
+//
+// File layout: JournalFileHeader followed by JournalEvent records.
+
+enum class JournalEventType : uint16_t {
+    RESERVE,          // reserveSegment(segment, vehicle, node); FAILED flag if refused
+    RELEASE,          // releaseSegment(segment, vehicle)
+    ENQUEUE,          // addToQueue(segment, vehicle, node)
+    DEQUEUE,          // removeFromQueue(segment, vehicle)
+    PROCESS_QUEUE,    // processQueue(segment)
+    UPDATE_QUEUES,    // updateQueues()
+    CLOCK,            // update(value = deltaTime), time = clock afterwards
+    REMOVE_VEHICLE,   // removeVehicle(vehicle)
+    QUEUE_INFO,       // setVehicleQueueInfo(vehicle, value = urgency, value2 = remaining route)
+    QUEUE_CONFIG,     // setQueueConfig(node = policy, value = aging rate)
+    PLATOON_CONFIG,   // setPlatoonConfig(node = enabled, value = spacing, value2 = headway)
+    ROLLBACK,         // rollback() to value = snapshot time (not replayable)
+    PATH_PLANNED,     // Planner: vehicle, node = target, value = nodes in path
+    PATH_FAILED       // Planner: vehicle, node = target
+};
+
+// Event flags
+const uint16_t JOURNAL_DERIVED = 1;   // Caused by another journaled call (skipped on replay)
+const uint16_t JOURNAL_FAILED = 2;    // Call returned false
+
+struct JournalEvent {
+    uint64_t sequence;    // Global order (assigned by record())
+    double time;          // SegmentManager clock in seconds
+    uint16_t type;        // JournalEventType
+    uint16_t flags;
+    int32_t vehicleId;
+    int32_t segmentId;
+    int32_t nodeId;
+    float value;
+    float value2;
+    uint32_t droppedBefore;   // Events lost (ring full) right before this one
+};
+static_assert(sizeof(JournalEvent) == 48, "JournalEvent is a fixed on-disk record");
+
+struct JournalFileHeader {
+    char magic[8];          // "PDSJRNL1"
+    uint32_t version;
+    uint32_t eventSize;
+    uint32_t nodeCount;     // Layout the journal was recorded on
+    uint32_t segmentCount;
+};
+
+class EventJournal {
+public:
+    explicit EventJournal(size_t capacity = 1 << 16);   // Rounded up to a power of two
+    ~EventJournal();
+
+    EventJournal(const EventJournal&) = delete;
+    EventJournal& operator=(const EventJournal&) = delete;
+
+    // Starts the writer thread; close() drains the ring and closes the file
+    bool open(const std::string& filename, uint32_t nodeCount, uint32_t segmentCount);
+    void close();
+    bool isOpen() const { return file != nullptr; }
+
+    // Lock-free, callable from any thread. Returns false if the event was dropped.
+    bool record(const JournalEvent& event);
+
+    uint64_t getDroppedCount() const { return dropped.load(std::memory_order_relaxed); }
+    uint64_t getWrittenCount() const { return written.load(std::memory_order_relaxed); }
+
+    // Offline reading for the replay tool
+    static bool readFile(const std::string& filename, JournalFileHeader& header, std::vector<JournalEvent>& events);
+    static const char* typeName(JournalEventType type);
+
+private:
+    struct Slot {
+        std::atomic<uint64_t> sequence;
+        JournalEvent event;
+    };
+
+    size_t drain(std::vector<JournalEvent>& batch);
+    void writerLoop();
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask;
+    alignas(64) std::atomic<uint64_t> enqueuePos;
+    alignas(64) uint64_t dequeuePos;        // Writer thread only
+    std::atomic<uint64_t> dropped;
+    std::atomic<uint32_t> pendingDrops;     // Drops not yet reported in an event
+    std::atomic<uint64_t> written;
+
+    std::FILE* file;
+    std::thread writer;
+    std::atomic<bool> running;
+};
+
+// Keeps nesting depth of journaled calls so that cascades can be flagged as derived
+struct JournalDepthGuard {
+    int& depth;
+    explicit JournalDepthGuard(int& d) : depth(d) { ++depth; }
+    ~JournalDepthGuard() { --depth; }
+};
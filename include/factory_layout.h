@@ -0,0 +1,6 @@
+#pragma once
+#include "path_system.h"
+
+// Baut das Fabrik-Layout (Knoten, Wartepunkte, Segmente) im 1920x1200 Koordinatensystem auf.
+// Ohne Raylib-Abhängigkeit, damit auch Benchmarks und Werkzeuge das echte Layout nutzen können.
+void createFactoryLayout(PathSystem& pathSystem);
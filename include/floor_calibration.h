@@ -0,0 +1,90 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+// Reference marker: where the camera saw it (crop pixels) and where it lies on the floor
+// (fullscreen pixels, the 1920x1200 frame of the path system)
+struct CalibrationPair {
+    float imageX, imageY;
+    float floorX, floorY;
+};
+
+// Camera crop -> floor model: radial lens correction around the crop center, then a
+// homography for the camera's perspective onto the floor plane.
+//   d = (p - center) / norm,  r2 = |d|^2,  u = d * (1 + k1 * r2 + k2 * r2^2)
+//   floor = floorCenter + floorScale * H(u)          (H projective, h[8] = 1)
+// norm is half the crop diagonal, so k1/k2 are comparable between camera resolutions.
+// fit() starts from the linear (DLT) homography without distortion and refines all ten
+// parameters with Levenberg-Marquardt on the floor-space residuals; with fewer than six
+// reference markers only the homography is fitted.
+class FloorCalibration {
+public:
+    FloorCalibration();
+
+    // Needs at least four markers, not three of them on a line; false leaves the model unchanged
+    bool fit(const std::vector<CalibrationPair>& pairs, int cropWidth, int cropHeight);
+
+    // Exact model; false where the point maps behind the camera (homography w <= 0)
+    bool toFloor(float imageX, float imageY, float& floorX, float& floorY) const;
+
+    // Root mean square floor distance of the model to the markers, px
+    double rmsError(const std::vector<CalibrationPair>& pairs) const;
+
+    bool isValid() const { return valid; }
+    int getCropWidth() const { return cropWidth; }
+    int getCropHeight() const { return cropHeight; }
+    double getK1() const { return params[8]; }
+    double getK2() const { return params[9]; }
+
+    // Text file, one marker per line: crop_x crop_y floor_x floor_y ('#' starts a comment)
+    static bool loadPairs(const std::string& path, std::vector<CalibrationPair>& pairs);
+
+private:
+    bool evaluate(const double* p, double imageX, double imageY, double& floorX, double& floorY) const;
+
+    double params[10];                 // h0..h7 (normalized spaces), k1, k2
+    double centerX, centerY, norm;     // Image normalization
+    double floorCenterX, floorCenterY, floorScale;
+    int cropWidth, cropHeight;
+    bool valid;
+};
+
+// The model sampled on a grid over the crop, every cellSize px including the far edges, so
+// converting a detection is one bilinear lookup instead of the distortion polynomial and the
+// projective division. cellSize 1 samples every pixel corner; the mapping is smooth enough
+// that a few pixels per cell interpolate it to well below the detection noise while the table
+// stays in cache. Built once per calibration and crop size.
+class FloorRemapTable {
+public:
+    FloorRemapTable();
+
+    void build(const FloorCalibration& calibration, int cropWidth, int cropHeight, int cellSize = 1);
+
+    // False outside the crop or where the model is undefined; no substitute position
+    bool lookup(float imageX, float imageY, float& floorX, float& floorY) const {
+        if (!(imageX >= 0.0f && imageY >= 0.0f && imageX <= cropWidth && imageY <= cropHeight)) return false;
+        const float gx = imageX * inverseCell, gy = imageY * inverseCell;
+        int ix = std::min(static_cast<int>(gx), columns - 2), iy = std::min(static_cast<int>(gy), rows - 2);
+        const float fx = gx - ix, fy = gy - iy;
+        const float* top = &table[(static_cast<size_t>(iy) * columns + ix) * 2];
+        const float* bottom = top + columns * 2;
+        float upperX = top[0] + (top[2] - top[0]) * fx, lowerX = bottom[0] + (bottom[2] - bottom[0]) * fx;
+        float upperY = top[1] + (top[3] - top[1]) * fx, lowerY = bottom[1] + (bottom[3] - bottom[1]) * fx;
+        floorX = upperX + (lowerX - upperX) * fy;
+        floorY = upperY + (lowerY - upperY) * fy;
+        return !std::isnan(floorX) && !std::isnan(floorY);   // NaN marks undefined grid points
+    }
+
+    bool isBuilt() const { return !table.empty(); }
+    int getCropWidth() const { return cropWidth; }
+    int getCropHeight() const { return cropHeight; }
+    size_t getBytes() const { return table.size() * sizeof(float); }
+
+private:
+    int cropWidth, cropHeight;
+    int columns, rows;                 // Grid points, at least 2 x 2
+    float inverseCell;
+    std::vector<float> table;          // Interleaved floor x, y per grid point, row by row
+};
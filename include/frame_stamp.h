@@ -0,0 +1,17 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+// Identity of the camera frame a value was derived from. Set by the detection thread and
+// carried through DetectedObject, Point and Auto to the vehicle command, so every stage can
+// tell how old its input is.
+struct FrameStamp {
+    uint64_t sequence;                                   // Detection thread frame number, 0 = not from the camera
+    std::chrono::steady_clock::time_point captureTime;   // Camera frame read (cap.read() returned)
+
+    FrameStamp() : sequence(0) {}
+    FrameStamp(uint64_t sequence, std::chrono::steady_clock::time_point captureTime)
+        : sequence(sequence), captureTime(captureTime) {}
+
+    bool isSet() const { return sequence != 0; }
+};
@@ -0,0 +1,40 @@
+#pragma once
+#include "segment_manager.h"
+#include <string>
+
+// Fleet simulation with the real VehicleController and SegmentManager, no window,
+// no camera, no Python. Vehicles are virtual Autos driven along their currentNodePath
+// with a fixed timestep (VehicleController simulated movement); every trip is planned
+// with setVehicleTargetNode() and a random job urgency in [0, 1] for the queue policies.
+// Runs as fast as the CPU allows.
+struct HeadlessSimulationConfig {
+    int vehicleCount;
+    float simulatedSeconds;
+    float timeStep;                             // Fixed step in simulated seconds
+    float vehicleSpeed;                         // px per second
+    unsigned int seed;                          // Target selection
+    int jobsPerVehicle;                         // 0 = drive until simulatedSeconds
+    unsigned threadCount;                       // TaskScheduler threads (0 = all, 1 = inline)
+    SegmentManager::PlatoonConfig platoon;
+    SegmentManager::QueueConfig queue;
+
+    HeadlessSimulationConfig() : vehicleCount(8), simulatedSeconds(3600.0f), timeStep(0.05f),
+                                 vehicleSpeed(100.0f), seed(42), jobsPerVehicle(0), threadCount(1) {}
+};
+
+struct HeadlessSimulationResult {
+    std::string label;
+    int completedTrips;
+    float tripsPerMinute;
+    float averageTripTime;      // Seconds per completed trip
+    float averageWaitPerTrip;   // Seconds in WAITING per completed trip
+    float makespan;             // Time the last job finished (simulated end if unfinished)
+    int collisionRisks;         // Vehicle pairs that became a collision risk (detectCollisionRisks)
+    float simulatedSeconds;
+    double wallSeconds;
+    double realTimeFactor;      // Simulated seconds per wall-clock second
+};
+
+HeadlessSimulationResult runHeadlessSimulation(const std::string& label, const HeadlessSimulationConfig& config);
+void printHeadlessSimulationHeader();
+void printHeadlessSimulationResult(const HeadlessSimulationResult& result);
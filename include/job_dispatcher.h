@@ -0,0 +1,91 @@
+#pragma once
+#include "path_system.h"
+#include "task_scheduler.h"
+#include "vehicle_controller.h"
+#include <deque>
+#include <future>
+#include <map>
+#include <vector>
+
+// Transport job: drive to pickupNodeId, then to dropoffNodeId
+struct TransportJob {
+    int jobId;
+    int pickupNodeId;
+    int dropoffNodeId;
+    double createdTime;
+    float urgency;       // Higher = more urgent; the vehicle queues at segments with it
+};
+
+struct JobAssignment {
+    int vehicleId;
+    int jobId;
+    float travelTime;    // Estimated seconds to the pickup node
+};
+
+// Queue of transport jobs, assigned in batches to idle vehicles with minimal total
+// empty travel time to the pickups. Vehicles sharing a start node (and speed) and jobs
+// sharing a pickup node are interchangeable, so the vehicle x job problem is solved as
+// a transportation problem over start nodes x pickup nodes: one Dijkstra per start node
+// (in parallel on the TaskScheduler), then the capacitated Hungarian method. Among jobs
+// with the same pickup the oldest go first; only the oldest maxBatchJobs open jobs take
+// part, so far-away jobs are not passed over forever by new nearby ones.
+class JobDispatcher {
+public:
+    // Subscribes to the controller's event bus: destroy the dispatcher before the controller
+    JobDispatcher(PathSystem* pathSys, VehicleController* vehicleCtrl);
+    ~JobDispatcher();
+
+    JobDispatcher(const JobDispatcher&) = delete;
+    JobDispatcher& operator=(const JobDispatcher&) = delete;
+
+    void setTaskScheduler(TaskScheduler* taskScheduler) { scheduler = taskScheduler; }
+    void setMaxBatchJobs(size_t jobs) { maxBatchJobs = jobs; }
+
+    int submitJob(int pickupNodeId, int dropoffNodeId, double now, float urgency = 0.0f);   // Job ID, -1 = unknown node
+
+    // Per frame: vehicles that reached their pickup continue to the dropoff, finished
+    // jobs are completed, then open jobs are dispatched to idle vehicles. Arrivals come from
+    // the controller's RouteCompleted events of the previous frame, so busy vehicles are not
+    // polled. Routes go through VehicleController::requestVehicleTarget, so dispatching
+    // never waits for a search. A vehicle sent elsewhere by hand gives its job back.
+    std::vector<JobAssignment> update();
+
+    // Optimal assignment of open jobs to idle vehicles, without committing anything
+    std::vector<JobAssignment> computeAssignments() const;
+
+    bool isVehicleBusy(int vehicleId) const { return activeJobs.count(vehicleId) != 0; }
+    size_t getOpenJobCount() const { return openJobs.size(); }
+    size_t getActiveJobCount() const { return activeJobs.size(); }
+    int getCompletedJobCount() const { return completedJobs; }
+    double getLastDispatchMicros() const { return lastDispatchMicros; }
+
+private:
+    struct ActiveJob {
+        TransportJob job;
+        bool loaded;                 // Pickup reached, driving to the dropoff
+        std::future<bool> route;     // Route to the current stop, valid until committed
+    };
+
+    static int currentStop(const ActiveJob& active) {
+        return active.loaded ? active.job.dropoffNodeId : active.job.pickupNodeId;
+    }
+    bool isIdle(const Auto& vehicle) const;
+    int startNodeOf(const Auto& vehicle) const;
+    std::vector<JobAssignment> dispatch();
+
+    PathSystem* pathSystem;
+    VehicleController* vehicleController;
+    TaskScheduler* scheduler;
+    size_t maxBatchJobs;
+
+    std::deque<TransportJob> openJobs;                  // Oldest first
+    std::map<int, ActiveJob> activeJobs;                // Vehicle ID -> job (ordered: deterministic updates)
+    int completedSubscription;
+    int replannedSubscription;
+    std::vector<RouteCompletedEvent> completedRoutes;   // Since the last update()
+    std::vector<RouteReplannedEvent> replannedRoutes;
+
+    int nextJobId;
+    int completedJobs;
+    double lastDispatchMicros;
+};
@@ -0,0 +1,28 @@
+#pragma once
+#include "event_journal.h"
+#include "segment_manager.h"
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+// Offline replay of a reservation journal. SegmentManager is deterministic, so
+// re-issuing the journaled top-level calls (derived events are skipped) on the
+// same layout rebuilds the reservation state at any point in time.
+struct JournalReplayResult {
+    size_t applied;          // Top-level events re-issued
+    size_t derivedSkipped;   // Cascaded events (reproduced by the replay itself)
+    size_t mismatches;       // RESERVE results that differ from the recording
+    size_t rollbacks;        // ROLLBACK events (state after them is not reproducible)
+    uint64_t droppedEvents;  // Events lost while recording (ring buffer full)
+    double reachedTime;
+
+    JournalReplayResult()
+        : applied(0), derivedSkipped(0), mismatches(0), rollbacks(0), droppedEvents(0), reachedTime(0.0) {}
+};
+
+JournalReplayResult replayJournal(const std::vector<JournalEvent>& events, SegmentManager& manager, double untilTime);
+void printJournalEvents(const std::vector<JournalEvent>& events, double fromTime, double untilTime, std::ostream& out);
+
+// Command-line tool: replay a journal file on the factory layout and print the
+// segment status at untilTime (and the events of the last second with listEvents)
+int runJournalReplay(const std::string& filename, double untilTime, bool listEvents);
@@ -0,0 +1,69 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+
+// Log-linear histogram of durations in the style of HdrHistogram: one bucket per nanosecond
+// below 64 ns, above that 32 buckets per power of two, so every recorded value is kept to
+// within 1/32 of itself (percentiles report the bucket middle, at most 1.6 % off) up to 2^40 ns
+// (18 minutes; longer values land in the last bucket, the maximum stays exact). record() is
+// one relaxed atomic increment plus a compare-exchange only when the maximum grows, so any
+// number of threads record without locks; readers sum the buckets and may miss values
+// recorded while they read.
+class LatencyHistogram {
+public:
+    static const int SUB_BUCKET_HALF = 32;
+    static const int MAX_SHIFT = 34;                     // Values below 2^40 ns keep full precision
+    static const int BUCKET_COUNT = SUB_BUCKET_HALF * (MAX_SHIFT + 2);
+
+    LatencyHistogram();
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(int64_t nanos);
+    void record(std::chrono::steady_clock::duration duration) {
+        record(static_cast<int64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count()));
+    }
+
+    uint64_t getCount() const;
+    int64_t getMax() const { return maximum.load(std::memory_order_relaxed); }
+
+    // Value (ns) that percent of the recorded values are at or below; 0 if empty
+    int64_t percentile(double percent) const;
+
+    void reset();
+
+private:
+    static int bucketIndex(uint64_t nanos);
+    static int64_t bucketMiddle(int index);
+
+    std::atomic<uint64_t> buckets[BUCKET_COUNT];
+    std::atomic<int64_t> maximum;
+};
+
+// Stages of a camera frame on its way to a vehicle command, plus the end-to-end total
+enum class LatencyStage {
+    CAPTURE,             // Detection thread frame start -> camera frame read (camera wait, GIL)
+    DETECT,              // Frame read -> detections ready (Python or native detector, packing)
+    BRIDGE,              // Detections ready -> main loop picks them up (triple buffer / ring)
+    PAIRING,             // Crop -> floor transform and Front/Heck pairing into vehicles
+    PLANNING,            // Simulation update: path system sync, job dispatch, vehicle movement
+    COMMAND_WRITE,       // Writing vehicle_commands.json
+    RENDER,              // Drawing the frame (BeginDrawing .. EndDrawing, includes v-sync)
+    CAMERA_TO_COMMAND,   // Frame read -> command computed from it written
+    COUNT
+};
+
+const char* latencyStageName(LatencyStage stage);
+
+// Process-wide histogram per stage
+LatencyHistogram& latencyHistogram(LatencyStage stage);
+
+inline void recordLatency(LatencyStage stage, std::chrono::steady_clock::time_point from,
+                          std::chrono::steady_clock::time_point to) {
+    latencyHistogram(stage).record(to - from);
+}
+
+// Frames, p50, p99 and max in ms per stage that recorded anything
+void printLatencyReport(std::ostream& out);
@@ -0,0 +1,61 @@
+#pragma once
+#include "marker_id.h"
+#include <cstdint>
+#include <vector>
+
+// HSV definition of one marker color in OpenCV ranges (H 0..179, S/V 0..255). A pixel
+// matches if its circular H distance and its S and V distances are within the tolerances.
+struct MarkerColor {
+    MarkerId marker;
+    int h, s, v;
+    int hTolerance, sTolerance, vTolerance;
+};
+
+// One class bit per color; the top bit is reserved for boundary bins of MarkerClassLut
+const int MAX_MARKER_COLORS = 7;
+
+// Same result as cv::cvtColor(COLOR_BGR2HSV) on 8-bit images
+void bgrToHsv(uint8_t b, uint8_t g, uint8_t r, uint8_t& h, uint8_t& s, uint8_t& v);
+
+// BGR -> marker class bitmask (bit c = colors[c]) through a 64x64x64 table indexed by the top
+// six bits of each channel, so one lookup classifies a pixel for all colors. A bin whose 64
+// colors all match or all miss a color stores the answer; a bin crossing a tolerance boundary
+// is flagged and its pixels are converted to HSV and checked exactly. The result therefore
+// equals cvtColor + create_hsv_mask for every pixel. build() combines precomputed H/S/V ranges
+// per bin with the tolerances and is cheap enough for every trackbar change.
+class MarkerClassLut {
+public:
+    static const int BIN_BITS = 6;
+    static const int BINS = 1 << (3 * BIN_BITS);
+
+    MarkerClassLut();
+
+    void build(const std::vector<MarkerColor>& colors);
+
+    uint8_t classify(uint8_t b, uint8_t g, uint8_t r) const {
+        uint8_t classes = table[binIndex(b, g, r)];
+        return (classes & BOUNDARY) ? classifyExact(b, g, r) : classes;
+    }
+    // count BGR pixels (3 bytes each) into count class bytes
+    void classifyRow(const uint8_t* bgr, int count, uint8_t* classes) const;
+
+    // Converts to HSV and checks the ranges, as classify() does for boundary bins
+    uint8_t classifyExact(uint8_t b, uint8_t g, uint8_t r) const;
+
+    bool isBoundaryBin(uint8_t b, uint8_t g, uint8_t r) const { return table[binIndex(b, g, r)] & BOUNDARY; }
+    int boundaryBinCount() const { return boundaryBins; }
+
+private:
+    static const uint8_t BOUNDARY = 0x80;
+    static const int SHIFT = 8 - BIN_BITS;
+
+    static int binIndex(uint8_t b, uint8_t g, uint8_t r) {
+        return ((b >> SHIFT) << (2 * BIN_BITS)) | ((g >> SHIFT) << BIN_BITS) | (r >> SHIFT);
+    }
+
+    std::vector<uint8_t> table;        // BINS entries: class bits or BOUNDARY
+    uint8_t hueBits[256];              // Per-channel class bits for the exact check
+    uint8_t satBits[256];
+    uint8_t valBits[256];
+    int boundaryBins;
+};
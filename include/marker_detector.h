@@ -0,0 +1,141 @@
+#pragma once
+#include "Vehicle.h"
+#include "coordinate_filter.h"
+#include "marker_class_lut.h"
+#include "marker_id.h"
+#include "run_length_labeller.h"
+#include <cstdint>
+#include <vector>
+
+struct MarkerDetectorConfig {
+    std::vector<MarkerColor> colors;             // At most MAX_MARKER_COLORS, further colors are ignored
+    int minSize;                 // Minimum blob (contour) area in px, "Mindest-Groesse"
+    int maxFrontMarkers;         // Front spots per frame
+    float minFrontDistance;      // px between two selected Front spots
+
+    // Tracking mode: between full sweeps only windows around the predicted markers are searched
+    bool roiTracking;
+    int sweepInterval;           // Frames between two periodic full sweeps
+    int roiRadius;               // Half edge of the window around a predicted position, px
+    float trackRadius;           // Max distance of a detection from its track's last position, px
+
+    // Pyramid mode (4 or 8, 1 = off): full sweeps classify every pyramidScale-th pixel first and
+    // search at full resolution only around the coarse hits
+    int pyramidScale;
+
+    // color_definitions, hsv_tolerances and min_size of Farberkennung.py
+    MarkerDetectorConfig();
+};
+
+// 8-bit BGR image as OpenCV stores it, rows stride bytes apart (a crop is a view into the frame)
+struct BgrImageView {
+    const uint8_t* data;
+    int width;
+    int height;
+    int stride;
+};
+
+// Connected region of one marker class
+struct MarkerBlob {
+    MarkerId marker;
+    int pixelCount;
+    float area;                  // Area of the polygon through the border pixel centers (cv2.contourArea)
+    float perimeter;             // Length of that contour (cv2.arcLength)
+    float cx, cy;                // Centroid (first-order moments), sub-pixel
+    int minX, minY, maxX, maxY;
+    float score;                 // area * (1 + compactness), the density score of the Python detector
+};
+
+// Native replacement for SimpleCoordinateDetector.detect_colors: per color an HSV mask,
+// morphological opening with the 3x3 ellipse, 8-connected blobs of at least minSize, up to
+// maxFrontMarkers Front spots with minFrontDistance and the best spot per Heck color, each
+// confirmed by the H value at its centroid. Output order, ids and area (= density score) follow
+// the Python detector; coordinates are sub-pixel instead of truncated. All colors share one
+// pass: a MarkerClassLut lookup gives a class bitmask per pixel, the opening works on all bits
+// at once and a RunLengthLabeller finds the blobs of every color. Not thread-safe (reuses its buffers); use one detector per thread.
+//
+// With roiTracking every detected marker becomes a FilteredPoint track whose velocity the
+// CoordinateFilter motion model keeps up to date. The next frame is only classified, opened and
+// labelled inside windows around the predicted positions (overlapping windows merged), so the
+// pixel work grows with the number of vehicles instead of the image size. The whole frame is
+// swept every sweepInterval frames, when a track was missed or a blob touches a window edge, and
+// while no marker is tracked; a track that a full sweep misses as well is dropped.
+//
+// With pyramidScale > 1 a full sweep first classifies a frame sampled at every pyramidScale-th
+// pixel and row, labels its raw class bits and opens a full-resolution window around each
+// coarse blob. Inside the windows the usual classification, opening and run-length moments
+// run unchanged, so the centroids equal those of the full-resolution path; a blob cut by its
+// window falls back to the full frame. Markers must span about 1.5 * pyramidScale px to be
+// sampled at all.
+class MarkerDetector {
+public:
+    explicit MarkerDetector(const MarkerDetectorConfig& config = MarkerDetectorConfig());
+
+    void setConfig(const MarkerDetectorConfig& config);
+    const MarkerDetectorConfig& getConfig() const { return config; }
+
+    // Appends the markers of the (already cropped) frame; coordinates are crop pixels
+    void detect(const BgrImageView& frame, std::vector<DetectedObject>& objects);
+
+    // Blobs of the last detect() per color, score-sorted, before the Front/Heck selection
+    const std::vector<MarkerBlob>& getBlobs() const { return blobs; }
+
+    // Class bitmask of the last detect() after the opening (bit c = config.colors[c]); in
+    // tracking mode only the last searched window
+    const std::vector<uint8_t>& getClassImage() const { return classes; }
+
+    // Tracking mode state: tracked markers in crop pixels, pixels searched by the last
+    // detect() and whether it was a full sweep
+    const std::vector<FilteredPoint>& getTracks() const { return tracks; }
+    int getLastPixelCount() const { return lastPixelCount; }
+    bool lastFrameWasSweep() const { return lastSweep; }
+    void resetTracking();
+
+    // Blob measures of a component; false if it is smaller than minSize
+    bool measureBlob(const ClassComponent& component, MarkerBlob& blob) const;
+
+private:
+    struct Candidate {
+        MarkerBlob blob;
+        int id;
+    };
+
+    // Searched part of the frame
+    struct Region {
+        int x, y, width, height;
+    };
+
+    bool planRegions();
+    void planPyramidRegions();
+    void mergeRegions();
+    bool searchRegions();
+    void classifyPixels(const Region& region);
+    void openClasses(const Region& region);
+    bool collectBlobs(const Region& region);
+    void updateTracks(const std::vector<DetectedObject>& objects, size_t firstObject);
+    bool hueMatches(const MarkerColor& color, float x, float y) const;
+    void selectCandidates(const MarkerColor& color, size_t firstBlob, int& nextId);
+
+    MarkerDetectorConfig config;
+    MarkerClassLut lut;
+    bool lutCurrent;                   // lut matches config.colors; rebuilt lazily by detect()
+    BgrImageView frame;                // Frame of the running detect()
+    int width, height;
+    std::vector<uint8_t> classes;      // Bit c set: pixel matches config.colors[c]
+    std::vector<uint8_t> scratch;
+    std::vector<uint8_t> coarseClasses;  // Sampled class image of pyramid mode
+    RunLengthLabeller labeller;
+    std::vector<ClassComponent> components;
+    std::vector<MarkerBlob> colorBlobs[MAX_MARKER_COLORS];
+    std::vector<MarkerBlob> blobs;
+    std::vector<Candidate> candidates;
+
+    CoordinateFilter motionModel;      // Velocity/acceleration update and prediction of the tracks
+    std::vector<FilteredPoint> tracks;
+    std::vector<bool> trackMatched;
+    std::vector<Region> regions;
+    int framesSinceSweep;
+    bool sweepRequested;
+    bool lastSweep;
+    int lastPixelCount;
+};
@@ -0,0 +1,26 @@
+#pragma once
+#include <cstdint>
+
+// Interned identity of a detected color marker. The detector reports names ("Front",
+// "Heck1" .. "HeckN"); py_runner turns them into a MarkerId once per detection and everything
+// downstream (points, filter, vehicles, controller mapping) compares small integers.
+using MarkerId = uint8_t;
+
+const MarkerId MARKER_NONE = 0;
+const MarkerId MARKER_FRONT = 1;
+const int MAX_HECK_MARKERS = 30;                 // Heck1 .. Heck30 are MarkerId 2 .. 31
+
+inline bool isFrontMarker(MarkerId marker) { return marker == MARKER_FRONT; }
+inline bool isHeckMarker(MarkerId marker) { return marker >= 2 && marker < 2 + MAX_HECK_MARKERS; }
+
+// Heck number (1 for Heck1), 0 for anything else
+inline int heckNumber(MarkerId marker) { return isHeckMarker(marker) ? marker - 1 : 0; }
+inline MarkerId heckMarker(int number) {
+    return (number >= 1 && number <= MAX_HECK_MARKERS) ? static_cast<MarkerId>(number + 1) : MARKER_NONE;
+}
+
+// Name -> MarkerId without allocating; unknown names give MARKER_NONE
+MarkerId internMarker(const char* name);
+
+// MarkerId -> name in static storage ("" for MARKER_NONE)
+const char* markerName(MarkerId marker);
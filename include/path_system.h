@@ -20,14 +20,17 @@ struct PathSegment {
     int endNodeId;
     float length;
     bool isOccupied;
-    int occupiedByVehicleId;
-    std::vector<int> queuedVehicles;
+    int occupiedByVehicleId;              // Leading vehicle (first one that entered)
+    std::vector<int> occupantVehicleIds;  // All vehicles on the segment in entry order
+    int occupiedFromNodeId;               // Entry node of the occupants = travel direction (-1 = exclusive)
+    double lastEntryTime;                 // Time of the last admission (for headway)
     
     PathSegment() : segmentId(-1), startNodeId(-1), endNodeId(-1), 
-                   length(0), isOccupied(false), occupiedByVehicleId(-1) {}
+                   length(0), isOccupied(false), occupiedByVehicleId(-1),
+                   occupiedFromNodeId(-1), lastEntryTime(0.0) {}
     PathSegment(int id, int start, int end, float len) 
         : segmentId(id), startNodeId(start), endNodeId(end), length(len),
-          isOccupied(false), occupiedByVehicleId(-1) {}
+          isOccupied(false), occupiedByVehicleId(-1), occupiedFromNodeId(-1), lastEntryTime(0.0) {}
 };
 
 class PathSystem {
@@ -49,6 +52,8 @@ public:
     // Path finding
     std::vector<int> findPath(int startNodeId, int endNodeId, 
                              const std::vector<int>& excludedSegments = {}) const;
+    // Shortest route length (px) from startNodeId to every node, indexed by node ID (inf = unreachable)
+    std::vector<float> findDistancesFrom(int startNodeId) const;
     std::vector<Point> getPathPoints(const std::vector<int>& segmentIds) const;
     
     // Utilities
@@ -61,6 +66,7 @@ public:
     const std::vector<PathSegment>& getSegments() const { return segments; }
     size_t getNodeCount() const { return nodes.size(); }
     size_t getSegmentCount() const { return segments.size(); }
+    unsigned int getLayoutVersion() const { return layoutVersion; }  // Increments on every node/segment change
     
     // Public utility functions
     float calculateDistance(const Point& a, const Point& b) const;
@@ -72,6 +78,7 @@ private:
     std::unordered_map<int, size_t> segmentIdToIndex;
     int nextNodeId;
     int nextSegmentId;
+    unsigned int layoutVersion;
     
     void connectNodeToSegment(int nodeId, int segmentId);
 };
@@ -2,7 +2,8 @@
 #ifndef POINT_H
 #define POINT_H
 
-#include <string>
+#include "frame_stamp.h"
+#include "marker_id.h"
 #include <cmath>
 
 enum class PointType {
@@ -15,10 +16,11 @@ struct Point {
     float y;
     bool isDragging;
     PointType type;
-    std::string color; // Farbe des erkannten Objekts
+    MarkerId marker;   // Erkannter Farbmarker (Front, Heck1, ...)
+    FrameStamp stamp;  // Kamera-Frame der Erkennung (nicht gesetzt für berechnete Punkte)
     
-    Point() : x(0.0f), y(0.0f), isDragging(false), type(PointType::IDENTIFICATION), color("") {}
-    Point(float x, float y, PointType t = PointType::IDENTIFICATION, const std::string& c = "") : x(x), y(y), isDragging(false), type(t), color(c) {}
+    Point() : x(0.0f), y(0.0f), isDragging(false), type(PointType::IDENTIFICATION), marker(MARKER_NONE) {}
+    Point(float x, float y, PointType t = PointType::IDENTIFICATION, MarkerId m = MARKER_NONE) : x(x), y(y), isDragging(false), type(t), marker(m) {}
     
     // Calculate distance to another point
     float distanceTo(const Point& other) const;
@@ -28,23 +30,23 @@ struct Point {
     
     // Operators for point arithmetic
     Point operator+(const Point& other) const {
-        return Point(x + other.x, y + other.y, type, color);
+        return Point(x + other.x, y + other.y, type, marker);
     }
     
     Point operator-(const Point& other) const {
-        return Point(x - other.x, y - other.y, type, color);
+        return Point(x - other.x, y - other.y, type, marker);
     }
     
     Point operator*(float scalar) const {
-        return Point(x * scalar, y * scalar, type, color);
+        return Point(x * scalar, y * scalar, type, marker);
     }
     
     Point normalize() const {
         float len = sqrt(x * x + y * y);
         if (len > 0.0f) {
-            return Point(x / len, y / len, type, color);
+            return Point(x / len, y / len, type, marker);
         }
-        return Point(0.0f, 0.0f, type, color);
+        return Point(0.0f, 0.0f, type, marker);
     }
 };
 
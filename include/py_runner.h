@@ -1,8 +1,52 @@
 #pragma once
+#include <chrono>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include "Vehicle.h"
 
+// Ein Datensatz im gepackten Ergebnis von detect_objects_packed() (Little Endian, ohne Padding).
+// Muss zu RECORD in src/detection_packing.py passen.
+struct PackedDetection {
+    int32_t id;
+    char color[8];              // Farbname (Front, Heck1, ...), mit 0 aufgefüllt
+    float x, y;                 // Normalisierte Koordinaten im Crop-Bereich
+    float area;
+    float crop_width;
+    float crop_height;
+};
+static_assert(sizeof(PackedDetection) == 32, "PackedDetection muss detection_packing.RECORD entsprechen");
+
+// Einstellungen aus capture_frame_native(): Kopf, dann colorCount Farbdatensätze in der
+// Reihenfolge von color_definitions. Muss zu SETTINGS_HEADER/SETTINGS_COLOR passen.
+struct PackedDetectorSettings {
+    int32_t minSize;            // Trackbar Mindest-Groesse
+    int32_t colorCount;
+};
+struct PackedMarkerColor {
+    char color[8];              // Farbname, mit 0 aufgefüllt
+    int32_t h, s, v;            // Ziel-HSV (OpenCV-Bereiche)
+    int32_t hTolerance, sTolerance, vTolerance;
+};
+static_assert(sizeof(PackedDetectorSettings) == 8, "PackedDetectorSettings muss detection_packing.SETTINGS_HEADER entsprechen");
+static_assert(sizeof(PackedMarkerColor) == 32, "PackedMarkerColor muss detection_packing.SETTINGS_COLOR entsprechen");
+
+// === ERKENNUNGS-BACKEND ===
+// PYTHON: detect_colors in Farberkennung.py (OpenCV). NATIVE: Python liefert nur Kamerabild
+// und Trackbar-Einstellungen, die Erkennung läuft im C++-MarkerDetector ohne GIL.
+// NATIVE_TRACKING: wie NATIVE, aber zwischen vollen Durchläufen nur Fenster um die
+// vorhergesagten Markerpositionen (MarkerDetectorConfig::roiTracking).
+// Vor dem ersten Frame bzw. vor start_detection_thread() setzen.
+enum class DetectionBackend {
+    PYTHON,
+    NATIVE,
+    NATIVE_TRACKING
+};
+void set_detection_backend(DetectionBackend backend);
+// Grob-Fein-Suche der nativen Erkennung: volle Durchläufe prüfen zuerst nur jedes scale-te
+// Pixel (4 oder 8, 1 = aus), MarkerDetectorConfig::pyramidScale
+void set_native_pyramid_scale(int scale);
+
 // === KOORDINATEN-ERKENNUNG ===
 // Get detected objects with normalized coordinates (mit automatischer Initialisierung)
 std::vector<DetectedObject> get_detected_coordinates();
@@ -10,6 +54,31 @@ std::vector<DetectedObject> get_detected_coordinates();
 // Cleanup coordinate detector resources
 void cleanup_coordinate_detector();
 
+// === ERKENNUNGS-THREAD ===
+// Ergebnis eines Kamera-Frames
+struct DetectionFrame {
+    std::vector<DetectedObject> objects;
+    uint64_t sequence;                                   // Fortlaufend ab 1
+    std::chrono::steady_clock::time_point captureTime;   // Kamerabild gelesen (cap.read() zurück), sonst Frame-Start
+    std::chrono::steady_clock::time_point publishTime;   // Ergebnis übergeben
+
+    DetectionFrame() : sequence(0) {}
+};
+
+// Kamera, Farberkennung und CV2-Fenster laufen in einem eigenen Thread, der den GIL nur
+// während des Python-Aufrufs hält; die Ergebnisse gehen über einen lock-freien Triple-Buffer
+// an die Hauptschleife. Python-Aufrufe aus anderen Threads warten nur auf den GIL.
+bool start_detection_thread();
+void stop_detection_thread();
+
+// Neuestes Ergebnis, ohne zu warten; false (frame unverändert), wenn seit dem letzten Aufruf
+// kein neues kam. Nur aus einem Thread aufrufen (Hauptschleife)
+bool get_latest_detections(DetectionFrame& frame);
+
+// Python-Brücke pro Frame: Modul-Import und Dictionary-Liste (vorher) gegen gecachte Funktion
+// und gepackte Datensätze (nachher), mit synthetischen Erkennungen ohne Kamera
+void run_python_bridge_benchmark();
+
 // === MONITOR 3 FUNKTIONEN ===
 // Aktiviere Monitor 3 Modus für alle CV2-Fenster
 bool enable_python_monitor3_mode();
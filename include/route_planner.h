@@ -0,0 +1,68 @@
+#pragma once
+#include "path_system.h"
+#include "point.h"
+#include "segment_manager.h"
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Everything a route search needs, copied when the request is made
+struct RouteRequest {
+    uint64_t requestId;
+    int vehicleId;
+    Point startPosition;         // Start = nearest node to this position
+    int targetNodeId;
+    unsigned int layoutVersion;  // PathSystem layout the request was made against
+};
+
+struct RouteResult {
+    uint64_t requestId;
+    int vehicleId;
+    int targetNodeId;
+    int startNodeId;             // -1 = no node near the start position
+    std::vector<int> nodePath;   // Empty = no route; just the start node = already at the target
+    unsigned int layoutVersion;
+};
+
+// Background route planning. submit() only enqueues; worker threads run the search
+// and park finished routes in a completion queue that the owner drains with
+// takeCompleted() at a frame boundary (VehicleController::updateVehicles), so the
+// render and control loop never waits for a search.
+//
+// Searches read only the PathSystem layout (nodes, segment lengths and connections);
+// the layout must not change while requests are pending. Results carry the layout
+// version they were computed against so stale ones can be recognized.
+class RoutePlanner {
+public:
+    RoutePlanner(const PathSystem* pathSys, const SegmentManager* segmentMgr, unsigned threadCount = 1);
+    ~RoutePlanner();
+
+    RoutePlanner(const RoutePlanner&) = delete;
+    RoutePlanner& operator=(const RoutePlanner&) = delete;
+
+    void submit(const RouteRequest& request);
+    std::vector<RouteResult> takeCompleted();   // Never blocks
+    size_t getPendingCount() const;             // Submitted, not yet taken
+
+    // The search itself, also used for synchronous planning (VehicleController::planPath)
+    static RouteResult computeRoute(const PathSystem& pathSystem, const SegmentManager& segmentManager,
+                                    const RouteRequest& request);
+    static int findStartNode(const PathSystem& pathSystem, const Point& position);   // -1 = none in reach
+
+private:
+    void workerLoop();
+
+    const PathSystem* pathSystem;
+    const SegmentManager* segmentManager;
+
+    mutable std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<RouteRequest> requests;
+    std::vector<RouteResult> completed;
+    size_t inFlight;
+    bool stopping;
+    std::vector<std::thread> workers;
+};
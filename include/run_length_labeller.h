@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Connected region of one class bit, with the sums the blob measures are derived from.
+// The quad counts are over all 2x2 pixel windows (also those reaching past the image border)
+// by how many of their pixels belong to the component; the contour through the border pixel
+// centers (cv2.findContours) encloses quadFull + quadThree / 2 and has the length
+// quadSide + sqrt(2) * (quadThree + 2 * quadDiagonal). Holes count as part of the component.
+struct ClassComponent {
+    int classIndex;
+    int pixelCount;
+    int64_t sumX, sumY;          // First-order moments in pixel coordinates
+    int minX, minY, maxX, maxY;
+    int quadFull;                // All four set
+    int quadThree;               // Three set
+    int quadSide;                // Two side by side
+    int quadDiagonal;            // Two on a diagonal
+};
+
+// 8-connected components of every bit of a class bitmask image in one row scan. Each row is
+// cut into runs per bit; runs touching a run of the same bit in the row above (diagonals
+// included) are merged with union-find, and pixel count, moments, bounding box and quad
+// counts are summed per run and per touching pair of runs instead of per pixel. Components come out per class in raster order
+// of their first pixel, as a flood fill finds them. Reuses its buffers between frames.
+class RunLengthLabeller {
+public:
+    void label(const uint8_t* classes, int width, int height, int classCount,
+               std::vector<ClassComponent>& components);
+
+private:
+    struct Run {
+        int x0, x1, y;
+        int classIndex;
+        int parent;              // Union-find; the root is the first run of the component
+        int verticalPairs;       // Pixel pairs with the row above: straight above,
+        int diagonalPairs;       // diagonally above,
+        int fullQuads;           // 2x2 windows filled by the two rows,
+        int diagonalQuads;       // windows holding only a diagonal pair
+    };
+
+    int findRoot(int run);
+    void mergeRows(size_t previousBegin, size_t rowBegin);
+
+    std::vector<Run> runs;
+    std::vector<int> componentOfRun;
+};
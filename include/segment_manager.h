@@ -1,6 +1,10 @@
 
 #pragma once
 #include "path_system.h"
+#include "segment_statistics.h"
+#include "segment_queue.h"
+#include "world_snapshot.h"
+#include "event_journal.h"
 #include <unordered_map>
 #include <vector>
 #include <queue>
@@ -10,16 +14,80 @@ class SegmentManager {
 public:
     SegmentManager(PathSystem* pathSys);
 
+    // Const queries may run concurrently from several threads as long as nothing mutates
+    // the manager meanwhile (update() keeps the lazily built lookup tables current).
+
     // Segment reservation system
+    // Without an entry node the reservation is exclusive; with fromNodeId several vehicles
+    // travelling the same direction may share a segment (platooning, see PlatoonConfig).
     bool canVehicleEnterSegment(int segmentId, int vehicleId) const;
+    bool canVehicleEnterSegment(int segmentId, int vehicleId, int fromNodeId) const;
     bool reserveSegment(int segmentId, int vehicleId);
+    bool reserveSegment(int segmentId, int vehicleId, int fromNodeId);
     void releaseSegment(int segmentId, int vehicleId);
 
     // Queue management
     void addToQueue(int segmentId, int vehicleId);
+    void addToQueue(int segmentId, int vehicleId, int fromNodeId);
     void removeFromQueue(int segmentId, int vehicleId);
     void processQueue(int segmentId);
     void updateQueues();
+    const SegmentQueue* getSegmentQueue(int segmentId) const;
+
+    // Queue discipline for contested segments. The key is fixed at enqueue time:
+    // FIFO = enqueue time, PRIORITY = -urgency, SHORTEST_REMAINING_ROUTE = remaining route,
+    // AGING = agingRate * enqueueTime - urgency (waiting agingRate seconds is worth one urgency unit)
+    enum class QueuePolicy { FIFO, PRIORITY, SHORTEST_REMAINING_ROUTE, AGING };
+    struct QueueConfig {
+        QueuePolicy policy;
+        float agingRate;        // Urgency units gained per second of waiting (AGING only)
+
+        QueueConfig() : policy(QueuePolicy::FIFO), agingRate(0.05f) {}
+    };
+    void setQueueConfig(const QueueConfig& config);
+    const QueueConfig& getQueueConfig() const { return queueConfig; }
+
+    // Job data used by the queue keys; read when the vehicle is enqueued
+    struct VehicleQueueInfo {
+        float urgency;          // Higher = more urgent job
+        float remainingRoute;   // Remaining route length (px) or time, smaller = sooner done
+
+        VehicleQueueInfo() : urgency(0.0f), remainingRoute(0.0f) {}
+    };
+    void setVehicleQueueInfo(int vehicleId, const VehicleQueueInfo& info);
+
+    // Copy-on-write snapshots for what-if planning. snapshot() is O(1); the overloads
+    // taking a ReservationSnapshot apply the same admission rules to the copy only,
+    // including dequeueing, dropped corridor holds and group-wide queue admission.
+    // rollback() restores occupancy, queues and clock; statistics and job info are kept.
+    ReservationSnapshot snapshot() const;
+    void rollback(const ReservationSnapshot& snapshot);
+    bool canVehicleEnterSegment(const ReservationSnapshot& state, int segmentId, int vehicleId, int fromNodeId) const;
+    bool reserveSegment(ReservationSnapshot& state, int segmentId, int vehicleId, int fromNodeId) const;
+    void releaseSegment(ReservationSnapshot& state, int segmentId, int vehicleId) const;
+
+    // Simulation clock in seconds, advanced once per frame; also admits queued vehicles
+    void update(float deltaTime);
+    double getCurrentTime() const { return currentTime; }
+
+    // Platooning: segment capacity by length, same direction only, minimum headway between entries
+    struct PlatoonConfig {
+        bool enabled;
+        float vehicleSpacing;   // Segment length (px) needed per admitted vehicle
+        float minHeadwayTime;   // Seconds between two admissions onto the same segment
+
+        PlatoonConfig() : enabled(true), vehicleSpacing(150.0f), minHeadwayTime(1.5f) {}
+    };
+    void setPlatoonConfig(const PlatoonConfig& config);
+    const PlatoonConfig& getPlatoonConfig() const { return platoonConfig; }
+    int getSegmentCapacity(int segmentId) const;
+
+    // Binary event journal (optional, not owned). Public calls are recorded with their
+    // arguments; calls made internally by another journaled call are flagged as derived.
+    void setJournal(EventJournal* eventJournal) { journal = eventJournal; }
+    EventJournal* getJournal() const { return journal; }
+    void journalEvent(JournalEventType type, int vehicleId, int segmentId, int nodeId,
+                      float value = 0.0f, float value2 = 0.0f, uint16_t flags = 0) const;
 
     // Vehicle management
     int getVehicleSegment(int vehicleId) const;
@@ -30,22 +98,33 @@ public:
     std::vector<int> findOptimalPath(int startNodeId, int endNodeId, int vehicleId) const;
     bool isPathClear(const std::vector<int>& path, int vehicleId) const;
 
-    // Time estimation methods
+    // Time estimation methods (from observed traversal/dwell statistics, length/fallbackSpeed otherwise)
     float estimatePathTime(const std::vector<int>& path, int vehicleId) const;
+    float estimateSegmentTime(int segmentId) const;
     float estimateWaitTime(int segmentId, int vehicleId) const;
+    const SegmentStatistics& getStatistics() const { return statistics; }
+    void setFallbackSpeed(float pixelsPerSecond) { fallbackSpeed = pixelsPerSecond; }
 
+    // Estimated wait + direct path against the detour; a cheaper detour is only chosen if a
+    // speculative reservation on a snapshot gets into it now (canUseEvasionRoute at a junction's
+    // evasion segment, the first corridor otherwise)
     bool shouldWaitOrReroute(int currentNodeId, int targetNodeId, int blockedSegmentId, int vehicleId) const;
 
     // Curve point detection
     bool isCurvePoint(int nodeId) const;
     std::vector<int> getCombinedCurveSegments(int nodeId) const;
 
-    // Node type detection
-    enum class NodeType { JUNCTION, WAITING, CURVE, REGULAR };
+    // Node type detection (O(1) lookups into tables rebuilt once per layout version)
+    enum class NodeType { JUNCTION, T_JUNCTION, WAITING, CURVE, REGULAR };
     NodeType getNodeType(int nodeId) const;
     bool isJunctionNode(int nodeId) const;
     bool isWaitingNode(int nodeId) const;
     bool isCurveNode(int nodeId) const;
+
+    // Precomputed waiting node relations
+    int getWaitingNodeJunction(int waitingNodeId) const;         // Associated (T-)junction of a waiting node
+    int getNearestWaitingNode(int nodeId) const;                 // Nearest waiting node by path length
+    int getApproachWaitingNode(int junctionId, int segmentId) const; // Waiting node on the approach via segmentId
     
     // Advanced conflict detection and resolution
     struct ConflictInfo {
@@ -92,8 +171,13 @@ public:
     bool isVehicleWaitingForOurSegments(int waitingVehicleId, int ourVehicleId) const;
     bool segmentsConflict(int seg1, int seg2, int vehicle1, int vehicle2) const;
     
-    // Consolidated segment handling
+    // Consolidated segment handling. Segments meeting at a merged waiting node (a waiting
+    // node between two junctions) form one group, computed with union-find per layout
+    // version. reserveSegment() takes the whole corridor ahead in one step; members further
+    // along stay "held" for the vehicle until it enters them, release stays per segment.
     std::vector<int> getConsolidatedSegmentGroup(int segmentId) const;
+    int getSegmentGroupId(int segmentId) const;
+    std::vector<std::pair<int, int>> getCorridorAhead(int segmentId, int fromNodeId) const;  // (segment, entry node)
     void checkAndAddConnectedSegments(int nodeId, std::vector<int>& toProcess, std::set<int>& processed) const;
     
     // Check if vehicle needs rerouting due to deadlock
@@ -102,13 +186,70 @@ public:
 
     // Status and debugging
     std::vector<int> getOccupiedSegments() const;
+    std::vector<int> getHeldSegments(int vehicleId) const;   // Corridor members held, not yet entered (sorted)
     void printSegmentStatus() const;
 
 private:
+    // Dense per-node/per-segment tables, indexed by node/segment ID.
+    // Segment-side tables use index segmentId * 2 + (junction == startNodeId ? 0 : 1).
+    struct LookupTables {
+        unsigned int layoutVersion;
+        bool valid;
+        std::vector<NodeType> nodeType;
+        std::vector<int> waitingNodeJunction;
+        std::vector<int> nearestWaitingNode;
+        std::vector<int> evasionSegment;
+        std::vector<int> approachWaitingNode;
+        std::vector<int> segmentGroup;                  // Segment ID -> index into groupMembers
+        std::vector<std::vector<int>> groupMembers;
+
+        LookupTables() : layoutVersion(0), valid(false) {}
+    };
+
+    const LookupTables& getLookupTables() const;
+    void rebuildLookupTables() const;
+    static int segmentSideIndex(const PathSegment& segment, int nodeId);
+    SegmentQueue* getQueue(int segmentId);
+    double queueKey(int vehicleId, double enqueueTime) const;
+
+    // Admission rule shared by live and speculative reservations; corridorEntry is the
+    // vehicle's queue entry on the entered segment (nullptr for the entered segment itself)
+    bool admits(const SegmentReservationState& state, int segmentId, int vehicleId, int fromNodeId, double now,
+                const SegmentQueue::Entry* corridorEntry) const;
+    void publishSegment(int segmentId);
+    void restoreSegment(int segmentId, const SegmentReservationState& state);
+
+    // Corridor reservation helpers
+    bool reserveCorridor(int segmentId, int vehicleId, int fromNodeId);
+    void leaveQueue(int segmentId, int vehicleId);
+    void occupySegment(int segmentId, int vehicleId, int fromNodeId, bool entered);
+    bool enterHeldSegment(int segmentId, int vehicleId);
+    void dropHeldSegments(int vehicleId, const std::vector<std::pair<int, int>>& keep);
+    bool isHeldBy(int segmentId, int vehicleId) const;
+
+    // The same steps on a snapshot; held segments are found by scanning, the snapshot has no per-vehicle index
+    void processQueue(ReservationSnapshot& state, int segmentId) const;
+    void dropHeldSegments(ReservationSnapshot& state, int vehicleId, const std::vector<std::pair<int, int>>& keep) const;
+
     PathSystem* pathSystem;
-    std::unordered_map<int, std::queue<int>> segmentQueues;
+    mutable LookupTables lookupTables;
+    PlatoonConfig platoonConfig;
+    double currentTime;
+    EventJournal* journal;
+    int journalDepth;
+    QueueConfig queueConfig;
+    uint64_t queueSequence;
+    std::vector<SegmentQueue> segmentQueues;                // Indexed by segment ID
+    std::unordered_map<int, VehicleQueueInfo> vehicleQueueInfo;
+    ReservationSnapshot reservations;   // Persistent mirror of the live occupancy/queues
+    std::unordered_map<int, std::vector<int>> heldSegments;  // Corridor members reserved but not yet entered
+
+    // Timing statistics
+    SegmentStatistics statistics;
+    float fallbackSpeed;                                // px/s used before a segment has samples
+    std::unordered_map<int, double> vehicleEntryTime;   // Time the vehicle entered its segment
     std::unordered_map<int, int> vehicleToSegment;
-    std::unordered_map<int, float> segmentReserveTime;
+    std::unordered_map<int, double> segmentReserveTime;
     std::unordered_map<int, std::vector<int>> reservedCurveSegments;
     std::set<int> deadlockedVehicles;
 };
@@ -0,0 +1,56 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Admission queue of one segment as an indexed binary min-heap.
+// Entries are ordered by (key, sequence): the queue discipline only decides the
+// key when a vehicle is enqueued, the sequence number keeps equal keys FIFO.
+// push/pop/remove are O(log n); the position index makes contains O(1).
+class SegmentQueue {
+public:
+    struct Entry {
+        int vehicleId;
+        int fromNodeId;      // Entry node the vehicle will come from (-1 = exclusive)
+        double enqueueTime;  // Simulation time the vehicle joined the queue
+        double key;          // Lower key = admitted earlier
+        uint64_t sequence;   // Tie-breaker, increasing per enqueue
+    };
+
+    bool empty() const { return heap.empty(); }
+    size_t size() const { return heap.size(); }
+    const Entry& top() const { return heap.front(); }
+
+    bool contains(int vehicleId) const { return position.count(vehicleId) > 0; }
+    Entry* find(int vehicleId);
+
+    bool push(const Entry& entry);   // false if the vehicle is already queued
+    void pop();
+    bool remove(int vehicleId);
+    void clear();
+
+    // Number of entries admitted before vehicleId (size() if not queued), O(n)
+    size_t countAhead(int vehicleId) const;
+
+    // All entries in admission order (copy, for status output and analysis)
+    std::vector<Entry> ordered() const;
+
+    // Recompute all keys (e.g. after a policy change) and restore the heap, O(n)
+    template <typename KeyFunction>
+    void rekey(KeyFunction keyOf) {
+        for (Entry& entry : heap) entry.key = keyOf(entry);
+        for (size_t i = heap.size() / 2; i-- > 0;) siftDown(i);
+    }
+
+private:
+    static bool before(const Entry& a, const Entry& b) {
+        return a.key < b.key || (a.key == b.key && a.sequence < b.sequence);
+    }
+    void swapEntries(size_t a, size_t b);
+    void siftUp(size_t index);
+    void siftDown(size_t index);
+
+    std::vector<Entry> heap;
+    std::unordered_map<int, size_t> position;  // vehicleId -> index in heap
+};
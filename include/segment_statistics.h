@@ -0,0 +1,75 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Online per-segment timing statistics, fed by reservation/release events.
+// Each segment keeps an EWMA and a log-bucketed quantile sketch for traversal
+// time (reserve -> release) and dwell time (queued -> admitted). Recording and
+// reading only use relaxed atomics, so planners on other threads can query
+// estimates while the control loop records. reset() is not thread-safe.
+class SegmentStatistics {
+public:
+    static const int BIN_COUNT = 48;             // Bins cover ~0.05 s .. ~2200 s
+    static constexpr float BIN_BASE = 0.05f;     // Upper edge of the first bin (seconds)
+    static constexpr float BIN_GROWTH = 1.25f;   // Ratio between consecutive bin edges
+
+    struct SegmentSnapshot {
+        int segmentId;
+        uint64_t traversalCount;
+        float traversalEwma;
+        float traversalP50;
+        float traversalP90;
+        float traversalP99;
+        uint64_t dwellCount;
+        float dwellEwma;
+        float dwellP50;
+        float dwellP99;
+    };
+
+    explicit SegmentStatistics(size_t segmentCount = 0, float ewmaAlpha = 0.2f);
+
+    void reset(size_t segmentCount);
+    size_t getSegmentCount() const { return segmentCount; }
+
+    // Recording (lock-free)
+    void recordTraversal(int segmentId, float seconds);
+    void recordDwell(int segmentId, float seconds);
+
+    // Queries - return -1 if there are no samples yet
+    float getTraversalEstimate(int segmentId) const;
+    float getTraversalQuantile(int segmentId, float quantile) const;
+    float getDwellEstimate(int segmentId) const;
+    float getDwellQuantile(int segmentId, float quantile) const;
+    uint64_t getTraversalCount(int segmentId) const;
+
+    // Offline analysis
+    std::vector<SegmentSnapshot> snapshot() const;
+    bool writeCsv(const std::string& filename) const;
+
+private:
+    struct Series {
+        std::atomic<uint64_t> count;
+        std::atomic<uint32_t> ewmaBits;   // float stored as raw bits for atomic CAS
+        std::atomic<uint32_t> bins[BIN_COUNT];
+    };
+    struct SegmentCounters {
+        Series traversal;
+        Series dwell;
+    };
+
+    static void record(Series& series, float seconds, float alpha);
+    static float ewma(const Series& series);
+    static float quantile(const Series& series, float q);
+    static int binIndex(float seconds);
+    static float binValue(int bin);
+
+    const Series* traversalSeries(int segmentId) const;
+    const Series* dwellSeries(int segmentId) const;
+
+    std::unique_ptr<SegmentCounters[]> counters;
+    size_t segmentCount;
+    float alpha;
+};
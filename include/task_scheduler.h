@@ -0,0 +1,68 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small work-stealing thread pool for per-frame fleet work.
+// parallelFor() cuts [0, count) into chunks of grainSize, deals them round-robin
+// onto per-worker deques and lets the calling thread help. A worker takes its own
+// chunks from the back and steals from the front of the others when it runs dry.
+//
+// Chunk boundaries depend only on count and grainSize, never on the thread count.
+// Tasks that write only to their own indices give the same result with 1 or N threads.
+//
+// parallelFor() must not be called from inside a task or from two threads at once.
+class TaskScheduler {
+public:
+    using RangeTask = std::function<void(size_t begin, size_t end)>;
+
+    // 0 = one thread per hardware thread; 1 = everything runs inline on the caller
+    explicit TaskScheduler(unsigned threadCount = 0);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    unsigned getThreadCount() const { return static_cast<unsigned>(queues.size()); }   // Including the caller
+
+    // Blocks until task has run for every chunk
+    void parallelFor(size_t count, size_t grainSize, const RangeTask& task);
+
+    // Number of chunks executed by a thread other than the one they were dealt to
+    size_t getStealCount() const { return steals.load(std::memory_order_relaxed); }
+
+private:
+    struct Chunk {
+        size_t begin;
+        size_t end;
+    };
+
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Chunk> chunks;
+    };
+
+    bool popLocal(size_t worker, Chunk& chunk);
+    bool steal(size_t thief, Chunk& chunk);
+    bool runOne(size_t worker);
+    void workerLoop(size_t worker);
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;   // Index 0 = calling thread
+    std::vector<std::thread> workers;
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    uint64_t batchNumber;                  // Guarded by wakeMutex
+    bool stopping;                         // Guarded by wakeMutex
+
+    const RangeTask* currentTask;          // Valid while a batch runs
+    std::atomic<size_t> remainingChunks;
+    std::atomic<size_t> steals;
+};
@@ -23,7 +23,8 @@ void updateTestWindowVehicles(const std::vector<Auto>& vehicles);
 void setTestWindowPathSystem(const PathSystem* pathSystem, const VehicleController* vehicleController);
 
 // Kalibrierte Koordinaten-Transformation (öffentlich verfügbar)
-void getCalibratedTransform(float crop_x, float crop_y, float crop_width, float crop_height, float& fullscreen_x, float& fullscreen_y);
+// false: Punkt liegt außerhalb von Crop oder Vollbild und ist zu verwerfen
+bool getCalibratedTransform(float crop_x, float crop_y, float crop_width, float crop_height, float& fullscreen_x, float& fullscreen_y);
 
 // Manuelle Test-Funktionen
 Point getManualVehiclePosition();
@@ -0,0 +1,75 @@
+#pragma once
+#include "segment_manager.h"
+#include <random>
+#include <string>
+
+// Segment-level traffic simulation on the factory layout (no window, no camera).
+// Vehicles drive random node-to-node trips at constant speed, reserving each segment
+// through the real SegmentManager and queueing when it is not available.
+// With jobsPerVehicle > 0 every vehicle stops after that many trips (makespan runs);
+// each trip gets a random urgency in [0, 1] for the queue policies.
+struct TrafficBenchmarkConfig {
+    int vehicleCount;
+    float simulatedSeconds;
+    float timeStep;
+    float vehicleSpeed;                         // px per second
+    unsigned int seed;
+    int jobsPerVehicle;                         // 0 = drive until simulatedSeconds
+    SegmentManager::PlatoonConfig platoon;
+    SegmentManager::QueueConfig queue;
+    std::string statisticsCsv;                  // Segment statistics snapshot after the run (empty = none)
+
+    TrafficBenchmarkConfig() : vehicleCount(8), simulatedSeconds(1800.0f), timeStep(0.05f),
+                               vehicleSpeed(100.0f), seed(42), jobsPerVehicle(0) {}
+};
+
+struct TrafficBenchmarkResult {
+    std::string label;
+    int completedTrips;
+    float tripsPerMinute;
+    float averageTripTime;      // Seconds per completed trip
+    float averageWaitPerTrip;   // Seconds spent queueing per completed trip
+    float averageEtaError;      // |predicted - actual| trip time at trip start, seconds
+    float makespan;             // Time the last job finished (simulatedSeconds if unfinished)
+    float p99Wait;              // 99th percentile of single queue waits (seconds)
+    float maxWait;              // Longest single queue wait (starvation indicator)
+};
+
+// Random main node (no waiting node) different from currentNodeId, -1 if there is none
+int pickRandomTarget(const PathSystem& pathSystem, int currentNodeId, std::mt19937& rng);
+
+TrafficBenchmarkResult runTrafficBenchmark(const std::string& label, const TrafficBenchmarkConfig& config);
+void printTrafficBenchmarkResult(const TrafficBenchmarkResult& result);
+
+// Exclusive segments vs. platooning at several fleet sizes. A non-empty statisticsCsv
+// receives the segment statistics of the 16-vehicle platooning run.
+void runPlatooningComparison(const std::string& statisticsCsv = "");
+
+// FIFO vs. priority vs. shortest-remaining-route vs. aging on a fixed job set
+void runQueuePolicyComparison();
+
+// Admission order of three vehicles the VehicleController queued at one segment, per policy
+// (urgency from the job, remaining route from the controller's route)
+void runControllerQueuePolicyCheck();
+
+// WorldSnapshot of a running fleet, then driving on (reservations, releases, queueing, one vehicle
+// removed and one added) and rollbackWorld(): occupants, queues, held corridors and vehicle
+// records must equal the state at the snapshot
+void runWorldSnapshotCheck();
+
+// Per-frame VehicleController cost (update + ID list + lookup of every vehicle) with simulated
+// movement on random trips, its hot column sync, movement kernel and replanning phases, and conflict
+// detection at 10/100/1000 vehicles, single-threaded and on all hardware threads
+void runFleetUpdateBenchmark();
+
+// JobDispatcher batch latency (distance matrix + assignment, and including route
+// planning) for several vehicle x job sizes, with the total travel time against greedy nearest-job
+void runDispatchBenchmark();
+
+// VehicleSpatialHash risk search against the all-pairs reference on synthetic fleets of
+// 100/1000/10000 vehicles at constant density (build time, query time, identical results)
+void runCollisionBenchmark();
+
+// Per-frame identity handling of the detections (boundary, Front/Heck split, filter key,
+// vehicle ID, controller mapping) with color strings against interned MarkerIds
+void runMarkerBenchmark();
@@ -0,0 +1,40 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+// Lock-free single-producer/single-consumer handoff of the latest value. The writer fills
+// writeSlot() and publish()es it; the reader calls update() and, if it returns true, reads
+// readSlot() until its next update(). Neither side ever waits: the writer overwrites a value
+// the reader skipped, the reader keeps the previous value while nothing new arrived.
+// Slots are reused, so containers inside T keep their capacity between frames.
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle(1), writeIndex(0), readIndex(2) {}
+
+    TripleBuffer(const TripleBuffer&) = delete;
+    TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+    // Writer thread only
+    T& writeSlot() { return slots[writeIndex]; }
+    void publish() {
+        writeIndex = middle.exchange(static_cast<uint8_t>(writeIndex | FRESH), std::memory_order_acq_rel) & INDEX_MASK;
+    }
+
+    // Reader thread only
+    bool update() {
+        if (!(middle.load(std::memory_order_acquire) & FRESH)) return false;
+        readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+    const T& readSlot() const { return slots[readIndex]; }
+
+private:
+    static const uint8_t INDEX_MASK = 3;
+    static const uint8_t FRESH = 4;          // Middle slot holds a value the reader has not taken yet
+
+    T slots[3];
+    std::atomic<uint8_t> middle;             // Index of the slot between writer and reader, plus FRESH
+    uint8_t writeIndex;
+    uint8_t readIndex;
+};
@@ -1,7 +1,17 @@
 #pragma once
 #include "auto.h"
 #include "path_system.h"
+#include "route_planner.h"
 #include "segment_manager.h"
+#include "task_scheduler.h"
+#include "vehicle_events.h"
+#include "vehicle_spatial_hash.h"
+#include "vehicle_store.h"
+#include "world_snapshot.h"
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <random>
 #include <vector>
 #include <unordered_map>
 
@@ -25,18 +35,60 @@ class VehicleController {
 public:
     VehicleController(PathSystem* pathSys, SegmentManager* segmentMgr);
 
+    // Per-frame work (movement, conflict detection, replanning) is split into parallel
+    // read phases and a serial apply phase in dense vehicle order, so results do not
+    // depend on the thread count. nullptr = everything runs on the calling thread.
+    void setTaskScheduler(TaskScheduler* taskScheduler) { scheduler = taskScheduler; }
+
+    // Simulated movement: updateVehicles() drives vehicles along currentNodePath at
+    // Auto::speed, reserving each segment on entry (headless simulation). Off = positions
+    // come from the camera (updateVehicleFromRealCoordinates).
+    void setSimulatedMovement(bool enabled) { simulatedMovement = enabled; }
+    bool isSimulatedMovement() const { return simulatedMovement; }
+
+    // Wall time of the phases of the last updateVehicles() call
+    struct UpdateTiming {
+        std::chrono::steady_clock::duration sync;          // Records edited since the last frame -> hot columns
+        std::chrono::steady_clock::duration movement;      // Parallel kinematics on the hot columns
+        std::chrono::steady_clock::duration transitions;   // Write-back, node transitions, reservations
+        std::chrono::steady_clock::duration replanning;    // updateVehiclePaths()
+    };
+    const UpdateTiming& getLastUpdateTiming() const { return lastUpdateTiming; }
+    void setLoggingEnabled(bool enabled) { loggingEnabled = enabled; }
+
+    // Background route planning for requestVehicleTarget(); nullptr = plan synchronously
+    void setRoutePlanner(RoutePlanner* routePlanner) { planner = routePlanner; }
+
+    // Progress events (node reached, blocked, replanned, route completed); queued as they
+    // happen and delivered in one batch per type at the end of updateVehicles()
+    VehicleEventBus& getEventBus() { return events; }
+
     // Vehicle management
     int addVehicle(const Point& startPosition);
     void removeVehicle(int vehicleId);
     void spawnInitialVehicles();
     void assignRandomTargetsToAllVehicles();
+    // Returned pointers stay valid until the next addVehicle/removeVehicle
     Auto* getVehicle(int vehicleId);
     const Auto* getVehicle(int vehicleId) const;
+    VehicleHandle getVehicleHandle(int vehicleId) const { return vehicles.handleOf(vehicleId); }
+    const Auto* getVehicle(VehicleHandle handle) const;
 
     // Smart target assignment
     bool setVehicleTargetNode(int vehicleId, int targetNodeId);  // Changed to bool return
+    // Non-blocking: the route is planned on the RoutePlanner and committed by the next
+    // updateVehicles(); until then the vehicle keeps its current route. The future is
+    // true once the route is committed, false if it failed or a newer target replaced it.
+    std::future<bool> requestVehicleTarget(int vehicleId, int targetNodeId);
+    bool hasPendingRoute(int vehicleId) const { return latestRouteRequest.count(vehicleId) != 0; }
+    // Callable from any thread (e.g. the Windows test window): the target is requested
+    // with requestVehicleTarget() at the start of the next updateVehicles()
+    void postVehicleTarget(int vehicleId, int targetNodeId);
     void assignNewRandomTarget(int vehicleId);
     bool isVehicleAtTarget(int vehicleId) const;
+    // Urgency of the vehicle's current job. A blocked vehicle queues with it and its
+    // remaining route length, so the SegmentManager queue policy decides who enters first.
+    void setVehicleJobUrgency(int vehicleId, float urgency);
 
     // Movement control
     void setVehicleTarget(int vehicleId, const Point& targetPosition);
@@ -48,6 +100,20 @@ public:
     bool hasVehicleArrived(int vehicleId) const;
     std::vector<int> getVehiclesAtPosition(const Point& position, float radius = 20.0f) const;
 
+    // Predictive collision checking. Every vehicle is swept COLLISION_LOOKAHEAD seconds
+    // ahead along its route at its speed (standing vehicles stay put); the corridors go
+    // into a spatial hash that is built on the first query after the fleet changed, so
+    // all queries of one frame share it. Risks are reported, not enforced: segment
+    // reservations stay the only thing that holds vehicles back.
+    static constexpr float COLLISION_LOOKAHEAD = 2.0f;     // Seconds
+    static constexpr float MIN_VEHICLE_DISTANCE = 60.0f;   // px between vehicle centers
+    std::vector<CollisionRisk> detectCollisionRisks(float minDistance = MIN_VEHICLE_DISTANCE) const;
+    bool hasMinimumDistanceToOtherVehicles(const Auto& vehicle, float minDistance) const;
+    // Straight move to targetPosition at the vehicle's speed against the other corridors
+    bool canMoveWithoutViolatingDistance(const Auto& vehicle, const Point& targetPosition, float minDistance) const;
+    // Driving segmentId to its far end would come within MIN_VEHICLE_DISTANCE of another vehicle
+    bool checkCollisionRisk(const Auto& vehicle, int segmentId) const;
+
     // Advanced conflict detection and resolution
     struct VehicleConflict {
         int vehicleId1;
@@ -57,6 +123,10 @@ public:
         bool canNegotiate;
     };
 
+    // Vehicle pairs expected at the same junction (3+ segments) within 2 s, at the earliest such
+    // junction on the first vehicle's route, ordered by dense index. Arrivals are bucketed per
+    // junction, so the cost follows the pairs that actually meet. Not run by updateVehicles():
+    // segment reservations are what holds vehicles back and nothing acts on the conflicts yet.
     std::vector<VehicleConflict> detectUpcomingConflicts() const;
     bool shouldVehicleWaitForConflictResolution(int vehicleId, const std::vector<VehicleConflict>& conflicts) const;
     bool resolveConflictThroughNegotiation(const VehicleConflict& conflict);
@@ -72,7 +142,7 @@ public:
     bool planDynamicPath(int vehicleId, int targetNodeId);
     void updateVehiclePaths();
     std::vector<int> calculateIntermediatePath(int vehicleId, const Point& currentPos, int targetNodeId);
-    bool needsPathRecalculation(int vehicleId);
+    bool needsPathRecalculation(int vehicleId) const;   // Blocked and a detour is cheaper than waiting
 
     // Vehicle coordination
     void coordinateVehicleMovements();
@@ -81,11 +151,19 @@ public:
 
     // Real coordinate integration
     void updateVehicleFromRealCoordinates(int vehicleId, const Point& realPosition, float realDirection);
-    int mapRealVehicleToSystem(const Point& realPosition, const std::string& vehicleColor);
+    int mapRealVehicleToSystem(const Point& realPosition, MarkerId vehicleMarker);
     void syncRealVehiclesWithSystem(const std::vector<Auto>& detectedAutos);
 
-    // Getters
-    const std::unordered_map<int, Auto>& getAllVehicles() const { return vehicles; }
+    // Copy-on-write snapshots of the fleet (and, via the World variants, the reservations).
+    // snapshot() re-publishes only vehicles touched since the last call; rollback() restores
+    // only vehicles that differ from the snapshot.
+    VehicleSnapshot snapshot();
+    void rollback(const VehicleSnapshot& snapshot);
+    WorldSnapshot snapshotWorld();
+    void rollbackWorld(const WorldSnapshot& snapshot);
+
+    // Getters (dense order, changes when vehicles are removed)
+    const std::vector<Auto>& getAllVehicles() const { return vehicles.allRecords(); }
     size_t getVehicleCount() const { return vehicles.size(); }
     const PathSystem* getPathSystem() const { return pathSystem; }
     
@@ -94,13 +172,30 @@ public:
     std::vector<int> getActiveVehicleIds() const;
 
 private:
-    void updateVehicleMovement(Auto& vehicle, float deltaTime);
+    // Runs as a parallel task: may only write hot columns (and nodeReached) of its own dense index
+    bool updateVehicleMovement(size_t index, float deltaTime);   // true if hot data changed
     void updateVehicleMovements(float deltaTime);
     void handleBlockedVehicle(Auto& vehicle);
     bool replanPathIfBlocked(int vehicleId);
     void moveVehicleAlongPath(Auto& vehicle, float deltaTime);
-    bool checkCollisionRisk(const Auto& vehicle, int segmentId);
     Point interpolatePosition(const Point& start, const Point& end, float t) const;
+    void runParallel(size_t count, size_t grainSize, const TaskScheduler::RangeTask& task) const;
+    struct JunctionArrival {
+        int nodeId;
+        float time;    // Expected seconds until the vehicle reaches the junction
+    };
+    std::vector<JunctionArrival> getJunctionArrivals(const Auto& vehicle) const;   // Junctions = 3+ segments
+    std::vector<int> planDetour(const Auto& vehicle) const;            // Node path, empty = keep route
+    int nextSegmentOnRoute(const Auto& vehicle, int& fromNodeId) const; // -1 = no segment ahead
+    float remainingRouteLength(const Auto& vehicle) const;              // px from the current node to the target
+    std::vector<int> toNodePath(int startNodeId, const std::vector<int>& segmentPath) const;
+    VehicleCorridor buildCorridor(const Auto& vehicle) const;
+    VehicleCorridor sweepCorridor(int vehicleId, const std::vector<Point>& waypoints, float speed) const;
+    const VehicleSpatialHash& getSpatialHash() const;
+    RouteRequest makeRouteRequest(const Auto& vehicle, int targetNodeId) const;
+    bool commitRoute(Auto& vehicle, const RouteResult& route);    // planPath's apply step
+    bool applyRoute(Auto& vehicle, const RouteResult& route);     // ... plus target and logging
+    void applyPlannedRoutes();
     bool tryReserveNextSegment(Auto& vehicle);
     void releaseCurrentSegment(Auto& vehicle);
 
@@ -123,8 +218,6 @@ private:
     Direction calculateDirection(const Point& from, const Point& to);
     Direction getOppositeDirection(Direction dir);
     bool tryEvasionRoute(int vehicleId, int tJunctionId);
-    bool hasMinimumDistanceToOtherVehicles(const Auto& vehicle, float minDistance);
-    bool canMoveWithoutViolatingDistance(const Auto& vehicle, const Point& targetPosition, float minDistance);
 
     // Junction-specific helper methods
     bool hasNearbyVehiclesAtSameJunction(const Auto& vehicle);
@@ -133,7 +226,35 @@ private:
 
     PathSystem* pathSystem;
     SegmentManager* segmentManager;
-    std::unordered_map<int, Auto> vehicles;  // Changed from vector to unordered_map
-    std::unordered_map<std::string, int> colorToVehicleId; // Map vehicle colors to IDs
+    VehicleStore vehicles;
+    TaskScheduler* scheduler;
+    std::vector<uint8_t> movementChanged;    // Per dense index, filled by the parallel movement phase
+    std::vector<uint8_t> nodeReached;        // Per dense index: reached the next route node this frame
+    UpdateTiming lastUpdateTiming;
+    int markerToVehicleId[2 + MAX_HECK_MARKERS];   // Vehicle ID per detected marker, 0 = unmapped
     int nextVehicleId;
+    bool loggingEnabled;
+    bool simulatedMovement;
+    std::mt19937 targetRng;                  // assignRandomTargetsToAllVehicles
+
+    VehicleEventBus events;
+
+    // Background planning: newest request per vehicle, promises until commit
+    RoutePlanner* planner;
+    uint64_t nextRouteRequestId;
+    std::unordered_map<int, uint64_t> latestRouteRequest;
+    std::unordered_map<uint64_t, std::promise<bool>> pendingRoutes;
+    std::mutex postedTargetsMutex;
+    std::vector<std::pair<int, int>> postedTargets;   // (vehicle ID, target node) from other threads
+
+    // Collision corridors of the current fleet state, rebuilt lazily (see getSpatialHash)
+    mutable std::mutex spatialHashMutex;
+    mutable VehicleSpatialHash spatialHash;
+    mutable bool spatialHashValid;
+
+    // Snapshot bookkeeping: every mutable access marks the vehicle dirty
+    void markDirty(int vehicleId);
+    VehicleSnapshot publishedVehicles;
+    std::vector<int> dirtyVehicles;
+    std::vector<uint8_t> dirtyFlags;         // Indexed by vehicle ID
 };
\ No newline at end of file
@@ -0,0 +1,93 @@
+#pragma once
+#include <functional>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+// Vehicle progress events emitted by the VehicleController. Times are SegmentManager clock seconds.
+struct NodeReachedEvent {
+    int vehicleId;
+    int nodeId;
+    size_t routeIndex;     // Index of nodeId in the route
+    size_t routeLength;    // Nodes in the route
+    double time;
+};
+
+struct RouteCompletedEvent {
+    int vehicleId;
+    int targetNodeId;
+    double time;
+};
+
+// Vehicle stopped in front of a segment it could not enter (once per wait, not per frame)
+struct VehicleBlockedEvent {
+    int vehicleId;
+    int nodeId;            // Where it waits
+    int segmentId;         // What it waits for
+    double time;
+};
+
+struct RouteReplannedEvent {
+    int vehicleId;
+    int targetNodeId;
+    size_t routeLength;    // Nodes in the new route
+    bool detour;           // Rerouted around a blocked segment (same target)
+    double time;
+};
+
+// Typed publish/subscribe with one queue per event type. publish() only queues; dispatch()
+// hands every subscriber the whole batch of its type once per frame (VehicleController calls
+// it at the end of updateVehicles). Types are delivered in the order NodeReached, Blocked,
+// Replanned, RouteCompleted, each batch in publish order. Events published by a handler go
+// out with the next dispatch. Not thread-safe: publish, subscribe and dispatch on the
+// thread that drives the controller.
+class VehicleEventBus {
+public:
+    template <typename Event>
+    using Handler = std::function<void(const std::vector<Event>& batch)>;
+
+    VehicleEventBus() : nextSubscriptionId(1) {}
+
+    VehicleEventBus(const VehicleEventBus&) = delete;
+    VehicleEventBus& operator=(const VehicleEventBus&) = delete;
+
+    template <typename Event>
+    int subscribe(Handler<Event> handler) {
+        int subscriptionId = nextSubscriptionId++;
+        channel<Event>().subscribers.emplace_back(subscriptionId, std::move(handler));
+        return subscriptionId;
+    }
+    void unsubscribe(int subscriptionId);
+
+    template <typename Event>
+    void publish(const Event& event) { channel<Event>().pending.push_back(event); }
+
+    void dispatch();
+    void clear();                  // Drop pending events without delivering them
+    size_t getPendingCount() const;
+
+private:
+    template <typename Event>
+    struct Channel {
+        std::vector<Event> pending;
+        std::vector<Event> delivering;   // Kept between frames so the batch buffers are reused
+        std::vector<std::pair<int, Handler<Event>>> subscribers;
+    };
+
+    template <typename Event>
+    Channel<Event>& channel() { return std::get<Channel<Event>>(channels); }
+
+    template <typename Event>
+    static void deliver(Channel<Event>& target) {
+        if (target.pending.empty()) return;
+        target.delivering.clear();
+        target.delivering.swap(target.pending);
+        // Copy: a handler may unsubscribe while the batch is delivered
+        std::vector<std::pair<int, Handler<Event>>> subscribers = target.subscribers;
+        for (const auto& subscriber : subscribers) subscriber.second(target.delivering);
+    }
+
+    std::tuple<Channel<NodeReachedEvent>, Channel<VehicleBlockedEvent>,
+               Channel<RouteReplannedEvent>, Channel<RouteCompletedEvent>> channels;
+    int nextSubscriptionId;
+};
@@ -0,0 +1,80 @@
+#pragma once
+#include "point.h"
+#include <cstdint>
+#include <vector>
+
+// Where a vehicle will be over the next seconds: a polyline through its route with the
+// time (seconds from now) each point is reached. points[0] is the current position at
+// time 0. A standing vehicle has a single point.
+struct VehicleCorridor {
+    int vehicleId;
+    std::vector<Point> points;
+    std::vector<float> times;
+};
+
+// Two corridors that come closer than the minimum distance within the look-ahead
+struct CollisionRisk {
+    int vehicleId1;
+    int vehicleId2;
+    float time;          // Seconds until the distance first drops below the minimum
+    float distance;      // Closest approach within the look-ahead (px)
+};
+
+// Uniform grid over the swept corridors of the fleet, rebuilt once per frame. Cells are
+// hashed into a flat bucket table (counting sort, no per-cell allocations); a corridor is
+// filed in every cell its bounding box touches. Pair tests only run for corridors found
+// through the cells around each other, so findRisks() costs O(n) for a fleet spread over
+// the layout instead of O(n^2).
+//
+// Corridors are compared in time, not only in space: both vehicles move linearly between
+// corridor points, and the closest approach is solved per overlapping time interval. Two
+// vehicles crossing the same spot seconds apart, or following each other at constant
+// spacing, are not a risk.
+class VehicleSpatialHash {
+public:
+    explicit VehicleSpatialHash(float cellSize = 100.0f);
+
+    // Corridors shorter than the horizon are held at their last point until the horizon
+    void build(std::vector<VehicleCorridor> corridors, float horizon);
+    void clear();
+
+    size_t size() const { return corridors.size(); }
+    const std::vector<VehicleCorridor>& getCorridors() const { return corridors; }
+    float getHorizon() const { return horizon; }
+
+    // Vehicles whose current position lies within radius, in build order
+    std::vector<int> queryRadius(const Point& position, float radius) const;
+
+    // Risks of an extra corridor (e.g. a planned move) against the filed ones; vehicleId
+    // of the probe itself is skipped
+    std::vector<CollisionRisk> findRisks(const VehicleCorridor& probe, float minDistance) const;
+
+    // All pairs at risk, ordered by (vehicleId1 build position, vehicleId2 build position)
+    std::vector<CollisionRisk> findRisks(float minDistance) const;
+    std::vector<CollisionRisk> findRisksBruteForce(float minDistance) const;   // Reference, O(n^2)
+
+    // Exact test of two corridors; false if they never come closer than minDistance
+    static bool closestApproach(const VehicleCorridor& a, const VehicleCorridor& b, float minDistance,
+                                CollisionRisk& risk);
+
+private:
+    struct Bounds {
+        float minX, minY, maxX, maxY;
+    };
+    struct CellRange {
+        int minX, minY, maxX, maxY;
+    };
+
+    CellRange cellsOf(const Bounds& bounds, float margin) const;
+    size_t bucketOf(int cellX, int cellY) const;
+    void collectCandidates(const Bounds& bounds, float margin, std::vector<uint32_t>& candidates) const;
+    static Bounds boundsOf(const VehicleCorridor& corridor);
+    static bool overlaps(const Bounds& a, const Bounds& b, float margin);
+
+    float cellSize;
+    float horizon;
+    std::vector<VehicleCorridor> corridors;
+    std::vector<Bounds> bounds;                 // Per corridor
+    std::vector<uint32_t> bucketStart;          // Table size + 1 offsets into entries
+    std::vector<uint32_t> entries;              // Corridor indices, grouped by bucket
+};
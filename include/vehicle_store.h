@@ -0,0 +1,103 @@
+#pragma once
+#include "auto.h"
+#include "path_system.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Generational handle into a VehicleStore. A handle goes stale when its vehicle
+// is removed; a later vehicle reusing the slot gets a new generation.
+struct VehicleHandle {
+    uint32_t index;        // Slot index
+    uint32_t generation;   // 0 = invalid handle
+
+    VehicleHandle() : index(0), generation(0) {}
+    VehicleHandle(uint32_t i, uint32_t g) : index(i), generation(g) {}
+
+    bool isNull() const { return generation == 0; }
+    bool operator==(const VehicleHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const VehicleHandle& other) const { return !(*this == other); }
+};
+
+// Per-frame fields as struct-of-arrays. All columns are indexed by dense position
+// (0..size()-1) and stay contiguous: removal moves the last vehicle into the gap.
+struct VehicleHotData {
+    std::vector<int> vehicleId;
+    std::vector<float> x;
+    std::vector<float> y;
+    std::vector<float> heading;              // Degrees, as Auto::getDirection()
+    std::vector<VehicleState> state;
+    std::vector<uint32_t> routeCursor;       // Auto::currentNodeIndex
+    std::vector<int> segmentId;              // Auto::currentSegmentId
+    std::vector<float> speed;                // Auto::speed (px per second)
+    std::vector<int> targetNodeId;           // currentNodePath[routeCursor], -1 = none or unknown node
+    std::vector<float> targetX;              // Position of targetNodeId
+    std::vector<float> targetY;
+};
+
+// Dense slot map of vehicles. The full Auto record (route, colors, detection points,
+// flags) is cold data kept in a parallel dense array; the hot columns mirror the
+// fields every frame touches, including the position of the route node being driven
+// to (resolved through the PathSystem; nodes never move once added).
+//
+// Coherence rules:
+//  - record(i) is always current.
+//  - editRecord(i) may change anything; the columns pick it up at the next syncHot().
+//  - After writing columns of i, commitHot(i) writes them back into the record. Only
+//    position, heading, state, cursor and segment are written back; a cursor change that
+//    needs a new target goes through editRecord().
+// Pointers and references into the store are invalidated by insert() and erase();
+// keep a VehicleHandle (or the vehicle ID) across those.
+class VehicleStore {
+public:
+    VehicleStore() : pathSystem(nullptr) {}
+
+    // Source of the target node positions; without it targetNodeId stays -1
+    void setPathSystem(const PathSystem* paths) { pathSystem = paths; }
+
+    // vehicle.vehicleId must be > 0 and not in the store
+    VehicleHandle insert(const Auto& vehicle);
+    bool erase(int vehicleId);
+    void clear();
+
+    size_t size() const { return records.size(); }
+    bool empty() const { return records.empty(); }
+
+    VehicleHandle handleOf(int vehicleId) const;
+    bool isValid(VehicleHandle handle) const;
+    int indexOf(VehicleHandle handle) const;      // Dense index, -1 if stale
+    int indexOf(int vehicleId) const;
+
+    const Auto& record(size_t index) const { return records[index]; }
+    Auto& editRecord(size_t index);
+    const std::vector<Auto>& allRecords() const { return records; }
+
+    // Columns are only current after syncHot()
+    void syncHot();
+    VehicleHotData& hot() { return hotData; }
+    const VehicleHotData& hot() const { return hotData; }
+    void commitHot(size_t index);
+
+private:
+    struct Slot {
+        uint32_t denseIndex;
+        uint32_t generation;   // Current generation of the slot
+    };
+
+    void pullHot(size_t index);
+    void pushBackHot(const Auto& vehicle);
+    void moveHot(size_t from, size_t to);
+    void popBackHot();
+    void resolveTarget(const Auto& vehicle, int& nodeId, float& x, float& y) const;
+
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::vector<VehicleHandle> handleById;     // Indexed by vehicle ID (IDs are not reused)
+
+    std::vector<uint32_t> denseToSlot;
+    std::vector<Auto> records;                 // Cold data, dense
+    std::vector<uint8_t> recordEdited;         // Dense, 1 = columns may be stale
+    std::vector<uint32_t> editedIndices;
+    VehicleHotData hotData;
+    const PathSystem* pathSystem;
+};
@@ -0,0 +1,108 @@
+#pragma once
+#include "auto.h"
+#include "segment_queue.h"
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Persistent (copy-on-write) array. Elements live in fixed-size chunks behind
+// shared pointers: copying the array is O(1), set() clones only the chunk table
+// and the one chunk it touches if they are still shared with another copy.
+// A copy may be handed to another thread; each copy must only be mutated by one.
+template <typename T>
+class PersistentArray {
+public:
+    static constexpr size_t CHUNK_SIZE = 32;
+
+    PersistentArray() : count(0) {}
+
+    size_t size() const { return count; }
+    size_t chunkCount() const { return table ? table->size() : 0; }
+
+    const T& get(size_t index) const {
+        return (*(*table)[index / CHUNK_SIZE])[index % CHUNK_SIZE];
+    }
+
+    void set(size_t index, const T& value) {
+        detachTable();
+        std::shared_ptr<Chunk>& chunk = (*table)[index / CHUNK_SIZE];
+        if (chunk.use_count() != 1) {
+            chunk = std::make_shared<Chunk>(*chunk);
+        }
+        (*chunk)[index % CHUNK_SIZE] = value;
+    }
+
+    // Growing appends default-constructed chunks; shrinking only hides elements
+    void resize(size_t newCount) {
+        size_t neededChunks = (newCount + CHUNK_SIZE - 1) / CHUNK_SIZE;
+        if (neededChunks > chunkCount()) {
+            detachTable();
+            while (table->size() < neededChunks) {
+                table->push_back(std::make_shared<Chunk>(CHUNK_SIZE));
+            }
+        }
+        count = newCount;
+    }
+
+    // True if both arrays still share chunk chunkIndex, i.e. nothing in it changed
+    bool sharesChunk(const PersistentArray& other, size_t chunkIndex) const {
+        if (chunkIndex >= chunkCount() || chunkIndex >= other.chunkCount()) return false;
+        return (*table)[chunkIndex] == (*other.table)[chunkIndex];
+    }
+
+private:
+    using Chunk = std::vector<T>;
+    using Table = std::vector<std::shared_ptr<Chunk>>;
+
+    void detachTable() {
+        if (!table) {
+            table = std::make_shared<Table>();
+        } else if (table.use_count() != 1) {
+            table = std::make_shared<Table>(*table);
+        }
+    }
+
+    std::shared_ptr<Table> table;
+    size_t count;
+};
+
+// Reservation state of one segment: occupants in entry order and the admission queue
+struct SegmentReservationState {
+    std::vector<int> occupantVehicleIds;
+    std::vector<double> occupantEntryTimes;
+    std::vector<int> heldVehicleIds;          // Occupants holding the segment as part of a corridor
+    int occupiedFromNodeId;
+    double lastEntryTime;
+    std::vector<SegmentQueue::Entry> queue;   // Admission order, front = next vehicle
+
+    SegmentReservationState() : occupiedFromNodeId(-1), lastEntryTime(0.0) {}
+};
+
+// Immutable view of all segment reservations at one point in time.
+// Copies are O(1); SegmentManager can evaluate hypothetical reservations on a
+// copy (reserveSegment/releaseSegment overloads) and roll the live state back to it.
+struct ReservationSnapshot {
+    PersistentArray<SegmentReservationState> segments;   // Indexed by segment ID
+    double currentTime;
+    uint64_t queueSequence;
+
+    ReservationSnapshot() : currentTime(0.0), queueSequence(0) {}
+};
+
+// Immutable view of the fleet, indexed by vehicle ID (nullptr = no such vehicle)
+struct VehicleSnapshot {
+    PersistentArray<std::shared_ptr<const Auto>> vehicles;
+
+    const Auto* getVehicle(int vehicleId) const {
+        if (vehicleId < 0 || vehicleId >= static_cast<int>(vehicles.size())) return nullptr;
+        return vehicles.get(vehicleId).get();
+    }
+};
+
+// Reservations + fleet; fork() is a plain copy
+struct WorldSnapshot {
+    ReservationSnapshot reservations;
+    VehicleSnapshot vehicles;
+
+    WorldSnapshot fork() const { return *this; }
+};
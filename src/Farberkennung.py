@@ -1,8 +1,11 @@
 import cv2
 import numpy as np
 import json
+import os
 import time
 import threading
+from detection_packing import pack_detections, pack_settings, to_cpp_dicts
+from detection_ring import DetectionRingWriter
 
 class SimpleCoordinateDetector:
     """
@@ -35,6 +38,13 @@ class SimpleCoordinateDetector:
         self.performance_mode = False  # Kann von C++ aktiviert werden
         self.show_filter_masks = True  # Filtermasken-Anzeige (für HSV-Einstellungen)
 
+        # Koordinaten gehen über den Shared-Memory-Ring (detection_ring.py); coordinates.json
+        # nur noch als Debug-Abzweig mit PDS_COORDINATES_JSON=1
+        self.coordinates_json_tap = os.environ.get('PDS_COORDINATES_JSON') == '1'
+
+        # Aufnahmezeit des letzten Kamerabilds (perf_counter_ns, 0 = keins) für die Latenz-Messung in C++
+        self.last_capture_ns = 0
+
         # Fenster-Verwaltung für besseres Verschieben
         self.windows_created = set()
         self.main_windows_positioned = False
@@ -864,7 +874,7 @@ class SimpleCoordinateDetector:
             cv2.imshow(window_name, mask_colored)
 
     def save_coordinates_for_cpp(self, detected_objects, crop_width, crop_height):
-        """Speichere Koordinaten für C++ Verarbeitung - OPTIMIERT FÜR MAXIMALE GESCHWINDIGKEIT"""
+        """Debug-Abzweig: Koordinaten als coordinates.json (nur mit coordinates_json_tap)"""
         try:
             output_data = {
                 'timestamp': time.time(),
@@ -902,6 +912,13 @@ class SimpleCoordinateDetector:
 
         self.create_trackbars()
 
+        # Eigenständiger Betrieb: dieser Prozess ist der Schreiber des Erkennungs-Rings
+        try:
+            ring_writer = DetectionRingWriter()
+        except Exception as e:
+            print(f"Shared-Memory-Ring nicht verfügbar: {e}")
+            ring_writer = None
+
         print("=== EINFACHE KOORDINATEN-ERKENNUNG ===")
         print("Koordinaten werden für C++ normalisiert (0,0 = oben links)")
         print("ESC = Beenden, F = Filtermasken ein/aus")
@@ -910,6 +927,7 @@ class SimpleCoordinateDetector:
 
         while True:
             ret, frame = self.cap.read()
+            capture_ns = time.perf_counter_ns()  # Aufnahmezeit = Bild gelesen, wie im C++-Erkennungs-Thread
             if not ret:
                 break
 
@@ -921,11 +939,11 @@ class SimpleCoordinateDetector:
             hsv_full_frame = cv2.cvtColor(frame, cv2.COLOR_BGR2HSV)
             color_position, rgb_values, hsv_values = self.measure_color_at_position(frame, hsv_full_frame)
 
-            # Speichere Koordinaten für C++ - SCHNELL ohne Debug-Ausgaben
-            if detected_objects:
-                if self.save_coordinates_for_cpp(detected_objects, crop_width, crop_height):
-                    # Minimale Ausgabe für Performance
-                    pass
+            # Jeder Frame in den Ring (auch ohne Erkennungen), JSON nur als Debug-Abzweig
+            if ring_writer:
+                ring_writer.publish(detected_objects, crop_width, crop_height, capture_ns)
+            if detected_objects and self.coordinates_json_tap:
+                self.save_coordinates_for_cpp(detected_objects, crop_width, crop_height)
 
             # Visualisierung
             left, top, right, bottom = crop_bounds
@@ -991,6 +1009,8 @@ class SimpleCoordinateDetector:
                         except:
                             pass
 
+        if ring_writer:
+            ring_writer.close()
         self.cap.release()
         cv2.destroyAllWindows()
         print("Koordinaten-Erkennung beendet.")
@@ -1028,14 +1048,16 @@ class SimpleCoordinateDetector:
 
         return cpp_objects
 
-    def process_frame_with_display(self):
-        """Verarbeite einen Frame und zeige Ergebnisse an"""
+    def process_frame_with_display(self, packed=False):
+        """Verarbeite einen Frame und zeige Ergebnisse an (packed: bytes fester Datensätze statt Dictionaries)"""
+        self.last_capture_ns = 0
         if self.cap is None:
-            return []
+            return b'' if packed else []
 
         ret, frame = self.cap.read()
         if not ret:
-            return []
+            return b'' if packed else []
+        self.last_capture_ns = time.perf_counter_ns()
 
         self.get_trackbar_values()
         cropped_frame, crop_bounds = self.crop_frame(frame)
@@ -1045,8 +1067,8 @@ class SimpleCoordinateDetector:
         hsv_full_frame = cv2.cvtColor(frame, cv2.COLOR_BGR2HSV)
         color_position, rgb_values, hsv_values = self.measure_color_at_position(frame, hsv_full_frame)
 
-        # Speichere Koordinaten für eventuelle JSON-Ausgabe
-        if detected_objects:
+        # Den Ring schreibt der C++-Erkennungs-Thread; JSON nur als Debug-Abzweig
+        if detected_objects and self.coordinates_json_tap:
             self.save_coordinates_for_cpp(detected_objects, crop_width, crop_height)
 
         # Visualisierung für Debug
@@ -1088,19 +1110,45 @@ class SimpleCoordinateDetector:
         cv2.waitKey(1)  # Non-blocking
 
         # Konvertiere für C++ Format
-        cpp_objects = []
-        for obj in detected_objects:
-            cpp_obj = {
-                'id': obj['id'],
-                'classified_color': obj['classified_color'],
-                'normalized_coords': obj['normalized_coords'],
-                'area': obj['area'],
-                'crop_width': crop_width,
-                'crop_height': crop_height
-            }
-            cpp_objects.append(cpp_obj)
+        if packed:
+            return pack_detections(detected_objects, crop_width, crop_height)
+        return to_cpp_dicts(detected_objects, crop_width, crop_height)
 
-        return cpp_objects
+    def capture_frame_native(self):
+        """Nur Kamerabild und Einstellungen für den C++-Detektor - die Erkennung selbst läuft in C++"""
+        self.last_capture_ns = 0
+        if self.cap is None:
+            return None
+
+        ret, frame = self.cap.read()
+        if not ret:
+            return None
+        self.last_capture_ns = time.perf_counter_ns()
+
+        self.get_trackbar_values()
+        cropped_frame, crop_bounds = self.crop_frame(frame)
+
+        # Der Crop ist eine Sicht auf frame - deshalb nur auf einer Kopie zeichnen
+        if not self.performance_mode:
+            display = frame.copy()
+            left, top, right, bottom = crop_bounds
+            cv2.rectangle(display, (left, top), (right, bottom), (0, 255, 0), 3)
+            cv2.putText(display, "ERKENNUNGSBEREICH (C++)", (left, top - 10), 
+                       cv2.FONT_HERSHEY_SIMPLEX, 0.6, (0, 255, 0), 2)
+
+            if self.color_picker_enabled:
+                hsv_full_frame = cv2.cvtColor(frame, cv2.COLOR_BGR2HSV)
+                color_position, rgb_values, hsv_values = self.measure_color_at_position(frame, hsv_full_frame)
+                if color_position:
+                    self.draw_color_picker(display, color_position, rgb_values, hsv_values)
+
+            if not self.main_windows_positioned:
+                self.create_or_update_window("Koordinaten-Erkennung", 640, 480, 100, 100)
+                self.main_windows_positioned = True
+            cv2.imshow("Koordinaten-Erkennung", display)
+        cv2.waitKey(1)  # Non-blocking, hält Trackbars und Fenster bedienbar
+
+        return cropped_frame, pack_settings(self.color_definitions, self.hsv_tolerances, self.min_size)
 
     def cleanup(self):
         """Aufräumen"""
@@ -1172,6 +1220,38 @@ def detect_objects():
         print(f"Fehler bei Objekterkennung: {e}")
         return []
 
+def detect_objects_packed():
+    """Wie detect_objects, aber als bytes fester Datensätze (detection_packing.RECORD, von C++ aufgerufen)"""
+    global _global_detector
+    if _global_detector is None:
+        print("Detektor nicht initialisiert!")
+        return b''
+
+    try:
+        return _global_detector.process_frame_with_display(packed=True)
+    except Exception as e:
+        print(f"Fehler bei Objekterkennung: {e}")
+        return b''
+
+def capture_frame_native():
+    """Kamerabild (Crop) und gepackte Einstellungen für den C++-Detektor, None ohne Bild (von C++ aufgerufen)"""
+    global _global_detector
+    if _global_detector is None:
+        print("Detektor nicht initialisiert!")
+        return None
+
+    try:
+        return _global_detector.capture_frame_native()
+    except Exception as e:
+        print(f"Fehler bei Bildaufnahme: {e}")
+        return None
+
+def last_capture_time_ns():
+    """Aufnahmezeit des zuletzt gelesenen Kamerabilds (perf_counter_ns), 0 ohne Bild (von C++ für die Latenz-Messung aufgerufen)"""
+    if _global_detector is None:
+        return 0
+    return _global_detector.last_capture_ns
+
 def enable_performance_mode():
     """Aktiviere Performance-Modus für maximale Geschwindigkeit (von C++ aufgerufen)"""
     global _global_detector
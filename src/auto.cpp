@@ -11,18 +11,25 @@
 
 int Auto::nextId = 1;
 
+// Both points come from one camera frame; if not, the command is as old as the older one
+static FrameStamp olderStamp(const FrameStamp& a, const FrameStamp& b) {
+    if (!a.isSet()) return b;
+    if (!b.isSet()) return a;
+    return a.captureTime <= b.captureTime ? a : b;
+}
+
 // Original detection-based constructors
 Auto::Auto() : direction(0.0f), valid(false), id(0), vehicleId(0), currentNodeId(-1), targetNodeId(-1), 
                pendingTargetNodeId(-1), currentNodeIndex(0), state(VehicleState::IDLE), 
-               currentDirection(Direction::NORTH), speed(50.0f), isMoving(false), isWaitingInQueue(false),
-               currentSegmentId(-1) {}
+               currentDirection(Direction::NORTH), speed(50.0f), jobUrgency(0.0f), isMoving(false), isWaitingInQueue(false),
+               currentSegmentId(-1), marker(MARKER_NONE) {}
 
 Auto::Auto(const Point& idPoint, const Point& fPoint) 
     : identificationPoint(idPoint), frontPoint(fPoint), valid(true), vehicleId(0), currentNodeId(-1), 
       targetNodeId(-1), pendingTargetNodeId(-1), currentNodeIndex(0), state(VehicleState::IDLE),
-      currentDirection(Direction::NORTH), speed(50.0f), isMoving(false), isWaitingInQueue(false),
-      currentSegmentId(-1) {
-    id = extractIdFromColor(idPoint.color);
+      currentDirection(Direction::NORTH), speed(50.0f), jobUrgency(0.0f), isMoving(false), isWaitingInQueue(false),
+      currentSegmentId(-1), marker(idPoint.marker), stamp(olderStamp(idPoint.stamp, fPoint.stamp)) {
+    id = heckNumber(marker);
     calculateCenterAndDirection();
 }
 
@@ -30,15 +37,15 @@ Auto::Auto(const Point& idPoint, const Point& fPoint)
 Auto::Auto(int id, const Point& startPos) 
     : identificationPoint(startPos), frontPoint(startPos), center(startPos), direction(0.0f), valid(true), id(id),
       vehicleId(id), position(startPos), targetPosition(startPos), currentNodeId(-1), targetNodeId(-1), pendingTargetNodeId(-1),
-      currentNodeIndex(0), state(VehicleState::IDLE), currentDirection(Direction::NORTH), speed(50.0f),
-      isMoving(false), isWaitingInQueue(false), currentSegmentId(-1) {
+      currentNodeIndex(0), state(VehicleState::IDLE), currentDirection(Direction::NORTH), speed(50.0f), jobUrgency(0.0f),
+      isMoving(false), isWaitingInQueue(false), currentSegmentId(-1), marker(MARKER_NONE) {
 }
 
 Auto::Auto(const Point& startPos, Direction dir) 
     : identificationPoint(startPos), frontPoint(startPos), center(startPos), direction(0.0f), valid(true), id(nextId++),
       vehicleId(id), position(startPos), targetPosition(startPos), currentNodeId(-1), targetNodeId(-1), pendingTargetNodeId(-1),
-      currentNodeIndex(0), state(VehicleState::IDLE), currentDirection(dir), speed(50.0f),
-      isMoving(false), isWaitingInQueue(false), currentSegmentId(-1) {
+      currentNodeIndex(0), state(VehicleState::IDLE), currentDirection(dir), speed(50.0f), jobUrgency(0.0f),
+      isMoving(false), isWaitingInQueue(false), currentSegmentId(-1), marker(MARKER_NONE) {
     center = startPos;
     direction = static_cast<float>(dir);
 }
@@ -47,7 +54,9 @@ void Auto::updatePoints(const Point& idPoint, const Point& fPoint) {
     identificationPoint = idPoint;
     frontPoint = fPoint;
     valid = true;
-    id = extractIdFromColor(idPoint.color);
+    id = heckNumber(idPoint.marker);
+    marker = idPoint.marker;
+    stamp = olderStamp(idPoint.stamp, fPoint.stamp);
     calculateCenterAndDirection();
 }
 
@@ -66,20 +75,6 @@ void Auto::calculateCenterAndDirection() {
     }
 }
 
-int Auto::extractIdFromColor(const std::string& color) {
-    // Extract number from color string like "Heck1", "Heck2", etc.
-    if (color.find("Heck") == 0 && color.length() > 4) {
-        try {
-            std::string numberPart = color.substr(4); // Extract everything after "Heck"
-            int extractedId = std::stoi(numberPart); // Extract number after "Heck"
-            return extractedId;
-        } catch (...) {
-            return 0; // Default if parsing fails
-        }
-    }
-    return 0; // Default for unknown colors
-}
-
 void Auto::setPosition(const Point& pos) {
     position = pos;
     center = pos; // Update center as well for compatibility
@@ -103,7 +98,7 @@ void Auto::updatePosition(float deltaTime) {
 
     if (distance > 0) {
         Point normalizedDir = direction * (1.0f / distance);
-        float moveDistance = speed * deltaTime * 60.0f; // Assuming 60 FPS
+        float moveDistance = speed * deltaTime;   // speed in px per second, independent of frame rate
 
         if (moveDistance >= distance) {
             position = targetPosition;
@@ -5,6 +5,9 @@
 #include "py_runner.h"
 #include "coordinate_filter_fast.h"
 #include "test_window.h"
+#include "factory_layout.h"
+#include "traffic_benchmark.h"
+#include "latency_trace.h"
 #include <algorithm>
 #include <cmath>
 #include <iostream>
@@ -14,13 +17,16 @@
 
 CarSimulation::CarSimulation() : tolerance(250.0f), time_elapsed(0.0f), car_point_distance(DEFAULT_CAR_POINT_DISTANCE),
                                  distance_buffer(DISTANCE_BUFFER), segmentManager(nullptr), vehicleController(nullptr),
-                                 pathSystemInitialized(false), selectedVehicle(-1) {
+                                 workerThreadCount(0), jobRng(42), pathSystemInitialized(false), selectedVehicle(-1) {
     renderer = nullptr;
     // Verwende den schnellen Filter für minimale Verzögerung
     fastFilter = createFastCoordinateFilter();
 }
 
 CarSimulation::~CarSimulation() {
+    // Planner threads read the path system and the segment manager: stop them first
+    routePlanner.reset();
+    jobDispatcher.reset();   // Unsubscribes from the controller's events
     if (renderer) {
         delete renderer;
     }
@@ -45,28 +51,29 @@ void CarSimulation::initialize() {
 
 void CarSimulation::updateFromDetectedObjects(const std::vector<DetectedObject>& detected_objects, const FieldTransform& field_transform) {
     // ULTRA-SCHNELLE VERARBEITUNG: Minimale Zwischenschritte
+    auto pairing_start = std::chrono::steady_clock::now();
     std::vector<Point> rawPoints;
     rawPoints.reserve(detected_objects.size()); // Verhindere Reallocations
     
-    std::vector<std::string> colors;
-    colors.reserve(detected_objects.size());
-
     // Optimierte Schleife mit KALIBRIERTER Koordinaten-Transformation
     for (const auto& obj : detected_objects) {
         // Verwende kalibrierte Transformation aus test_window.cpp
         if (obj.crop_width > 0 && obj.crop_height > 0) {
             float window_x, window_y;
-            getCalibratedTransform(obj.coordinates.x, obj.coordinates.y, 
-                                 obj.crop_width, obj.crop_height, 
-                                 window_x, window_y);
-
-            if (obj.color == "Front") {
-                rawPoints.emplace_back(window_x, window_y, PointType::FRONT, obj.color);
-                colors.push_back(obj.color);
-            } else if (obj.color.find("Heck") == 0) {
-                rawPoints.emplace_back(window_x, window_y, PointType::IDENTIFICATION, obj.color);
-                colors.push_back(obj.color);
+            if (!getCalibratedTransform(obj.coordinates.x, obj.coordinates.y, 
+                                        obj.crop_width, obj.crop_height, 
+                                        window_x, window_y)) {
+                continue;   // Außerhalb des kalibrierten Bereichs - nicht auf die Bildmitte setzen
+            }
+
+            if (isFrontMarker(obj.marker)) {
+                rawPoints.emplace_back(window_x, window_y, PointType::FRONT, obj.marker);
+            } else if (isHeckMarker(obj.marker)) {
+                rawPoints.emplace_back(window_x, window_y, PointType::IDENTIFICATION, obj.marker);
+            } else {
+                continue;
             }
+            rawPoints.back().stamp = obj.stamp;   // Kamera-Frame bis zum Fahrbefehl mitführen
         }
     }
 
@@ -75,6 +82,7 @@ void CarSimulation::updateFromDetectedObjects(const std::vector<DetectedObject>&
     
     // Sofortige Fahrzeugerkennung
     detectVehicles();
+    recordLatency(LatencyStage::PAIRING, pairing_start, std::chrono::steady_clock::now());
 
     // Update test window with detected objects and vehicles
     std::vector<DetectedObject> detectedObjForWindow;
@@ -82,7 +90,8 @@ void CarSimulation::updateFromDetectedObjects(const std::vector<DetectedObject>&
         DetectedObject obj;
         obj.coordinates.x = point.x;
         obj.coordinates.y = point.y;
-        obj.color = point.color;
+        obj.marker = point.marker;
+        obj.stamp = point.stamp;
         detectedObjForWindow.push_back(obj);
     }
     updateTestWindowCoordinates(detectedObjForWindow);
@@ -161,12 +170,19 @@ void CarSimulation::update(float deltaTime) {
     // Handle vehicle selection and target assignment
     handleVehicleSelection();
     handleTargetAssignment();
+    handleJobInput();
 
     // Update path system vehicles
     if (pathSystemInitialized && vehicleController) {
         // Sync detected vehicles with path system
         syncDetectedVehiclesWithPathSystem();
 
+        // Transportaufträge weiterschalten und freie Fahrzeuge zuweisen
+        for (const JobAssignment& assignment : jobDispatcher->update()) {
+            std::cout << "Job " << assignment.jobId << " -> vehicle " << assignment.vehicleId
+                      << " (" << assignment.travelTime << " s to pickup)" << std::endl;
+        }
+
         // Update vehicle movement along paths
         vehicleController->updateVehicles(deltaTime);
     }
@@ -262,8 +278,20 @@ void CarSimulation::initializePathSystem() {
     // Initialize segment manager
     segmentManager = new SegmentManager(&pathSystem);
 
+    // Binäres Journal aller Reservierungen für Offline-Analyse (--replay)
+    journal.reset(new EventJournal());
+    if (journal->open("reservation_journal.bin", pathSystem.getNodeCount(), pathSystem.getSegmentCount())) {
+        segmentManager->setJournal(journal.get());
+    }
+
     // Initialize vehicle controller
     vehicleController = new VehicleController(&pathSystem, segmentManager);
+    taskScheduler.reset(new TaskScheduler(workerThreadCount));
+    vehicleController->setTaskScheduler(taskScheduler.get());
+    routePlanner.reset(new RoutePlanner(&pathSystem, segmentManager));
+    vehicleController->setRoutePlanner(routePlanner.get());
+    jobDispatcher.reset(new JobDispatcher(&pathSystem, vehicleController));
+    jobDispatcher->setTaskScheduler(taskScheduler.get());
 
     pathSystemInitialized = true;
 
@@ -272,99 +300,15 @@ void CarSimulation::initializePathSystem() {
 
     std::cout << "Path system initialized with " << pathSystem.getNodeCount()
               << " nodes and " << pathSystem.getSegmentCount() << " segments" << std::endl;
+    std::cout << "Fleet update runs on " << taskScheduler->getThreadCount() << " thread(s)" << std::endl;
 }
 
 void CarSimulation::createFactoryPathSystem() {
     // Clear any existing data
     pathSystem = PathSystem();
 
-    // Create the factory nodes with exact coordinates (scaled to window)
-    int node1 = pathSystem.addNode(70, 65);       // Node 1
-    int node2 = pathSystem.addNode(640, 65);      // Node 2
-    int node3 = pathSystem.addNode(985, 65);      // Node 3
-    int node4 = pathSystem.addNode(1860, 65);     // Node 4
-    int node5 = pathSystem.addNode(70, 470);      // Node 5
-    int node6 = pathSystem.addNode(640, 470);     // Node 6
-    int node7 = pathSystem.addNode(985, 320);     // Node 7
-    int node8 = pathSystem.addNode(1860, 320);    // Node 8
-    int node9 = pathSystem.addNode(985, 750);     // Node 9
-    int node10 = pathSystem.addNode(1860, 750);   // Node 10
-    int node11 = pathSystem.addNode(70, 1135);    // Node 11
-    int node12 = pathSystem.addNode(985, 1135);   // Node 12
-    int node13 = pathSystem.addNode(1860, 1135);  // Node 13
-
-    // Add waiting points at T-junctions
-    int wait2_left = pathSystem.addWaitingNode(640 - 150, 65);
-    int wait2_bottom = pathSystem.addWaitingNode(640, 65 + 150);
-    int wait2_3_merged = pathSystem.addWaitingNode(812, 65);
-
-    int wait3_east = pathSystem.addWaitingNode(985 + 150, 65);
-
-    int wait5_top = pathSystem.addWaitingNode(70, 470 - 150);
-    int wait5_right = pathSystem.addWaitingNode(70 + 150, 470);
-    int wait5_bottom = pathSystem.addWaitingNode(70, 470 + 150);
-
-    int wait3_7_merged = pathSystem.addWaitingNode(985, 192);
-    int wait7_east = pathSystem.addWaitingNode(985 + 150, 320);
-    int wait7_south_merged = pathSystem.addWaitingNode(985, 535);
-
-    int wait8_west = pathSystem.addWaitingNode(1860 - 150, 320);
-    int wait8_10_merged = pathSystem.addWaitingNode(1860, 535);
-
-    int wait9_east = pathSystem.addWaitingNode(985 + 150, 750);
-    int wait9_south_merged = pathSystem.addWaitingNode(985, 942);
-
-    int wait12_east = pathSystem.addWaitingNode(985 + 150, 1135);
-    int wait12_west = pathSystem.addWaitingNode(985 - 150, 1135);
-
-    int wait10_left = pathSystem.addWaitingNode(1860 - 150, 750);
-    int wait10_bottom = pathSystem.addWaitingNode(1860, 750 + 150);
-
-    // Connect main nodes
-    pathSystem.addSegment(node1, node2);
-    pathSystem.addSegment(node1, node5);
-    pathSystem.addSegment(node2, node3);
-    pathSystem.addSegment(node2, node6);
-    pathSystem.addSegment(node3, node4);
-    pathSystem.addSegment(node3, node7);
-    pathSystem.addSegment(node4, node8);
-    pathSystem.addSegment(node5, node6);
-    pathSystem.addSegment(node5, node11);
-    pathSystem.addSegment(node7, node8);
-    pathSystem.addSegment(node7, node9);
-    pathSystem.addSegment(node8, node10);
-    pathSystem.addSegment(node9, node10);
-    pathSystem.addSegment(node9, node12);
-    pathSystem.addSegment(node10, node13);
-    pathSystem.addSegment(node11, node12);
-    pathSystem.addSegment(node12, node13);
-
-    // Connect waiting points
-    pathSystem.addSegment(node2, wait2_left);
-    pathSystem.addSegment(node2, wait2_bottom);
-    pathSystem.addSegment(node2, wait2_3_merged);
-    pathSystem.addSegment(node3, wait2_3_merged);
-    pathSystem.addSegment(node3, wait3_east);
-    pathSystem.addSegment(node3, wait3_7_merged);
-    pathSystem.addSegment(node5, wait5_top);
-    pathSystem.addSegment(node5, wait5_right);
-    pathSystem.addSegment(node5, wait5_bottom);
-    pathSystem.addSegment(node7, wait3_7_merged);
-    pathSystem.addSegment(node7, wait7_east);
-    pathSystem.addSegment(node7, wait7_south_merged);
-    pathSystem.addSegment(node9, wait7_south_merged);
-    pathSystem.addSegment(node8, wait8_west);
-    pathSystem.addSegment(node8, wait8_10_merged);
-    pathSystem.addSegment(node9, wait9_east);
-    pathSystem.addSegment(node9, wait9_south_merged);
-    pathSystem.addSegment(node12, wait9_south_merged);
-    pathSystem.addSegment(node12, wait12_east);
-    pathSystem.addSegment(node12, wait12_west);
-    pathSystem.addSegment(node10, wait8_10_merged);
-    pathSystem.addSegment(node10, wait10_left);
-    pathSystem.addSegment(node10, wait10_bottom);
-
-    // Path system initialization complete
+    // Create the factory nodes, waiting points and segments
+    createFactoryLayout(pathSystem);
 }
 
 void CarSimulation::syncDetectedVehiclesWithPathSystem() {
@@ -478,16 +422,28 @@ void CarSimulation::handleVehicleSelection() {
     }
 }
 
+void CarSimulation::handleJobInput() {
+    if (!pathSystemInitialized || !jobDispatcher) return;
+
+    // J: ein zufälliger Transportauftrag pro Fahrzeug (Abholung und Abgabe auf Hauptknoten)
+    if (IsKeyPressed(KEY_J)) {
+        size_t jobs = std::max<size_t>(1, vehicleController->getVehicleCount());
+        for (size_t i = 0; i < jobs; i++) {
+            int pickupNodeId = pickRandomTarget(pathSystem, -1, jobRng);
+            jobDispatcher->submitJob(pickupNodeId, pickRandomTarget(pathSystem, pickupNodeId, jobRng), time_elapsed);
+        }
+        std::cout << "Submitted " << jobs << " transport jobs (" << jobDispatcher->getOpenJobCount()
+                  << " open, " << jobDispatcher->getCompletedJobCount() << " done)" << std::endl;
+    }
+}
+
 void CarSimulation::handleTargetAssignment() {
     if (!pathSystemInitialized || !vehicleController || selectedVehicle < 0) return;
 
-    const auto& vehicles = vehicleController->getAllVehicles();
-    if (static_cast<size_t>(selectedVehicle) >= vehicles.size()) return;
-
-    auto it = vehicles.find(selectedVehicle);
-    if (it == vehicles.end()) return;
+    const Auto* selected = vehicleController->getVehicle(selectedVehicle);
+    if (!selected) return;
     
-    int vehicleId = it->second.vehicleId;
+    int vehicleId = selected->vehicleId;
 
     // Mouse click on node for target selection
     if (IsMouseButtonPressed(MOUSE_LEFT_BUTTON)) {
@@ -497,7 +453,7 @@ void CarSimulation::handleTargetAssignment() {
         // Find nearest node to mouse click
         int nearestNodeId = pathSystem.findNearestNode(worldPos, 80.0f);
         if (nearestNodeId != -1) {
-            vehicleController->setVehicleTargetNode(vehicleId, nearestNodeId);
+            vehicleController->requestVehicleTarget(vehicleId, nearestNodeId);
             std::cout << "Vehicle " << (selectedVehicle + 1) << " target set to node " << nearestNodeId << std::endl;
         }
     }
@@ -508,7 +464,7 @@ void CarSimulation::handleTargetAssignment() {
         if (IsKeyPressed(key)) {
             int targetNode = (i == 0) ? 10 : i;
             if (targetNode <= 13) {
-                vehicleController->setVehicleTargetNode(vehicleId, targetNode);
+                vehicleController->requestVehicleTarget(vehicleId, targetNode);
                 std::cout << "Vehicle " << (selectedVehicle + 1) << " target set to node " << targetNode << std::endl;
             }
             break;
@@ -517,15 +473,15 @@ void CarSimulation::handleTargetAssignment() {
 
     // Special keys for nodes 11-13
     if (IsKeyPressed(KEY_Q)) {
-        vehicleController->setVehicleTargetNode(vehicleId, 11);
+        vehicleController->requestVehicleTarget(vehicleId, 11);
         std::cout << "Vehicle " << (selectedVehicle + 1) << " target set to node 11" << std::endl;
     }
     if (IsKeyPressed(KEY_Y)) {
-        vehicleController->setVehicleTargetNode(vehicleId, 12);
+        vehicleController->requestVehicleTarget(vehicleId, 12);
         std::cout << "Vehicle " << (selectedVehicle + 1) << " target set to node 12" << std::endl;
     }
     if (IsKeyPressed(KEY_X)) {
-        vehicleController->setVehicleTargetNode(vehicleId, 13);
+        vehicleController->requestVehicleTarget(vehicleId, 13);
         std::cout << "Vehicle " << (selectedVehicle + 1) << " target set to node 13" << std::endl;
     }
 
@@ -12,13 +12,13 @@ CoordinateFilter::CoordinateFilter(float radius, float timeout, int minDetection
 }
 
 std::vector<Point> CoordinateFilter::filterAndSmooth(const std::vector<Point>& newDetections, 
-                                                    const std::vector<std::string>& colors) {
+                                                    const std::vector<MarkerId>& markers) {
     // Abgelaufene Punkte entfernen
     removeExpiredPoints();
 
     // Neue Erkennungen verarbeiten
-    for (size_t i = 0; i < newDetections.size() && i < colors.size(); i++) {
-        processDetection(newDetections[i], colors[i]);
+    for (size_t i = 0; i < newDetections.size() && i < markers.size(); i++) {
+        processDetection(newDetections[i], markers[i]);
     }
 
     // Generate predictions for missing points
@@ -27,85 +27,63 @@ std::vector<Point> CoordinateFilter::filterAndSmooth(const std::vector<Point>& n
     // Nur stabile und gültige Punkte zurückgeben
     std::vector<Point> result;
 
-    // Heck-Punkte hinzufügen (maximal 1 pro Heck-Typ 1,2,3,4)
-    std::map<std::string, bool> heckNumbersAdded;
-    for (const auto& [color, fp] : stablePoints) {
-        if (fp.isValid && fp.isStable) {
-            std::string partType = getVehiclePartType(color);
-            if (partType == "heck") {
-                std::string heckNumber = extractHeckNumber(color);
-                if (heckNumbersAdded.find(heckNumber) == heckNumbersAdded.end()) {
-                    // Point mit originalem Farbnamen erstellen
-                    Point filteredPoint = fp.point;
-                    filteredPoint.type = PointType::IDENTIFICATION;
-                    filteredPoint.color = color; // Originale Farbe beibehalten (Heck1, Heck2, etc.)
-                    result.push_back(filteredPoint);
-                    heckNumbersAdded[heckNumber] = true;
-                } else {
-                    continue;
-                }
-            }
+    // Heck-Punkte hinzufügen (Schlüssel = MarkerId, also maximal 1 pro Heck-Nummer)
+    for (const auto& [key, fp] : stablePoints) {
+        if (fp.isValid && fp.isStable && isHeckMarker(fp.marker)) {
+            Point filteredPoint = fp.point;
+            filteredPoint.type = PointType::IDENTIFICATION;
+            filteredPoint.marker = fp.marker;
+            result.push_back(filteredPoint);
         }
     }
 
     // Front-Punkte hinzufügen (maximal 4)
     int frontCount = 0;
-    for (const auto& [color, fp] : stablePoints) {
-        if (fp.isValid && fp.isStable && frontCount < 4) {
-            std::string partType = getVehiclePartType(color);
-            if (partType == "front") {
-                // Point mit originalem Farbnamen erstellen
-                Point filteredPoint = fp.point;
-                filteredPoint.type = PointType::FRONT;
-                filteredPoint.color = fp.color; // Verwende gespeicherte originale Farbe
-                result.push_back(filteredPoint);
-                frontCount++;
-            }
+    for (const auto& [key, fp] : stablePoints) {
+        if (fp.isValid && fp.isStable && frontCount < 4 && isFrontMarker(fp.marker)) {
+            Point filteredPoint = fp.point;
+            filteredPoint.type = PointType::FRONT;
+            filteredPoint.marker = fp.marker;
+            result.push_back(filteredPoint);
+            frontCount++;
         }
     }
 
     return result;
 }
 
-void CoordinateFilter::processDetection(const Point& newPoint, const std::string& color) {
-    std::string partType = getVehiclePartType(color);
-    std::string actualKey = color; // Standard: verwende die originale Farbe als Schlüssel
+void CoordinateFilter::processDetection(const Point& newPoint, MarkerId marker) {
+    if (!isFrontMarker(marker) && !isHeckMarker(marker)) return;
+    int actualKey = marker; // Standard: Heck-Punkte unter ihrer MarkerId
 
     // Für Front-Punkte: Spezielle Behandlung, da alle als "Front" kommen
-    if (partType == "front") {
+    if (isFrontMarker(marker)) {
         // Suche nach existierendem Front-Punkt in der Nähe
-        std::string nearbyFrontKey = "";
-        for (const auto& [existingColor, fp] : stablePoints) {
-            if (getVehiclePartType(existingColor) == "front" && 
-                fp.point.distanceTo(newPoint) <= detectionRadius) {
-                nearbyFrontKey = existingColor;
-                break;
+        int nearbyFrontKey = -1;
+        int activeFrontCount = 0;
+        for (const auto& [key, fp] : stablePoints) {
+            if (!isFrontMarker(fp.marker)) continue;
+            activeFrontCount++;
+            if (nearbyFrontKey < 0 && fp.point.distanceTo(newPoint) <= detectionRadius) {
+                nearbyFrontKey = key;
             }
         }
 
-        if (!nearbyFrontKey.empty()) {
+        if (nearbyFrontKey >= 0) {
             // Verwende den existierenden Schlüssel
             actualKey = nearbyFrontKey;
         } else {
-            // Erstelle neuen eindeutigen Schlüssel für Front-Punkt
-            int frontIndex = 1;
-            while (stablePoints.find("Front_" + std::to_string(frontIndex)) != stablePoints.end()) {
-                frontIndex++;
-            }
-            actualKey = "Front_" + std::to_string(frontIndex);
-
             // Prüfe maximale Anzahl Front-Punkte (alle, nicht nur stabile)
-            int activeFrontCount = 0;
-            for (const auto& [col, fp] : stablePoints) {
-                if (getVehiclePartType(col) == "front") {
-                    activeFrontCount++;
-                }
-            }
-
             if (activeFrontCount >= 4) {
                 std::cout << "Bereits 4 Front-Punkte aktiv - neue Detektion ignoriert" << std::endl;
                 return;
             }
+
+            // Erstelle neuen eindeutigen Schlüssel für Front-Punkt
+            actualKey = FRONT_KEY_BASE + 1;
+            while (stablePoints.find(actualKey) != stablePoints.end()) {
+                actualKey++;
+            }
         }
     }
 
@@ -118,7 +96,7 @@ void CoordinateFilter::processDetection(const Point& newPoint, const std::string
         // Prüfen ob neue Detektion im erlaubten Bereich ist
         if (fp.isStable && !isWithinMovementThreshold(fp.point, newPoint)) {
             // Zu große Bewegung - als Ausreißer ignorieren
-            std::cout << "Ausreißer ignoriert für " << actualKey << " (zu große Bewegung)" << std::endl;
+            std::cout << "Ausreißer ignoriert für " << markerName(marker) << " (zu große Bewegung)" << std::endl;
             return;
         }
 
@@ -148,39 +126,27 @@ void CoordinateFilter::processDetection(const Point& newPoint, const std::string
         updatePointStability(fp);
 
     } else {
-        // Für Heck-Punkte: Spezielle Validierung
-        if (partType == "heck") {
-            // Prüfen ob bereits ein Heck-Punkt mit derselben Nummer existiert
-            for (const auto& [existingColor, fp] : stablePoints) {
-                if (getVehiclePartType(existingColor) == "heck") {
-                    std::string newHeckType = extractHeckNumber(color);
-                    std::string existingHeckType = extractHeckNumber(existingColor);
-
-                    if (newHeckType == existingHeckType && (fp.isValid || fp.isStable)) {
-                        std::cout << "Heck-Punkt " << newHeckType << " bereits aktiv (" << existingColor 
-                                  << ") - neue Detektion " << color << " ignoriert" << std::endl;
-                        return;
-                    }
-                }
-            }
-
+        // Für Heck-Punkte: derselbe Marker liegt unter demselben Schlüssel, also nur die Gesamtzahl prüfen
+        if (isHeckMarker(marker)) {
             // Maximal 4 Heck-Punkte insgesamt
             int activeHeckCount = 0;
-            for (const auto& [col, fp] : stablePoints) {
-                if (getVehiclePartType(col) == "heck" && (fp.isValid || fp.isStable)) {
+            for (const auto& [key, fp] : stablePoints) {
+                if (isHeckMarker(fp.marker) && (fp.isValid || fp.isStable)) {
                     activeHeckCount++;
                 }
             }
 
             if (activeHeckCount >= 4) {
-                std::cout << "Bereits 4 Heck-Punkte aktiv - neue Detektion " << color << " ignoriert" << std::endl;
+                std::cout << "Bereits 4 Heck-Punkte aktiv - neue Detektion " << markerName(marker) << " ignoriert" << std::endl;
                 return;
             }
         }
 
         // Neuen Punkt erstellen
-        stablePoints[actualKey] = FilteredPoint(newPoint, color); // Originale Farbe im FilteredPoint speichern
-        std::cout << "Neuer " << partType << "-Punkt erkannt: " << actualKey << " (original: " << color << ")" << std::endl;
+        stablePoints[actualKey] = FilteredPoint(newPoint, marker);
+        std::cout << "Neuer " << (isFrontMarker(marker) ? "front" : "heck") << "-Punkt erkannt: " << markerName(marker);
+        if (isFrontMarker(marker)) std::cout << "_" << (actualKey - FRONT_KEY_BASE);
+        std::cout << std::endl;
     }
 }
 
@@ -202,7 +168,7 @@ void CoordinateFilter::removeExpiredPoints() {
                            (fp.missedDetections > maxMissedDetections);
 
         if (shouldRemove) {
-            std::cout << "Punkt " << fp.color << " entfernt (Timeout: " 
+            std::cout << "Punkt " << markerName(fp.marker) << " entfernt (Timeout: " 
                       << (timeDiff.count() > validityTimeout * 1000) 
                       << ", Missed: " << fp.missedDetections << ")" << std::endl;
             it = stablePoints.erase(it);
@@ -228,7 +194,7 @@ void CoordinateFilter::updatePointStability(FilteredPoint& fp) {
             fp.isStable = true;
             fp.isValid = true;
             fp.consecutiveValidDetections = fp.recentDetections.size();
-            std::cout << "Punkt " << fp.color << " ist jetzt stabil nach " 
+            std::cout << "Punkt " << markerName(fp.marker) << " ist jetzt stabil nach " 
                       << fp.totalDetections << " Detektionen" << std::endl;
         } else if (allWithinRadius) {
             fp.isValid = true;
@@ -255,24 +221,6 @@ bool CoordinateFilter::isWithinMovementThreshold(const Point& oldPos, const Poin
     return oldPos.distanceTo(newPos) <= movementThreshold;
 }
 
-std::string CoordinateFilter::getVehiclePartType(const std::string& color) const {
-    if (color.find("Heck") == 0) {
-        return "heck";
-    } else if (color.find("Front") == 0) {
-        return "front";
-    }
-    return color;
-}
-
-std::string CoordinateFilter::extractHeckNumber(const std::string& color) const {
-    if (color.find("Heck") == 0) {
-        // Extract number from "Heck1", "Heck2", etc.
-        std::string numberPart = color.substr(4); // Skip "Heck"
-        return numberPart.empty() ? "0" : numberPart;
-    }
-    return "";
-}
-
 void CoordinateFilter::updateMotionModel(FilteredPoint& fp, const Point& newPosition) {
     auto now = std::chrono::steady_clock::now();
     auto timeDiff = std::chrono::duration_cast<std::chrono::milliseconds>(now - fp.lastUpdate);
@@ -330,7 +278,7 @@ Point CoordinateFilter::predictNextPosition(const FilteredPoint& fp, float delta
 void CoordinateFilter::generatePredictedPoints() {
     auto now = std::chrono::steady_clock::now();
     
-    for (auto& [color, fp] : stablePoints) {
+    for (auto& [key, fp] : stablePoints) {
         if (fp.isStable && fp.hasPrediction && fp.missedDetections > 0) {
             auto timeDiff = std::chrono::duration_cast<std::chrono::milliseconds>(now - fp.lastUpdate);
             float deltaTime = timeDiff.count() / 1000.0f;
@@ -342,7 +290,7 @@ void CoordinateFilter::generatePredictedPoints() {
                 // Update the point with predicted position for smoother tracking
                 fp.point = fp.predictedPosition;
                 
-                std::cout << "Punkt " << color << " vorhergesagt bei (" 
+                std::cout << "Punkt " << markerName(fp.marker) << " vorhergesagt bei (" 
                           << fp.predictedPosition.x << ", " << fp.predictedPosition.y 
                           << ") nach " << deltaTime << "s" << std::endl;
             }
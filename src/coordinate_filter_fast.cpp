@@ -21,22 +21,22 @@ public:
     }
 
     std::vector<Point> filterAndSmooth(const std::vector<Point>& newDetections, 
-                                      const std::vector<std::string>& colors) {
+                                      const std::vector<MarkerId>& markers) {
         std::vector<Point> result;
         result.reserve(newDetections.size()); // Performance-Optimierung
         
         // ABSOLUT DIREKTER DURCHGANG - KEINE VALIDIERUNG für maximale Geschwindigkeit
-        for (size_t i = 0; i < newDetections.size() && i < colors.size(); i++) {
+        for (size_t i = 0; i < newDetections.size() && i < markers.size(); i++) {
             Point fastPoint = newDetections[i];
             
-            // Setze Punkttyp basierend auf Farbe (ohne Validierung)
-            if (colors[i].find("Front") == 0) {
+            // Setze Punkttyp basierend auf Marker (ohne Validierung)
+            if (isFrontMarker(markers[i])) {
                 fastPoint.type = PointType::FRONT;
-            } else if (colors[i].find("Heck") == 0) {
+            } else if (isHeckMarker(markers[i])) {
                 fastPoint.type = PointType::IDENTIFICATION;
             }
             
-            fastPoint.color = colors[i];
+            fastPoint.marker = markers[i];
             result.push_back(std::move(fastPoint)); // Move semantics
         }
         
@@ -53,13 +53,12 @@ private:
     
     std::vector<Point> removeDuplicateHeckPoints(const std::vector<Point>& points) {
         std::vector<Point> result;
-        std::map<std::string, bool> heckNumbersSeen;
+        bool heckNumbersSeen[2 + MAX_HECK_MARKERS] = {};
         
         for (const Point& p : points) {
-            if (p.color.find("Heck") == 0) {
-                std::string heckNumber = p.color.substr(4); // "Heck1" -> "1"
-                if (heckNumbersSeen.find(heckNumber) == heckNumbersSeen.end()) {
-                    heckNumbersSeen[heckNumber] = true;
+            if (isHeckMarker(p.marker)) {
+                if (!heckNumbersSeen[p.marker]) {
+                    heckNumbersSeen[p.marker] = true;
                     result.push_back(p);
                 }
             } else {
@@ -76,7 +75,7 @@ private:
         
         // Trenne Front und andere Punkte
         for (const Point& p : points) {
-            if (p.color.find("Front") == 0) {
+            if (isFrontMarker(p.marker)) {
                 frontPoints.push_back(p);
             } else {
                 otherPoints.push_back(p);
@@ -0,0 +1,55 @@
+import struct
+
+# Ein Datensatz pro erkanntem Objekt, Little Endian, 32 Bytes:
+# id (int32), Farbname (8 Bytes, mit 0 aufgefüllt), x, y, area, crop_width, crop_height (float32)
+# Muss zu PackedDetection in include/py_runner.h passen.
+RECORD = struct.Struct('<i8s5f')
+
+# Einstellungen für den C++-Detektor: Kopf min_size, Anzahl Farben (int32), dann pro Farbe
+# Farbname (8 Bytes) und Ziel-H, -S, -V sowie H-, S-, V-Toleranz (int32).
+# Muss zu PackedDetectorSettings/PackedMarkerColor in include/py_runner.h passen.
+SETTINGS_HEADER = struct.Struct('<ii')
+SETTINGS_COLOR = struct.Struct('<8s6i')
+
+
+def pack_detections(detected_objects, crop_width, crop_height):
+    """Packt die Erkennungen in ein bytes-Objekt fester Datensätze (von C++ per Buffer-Protokoll gelesen)"""
+    buffer = bytearray(RECORD.size * len(detected_objects))
+    for i, obj in enumerate(detected_objects):
+        coords = obj['normalized_coords']
+        RECORD.pack_into(buffer, i * RECORD.size, obj['id'], obj['classified_color'].encode('ascii'),
+                         coords[0], coords[1], obj['area'], crop_width, crop_height)
+    return bytes(buffer)
+
+
+def pack_settings(color_definitions, hsv_tolerances, min_size):
+    """Packt Farbdefinitionen und Toleranzen (Trackbar-Stand) für den C++-Detektor"""
+    buffer = bytearray(SETTINGS_HEADER.size + SETTINGS_COLOR.size * len(color_definitions))
+    SETTINGS_HEADER.pack_into(buffer, 0, min_size, len(color_definitions))
+    for i, (color_name, (h, s, v)) in enumerate(color_definitions.items()):
+        tolerances = hsv_tolerances[color_name]
+        SETTINGS_COLOR.pack_into(buffer, SETTINGS_HEADER.size + i * SETTINGS_COLOR.size, color_name.encode('ascii'),
+                                 h, s, v, tolerances['h'], tolerances['s'], tolerances['v'])
+    return bytes(buffer)
+
+
+def to_cpp_dicts(detected_objects, crop_width, crop_height):
+    """Bisheriges Format: eine Liste von Dictionaries pro Frame"""
+    return [{
+        'id': obj['id'],
+        'classified_color': obj['classified_color'],
+        'normalized_coords': obj['normalized_coords'],
+        'area': obj['area'],
+        'crop_width': crop_width,
+        'crop_height': crop_height
+    } for obj in detected_objects]
+
+
+def benchmark_detections(count):
+    """Synthetische Erkennungen (abwechselnd Front und Heck) für den Brücken-Benchmark, ohne Kamera"""
+    objects = []
+    for i in range(count):
+        color = 'Front' if i % 2 == 0 else f'Heck{i // 2 % 30 + 1}'
+        objects.append({'id': i + 1, 'classified_color': color,
+                        'normalized_coords': (10.0 + i, 20.0 + i), 'area': 150.0})
+    return objects
@@ -0,0 +1,211 @@
+#include "detection_ring.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+const size_t RING_SIZE = sizeof(DetectionRingHeader) + sizeof(DetectionRingSlot) * DETECTION_RING_SLOTS;
+
+bool headerMatches(const DetectionRingHeader* header) {
+    return header->magic == DETECTION_RING_MAGIC && header->version == DETECTION_RING_VERSION &&
+           header->slotCount == static_cast<uint32_t>(DETECTION_RING_SLOTS) && header->slotSize == sizeof(DetectionRingSlot);
+}
+
+} // namespace
+
+int64_t toRingNanos(std::chrono::steady_clock::time_point time) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count();
+}
+
+std::chrono::steady_clock::time_point fromRingNanos(int64_t nanos) {
+    return std::chrono::steady_clock::time_point(
+        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(nanos)));
+}
+
+DetectionRingMapping::~DetectionRingMapping() {
+    close();
+}
+
+bool DetectionRingMapping::map(const std::string& name, bool create) {
+    close();
+#ifdef _WIN32
+    HANDLE mapping = create
+        ? CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, static_cast<DWORD>(RING_SIZE), name.c_str())
+        : OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str());
+    if (!mapping) return false;
+    void* address = MapViewOfFile(mapping, create ? FILE_MAP_ALL_ACCESS : FILE_MAP_READ, 0, 0, 0);
+    MEMORY_BASIC_INFORMATION info;
+    if (!address || VirtualQuery(address, &info, sizeof(info)) == 0 || info.RegionSize < RING_SIZE) {
+        if (address) UnmapViewOfFile(address);
+        CloseHandle(mapping);
+        return false;
+    }
+    handle = mapping;
+#else
+    const std::string objectName = "/" + name;
+    int fd = shm_open(objectName.c_str(), create ? O_CREAT | O_RDWR : O_RDONLY, 0666);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (static_cast<size_t>(info.st_size) < RING_SIZE &&
+                                  (!create || ftruncate(fd, static_cast<off_t>(RING_SIZE)) != 0))) {
+        ::close(fd);
+        return false;
+    }
+    void* address = mmap(nullptr, RING_SIZE, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);   // The mapping keeps the object alive
+    if (address == MAP_FAILED) return false;
+#endif
+    header = static_cast<DetectionRingHeader*>(address);
+    size = RING_SIZE;
+    return true;
+}
+
+void DetectionRingMapping::close() {
+    if (!header) return;
+#ifdef _WIN32
+    UnmapViewOfFile(header);
+    CloseHandle(static_cast<HANDLE>(handle));
+    handle = nullptr;
+#else
+    munmap(header, size);
+#endif
+    header = nullptr;
+    size = 0;
+}
+
+DetectionRingSlot& DetectionRingMapping::slot(uint64_t sequence) const {
+    DetectionRingSlot* slots = reinterpret_cast<DetectionRingSlot*>(header + 1);
+    return slots[sequence % DETECTION_RING_SLOTS];
+}
+
+bool DetectionRingWriter::open(const std::string& name) {
+    if (!map(name, true)) return false;
+    if (!headerMatches(header)) {
+        // New object (zero-filled) or an incompatible layout: start over at frame 1
+        std::memset(static_cast<void*>(header + 1), 0, sizeof(DetectionRingSlot) * DETECTION_RING_SLOTS);
+        header->writeSequence.store(0, std::memory_order_relaxed);
+        header->slotCount = DETECTION_RING_SLOTS;
+        header->slotSize = sizeof(DetectionRingSlot);
+        header->version = DETECTION_RING_VERSION;
+        std::atomic_thread_fence(std::memory_order_release);
+        header->magic = DETECTION_RING_MAGIC;
+    }
+    return true;
+}
+
+void DetectionRingWriter::publish(const DetectionFrame& frame) {
+    if (!header) return;
+    const uint64_t sequence = header->writeSequence.load(std::memory_order_relaxed) + 1;
+    DetectionRingSlot& target = slot(sequence);
+
+    target.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);   // Readers see 0 before any new byte
+    target.captureNanos = toRingNanos(frame.captureTime);
+    target.publishNanos = toRingNanos(frame.publishTime);
+    target.count = static_cast<int32_t>(std::min(frame.objects.size(), static_cast<size_t>(DETECTION_RING_MAX_OBJECTS)));
+    for (int i = 0; i < target.count; i++) {
+        const DetectedObject& object = frame.objects[i];
+        PackedDetection& record = target.objects[i];
+        record.id = object.id;
+        std::memset(record.color, 0, sizeof(record.color));
+        std::strncpy(record.color, markerName(object.marker), sizeof(record.color));
+        record.x = object.coordinates.x;
+        record.y = object.coordinates.y;
+        record.area = object.area;
+        record.crop_width = object.crop_width;
+        record.crop_height = object.crop_height;
+    }
+    target.sequence.store(sequence, std::memory_order_release);
+    header->writeSequence.store(sequence, std::memory_order_release);
+}
+
+uint64_t DetectionRingWriter::getWriteSequence() const {
+    return header ? header->writeSequence.load(std::memory_order_acquire) : 0;
+}
+
+bool DetectionRingReader::open(const std::string& name) {
+    if (!map(name, false)) return false;
+    if (!headerMatches(header)) {
+        close();
+        return false;
+    }
+    nextSequence = header->writeSequence.load(std::memory_order_acquire) + 1;
+    droppedFrames = 0;
+    return true;
+}
+
+bool DetectionRingReader::next(DetectionFrame& frame) {
+    if (!header) return false;
+    for (;;) {
+        const uint64_t written = header->writeSequence.load(std::memory_order_acquire);
+        if (written < nextSequence) {
+            // A restarted writer that began again at frame 1 (incompatible ring reset)
+            if (written + DETECTION_RING_SLOTS < nextSequence) nextSequence = written + 1;
+            return false;
+        }
+        if (written - nextSequence >= static_cast<uint64_t>(DETECTION_RING_SLOTS)) {
+            // Overrun: the oldest unread frames are already overwritten
+            uint64_t oldest = written - DETECTION_RING_SLOTS + 1;
+            droppedFrames += oldest - nextSequence;
+            nextSequence = oldest;
+        }
+
+        const DetectionRingSlot& source = slot(nextSequence);
+        if (source.sequence.load(std::memory_order_acquire) != nextSequence) {
+            droppedFrames++;   // Overwritten (or being overwritten) meanwhile
+            nextSequence++;
+            continue;
+        }
+        int64_t captureNanos = source.captureNanos, publishNanos = source.publishNanos;
+        int count = std::max(0, std::min(static_cast<int>(source.count), DETECTION_RING_MAX_OBJECTS));
+        PackedDetection records[DETECTION_RING_MAX_OBJECTS];
+        std::memcpy(records, source.objects, sizeof(PackedDetection) * count);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (source.sequence.load(std::memory_order_relaxed) != nextSequence) {
+            droppedFrames++;
+            nextSequence++;
+            continue;
+        }
+
+        frame.sequence = nextSequence++;
+        frame.captureTime = fromRingNanos(captureNanos);
+        frame.publishTime = fromRingNanos(publishNanos);
+        frame.objects.clear();
+        for (int i = 0; i < count; i++) {
+            const PackedDetection& record = records[i];
+            char colorName[sizeof(record.color) + 1] = {};
+            std::memcpy(colorName, record.color, sizeof(record.color));
+
+            DetectedObject object;
+            object.id = record.id;
+            object.marker = internMarker(colorName);
+            object.coordinates.x = record.x;
+            object.coordinates.y = record.y;
+            object.area = record.area;
+            object.crop_width = record.crop_width;
+            object.crop_height = record.crop_height;
+            frame.objects.push_back(object);
+        }
+        return true;
+    }
+}
+
+bool DetectionRingReader::latest(DetectionFrame& frame) {
+    if (!header) return false;
+    const uint64_t written = header->writeSequence.load(std::memory_order_acquire);
+    if (written > nextSequence) {
+        droppedFrames += written - nextSequence;
+        nextSequence = written;
+    }
+    return next(frame);
+}
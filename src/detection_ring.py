@@ -0,0 +1,72 @@
+import struct
+import time
+from multiprocessing import resource_tracker, shared_memory
+
+from detection_packing import RECORD
+
+# Erkennungs-Stream im Shared Memory statt coordinates.json (Schreiber, wenn Farberkennung.py
+# allein läuft). Muss zu include/detection_ring.h passen: Kopf, dann SLOTS Slots fester Größe.
+# Kopf: magic, version, slotCount, slotSize (uint32), writeSequence (uint64)
+# Slot: sequence (uint64, 0 während des Schreibens), captureNanos, publishNanos (int64,
+#       time.perf_counter_ns wie std::chrono::steady_clock), count, reserviert (int32),
+#       dann MAX_OBJECTS Datensätze im Format detection_packing.RECORD
+NAME = 'pds_detections'
+MAGIC = 0x44535050
+VERSION = 1
+SLOTS = 64
+MAX_OBJECTS = 16
+HEADER = struct.Struct('<IIIIQ')
+SLOT_HEADER = struct.Struct('<QqqiI')
+SLOT_SIZE = SLOT_HEADER.size + MAX_OBJECTS * RECORD.size
+RING_SIZE = HEADER.size + SLOTS * SLOT_SIZE
+SEQUENCE = struct.Struct('<Q')
+WRITE_SEQUENCE_OFFSET = 16
+
+
+class DetectionRingWriter:
+    """Einziger Schreiber des Rings; setzt eine vorhandene Sequenz fort (Leser bleiben monoton).
+    Die 8-Byte-Sequenzen werden als ganze Wörter geschrieben; die Reihenfolge der Speicherzugriffe
+    garantiert CPython nur auf x86 (Total Store Order) - wie die Kamera-PCs des Projekts."""
+
+    def __init__(self, name=NAME):
+        try:
+            self.shm = shared_memory.SharedMemory(name=name, create=False)
+            if self.shm.size < RING_SIZE:
+                raise ValueError(f"Shared Memory {name} zu klein")
+        except FileNotFoundError:
+            self.shm = shared_memory.SharedMemory(name=name, create=True, size=RING_SIZE)
+        # Nicht beim Prozessende löschen: laufende Leser behalten den Ring
+        try:
+            resource_tracker.unregister(self.shm._name, 'shared_memory')
+        except Exception:
+            pass
+        self.buffer = self.shm.buf
+
+        magic, version, slot_count, slot_size, self.sequence = HEADER.unpack_from(self.buffer, 0)
+        if (magic, version, slot_count, slot_size) != (MAGIC, VERSION, SLOTS, SLOT_SIZE):
+            self.buffer[HEADER.size:RING_SIZE] = bytes(RING_SIZE - HEADER.size)
+            self.sequence = 0
+            HEADER.pack_into(self.buffer, 0, 0, VERSION, SLOTS, SLOT_SIZE, 0)
+            struct.pack_into('<I', self.buffer, 0, MAGIC)
+
+    def publish(self, detected_objects, crop_width, crop_height, capture_ns):
+        """Ein Frame (Erkennungen wie detect_colors) als nächster Slot"""
+        sequence = self.sequence + 1
+        offset = HEADER.size + (sequence % SLOTS) * SLOT_SIZE
+        count = min(len(detected_objects), MAX_OBJECTS)
+
+        SEQUENCE.pack_into(self.buffer, offset, 0)
+        record_offset = offset + SLOT_HEADER.size
+        for obj in detected_objects[:count]:
+            coords = obj['normalized_coords']
+            RECORD.pack_into(self.buffer, record_offset, obj['id'], obj['classified_color'].encode('ascii'),
+                             coords[0], coords[1], obj['area'], crop_width, crop_height)
+            record_offset += RECORD.size
+        SLOT_HEADER.pack_into(self.buffer, offset, 0, capture_ns, time.perf_counter_ns(), count, 0)
+        SEQUENCE.pack_into(self.buffer, offset, sequence)
+        SEQUENCE.pack_into(self.buffer, WRITE_SEQUENCE_OFFSET, sequence)
+        self.sequence = sequence
+
+    def close(self):
+        self.buffer = None
+        self.shm.close()
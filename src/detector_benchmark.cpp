@@ -0,0 +1,813 @@
+#include "detector_benchmark.h"
+#include "floor_calibration.h"
+#include "latency_trace.h"
+#include "marker_detector.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+struct DrawnMarker {
+    MarkerId marker;
+    float x, y;
+};
+
+struct SyntheticFrame {
+    int width, height;
+    std::vector<uint8_t> bgr;
+    std::vector<DrawnMarker> markers;
+};
+
+// OpenCV HSV (H 0..179) to BGR
+void hsvToBgr(int h, int s, int v, uint8_t* bgr) {
+    float hue = h * 2.0f / 60.0f;
+    float chroma = v * s / 255.0f;
+    float x = chroma * (1.0f - std::fabs(std::fmod(hue, 2.0f) - 1.0f));
+    float m = v - chroma;
+    float r = 0.0f, g = 0.0f, b = 0.0f;
+    switch (static_cast<int>(hue) % 6) {
+        case 0: r = chroma; g = x; break;
+        case 1: r = x; g = chroma; break;
+        case 2: g = chroma; b = x; break;
+        case 3: g = x; b = chroma; break;
+        case 4: r = x; b = chroma; break;
+        default: r = chroma; b = x; break;
+    }
+    bgr[0] = static_cast<uint8_t>(std::lround(b + m));
+    bgr[1] = static_cast<uint8_t>(std::lround(g + m));
+    bgr[2] = static_cast<uint8_t>(std::lround(r + m));
+}
+
+// Gray, low-saturation noise floor
+void fillNoise(SyntheticFrame& frame, std::mt19937& rng) {
+    frame.bgr.resize(static_cast<size_t>(frame.width) * frame.height * 3);
+    std::uniform_int_distribution<int> gray(70, 150);
+    std::uniform_int_distribution<int> tint(-12, 12);
+    for (size_t i = 0; i < frame.bgr.size(); i += 3) {
+        int base = gray(rng);
+        frame.bgr[i] = static_cast<uint8_t>(base + tint(rng));
+        frame.bgr[i + 1] = static_cast<uint8_t>(base + tint(rng));
+        frame.bgr[i + 2] = static_cast<uint8_t>(base + tint(rng));
+    }
+}
+
+// Discs of radius 9 at the sub-pixel marker centers, with per-pixel brightness jitter
+// (scaling keeps S of the markers)
+void drawMarkers(SyntheticFrame& frame, const MarkerDetectorConfig& config, std::mt19937& rng) {
+    const float radius = 9.0f;
+    std::uniform_real_distribution<float> jitter(0.85f, 1.0f);
+    for (const DrawnMarker& drawn : frame.markers) {
+        const MarkerColor* color = nullptr;
+        for (const MarkerColor& candidate : config.colors) {
+            if (candidate.marker == drawn.marker) color = &candidate;
+        }
+        if (!color) continue;
+        uint8_t base[3];
+        hsvToBgr(color->h, color->s, color->v, base);
+        for (int y = static_cast<int>(drawn.y - radius) - 1; y <= static_cast<int>(drawn.y + radius) + 1; y++) {
+            for (int x = static_cast<int>(drawn.x - radius) - 1; x <= static_cast<int>(drawn.x + radius) + 1; x++) {
+                if (x < 0 || y < 0 || x >= frame.width || y >= frame.height) continue;
+                if (std::hypot(x - drawn.x, y - drawn.y) > radius) continue;
+                uint8_t* pixel = &frame.bgr[(static_cast<size_t>(y) * frame.width + x) * 3];
+                float scale = jitter(rng);
+                for (int c = 0; c < 3; c++) pixel[c] = static_cast<uint8_t>(base[c] * scale);
+            }
+        }
+    }
+}
+
+// Noise floor with four vehicles at random places: a Heck disc and a Front disc each
+SyntheticFrame makeSyntheticFrame(int width, int height, const MarkerDetectorConfig& config, std::mt19937& rng) {
+    SyntheticFrame frame;
+    frame.width = width;
+    frame.height = height;
+    fillNoise(frame, rng);
+
+    const float margin = 40.0f;
+    std::uniform_real_distribution<float> px(margin, width - margin);
+    std::uniform_real_distribution<float> py(margin, height - margin);
+    std::uniform_real_distribution<float> angle(0.0f, 6.2831853f);
+
+    for (int vehicle = 1; vehicle <= 4; vehicle++) {
+        // Heck and Front 24 px apart, vehicles at least 80 px from each other
+        DrawnMarker heck = {heckMarker(vehicle), 0.0f, 0.0f}, front = {MARKER_FRONT, 0.0f, 0.0f};
+        for (int attempt = 0; attempt < 1000; attempt++) {
+            float a = angle(rng);
+            heck.x = px(rng);
+            heck.y = py(rng);
+            front.x = heck.x + 24.0f * std::cos(a);
+            front.y = heck.y + 24.0f * std::sin(a);
+            bool free = true;
+            for (const DrawnMarker& other : frame.markers) {
+                if (std::hypot(other.x - heck.x, other.y - heck.y) < 80.0f) free = false;
+            }
+            if (free) break;
+        }
+        frame.markers.push_back(heck);
+        frame.markers.push_back(front);
+    }
+
+    drawMarkers(frame, config, rng);
+    return frame;
+}
+
+// Four vehicles driving circles side by side, alternating direction, speed px per frame;
+// the Front marker leads the Heck marker by 24 px along the direction of travel
+void placeCirclingVehicles(SyntheticFrame& frame, int frameIndex, float speed) {
+    frame.markers.clear();
+    const float radius = std::min(frame.width / 8.0f, frame.height / 4.0f) * 0.6f;
+    for (int vehicle = 1; vehicle <= 4; vehicle++) {
+        float cx = frame.width * (2 * vehicle - 1) / 8.0f, cy = frame.height / 2.0f;
+        float direction = vehicle % 2 ? 1.0f : -1.0f;
+        float a = vehicle * 1.3f + direction * frameIndex * speed / radius;
+        float hx = cx + radius * std::cos(a), hy = cy + radius * std::sin(a);
+        frame.markers.push_back({heckMarker(vehicle), hx, hy});
+        frame.markers.push_back({MARKER_FRONT, hx - direction * 24.0f * std::sin(a), hy + direction * 24.0f * std::cos(a)});
+    }
+}
+
+// Binary PPM (P6, maxval 255) as written by cv2.imwrite("frame.ppm", frame), RGB -> BGR
+bool loadPpmFrame(const std::string& path, SyntheticFrame& frame) {
+    std::ifstream file(path, std::ios::binary);
+    std::string magic;
+    int maxValue = 0;
+    file >> magic;
+    // Header fields may be separated by comment lines
+    int* fields[] = {&frame.width, &frame.height, &maxValue};
+    for (int* field : fields) {
+        while (file >> std::ws && file.peek() == '#') file.ignore(1 << 20, '\n');
+        file >> *field;
+    }
+    if (!file || magic != "P6" || maxValue != 255 || frame.width <= 0 || frame.height <= 0) return false;
+    file.get();
+
+    frame.bgr.resize(static_cast<size_t>(frame.width) * frame.height * 3);
+    file.read(reinterpret_cast<char*>(frame.bgr.data()), static_cast<std::streamsize>(frame.bgr.size()));
+    if (!file) return false;
+    for (size_t i = 0; i < frame.bgr.size(); i += 3) std::swap(frame.bgr[i], frame.bgr[i + 2]);
+    frame.markers.clear();
+    return true;
+}
+
+// Largest centroid distance between two detections of the same frame, or -1 if the markers
+// differ (object by object; both come out in the same order)
+double maxCentroidDifference(const std::vector<DetectedObject>& a, const std::vector<DetectedObject>& b) {
+    if (a.size() != b.size()) return -1.0;
+    double maxDifference = 0.0;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].marker != b[i].marker) return -1.0;
+        maxDifference = std::max(maxDifference, static_cast<double>(std::hypot(a[i].coordinates.x - b[i].coordinates.x,
+                                                                               a[i].coordinates.y - b[i].coordinates.y)));
+    }
+    return maxDifference;
+}
+
+// Stand-in for the real camera: 800x600 crop onto the 1920x1200 floor with barrel distortion
+// and a slightly tilted view (same model family as FloorCalibration, other parameters)
+void cameraToFloor(double x, double y, double& floorX, double& floorY) {
+    const double norm = 500.0;   // Half diagonal of 800x600
+    double dx = (x - 400.0) / norm, dy = (y - 300.0) / norm;
+    double r2 = dx * dx + dy * dy;
+    double factor = 1.0 - 0.08 * r2 + 0.012 * r2 * r2;
+    double ux = dx * factor, uy = dy * factor;
+    double w = 1.0 + 0.06 * ux - 0.04 * uy;
+    floorX = 960.0 + (1150.0 * ux + 40.0 * uy + 10.0) / w;
+    floorY = 600.0 + (-30.0 * ux + 1000.0 * uy - 5.0) / w;
+}
+
+// Drawn markers found within 3 px; adds the distances of the found ones
+int countFound(const SyntheticFrame& frame, const std::vector<DetectedObject>& objects, double& errorSum, double& maxError) {
+    int found = 0;
+    for (const DrawnMarker& drawn : frame.markers) {
+        double best = 1e9;
+        for (const DetectedObject& object : objects) {
+            if (object.marker != drawn.marker) continue;
+            best = std::min(best, static_cast<double>(std::hypot(object.coordinates.x - drawn.x,
+                                                                 object.coordinates.y - drawn.y)));
+        }
+        if (best < 3.0) {
+            found++;
+            errorSum += best;
+            maxError = std::max(maxError, best);
+        }
+    }
+    return found;
+}
+
+// Reference for the labeller: per-pixel 8-connected flood fill over every class bit, as
+// MarkerDetector did before the run-length pass
+void floodFillComponents(const std::vector<uint8_t>& classes, int width, int height, int classCount,
+                         std::vector<ClassComponent>& components) {
+    components.clear();
+    std::vector<uint8_t> visited(classes.size(), 0);
+    std::vector<int> stack;
+    std::vector<ClassComponent> perClass[MAX_MARKER_COLORS];
+    for (int start = 0; start < width * height; start++) {
+        for (int c = 0; c < classCount; c++) {
+            const uint8_t bit = static_cast<uint8_t>(1 << c);
+            if (!(classes[start] & bit) || (visited[start] & bit)) continue;
+
+            ClassComponent component = {c, 0, 0, 0, width, height, -1, -1, 0, 0, 0, 0};
+            stack.assign(1, start);
+            visited[start] |= bit;
+            while (!stack.empty()) {
+                int index = stack.back();
+                stack.pop_back();
+                int x = index % width, y = index / width;
+                component.pixelCount++;
+                component.sumX += x;
+                component.sumY += y;
+                component.minX = std::min(component.minX, x);
+                component.minY = std::min(component.minY, y);
+                component.maxX = std::max(component.maxX, x);
+                component.maxY = std::max(component.maxY, y);
+                // The four 2x2 windows around the pixel, each counted at its first set pixel
+                // (8-connected: every set pixel of a window is in this component)
+                for (int wy = y - 1; wy <= y; wy++) {
+                    for (int wx = x - 1; wx <= x; wx++) {
+                        bool set[4];
+                        for (int k = 0; k < 4; k++) {
+                            int px = wx + (k & 1), py = wy + (k >> 1);
+                            set[k] = px >= 0 && py >= 0 && px < width && py < height && (classes[py * width + px] & bit);
+                        }
+                        int first = 0;
+                        while (!set[first]) first++;
+                        if (wx + (first & 1) != x || wy + (first >> 1) != y) continue;
+
+                        int count = set[0] + set[1] + set[2] + set[3];
+                        if (count == 4) component.quadFull++;
+                        else if (count == 3) component.quadThree++;
+                        else if (count == 2 && set[0] == set[3]) component.quadDiagonal++;
+                        else if (count == 2) component.quadSide++;
+                    }
+                }
+                for (int dy = -1; dy <= 1; dy++) {
+                    for (int dx = -1; dx <= 1; dx++) {
+                        int nx = x + dx, ny = y + dy;
+                        if (nx < 0 || ny < 0 || nx >= width || ny >= height) continue;
+                        int neighbor = ny * width + nx;
+                        if ((classes[neighbor] & bit) && !(visited[neighbor] & bit)) {
+                            visited[neighbor] |= bit;
+                            stack.push_back(neighbor);
+                        }
+                    }
+                }
+            }
+            perClass[c].push_back(component);
+        }
+    }
+    for (int c = 0; c < classCount; c++) components.insert(components.end(), perClass[c].begin(), perClass[c].end());
+}
+
+bool sameComponents(const std::vector<ClassComponent>& a, const std::vector<ClassComponent>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); i++) {
+        if (a[i].classIndex != b[i].classIndex || a[i].pixelCount != b[i].pixelCount ||
+            a[i].sumX != b[i].sumX || a[i].sumY != b[i].sumY ||
+            a[i].minX != b[i].minX || a[i].minY != b[i].minY || a[i].maxX != b[i].maxX || a[i].maxY != b[i].maxY ||
+            a[i].quadFull != b[i].quadFull || a[i].quadThree != b[i].quadThree ||
+            a[i].quadSide != b[i].quadSide || a[i].quadDiagonal != b[i].quadDiagonal) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+void runMarkerDetectorBenchmark() {
+    std::cout << "=== Native marker detector per camera frame (budget 33.3 ms at 30 fps) ===\n";
+    std::cout << std::left << std::setw(12) << "Frame" << std::right << std::setw(12) << "Time [ms]"
+              << std::setw(14) << "Frames/s" << std::setw(16) << "All found [%]" << std::setw(18) << "Mean error [px]"
+              << std::setw(17) << "Max error [px]" << "\n";
+
+    MarkerDetector detector;
+    const int sizes[][2] = {{640, 480}, {1280, 720}, {1920, 1080}};
+    for (const auto& size : sizes) {
+        std::mt19937 rng(42);
+        std::vector<SyntheticFrame> frames;
+        for (int i = 0; i < 8; i++) frames.push_back(makeSyntheticFrame(size[0], size[1], detector.getConfig(), rng));
+
+        const int runs = size[0] <= 640 ? 200 : 50;
+        std::vector<DetectedObject> objects;
+        detector.detect({frames[0].bgr.data(), frames[0].width, frames[0].height, frames[0].width * 3}, objects);   // Builds the class table
+        int framesComplete = 0;
+        double errorSum = 0.0, maxError = 0.0;
+        int matched = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int run = 0; run < runs; run++) {
+            const SyntheticFrame& frame = frames[run % frames.size()];
+            objects.clear();
+            detector.detect({frame.bgr.data(), frame.width, frame.height, frame.width * 3}, objects);
+            if (run >= static_cast<int>(frames.size())) continue;
+
+            // Each drawn marker against the closest detection of its kind
+            int found = countFound(frame, objects, errorSum, maxError);
+            matched += found;
+            if (found == static_cast<int>(frame.markers.size())) framesComplete++;
+        }
+        double millis = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e3 / runs;
+
+        std::cout << std::left << std::setw(12) << (std::to_string(size[0]) + "x" + std::to_string(size[1]))
+                  << std::right << std::fixed << std::setprecision(2) << std::setw(12) << millis
+                  << std::setprecision(0) << std::setw(14) << 1000.0 / millis
+                  << std::setw(16) << 100.0 * framesComplete / frames.size()
+                  << std::setprecision(3) << std::setw(18) << (matched ? errorSum / matched : 0.0)
+                  << std::setw(17) << maxError << "\n";
+    }
+    std::cout << std::flush;
+}
+
+void runMarkerClassLutBenchmark() {
+    std::cout << "=== Pixel classification per frame: HSV conversion + range check vs. BGR class table ===\n";
+    std::cout << std::left << std::setw(12) << "Frame" << std::right << std::setw(12) << "HSV [ms]"
+              << std::setw(14) << "Table [ms]" << std::setw(16) << "Boundary [%]" << std::setw(8) << "Same" << "\n";
+
+    MarkerDetectorConfig config;
+    MarkerClassLut lut;
+    auto start = std::chrono::steady_clock::now();
+    lut.build(config.colors);
+    double firstBuildMillis = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e3;
+
+    const int sizes[][2] = {{640, 480}, {1280, 720}, {1920, 1080}};
+    for (const auto& size : sizes) {
+        std::mt19937 rng(42);
+        SyntheticFrame frame = makeSyntheticFrame(size[0], size[1], config, rng);
+        const int pixels = frame.width * frame.height;
+        const int runs = 20;
+        std::vector<uint8_t> before(pixels), after(pixels);
+
+        // Before: every pixel converted to HSV and checked against the ranges of all colors
+        start = std::chrono::steady_clock::now();
+        for (int run = 0; run < runs; run++) {
+            const uint8_t* bgr = frame.bgr.data();
+            for (int i = 0; i < pixels; i++, bgr += 3) before[i] = lut.classifyExact(bgr[0], bgr[1], bgr[2]);
+        }
+        double hsvMillis = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e3 / runs;
+
+        // After: one table lookup, HSV only in bins crossing a tolerance boundary
+        start = std::chrono::steady_clock::now();
+        for (int run = 0; run < runs; run++) {
+            for (int y = 0; y < frame.height; y++) {
+                lut.classifyRow(&frame.bgr[static_cast<size_t>(y) * frame.width * 3], frame.width, &after[static_cast<size_t>(y) * frame.width]);
+            }
+        }
+        double lutMillis = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e3 / runs;
+
+        int boundaryPixels = 0;
+        for (int i = 0; i < pixels; i++) {
+            boundaryPixels += lut.isBoundaryBin(frame.bgr[i * 3], frame.bgr[i * 3 + 1], frame.bgr[i * 3 + 2]);
+        }
+
+        std::cout << std::left << std::setw(12) << (std::to_string(size[0]) + "x" + std::to_string(size[1]))
+                  << std::right << std::fixed << std::setprecision(2) << std::setw(12) << hsvMillis
+                  << std::setw(14) << lutMillis << std::setw(16) << 100.0 * boundaryPixels / pixels
+                  << std::setw(8) << (before == after ? "yes" : "NO") << "\n";
+    }
+
+    // Trackbar change: only the tolerance step, the per-bin HSV ranges are kept
+    start = std::chrono::steady_clock::now();
+    const int rebuilds = 20;
+    for (int i = 0; i < rebuilds; i++) {
+        config.colors[i % config.colors.size()].hTolerance += 1;
+        lut.build(config.colors);
+    }
+    double rebuildMillis = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e3 / rebuilds;
+    std::cout << "Table: " << MarkerClassLut::BINS << " bins, " << lut.boundaryBinCount() << " boundary bins, first build "
+              << std::setprecision(1) << firstBuildMillis << " ms, rebuild after a trackbar change " << std::setprecision(2)
+              << rebuildMillis << " ms\n" << std::flush;
+}
+
+void runMarkerLabellerBenchmark() {
+    std::cout << "=== Blob extraction per frame (all colors): pixel flood fill vs. run-length labeller ===\n";
+    std::cout << std::left << std::setw(12) << "Frame" << std::right << std::setw(14) << "Fill [us]"
+              << std::setw(14) << "Runs [us]" << std::setw(13) << "Components" << std::setw(8) << "Blobs"
+              << std::setw(8) << "Same" << "\n";
+
+    MarkerDetector detector;
+    const int classCount = static_cast<int>(detector.getConfig().colors.size());
+    const int sizes[][2] = {{640, 480}, {1280, 720}, {1920, 1080}};
+    for (const auto& size : sizes) {
+        std::mt19937 rng(42);
+        SyntheticFrame frame = makeSyntheticFrame(size[0], size[1], detector.getConfig(), rng);
+        std::vector<DetectedObject> objects;
+        detector.detect({frame.bgr.data(), frame.width, frame.height, frame.width * 3}, objects);
+        const std::vector<uint8_t> classes = detector.getClassImage();
+        const int runs = 50;
+
+        std::vector<ClassComponent> before, after;
+        auto start = std::chrono::steady_clock::now();
+        for (int run = 0; run < runs; run++) floodFillComponents(classes, frame.width, frame.height, classCount, before);
+        double fillMicros = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6 / runs;
+
+        RunLengthLabeller labeller;
+        start = std::chrono::steady_clock::now();
+        for (int run = 0; run < runs; run++) labeller.label(classes.data(), frame.width, frame.height, classCount, after);
+        double runMicros = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6 / runs;
+
+        int blobs = 0;
+        for (const ClassComponent& component : after) {
+            MarkerBlob blob;
+            blobs += detector.measureBlob(component, blob);
+        }
+
+        std::cout << std::left << std::setw(12) << (std::to_string(size[0]) + "x" + std::to_string(size[1]))
+                  << std::right << std::fixed << std::setprecision(1) << std::setw(14) << fillMicros
+                  << std::setw(14) << runMicros << std::setw(13) << after.size() << std::setw(8) << blobs
+                  << std::setw(8) << (sameComponents(before, after) ? "yes" : "NO") << "\n";
+    }
+    std::cout << std::flush;
+}
+
+void runMarkerContourCheck() {
+    std::cout << "=== Blob area and perimeter against cv2.contourArea / cv2.arcLength ===\n";
+    std::cout << std::left << std::setw(16) << "Shape" << std::right << std::setw(8) << "Pixels"
+              << std::setw(10) << "Area" << std::setw(10) << "OpenCV" << std::setw(12) << "Perimeter"
+              << std::setw(10) << "OpenCV" << std::setw(14) << "Compactness" << "\n";
+
+    // Rectangles w x h, discs (x - c)^2 + (y - c)^2 <= r^2 on the pixel grid; OpenCV values
+    // measured on the same masks
+    struct Shape {
+        const char* name;
+        int width, height, radius;
+        double contourArea, arcLength;
+    };
+    const Shape shapes[] = {
+        {"rect 10x10", 10, 10, 0, 81.0, 36.0},
+        {"rect 20x5", 20, 5, 0, 76.0, 46.0},
+        {"rect 30x3", 30, 3, 0, 58.0, 62.0},
+        {"disc r=3", 0, 0, 3, 20.0, 19.3137},
+        {"disc r=5", 0, 0, 5, 66.0, 32.9706},
+        {"disc r=10", 0, 0, 10, 288.0, 65.9411},
+        {"disc r=20", 0, 0, 20, 1200.0, 131.8822},
+        {"disc r=40", 0, 0, 40, 4912.0, 263.7645},
+    };
+
+    MarkerDetector detector;
+    RunLengthLabeller labeller;
+    std::vector<ClassComponent> components;
+    const int size = 120;
+    for (const Shape& shape : shapes) {
+        std::vector<uint8_t> classes(size * size, 0);
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                bool inside = shape.radius > 0
+                    ? (x - 60) * (x - 60) + (y - 60) * (y - 60) <= shape.radius * shape.radius
+                    : x >= 10 && y >= 10 && x < 10 + shape.width && y < 10 + shape.height;
+                classes[y * size + x] = inside ? 1 : 0;
+            }
+        }
+        labeller.label(classes.data(), size, size, 1, components);
+        MarkerBlob blob;
+        detector.measureBlob(components[0], blob);
+
+        const float pi = 3.14159265358979f;
+        std::cout << std::left << std::setw(16) << shape.name << std::right << std::setw(8) << blob.pixelCount
+                  << std::fixed << std::setprecision(1) << std::setw(10) << blob.area << std::setw(10) << shape.contourArea
+                  << std::setprecision(2) << std::setw(12) << blob.perimeter << std::setw(10) << shape.arcLength
+                  << std::setprecision(3) << std::setw(14) << 4.0f * pi * blob.area / (blob.perimeter * blob.perimeter) << "\n";
+    }
+    std::cout << std::flush;
+}
+
+void runMarkerTrackingBenchmark() {
+    std::cout << "=== Marker detection on a moving sequence: full frame vs. tracking windows (30 fps paced) ===\n";
+    std::cout << std::left << std::setw(12) << "Frame" << std::right << std::setw(12) << "Full [ms]"
+              << std::setw(15) << "Tracking [ms]" << std::setw(14) << "Window px" << std::setw(12) << "Pixels [%]"
+              << std::setw(9) << "Sweeps" << std::setw(14) << "Found full" << std::setw(15) << "Found track"
+              << std::setw(17) << "Max error [px]" << "\n";
+
+    const int frameCount = 90;
+    const float speed = 6.0f;   // px per frame, 180 px/s at 30 fps
+    const auto period = std::chrono::microseconds(33333);
+    const int sizes[][2] = {{640, 480}, {1280, 720}, {1920, 1080}};
+    for (const auto& size : sizes) {
+        MarkerDetector full;
+        MarkerDetectorConfig config = full.getConfig();
+        config.roiTracking = true;
+        MarkerDetector tracking(config);
+
+        std::mt19937 rng(42);
+        SyntheticFrame background;
+        background.width = size[0];
+        background.height = size[1];
+        fillNoise(background, rng);
+        SyntheticFrame frame = background;
+
+        std::vector<DetectedObject> objects;
+        full.detect({frame.bgr.data(), frame.width, frame.height, frame.width * 3}, objects);   // Builds the class tables
+        tracking.detect({frame.bgr.data(), frame.width, frame.height, frame.width * 3}, objects);
+
+        // Paced like the camera, so the motion model sees real frame intervals
+        double fullSeconds = 0.0, trackingSeconds = 0.0, errorSum = 0.0, maxError = 0.0;
+        long long pixels = 0, windowPixels = 0;
+        int sweeps = 0, completeFull = 0, completeTracking = 0;
+        auto nextFrame = std::chrono::steady_clock::now();
+        for (int index = 0; index < frameCount; index++) {
+            std::copy(background.bgr.begin(), background.bgr.end(), frame.bgr.begin());
+            placeCirclingVehicles(frame, index, speed);
+            drawMarkers(frame, config, rng);
+            const BgrImageView view = {frame.bgr.data(), frame.width, frame.height, frame.width * 3};
+            const int markers = static_cast<int>(frame.markers.size());
+
+            objects.clear();
+            auto start = std::chrono::steady_clock::now();
+            full.detect(view, objects);
+            fullSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            double unused = 0.0, unusedMax = 0.0;
+            completeFull += countFound(frame, objects, unused, unusedMax) == markers;
+
+            objects.clear();
+            start = std::chrono::steady_clock::now();
+            tracking.detect(view, objects);
+            trackingSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            completeTracking += countFound(frame, objects, errorSum, maxError) == markers;
+            pixels += tracking.getLastPixelCount();
+            if (tracking.lastFrameWasSweep()) sweeps++;
+            else windowPixels += tracking.getLastPixelCount();
+
+            nextFrame += period;
+            std::this_thread::sleep_until(nextFrame);
+        }
+
+        const double framePixels = static_cast<double>(frame.width) * frame.height;
+        std::cout << std::left << std::setw(12) << (std::to_string(size[0]) + "x" + std::to_string(size[1]))
+                  << std::right << std::fixed << std::setprecision(3) << std::setw(12) << fullSeconds * 1e3 / frameCount
+                  << std::setw(15) << trackingSeconds * 1e3 / frameCount
+                  << std::setprecision(0) << std::setw(14) << static_cast<double>(windowPixels) / std::max(frameCount - sweeps, 1)
+                  << std::setprecision(1) << std::setw(12) << 100.0 * pixels / frameCount / framePixels
+                  << std::setw(9) << sweeps
+                  << std::setw(13) << 100.0 * completeFull / frameCount << "%"
+                  << std::setw(14) << 100.0 * completeTracking / frameCount << "%"
+                  << std::setprecision(3) << std::setw(17) << maxError << "\n";
+    }
+    std::cout << std::flush;
+}
+
+void runMarkerPyramidBenchmark(const std::vector<std::string>& framePaths) {
+    std::cout << "=== Full sweep per frame: full resolution vs. coarse-to-fine pyramid (1/4, 1/8) ===\n";
+    std::cout << std::left << std::setw(24) << "Frames" << std::right << std::setw(12) << "Full [ms]"
+              << std::setw(12) << "1/4 [ms]" << std::setw(12) << "1/8 [ms]" << std::setw(12) << "Pixels 1/4"
+              << std::setw(12) << "Pixels 1/8" << std::setw(10) << "Markers" << std::setw(17) << "Max diff [px]" << "\n";
+
+    // Recorded frames one row each, otherwise eight synthetic frames per camera resolution
+    std::vector<std::pair<std::string, std::vector<SyntheticFrame>>> sets;
+    for (const std::string& path : framePaths) {
+        SyntheticFrame frame;
+        if (!loadPpmFrame(path, frame)) {
+            std::cerr << "Frame nicht lesbar (erwartet P6-PPM): " << path << std::endl;
+            continue;
+        }
+        sets.push_back({path.substr(path.find_last_of("/\\") + 1), {frame}});
+    }
+    if (framePaths.empty()) {
+        const int sizes[][2] = {{640, 480}, {1280, 720}, {1920, 1080}};
+        for (const auto& size : sizes) {
+            std::mt19937 rng(42);
+            std::vector<SyntheticFrame> frames;
+            for (int i = 0; i < 8; i++) frames.push_back(makeSyntheticFrame(size[0], size[1], MarkerDetectorConfig(), rng));
+            sets.push_back({std::to_string(size[0]) + "x" + std::to_string(size[1]), frames});
+        }
+    }
+
+    const int scales[] = {1, 4, 8};
+    MarkerDetector detectors[3];
+    for (int level = 0; level < 3; level++) {
+        MarkerDetectorConfig config = detectors[level].getConfig();
+        config.pyramidScale = scales[level];
+        detectors[level].setConfig(config);
+    }
+
+    for (const auto& set : sets) {
+        const std::vector<SyntheticFrame>& frames = set.second;
+        const int runs = frames[0].width <= 640 ? 200 : 50;
+        double millis[3] = {}, pixels[3] = {};
+        double maxDifference = 0.0;
+        size_t markers = 0;
+        std::vector<DetectedObject> reference, objects;
+        for (int level = 0; level < 3; level++) {
+            const SyntheticFrame& first = frames[0];
+            detectors[level].detect({first.bgr.data(), first.width, first.height, first.width * 3}, objects);   // Builds the class table
+            auto start = std::chrono::steady_clock::now();
+            for (int run = 0; run < runs; run++) {
+                const SyntheticFrame& frame = frames[run % frames.size()];
+                objects.clear();
+                detectors[level].detect({frame.bgr.data(), frame.width, frame.height, frame.width * 3}, objects);
+                pixels[level] += detectors[level].getLastPixelCount();
+            }
+            millis[level] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e3 / runs;
+            pixels[level] /= runs;
+        }
+
+        // Same markers at the same centroids as the full-resolution path, frame by frame
+        for (const SyntheticFrame& frame : frames) {
+            const BgrImageView view = {frame.bgr.data(), frame.width, frame.height, frame.width * 3};
+            reference.clear();
+            detectors[0].detect(view, reference);
+            markers += reference.size();
+            for (int level = 1; level < 3; level++) {
+                objects.clear();
+                detectors[level].detect(view, objects);
+                double difference = maxCentroidDifference(reference, objects);
+                maxDifference = difference < 0.0 || maxDifference < 0.0 ? -1.0 : std::max(maxDifference, difference);
+            }
+        }
+
+        const double framePixels = static_cast<double>(frames[0].width) * frames[0].height;
+        std::cout << std::left << std::setw(24) << set.first.substr(0, 23) << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(12) << millis[0] << std::setw(12) << millis[1] << std::setw(12) << millis[2]
+                  << std::setprecision(1) << std::setw(11) << 100.0 * pixels[1] / framePixels << "%"
+                  << std::setw(11) << 100.0 * pixels[2] / framePixels << "%" << std::setw(10) << markers
+                  << std::setprecision(3) << std::setw(17);
+        if (maxDifference < 0.0) std::cout << "DIFFERENT";
+        else std::cout << maxDifference;
+        std::cout << "\n";
+    }
+    std::cout << std::flush;
+}
+
+void runFloorCalibrationBenchmark() {
+    std::cout << "=== Crop -> floor coordinates: scale/offset trackbars vs. homography + lens model (800x600 crop) ===\n";
+    const int cropWidth = 800, cropHeight = 600;
+    std::mt19937 rng(42);
+    std::normal_distribution<float> detectionNoise(0.0f, 0.3f);
+
+    // 5x4 reference markers, their detections with 0.3 px noise
+    std::vector<CalibrationPair> pairs;
+    for (int row = 0; row < 4; row++) {
+        for (int col = 0; col < 5; col++) {
+            double x = 40.0 + col * (cropWidth - 80.0) / 4, y = 40.0 + row * (cropHeight - 80.0) / 3, floorX, floorY;
+            cameraToFloor(x, y, floorX, floorY);
+            pairs.push_back({static_cast<float>(x) + detectionNoise(rng), static_cast<float>(y) + detectionNoise(rng),
+                             static_cast<float>(floorX), static_cast<float>(floorY)});
+        }
+    }
+
+    // Before: per-axis scale and offset (the trackbars; the curve term is linear per axis too),
+    // here at their least-squares optimum
+    double scale[2], offset[2];
+    for (int axis = 0; axis < 2; axis++) {
+        double sumI = 0, sumF = 0, sumII = 0, sumIF = 0;
+        for (const CalibrationPair& pair : pairs) {
+            double image = axis ? pair.imageY : pair.imageX, floor = axis ? pair.floorY : pair.floorX;
+            sumI += image;
+            sumF += floor;
+            sumII += image * image;
+            sumIF += image * floor;
+        }
+        double n = static_cast<double>(pairs.size());
+        scale[axis] = (n * sumIF - sumI * sumF) / (n * sumII - sumI * sumI);
+        offset[axis] = (sumF - scale[axis] * sumI) / n;
+    }
+
+    FloorCalibration calibration;
+    auto start = std::chrono::steady_clock::now();
+    bool fitted = calibration.fit(pairs, cropWidth, cropHeight);
+    double fitMillis = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e3;
+    const int cellSizes[3] = {1, 4, 8};
+    FloorRemapTable tables[3];
+    double buildMillis[3];
+    for (int t = 0; t < 3; t++) {
+        start = std::chrono::steady_clock::now();
+        tables[t].build(calibration, cropWidth, cropHeight, cellSizes[t]);
+        buildMillis[t] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e3;
+    }
+    const int mappings = 5;   // Scale/offset, exact model, three tables
+
+    // Accuracy on random crop positions against the true mapping
+    const int pointCount = 1 << 16;
+    std::uniform_real_distribution<float> px(0.0f, static_cast<float>(cropWidth)), py(0.0f, static_cast<float>(cropHeight));
+    std::vector<float> xs(pointCount), ys(pointCount);
+    double errorSum[mappings] = {}, errorMax[mappings] = {};
+    int failed = 0;
+    for (int i = 0; i < pointCount; i++) {
+        xs[i] = px(rng);
+        ys[i] = py(rng);
+        double trueX, trueY;
+        cameraToFloor(xs[i], ys[i], trueX, trueY);
+        float floorX[mappings] = {}, floorY[mappings] = {};
+        floorX[0] = static_cast<float>(scale[0] * xs[i] + offset[0]);
+        floorY[0] = static_cast<float>(scale[1] * ys[i] + offset[1]);
+        failed += !calibration.toFloor(xs[i], ys[i], floorX[1], floorY[1]);
+        for (int t = 0; t < 3; t++) failed += !tables[t].lookup(xs[i], ys[i], floorX[2 + t], floorY[2 + t]);
+        for (int m = 0; m < mappings; m++) {
+            double error = std::hypot(floorX[m] - trueX, floorY[m] - trueY);
+            errorSum[m] += error;
+            errorMax[m] = std::max(errorMax[m], error);
+        }
+    }
+
+    // Cost per point over the same positions
+    double nanos[mappings];
+    float sink = 0.0f;
+    const int rounds = 16;
+    for (int m = 0; m < mappings; m++) {
+        start = std::chrono::steady_clock::now();
+        for (int round = 0; round < rounds; round++) {
+            for (int i = 0; i < pointCount; i++) {
+                float floorX = 0, floorY = 0;
+                if (m == 0) {
+                    floorX = static_cast<float>(scale[0]) * xs[i] + static_cast<float>(offset[0]);
+                    floorY = static_cast<float>(scale[1]) * ys[i] + static_cast<float>(offset[1]);
+                } else if (m == 1) {
+                    calibration.toFloor(xs[i], ys[i], floorX, floorY);
+                } else {
+                    tables[m - 2].lookup(xs[i], ys[i], floorX, floorY);
+                }
+                sink += floorX + floorY;
+            }
+        }
+        nanos[m] = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / (rounds * pointCount);
+    }
+
+    std::cout << std::left << std::setw(22) << "Mapping" << std::right << std::setw(16) << "Mean error [px]"
+              << std::setw(15) << "Max error [px]" << std::setw(13) << "Cost [ns]" << std::setw(12) << "Build [ms]"
+              << std::setw(12) << "Table [KB]" << "\n";
+    const char* names[mappings] = {"Scale/offset", "Model (exact)", "Remap table 1 px", "Remap table 4 px", "Remap table 8 px"};
+    for (int m = 0; m < mappings; m++) {
+        std::cout << std::left << std::setw(22) << names[m] << std::right << std::fixed << std::setprecision(3)
+                  << std::setw(16) << errorSum[m] / pointCount << std::setw(15) << errorMax[m]
+                  << std::setprecision(1) << std::setw(13) << nanos[m];
+        if (m >= 2) std::cout << std::setw(12) << buildMillis[m - 2] << std::setw(12) << tables[m - 2].getBytes() / 1024.0;
+        std::cout << "\n";
+    }
+    std::cout << "Fit " << (fitted ? "ok" : "FAILED") << " from " << pairs.size() << " markers (0.3 px noise) in "
+              << std::setprecision(2) << fitMillis << " ms, marker RMS " << calibration.rmsError(pairs) << " px, k1 "
+              << std::setprecision(4) << calibration.getK1() << ", k2 " << calibration.getK2()
+              << (failed ? ", UNDEFINED POINTS" : "") << (sink == 0.0f ? " " : "") << "\n" << std::flush;
+}
+
+void runLatencyTraceBenchmark() {
+    std::cout << "=== Latency recording: LatencyHistogram vs. mutex + sample vector ===\n";
+    // Stage latencies from microseconds to a few hundred ms (log-normal around 2 ms)
+    const int perThread = 1 << 20;
+    const int maxThreads = 4;
+    std::mt19937 rng(7);
+    std::lognormal_distribution<double> latency(std::log(2e6), 1.0);
+    std::vector<int64_t> samples(static_cast<size_t>(perThread) * maxThreads);
+    for (int64_t& sample : samples) sample = static_cast<int64_t>(latency(rng));
+
+    std::cout << std::left << std::setw(26) << "Recorder" << std::right << std::setw(9) << "Threads"
+              << std::setw(16) << "ns per record" << std::setw(14) << "Memory [KB]" << "\n";
+    static LatencyHistogram histogram;   // ~9 KB of counters, one per process and stage in real use
+    std::vector<int64_t> recorded;
+    for (int threads : {1, maxThreads}) {
+        for (int recorder = 1; recorder >= 0; recorder--) {   // Histogram last, its percentiles are checked below
+            histogram.reset();
+            recorded.clear();
+            recorded.reserve(samples.size());
+            std::mutex recordedMutex;
+            auto start = std::chrono::steady_clock::now();
+            std::vector<std::thread> workers;
+            for (int t = 0; t < threads; t++) {
+                workers.emplace_back([&, t]() {
+                    const int64_t* begin = samples.data() + static_cast<size_t>(t) * perThread;
+                    for (int i = 0; i < perThread; i++) {
+                        if (recorder == 0) {
+                            histogram.record(begin[i]);
+                        } else {
+                            std::lock_guard<std::mutex> lock(recordedMutex);
+                            recorded.push_back(begin[i]);
+                        }
+                    }
+                });
+            }
+            for (std::thread& worker : workers) worker.join();
+            double nanos = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 /
+                           (static_cast<double>(perThread) * threads);
+            double kilobytes = recorder == 0 ? sizeof(LatencyHistogram) / 1024.0
+                                             : recorded.size() * sizeof(int64_t) / 1024.0;
+            std::cout << std::left << std::setw(26) << (recorder == 0 ? "LatencyHistogram" : "Mutex + vector (exact)")
+                      << std::right << std::setw(9) << threads << std::fixed << std::setprecision(1)
+                      << std::setw(16) << nanos << std::setw(14) << kilobytes << "\n";
+        }
+    }
+
+    // The last histogram run recorded every sample once; exact percentiles from the sorted samples
+    std::vector<int64_t> sorted(samples);
+    std::sort(sorted.begin(), sorted.end());
+    auto exact = [&](double percent) {
+        size_t rank = static_cast<size_t>(std::ceil(percent / 100.0 * sorted.size()));
+        return sorted[std::max<size_t>(rank, 1) - 1];
+    };
+    std::cout << std::left << std::setw(26) << "Percentile" << std::right << std::setw(14) << "Exact [ms]"
+              << std::setw(16) << "Histogram [ms]" << std::setw(12) << "Error" << "\n";
+    const std::pair<const char*, double> percentiles[] = {{"p50", 50.0}, {"p99", 99.0}, {"p99.9", 99.9}};
+    for (const auto& percentile : percentiles) {
+        int64_t truth = exact(percentile.second), estimate = histogram.percentile(percentile.second);
+        std::cout << std::left << std::setw(26) << percentile.first << std::right << std::setprecision(3)
+                  << std::setw(14) << truth / 1e6 << std::setw(16) << estimate / 1e6 << std::setprecision(2)
+                  << std::setw(11) << 100.0 * std::fabs(static_cast<double>(estimate - truth)) / truth << "%\n";
+    }
+    std::cout << std::left << std::setw(26) << "max" << std::right << std::setprecision(3) << std::setw(14)
+              << sorted.back() / 1e6 << std::setw(16) << histogram.getMax() / 1e6 << "\n" << std::flush;
+}
@@ -0,0 +1,157 @@
+#include "event_journal.h"
+#include <chrono>
+#include <cstring>
+
+namespace {
+const char JOURNAL_MAGIC[8] = {'P', 'D', 'S', 'J', 'R', 'N', 'L', '1'};
+const uint32_t JOURNAL_VERSION = 2;
+}
+
+EventJournal::EventJournal(size_t capacity)
+    : mask(0), enqueuePos(0), dequeuePos(0), dropped(0), pendingDrops(0), written(0), file(nullptr), running(false) {
+    size_t size = 2;
+    while (size < capacity) size <<= 1;
+    mask = size - 1;
+
+    slots.reset(new Slot[size]);
+    for (size_t i = 0; i < size; i++) {
+        slots[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+EventJournal::~EventJournal() {
+    close();
+}
+
+bool EventJournal::open(const std::string& filename, uint32_t nodeCount, uint32_t segmentCount) {
+    close();
+
+    file = std::fopen(filename.c_str(), "wb");
+    if (!file) return false;
+
+    JournalFileHeader header;
+    std::memcpy(header.magic, JOURNAL_MAGIC, sizeof(header.magic));
+    header.version = JOURNAL_VERSION;
+    header.eventSize = sizeof(JournalEvent);
+    header.nodeCount = nodeCount;
+    header.segmentCount = segmentCount;
+    std::fwrite(&header, sizeof(header), 1, file);
+
+    running.store(true, std::memory_order_release);
+    writer = std::thread(&EventJournal::writerLoop, this);
+    return true;
+}
+
+void EventJournal::close() {
+    if (writer.joinable()) {
+        running.store(false, std::memory_order_release);
+        writer.join();
+    }
+    if (file) {
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+bool EventJournal::record(const JournalEvent& event) {
+    // Bounded MPSC queue: each slot's sequence tells producers whether it is free
+    uint64_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &slots[pos & mask];
+        uint64_t seq = slot->sequence.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            dropped.fetch_add(1, std::memory_order_relaxed);   // Ring full - never block the caller
+            pendingDrops.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot->event = event;
+    slot->event.sequence = pos;
+    slot->event.droppedBefore = pendingDrops.exchange(0, std::memory_order_relaxed);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+size_t EventJournal::drain(std::vector<JournalEvent>& batch) {
+    batch.clear();
+    while (true) {
+        Slot& slot = slots[dequeuePos & mask];
+        uint64_t seq = slot.sequence.load(std::memory_order_acquire);
+        if (seq != dequeuePos + 1) break;   // Not yet published
+
+        batch.push_back(slot.event);
+        slot.sequence.store(dequeuePos + mask + 1, std::memory_order_release);
+        dequeuePos++;
+    }
+    return batch.size();
+}
+
+void EventJournal::writerLoop() {
+    std::vector<JournalEvent> batch;
+    batch.reserve(mask + 1);
+
+    auto flushBatch = [this, &batch]() {
+        if (batch.empty()) return;
+        std::fwrite(batch.data(), sizeof(JournalEvent), batch.size(), file);
+        std::fflush(file);
+        written.fetch_add(batch.size(), std::memory_order_relaxed);
+    };
+
+    while (running.load(std::memory_order_acquire)) {
+        if (drain(batch) > 0) {
+            flushBatch();
+        } else {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+
+    // Final drain after close()
+    while (drain(batch) > 0) {
+        flushBatch();
+    }
+}
+
+bool EventJournal::readFile(const std::string& filename, JournalFileHeader& header, std::vector<JournalEvent>& events) {
+    std::FILE* in = std::fopen(filename.c_str(), "rb");
+    if (!in) return false;
+
+    bool valid = std::fread(&header, sizeof(header), 1, in) == 1 &&
+                 std::memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) == 0 &&
+                 header.version == JOURNAL_VERSION && header.eventSize == sizeof(JournalEvent);
+    if (valid) {
+        events.clear();
+        JournalEvent event;
+        while (std::fread(&event, sizeof(event), 1, in) == 1) {
+            events.push_back(event);
+        }
+    }
+    std::fclose(in);
+    return valid;
+}
+
+const char* EventJournal::typeName(JournalEventType type) {
+    switch (type) {
+        case JournalEventType::RESERVE: return "RESERVE";
+        case JournalEventType::RELEASE: return "RELEASE";
+        case JournalEventType::ENQUEUE: return "ENQUEUE";
+        case JournalEventType::DEQUEUE: return "DEQUEUE";
+        case JournalEventType::PROCESS_QUEUE: return "PROCESS_QUEUE";
+        case JournalEventType::UPDATE_QUEUES: return "UPDATE_QUEUES";
+        case JournalEventType::CLOCK: return "CLOCK";
+        case JournalEventType::REMOVE_VEHICLE: return "REMOVE_VEHICLE";
+        case JournalEventType::QUEUE_INFO: return "QUEUE_INFO";
+        case JournalEventType::QUEUE_CONFIG: return "QUEUE_CONFIG";
+        case JournalEventType::PLATOON_CONFIG: return "PLATOON_CONFIG";
+        case JournalEventType::ROLLBACK: return "ROLLBACK";
+        case JournalEventType::PATH_PLANNED: return "PATH_PLANNED";
+        case JournalEventType::PATH_FAILED: return "PATH_FAILED";
+    }
+    return "UNKNOWN";
+}
@@ -0,0 +1,89 @@
+#include "factory_layout.h"
+
+void createFactoryLayout(PathSystem& pathSystem) {
+    // Create the factory nodes with exact coordinates (scaled to window)
+    int node1 = pathSystem.addNode(70, 65);       // Node 1
+    int node2 = pathSystem.addNode(640, 65);      // Node 2
+    int node3 = pathSystem.addNode(985, 65);      // Node 3
+    int node4 = pathSystem.addNode(1860, 65);     // Node 4
+    int node5 = pathSystem.addNode(70, 470);      // Node 5
+    int node6 = pathSystem.addNode(640, 470);     // Node 6
+    int node7 = pathSystem.addNode(985, 320);     // Node 7
+    int node8 = pathSystem.addNode(1860, 320);    // Node 8
+    int node9 = pathSystem.addNode(985, 750);     // Node 9
+    int node10 = pathSystem.addNode(1860, 750);   // Node 10
+    int node11 = pathSystem.addNode(70, 1135);    // Node 11
+    int node12 = pathSystem.addNode(985, 1135);   // Node 12
+    int node13 = pathSystem.addNode(1860, 1135);  // Node 13
+
+    // Add waiting points at T-junctions
+    int wait2_left = pathSystem.addWaitingNode(640 - 150, 65);
+    int wait2_bottom = pathSystem.addWaitingNode(640, 65 + 150);
+    int wait2_3_merged = pathSystem.addWaitingNode(812, 65);
+
+    int wait3_east = pathSystem.addWaitingNode(985 + 150, 65);
+
+    int wait5_top = pathSystem.addWaitingNode(70, 470 - 150);
+    int wait5_right = pathSystem.addWaitingNode(70 + 150, 470);
+    int wait5_bottom = pathSystem.addWaitingNode(70, 470 + 150);
+
+    int wait3_7_merged = pathSystem.addWaitingNode(985, 192);
+    int wait7_east = pathSystem.addWaitingNode(985 + 150, 320);
+    int wait7_south_merged = pathSystem.addWaitingNode(985, 535);
+
+    int wait8_west = pathSystem.addWaitingNode(1860 - 150, 320);
+    int wait8_10_merged = pathSystem.addWaitingNode(1860, 535);
+
+    int wait9_east = pathSystem.addWaitingNode(985 + 150, 750);
+    int wait9_south_merged = pathSystem.addWaitingNode(985, 942);
+
+    int wait12_east = pathSystem.addWaitingNode(985 + 150, 1135);
+    int wait12_west = pathSystem.addWaitingNode(985 - 150, 1135);
+
+    int wait10_left = pathSystem.addWaitingNode(1860 - 150, 750);
+    int wait10_bottom = pathSystem.addWaitingNode(1860, 750 + 150);
+
+    // Connect main nodes
+    pathSystem.addSegment(node1, node2);
+    pathSystem.addSegment(node1, node5);
+    pathSystem.addSegment(node2, node3);
+    pathSystem.addSegment(node2, node6);
+    pathSystem.addSegment(node3, node4);
+    pathSystem.addSegment(node3, node7);
+    pathSystem.addSegment(node4, node8);
+    pathSystem.addSegment(node5, node6);
+    pathSystem.addSegment(node5, node11);
+    pathSystem.addSegment(node7, node8);
+    pathSystem.addSegment(node7, node9);
+    pathSystem.addSegment(node8, node10);
+    pathSystem.addSegment(node9, node10);
+    pathSystem.addSegment(node9, node12);
+    pathSystem.addSegment(node10, node13);
+    pathSystem.addSegment(node11, node12);
+    pathSystem.addSegment(node12, node13);
+
+    // Connect waiting points
+    pathSystem.addSegment(node2, wait2_left);
+    pathSystem.addSegment(node2, wait2_bottom);
+    pathSystem.addSegment(node2, wait2_3_merged);
+    pathSystem.addSegment(node3, wait2_3_merged);
+    pathSystem.addSegment(node3, wait3_east);
+    pathSystem.addSegment(node3, wait3_7_merged);
+    pathSystem.addSegment(node5, wait5_top);
+    pathSystem.addSegment(node5, wait5_right);
+    pathSystem.addSegment(node5, wait5_bottom);
+    pathSystem.addSegment(node7, wait3_7_merged);
+    pathSystem.addSegment(node7, wait7_east);
+    pathSystem.addSegment(node7, wait7_south_merged);
+    pathSystem.addSegment(node9, wait7_south_merged);
+    pathSystem.addSegment(node8, wait8_west);
+    pathSystem.addSegment(node8, wait8_10_merged);
+    pathSystem.addSegment(node9, wait9_east);
+    pathSystem.addSegment(node9, wait9_south_merged);
+    pathSystem.addSegment(node12, wait9_south_merged);
+    pathSystem.addSegment(node12, wait12_east);
+    pathSystem.addSegment(node12, wait12_west);
+    pathSystem.addSegment(node10, wait8_10_merged);
+    pathSystem.addSegment(node10, wait10_left);
+    pathSystem.addSegment(node10, wait10_bottom);
+}
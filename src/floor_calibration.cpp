@@ -0,0 +1,220 @@
+#include "floor_calibration.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+// Gaussian elimination with partial pivoting on the n x n system a x = b (b becomes x)
+bool solveLinearSystem(std::vector<double>& a, std::vector<double>& b, int n) {
+    for (int col = 0; col < n; col++) {
+        int pivot = col;
+        for (int row = col + 1; row < n; row++) {
+            if (std::fabs(a[row * n + col]) > std::fabs(a[pivot * n + col])) pivot = row;
+        }
+        if (std::fabs(a[pivot * n + col]) < 1e-12) return false;
+        if (pivot != col) {
+            for (int k = 0; k < n; k++) std::swap(a[col * n + k], a[pivot * n + k]);
+            std::swap(b[col], b[pivot]);
+        }
+        for (int row = col + 1; row < n; row++) {
+            double factor = a[row * n + col] / a[col * n + col];
+            for (int k = col; k < n; k++) a[row * n + k] -= factor * a[col * n + k];
+            b[row] -= factor * b[col];
+        }
+    }
+    for (int row = n - 1; row >= 0; row--) {
+        for (int k = row + 1; k < n; k++) b[row] -= a[row * n + k] * b[k];
+        b[row] /= a[row * n + row];
+    }
+    return true;
+}
+
+} // namespace
+
+FloorCalibration::FloorCalibration()
+    : centerX(0.0), centerY(0.0), norm(1.0), floorCenterX(0.0), floorCenterY(0.0), floorScale(1.0),
+      cropWidth(0), cropHeight(0), valid(false) {
+    std::fill(params, params + 10, 0.0);
+    params[0] = params[4] = 1.0;
+}
+
+bool FloorCalibration::evaluate(const double* p, double imageX, double imageY, double& floorX, double& floorY) const {
+    double dx = (imageX - centerX) / norm, dy = (imageY - centerY) / norm;
+    double r2 = dx * dx + dy * dy;
+    double factor = 1.0 + p[8] * r2 + p[9] * r2 * r2;
+    double ux = dx * factor, uy = dy * factor;
+    double w = p[6] * ux + p[7] * uy + 1.0;
+    if (w <= 1e-9) return false;
+    floorX = floorCenterX + floorScale * (p[0] * ux + p[1] * uy + p[2]) / w;
+    floorY = floorCenterY + floorScale * (p[3] * ux + p[4] * uy + p[5]) / w;
+    return true;
+}
+
+bool FloorCalibration::toFloor(float imageX, float imageY, float& floorX, float& floorY) const {
+    double x, y;
+    if (!evaluate(params, imageX, imageY, x, y)) return false;
+    floorX = static_cast<float>(x);
+    floorY = static_cast<float>(y);
+    return true;
+}
+
+double FloorCalibration::rmsError(const std::vector<CalibrationPair>& pairs) const {
+    if (pairs.empty()) return 0.0;
+    double sum = 0.0;
+    for (const CalibrationPair& pair : pairs) {
+        double x, y;
+        if (!evaluate(params, pair.imageX, pair.imageY, x, y)) return std::numeric_limits<double>::infinity();
+        sum += (x - pair.floorX) * (x - pair.floorX) + (y - pair.floorY) * (y - pair.floorY);
+    }
+    return std::sqrt(sum / pairs.size());
+}
+
+bool FloorCalibration::fit(const std::vector<CalibrationPair>& pairs, int width, int height) {
+    const int count = static_cast<int>(pairs.size());
+    if (count < 4 || width <= 0 || height <= 0) return false;
+
+    // Both spaces normalized to about unit size, which keeps the normal equations well conditioned
+    FloorCalibration model = *this;
+    model.cropWidth = width;
+    model.cropHeight = height;
+    model.centerX = width / 2.0;
+    model.centerY = height / 2.0;
+    model.norm = std::sqrt(model.centerX * model.centerX + model.centerY * model.centerY);
+    model.floorCenterX = model.floorCenterY = 0.0;
+    for (const CalibrationPair& pair : pairs) {
+        model.floorCenterX += pair.floorX / count;
+        model.floorCenterY += pair.floorY / count;
+    }
+    double spread = 0.0;
+    for (const CalibrationPair& pair : pairs) {
+        spread += std::hypot(pair.floorX - model.floorCenterX, pair.floorY - model.floorCenterY) / count;
+    }
+    model.floorScale = spread > 0.0 ? spread : 1.0;
+
+    std::vector<double> ux(count), uy(count), fx(count), fy(count);
+    for (int i = 0; i < count; i++) {
+        ux[i] = (pairs[i].imageX - model.centerX) / model.norm;
+        uy[i] = (pairs[i].imageY - model.centerY) / model.norm;
+        fx[i] = (pairs[i].floorX - model.floorCenterX) / model.floorScale;
+        fy[i] = (pairs[i].floorY - model.floorCenterY) / model.floorScale;
+    }
+
+    // Linear homography (DLT with h8 = 1), least squares through the normal equations
+    std::vector<double> ata(64, 0.0), atb(8, 0.0);
+    for (int i = 0; i < count; i++) {
+        const double rows[2][8] = {
+            {ux[i], uy[i], 1.0, 0.0, 0.0, 0.0, -ux[i] * fx[i], -uy[i] * fx[i]},
+            {0.0, 0.0, 0.0, ux[i], uy[i], 1.0, -ux[i] * fy[i], -uy[i] * fy[i]},
+        };
+        const double targets[2] = {fx[i], fy[i]};
+        for (int r = 0; r < 2; r++) {
+            for (int j = 0; j < 8; j++) {
+                atb[j] += rows[r][j] * targets[r];
+                for (int k = 0; k < 8; k++) ata[j * 8 + k] += rows[r][j] * rows[r][k];
+            }
+        }
+    }
+    if (!solveLinearSystem(ata, atb, 8)) return false;
+    std::copy(atb.begin(), atb.end(), model.params);
+    model.params[8] = model.params[9] = 0.0;
+
+    // Levenberg-Marquardt on all parameters (numeric Jacobian), distortion only with enough markers
+    const int parameterCount = count >= 6 ? 10 : 8;
+    auto residuals = [&](const double* p, std::vector<double>& r) {
+        double sum = 0.0;
+        for (int i = 0; i < count; i++) {
+            double x, y;
+            if (!model.evaluate(p, pairs[i].imageX, pairs[i].imageY, x, y)) return std::numeric_limits<double>::infinity();
+            r[2 * i] = (x - pairs[i].floorX) / model.floorScale;
+            r[2 * i + 1] = (y - pairs[i].floorY) / model.floorScale;
+            sum += r[2 * i] * r[2 * i] + r[2 * i + 1] * r[2 * i + 1];
+        }
+        return sum;
+    };
+    std::vector<double> r(2 * count), shifted(2 * count), jacobian(2 * count * parameterCount);
+    double cost = residuals(model.params, r);
+    if (!std::isfinite(cost)) return false;
+    double lambda = 1e-3;
+    bool converged = false;
+    for (int iteration = 0; iteration < 100 && !converged && cost > 1e-20; iteration++) {
+        for (int j = 0; j < parameterCount; j++) {
+            double p[10];
+            std::copy(model.params, model.params + 10, p);
+            const double step = 1e-7 * std::max(1.0, std::fabs(p[j]));
+            p[j] += step;
+            if (!std::isfinite(residuals(p, shifted))) return false;
+            for (int i = 0; i < 2 * count; i++) jacobian[i * parameterCount + j] = (shifted[i] - r[i]) / step;
+        }
+        std::vector<double> jtj(parameterCount * parameterCount, 0.0), jtr(parameterCount, 0.0);
+        for (int i = 0; i < 2 * count; i++) {
+            const double* row = &jacobian[i * parameterCount];
+            for (int j = 0; j < parameterCount; j++) {
+                jtr[j] -= row[j] * r[i];
+                for (int k = 0; k < parameterCount; k++) jtj[j * parameterCount + k] += row[j] * row[k];
+            }
+        }
+
+        bool improved = false;
+        while (!improved && lambda < 1e10) {
+            std::vector<double> a = jtj, delta = jtr;
+            for (int j = 0; j < parameterCount; j++) a[j * parameterCount + j] *= 1.0 + lambda;
+            if (solveLinearSystem(a, delta, parameterCount)) {
+                double p[10];
+                std::copy(model.params, model.params + 10, p);
+                for (int j = 0; j < parameterCount; j++) p[j] += delta[j];
+                double newCost = residuals(p, shifted);
+                if (newCost < cost) {
+                    improved = true;
+                    converged = cost - newCost < 1e-12 * cost;
+                    std::copy(p, p + 10, model.params);
+                    r.swap(shifted);
+                    cost = newCost;
+                    lambda = std::max(lambda / 10.0, 1e-12);
+                }
+            }
+            if (!improved) lambda *= 10.0;
+        }
+        if (!improved) break;
+    }
+
+    model.valid = true;
+    *this = model;
+    return true;
+}
+
+bool FloorCalibration::loadPairs(const std::string& path, std::vector<CalibrationPair>& pairs) {
+    std::ifstream file(path);
+    if (!file) return false;
+    pairs.clear();
+    std::string line;
+    while (std::getline(file, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream fields(line);
+        CalibrationPair pair;
+        if (fields >> pair.imageX >> pair.imageY >> pair.floorX >> pair.floorY) pairs.push_back(pair);
+    }
+    return true;
+}
+
+FloorRemapTable::FloorRemapTable() : cropWidth(0), cropHeight(0), columns(0), rows(0), inverseCell(1.0f) {}
+
+void FloorRemapTable::build(const FloorCalibration& calibration, int width, int height, int cellSize) {
+    cellSize = std::max(cellSize, 1);
+    cropWidth = std::max(width, 1);
+    cropHeight = std::max(height, 1);
+    columns = (cropWidth + cellSize - 1) / cellSize + 1;
+    rows = (cropHeight + cellSize - 1) / cellSize + 1;
+    inverseCell = 1.0f / cellSize;
+    table.resize(static_cast<size_t>(columns) * rows * 2);
+    float* out = table.data();
+    for (int row = 0; row < rows; row++) {
+        for (int column = 0; column < columns; column++, out += 2) {
+            if (!calibration.toFloor(static_cast<float>(column * cellSize), static_cast<float>(row * cellSize), out[0], out[1])) {
+                out[0] = out[1] = std::numeric_limits<float>::quiet_NaN();
+            }
+        }
+    }
+}
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "detection_ring.h"
+#include "headless_simulation.h"
+#include "traffic_benchmark.h"
+#include "detector_benchmark.h"
+#include "latency_trace.h"
+
+// Headless-Einstiegspunkt ohne raylib, Kamera und Python (baut unter Linux: build_headless.sh)
+
+namespace {
+
+bool parsePolicy(const std::string& name, SegmentManager::QueuePolicy& policy) {
+    if (name == "fifo") policy = SegmentManager::QueuePolicy::FIFO;
+    else if (name == "priority") policy = SegmentManager::QueuePolicy::PRIORITY;
+    else if (name == "shortest") policy = SegmentManager::QueuePolicy::SHORTEST_REMAINING_ROUTE;
+    else if (name == "aging") policy = SegmentManager::QueuePolicy::AGING;
+    else return false;
+    return true;
+}
+
+// Liest den Erkennungs-Ring eines laufenden Hauptprogramms bzw. Farberkennung.py mit
+int watchDetectionRing(float seconds) {
+    DetectionRingReader reader;
+    auto end = std::chrono::steady_clock::now() + std::chrono::duration<float>(seconds);
+    DetectionFrame frame;
+    while (std::chrono::steady_clock::now() < end) {
+        if (!reader.isOpen() && !reader.open()) {
+            // Der Ring entsteht mit dem ersten Schreiber
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            continue;
+        }
+        if (!reader.next(frame)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            continue;
+        }
+        auto now = std::chrono::steady_clock::now();
+        recordLatency(LatencyStage::DETECT, frame.captureTime, frame.publishTime);
+        recordLatency(LatencyStage::BRIDGE, frame.publishTime, now);
+        std::cout << "#" << frame.sequence << std::fixed << std::setprecision(1)
+                  << "  Erkennung " << std::chrono::duration<double, std::milli>(frame.publishTime - frame.captureTime).count() << " ms"
+                  << "  Ring " << std::chrono::duration<double, std::milli>(now - frame.publishTime).count() << " ms"
+                  << "  verloren " << reader.getDroppedFrames() << " ";
+        for (const DetectedObject& object : frame.objects) {
+            std::cout << " " << markerName(object.marker) << "(" << object.coordinates.x << "," << object.coordinates.y << ")";
+        }
+        std::cout << std::endl;
+    }
+    if (!reader.isOpen()) {
+        std::cerr << "Kein Erkennungs-Ring " << DETECTION_RING_NAME << " (läuft die Erkennung?)" << std::endl;
+        return 1;
+    }
+    // Aus dem Ring messbar: Bild gelesen -> Ring und Ring -> dieser Prozess
+    printLatencyReport(std::cout);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    HeadlessSimulationConfig config;
+    bool comparePolicies = false;
+    bool runBenchmarks = false;
+    std::string statisticsCsv;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--vehicles" && hasValue) {
+            config.vehicleCount = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--seconds" && hasValue) {
+            config.simulatedSeconds = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--dt" && hasValue) {
+            config.timeStep = std::max(0.001f, static_cast<float>(std::atof(argv[++i])));
+        } else if (arg == "--speed" && hasValue) {
+            config.vehicleSpeed = static_cast<float>(std::atof(argv[++i]));
+        } else if (arg == "--seed" && hasValue) {
+            config.seed = static_cast<unsigned>(std::atoi(argv[++i]));
+        } else if (arg == "--jobs" && hasValue) {
+            config.jobsPerVehicle = std::max(0, std::atoi(argv[++i]));
+        } else if ((arg == "--threads" || arg == "-t") && hasValue) {
+            config.threadCount = static_cast<unsigned>(std::max(0, std::atoi(argv[++i])));
+        } else if (arg == "--no-platooning") {
+            config.platoon.enabled = false;
+        } else if (arg == "--policy" && hasValue) {
+            if (!parsePolicy(argv[++i], config.queue.policy)) {
+                std::cerr << "Unbekannte Queue-Policy: " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--compare-policies") {
+            comparePolicies = true;
+        } else if (arg == "--benchmark" || arg == "-b") {
+            runBenchmarks = true;
+        } else if (arg == "--statistics-csv" && hasValue) {
+            statisticsCsv = argv[++i];
+        } else if (arg == "--detector-frames" && hasValue) {
+            // Aufgenommene Kamera-Frames (PPM) bis zur nächsten Option
+            std::vector<std::string> framePaths;
+            while (i + 1 < argc && argv[i + 1][0] != '-') framePaths.push_back(argv[++i]);
+            runMarkerPyramidBenchmark(framePaths);
+            return 0;
+        } else if (arg == "--watch-detections") {
+            // Optional: Dauer in Sekunden
+            float seconds = i + 1 < argc && argv[i + 1][0] != '-' ? static_cast<float>(std::atof(argv[++i])) : 3600.0f;
+            return watchDetectionRing(seconds);
+        } else if (arg == "--help" || arg == "-h") {
+            std::cout << "Verwendung: " << argv[0] << " [OPTIONEN]" << std::endl;
+            std::cout << "  --vehicles N         Anzahl Fahrzeuge (Standard: 8)" << std::endl;
+            std::cout << "  --seconds S          Simulierte Sekunden (Standard: 3600)" << std::endl;
+            std::cout << "  --dt S               Fester Zeitschritt (Standard: 0.05)" << std::endl;
+            std::cout << "  --speed V            Geschwindigkeit in px/s (Standard: 100)" << std::endl;
+            std::cout << "  --seed N             Zufallsstartwert für Fahrziele" << std::endl;
+            std::cout << "  --jobs N             Fahrten pro Fahrzeug, danach parken (0 = unbegrenzt)" << std::endl;
+            std::cout << "  --threads, -t N      Threads für das Flotten-Update (0 = alle Kerne)" << std::endl;
+            std::cout << "  --no-platooning      Keine Kolonnenfahrt (ein Fahrzeug pro Segment)" << std::endl;
+            std::cout << "  --policy NAME        Queue-Policy: fifo, priority, shortest, aging" << std::endl;
+            std::cout << "  --compare-policies   Alle Queue-Policies mit denselben Fahrzielen vergleichen" << std::endl;
+            std::cout << "  --benchmark, -b      Segment- und Flotten-Benchmarks" << std::endl;
+            std::cout << "  --statistics-csv DATEI  Segment-Statistik des Benchmarks (16 Fahrzeuge, Kolonne) als CSV schreiben" << std::endl;
+            std::cout << "  --detector-frames DATEI...  Pyramiden-Erkennung auf aufgenommenen Frames (PPM) messen" << std::endl;
+            std::cout << "  --watch-detections [SEK]  Erkennungs-Ring (Shared Memory) der laufenden Erkennung mitlesen, danach Latenz-Bericht" << std::endl;
+            std::cout << "  --help, -h           Diese Hilfe anzeigen" << std::endl;
+            return 0;
+        } else {
+            std::cerr << "Unbekannte Option: " << arg << " (--help)" << std::endl;
+            return 1;
+        }
+    }
+
+    if (runBenchmarks) {
+        runPlatooningComparison(statisticsCsv);
+        runQueuePolicyComparison();
+        runControllerQueuePolicyCheck();
+        runWorldSnapshotCheck();
+        runFleetUpdateBenchmark();
+        runDispatchBenchmark();
+        runCollisionBenchmark();
+        runMarkerBenchmark();
+        runMarkerClassLutBenchmark();
+        runMarkerLabellerBenchmark();
+        runMarkerContourCheck();
+        runMarkerDetectorBenchmark();
+        runMarkerTrackingBenchmark();
+        runMarkerPyramidBenchmark();
+        runFloorCalibrationBenchmark();
+        runLatencyTraceBenchmark();
+        return 0;
+    }
+
+    printHeadlessSimulationHeader();
+    if (comparePolicies) {
+        const std::pair<SegmentManager::QueuePolicy, const char*> policies[] = {
+            {SegmentManager::QueuePolicy::FIFO, "fifo"},
+            {SegmentManager::QueuePolicy::PRIORITY, "priority"},
+            {SegmentManager::QueuePolicy::SHORTEST_REMAINING_ROUTE, "shortest"},
+            {SegmentManager::QueuePolicy::AGING, "aging"},
+        };
+        for (const auto& policy : policies) {
+            config.queue.policy = policy.first;
+            printHeadlessSimulationResult(runHeadlessSimulation(
+                std::string(policy.second) + ", " + std::to_string(config.vehicleCount) + " vehicles", config));
+        }
+    } else {
+        printHeadlessSimulationResult(runHeadlessSimulation(
+            std::to_string(config.vehicleCount) + " vehicles", config));
+    }
+    return 0;
+}
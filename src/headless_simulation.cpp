@@ -0,0 +1,159 @@
+#include "headless_simulation.h"
+#include "factory_layout.h"
+#include "task_scheduler.h"
+#include "traffic_benchmark.h"
+#include "vehicle_controller.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace {
+
+struct TripState {
+    bool needsTrip;      // Arrived (or planning failed) and waiting for the next job
+    bool parked;         // All jobs done
+    double tripStartTime;
+    float tripWaitTime;
+    int jobsDone;
+};
+
+} // namespace
+
+HeadlessSimulationResult runHeadlessSimulation(const std::string& label, const HeadlessSimulationConfig& config) {
+    PathSystem pathSystem;
+    createFactoryLayout(pathSystem);
+
+    SegmentManager segmentManager(&pathSystem);
+    segmentManager.setPlatoonConfig(config.platoon);
+    segmentManager.setQueueConfig(config.queue);
+
+    TaskScheduler scheduler(config.threadCount);
+    VehicleController controller(&pathSystem, &segmentManager);
+    controller.setTaskScheduler(&scheduler);
+    controller.setSimulatedMovement(true);
+    controller.setLoggingEnabled(false);
+
+    std::mt19937 rng(config.seed);
+    std::mt19937 urgencyRng(config.seed + 1);   // Own stream: the targets stay the same as without urgency
+    std::uniform_real_distribution<float> urgency(0.0f, 1.0f);
+
+    // Spread the fleet over the main nodes, as the segment benchmark does
+    std::vector<int> mainNodes;
+    for (const auto& node : pathSystem.getNodes()) {
+        if (!node.isWaitingNode) mainNodes.push_back(node.nodeId);
+    }
+
+    std::vector<TripState> trips(config.vehicleCount + 1);   // Indexed by vehicle ID (IDs start at 1)
+    for (int i = 0; i < config.vehicleCount; i++) {
+        const PathNode* start = pathSystem.getNode(mainNodes[i % mainNodes.size()]);
+        int vehicleId = controller.addVehicle(start->position);
+
+        Auto* vehicle = controller.getVehicle(vehicleId);
+        vehicle->currentNodeId = start->nodeId;
+        vehicle->realWorldCoordinates = start->position;
+        vehicle->speed = config.vehicleSpeed;
+        trips[vehicleId] = {true, false, 0.0f, 0.0f, 0};
+    }
+
+    int completedTrips = 0;
+    double totalTripTime = 0.0;
+    double totalWaitTime = 0.0;
+    float makespan = config.simulatedSeconds;
+    int parkedVehicles = 0;
+    std::vector<int> needsTrip;
+    int collisionRisks = 0;
+    std::set<std::pair<int, int>> riskPairs, previousRiskPairs;
+
+    auto wallStart = std::chrono::steady_clock::now();
+    const int steps = static_cast<int>(config.simulatedSeconds / config.timeStep);
+    int step = 0;
+    for (; step < steps; step++) {
+        double now = segmentManager.getCurrentTime();
+
+        // Trip bookkeeping, then plan the next job of every vehicle that needs one
+        needsTrip.clear();
+        for (const Auto& vehicle : controller.getAllVehicles()) {
+            TripState& trip = trips[vehicle.vehicleId];
+            if (trip.parked) continue;
+
+            if (vehicle.state == VehicleState::WAITING) {
+                trip.tripWaitTime += config.timeStep;
+            } else if (vehicle.state == VehicleState::ARRIVED && !trip.needsTrip) {
+                completedTrips++;
+                totalTripTime += now - trip.tripStartTime;
+                totalWaitTime += trip.tripWaitTime;
+                trip.jobsDone++;
+                trip.needsTrip = true;
+
+                if (config.jobsPerVehicle > 0 && trip.jobsDone >= config.jobsPerVehicle) {
+                    trip.parked = true;   // The last node stays free
+                    parkedVehicles++;
+                    continue;
+                }
+            }
+            if (trip.needsTrip) needsTrip.push_back(vehicle.vehicleId);
+        }
+
+        if (config.jobsPerVehicle > 0 && parkedVehicles == config.vehicleCount) {
+            makespan = static_cast<float>(now);
+            break;
+        }
+
+        for (int vehicleId : needsTrip) {
+            int target = pickRandomTarget(pathSystem, controller.getVehicle(vehicleId)->currentNodeId, rng);
+            if (target != -1 && controller.setVehicleTargetNode(vehicleId, target)) {
+                controller.setVehicleJobUrgency(vehicleId, urgency(urgencyRng));
+                trips[vehicleId].needsTrip = false;
+                trips[vehicleId].tripStartTime = now;
+                trips[vehicleId].tripWaitTime = 0.0f;
+            }
+        }
+
+        controller.updateVehicles(config.timeStep);
+
+        // Count each pair once per episode in which it stays at risk
+        riskPairs.clear();
+        for (const CollisionRisk& risk : controller.detectCollisionRisks()) {
+            std::pair<int, int> pair(risk.vehicleId1, risk.vehicleId2);
+            if (previousRiskPairs.count(pair) == 0) collisionRisks++;
+            riskPairs.insert(pair);
+        }
+        riskPairs.swap(previousRiskPairs);
+    }
+    double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+    float simulated = step * config.timeStep;
+
+    HeadlessSimulationResult result;
+    result.label = label;
+    result.completedTrips = completedTrips;
+    result.tripsPerMinute = simulated > 0.0f ? completedTrips / (simulated / 60.0f) : 0.0f;
+    result.averageTripTime = completedTrips > 0 ? static_cast<float>(totalTripTime / completedTrips) : 0.0f;
+    result.averageWaitPerTrip = completedTrips > 0 ? static_cast<float>(totalWaitTime / completedTrips) : 0.0f;
+    result.makespan = makespan;
+    result.collisionRisks = collisionRisks;
+    result.simulatedSeconds = simulated;
+    result.wallSeconds = wallSeconds;
+    result.realTimeFactor = wallSeconds > 0.0 ? simulated / wallSeconds : 0.0;
+    return result;
+}
+
+void printHeadlessSimulationHeader() {
+    std::cout << std::left << std::setw(28) << "Lauf" << std::right
+              << std::setw(8) << "Trips" << std::setw(12) << "Trips/min"
+              << std::setw(12) << "Trip [s]" << std::setw(12) << "Wait [s]"
+              << std::setw(12) << "Makespan" << std::setw(10) << "Risiken" << std::setw(13) << "Echtzeit" << "\n";
+}
+
+void printHeadlessSimulationResult(const HeadlessSimulationResult& result) {
+    std::cout << std::left << std::setw(28) << result.label << std::right << std::fixed << std::setprecision(1)
+              << std::setw(8) << result.completedTrips
+              << std::setw(12) << result.tripsPerMinute
+              << std::setw(12) << result.averageTripTime
+              << std::setw(12) << result.averageWaitPerTrip
+              << std::setw(12) << result.makespan
+              << std::setw(10) << result.collisionRisks
+              << std::setw(12) << std::setprecision(0) << result.realTimeFactor << "x\n";
+}
@@ -0,0 +1,307 @@
+#include "job_dispatcher.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <map>
+#include <unordered_set>
+
+namespace {
+
+const float FALLBACK_SPEED = 100.0f;       // px per second, for vehicles without speed
+// Transportation problem: supply[r] identical vehicles per row group, demand[c] identical
+// jobs per pickup column, cost row-major (infinite = no route). Returns the flow matrix of
+// a minimum-cost assignment of min(total supply, total demand) pairs. Hungarian method in
+// its capacitated form: successive shortest augmenting paths with node potentials, each
+// path found by a dense Dijkstra over source, rows, columns and sink.
+std::vector<int> solveTransportation(const std::vector<double>& cost, const std::vector<int>& supply,
+                                     const std::vector<int>& demand) {
+    const int rows = static_cast<int>(supply.size());
+    const int cols = static_cast<int>(demand.size());
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    // Node numbering: 0 = source, 1..rows, rows+1..rows+cols, sink
+    const int source = 0;
+    const int sink = rows + cols + 1;
+    const int nodeCount = rows + cols + 2;
+    auto columnNode = [rows](int c) { return rows + 1 + c; };
+
+    std::vector<int> flow(static_cast<size_t>(rows) * cols, 0);
+    std::vector<int> supplyLeft = supply, demandLeft = demand;
+    std::vector<double> potential(nodeCount, 0.0), distance(nodeCount);
+    std::vector<int> parent(nodeCount);
+    std::vector<char> done(nodeCount);
+
+    while (true) {
+        std::fill(distance.begin(), distance.end(), infinity);
+        std::fill(done.begin(), done.end(), 0);
+        distance[source] = 0.0;
+
+        for (int step = 0; step < nodeCount; step++) {
+            int node = -1;
+            for (int n = 0; n < nodeCount; n++) {
+                if (!done[n] && distance[n] < infinity && (node == -1 || distance[n] < distance[node])) node = n;
+            }
+            if (node == -1 || node == sink) break;
+            done[node] = 1;
+
+            auto relax = [&](int to, double edgeCost) {
+                double candidate = distance[node] + edgeCost + potential[node] - potential[to];
+                if (candidate < distance[to]) {
+                    distance[to] = candidate;
+                    parent[to] = node;
+                }
+            };
+            if (node == source) {
+                for (int r = 0; r < rows; r++) {
+                    if (supplyLeft[r] > 0) relax(1 + r, 0.0);
+                }
+            } else if (node <= rows) {
+                const int r = node - 1;
+                for (int c = 0; c < cols; c++) {
+                    double edgeCost = cost[static_cast<size_t>(r) * cols + c];
+                    if (edgeCost < infinity) relax(columnNode(c), edgeCost);
+                }
+            } else {
+                const int c = node - rows - 1;
+                if (demandLeft[c] > 0) relax(sink, 0.0);
+                for (int r = 0; r < rows; r++) {
+                    if (flow[static_cast<size_t>(r) * cols + c] > 0) relax(1 + r, -cost[static_cast<size_t>(r) * cols + c]);
+                }
+            }
+        }
+        if (distance[sink] == infinity) break;
+
+        // Reduced costs stay non-negative with potentials capped at the sink distance
+        for (int n = 0; n < nodeCount; n++) {
+            potential[n] += std::min(distance[n], distance[sink]);
+        }
+
+        // Push as many pairs as the path allows
+        int amount = std::numeric_limits<int>::max();
+        for (int node = sink; node != source; node = parent[node]) {
+            int from = parent[node];
+            if (from == source) amount = std::min(amount, supplyLeft[node - 1]);
+            else if (node == sink) amount = std::min(amount, demandLeft[from - rows - 1]);
+            else if (from > rows) amount = std::min(amount, flow[static_cast<size_t>(node - 1) * cols + (from - rows - 1)]);
+        }
+        for (int node = sink; node != source; node = parent[node]) {
+            int from = parent[node];
+            if (from == source) supplyLeft[node - 1] -= amount;
+            else if (node == sink) demandLeft[from - rows - 1] -= amount;
+            else if (from <= rows) flow[static_cast<size_t>(from - 1) * cols + (node - rows - 1)] += amount;
+            else flow[static_cast<size_t>(node - 1) * cols + (from - rows - 1)] -= amount;
+        }
+    }
+    return flow;
+}
+
+} // namespace
+
+JobDispatcher::JobDispatcher(PathSystem* pathSys, VehicleController* vehicleCtrl)
+    : pathSystem(pathSys), vehicleController(vehicleCtrl), scheduler(nullptr), maxBatchJobs(256),
+      nextJobId(1), completedJobs(0), lastDispatchMicros(0.0) {
+    // Arrivals and route changes come in as events, collected until the next update()
+    VehicleEventBus& events = vehicleController->getEventBus();
+    completedSubscription = events.subscribe<RouteCompletedEvent>([this](const std::vector<RouteCompletedEvent>& batch) {
+        completedRoutes.insert(completedRoutes.end(), batch.begin(), batch.end());
+    });
+    replannedSubscription = events.subscribe<RouteReplannedEvent>([this](const std::vector<RouteReplannedEvent>& batch) {
+        replannedRoutes.insert(replannedRoutes.end(), batch.begin(), batch.end());
+    });
+}
+
+JobDispatcher::~JobDispatcher() {
+    vehicleController->getEventBus().unsubscribe(completedSubscription);
+    vehicleController->getEventBus().unsubscribe(replannedSubscription);
+}
+
+int JobDispatcher::submitJob(int pickupNodeId, int dropoffNodeId, double now, float urgency) {
+    if (!pathSystem->getNode(pickupNodeId) || !pathSystem->getNode(dropoffNodeId)) return -1;
+
+    TransportJob job;
+    job.jobId = nextJobId++;
+    job.pickupNodeId = pickupNodeId;
+    job.dropoffNodeId = dropoffNodeId;
+    job.createdTime = now;
+    job.urgency = urgency;
+    openJobs.push_back(job);
+    return job.jobId;
+}
+
+bool JobDispatcher::isIdle(const Auto& vehicle) const {
+    if (isVehicleBusy(vehicle.vehicleId) || vehicleController->hasPendingRoute(vehicle.vehicleId)) return false;
+    return vehicle.state == VehicleState::ARRIVED || vehicle.currentNodePath.empty();
+}
+
+int JobDispatcher::startNodeOf(const Auto& vehicle) const {
+    if (pathSystem->getNode(vehicle.currentNodeId)) return vehicle.currentNodeId;
+    return pathSystem->findNearestNode(vehicle.realWorldCoordinates, 500.0f);
+}
+
+std::vector<JobAssignment> JobDispatcher::update() {
+    // Read-only lookups: the mutable getVehicle() would mark every busy vehicle dirty each frame
+    const VehicleController& controller = *vehicleController;
+    for (auto it = activeJobs.begin(); it != activeJobs.end();) {
+        ActiveJob& active = it->second;
+        if (!controller.getVehicle(it->first)) {
+            openJobs.push_front(active.job);   // Vehicle removed: job goes back to the front
+            it = activeJobs.erase(it);
+            continue;
+        }
+
+        // Route still being planned; the vehicle stands on its old route until then
+        if (active.route.valid() && active.route.wait_for(std::chrono::seconds(0)) == std::future_status::ready &&
+            !active.route.get()) {
+            if (active.loaded) {
+                active.route = vehicleController->requestVehicleTarget(it->first, active.job.dropoffNodeId);
+            } else {
+                openJobs.push_front(active.job);   // Pickup unreachable: free the vehicle
+                vehicleController->setVehicleJobUrgency(it->first, 0.0f);
+                it = activeJobs.erase(it);
+                continue;
+            }
+        }
+        ++it;
+    }
+
+    // A committed route to somewhere else than the current stop (e.g. a target set by
+    // hand) takes the vehicle off its job; detours keep the stop
+    for (const RouteReplannedEvent& event : replannedRoutes) {
+        auto it = activeJobs.find(event.vehicleId);
+        if (it == activeJobs.end() || it->second.route.valid() || event.targetNodeId == currentStop(it->second)) continue;
+        openJobs.push_front(it->second.job);
+        vehicleController->setVehicleJobUrgency(event.vehicleId, 0.0f);
+        activeJobs.erase(it);
+    }
+    replannedRoutes.clear();
+
+    // Stops reached since the last update: continue to the dropoff, or complete the job
+    for (const RouteCompletedEvent& event : completedRoutes) {
+        auto it = activeJobs.find(event.vehicleId);
+        if (it == activeJobs.end() || it->second.route.valid() || event.targetNodeId != currentStop(it->second)) continue;
+
+        ActiveJob& active = it->second;
+        if (!active.loaded) {
+            active.loaded = true;
+            active.route = vehicleController->requestVehicleTarget(it->first, active.job.dropoffNodeId);
+        } else {
+            completedJobs++;
+            vehicleController->setVehicleJobUrgency(event.vehicleId, 0.0f);
+            activeJobs.erase(it);
+        }
+    }
+    completedRoutes.clear();
+
+    return dispatch();
+}
+
+std::vector<JobAssignment> JobDispatcher::computeAssignments() const {
+    std::vector<JobAssignment> assignments;
+
+    std::vector<const Auto*> idleVehicles;
+    std::vector<int> startNodes;
+    for (const Auto& vehicle : vehicleController->getAllVehicles()) {
+        if (!isIdle(vehicle)) continue;
+        int startNodeId = startNodeOf(vehicle);
+        if (startNodeId == -1) continue;
+        idleVehicles.push_back(&vehicle);
+        startNodes.push_back(startNodeId);
+    }
+    const size_t jobCount = std::min(openJobs.size(), maxBatchJobs);
+    if (idleVehicles.empty() || jobCount == 0) return assignments;
+
+    // Vehicles on the same node with the same speed are interchangeable, and so are jobs
+    // with the same pickup: the assignment shrinks to groups x pickup nodes
+    std::map<std::pair<int, float>, int> groupIndex;
+    std::vector<int> groupStart;
+    std::vector<float> groupSpeed;
+    std::vector<std::vector<const Auto*>> groupVehicles;
+    for (size_t i = 0; i < idleVehicles.size(); i++) {
+        float speed = idleVehicles[i]->speed > 0.0f ? idleVehicles[i]->speed : FALLBACK_SPEED;
+        auto inserted = groupIndex.emplace(std::make_pair(startNodes[i], speed), static_cast<int>(groupStart.size()));
+        if (inserted.second) {
+            groupStart.push_back(startNodes[i]);
+            groupSpeed.push_back(speed);
+            groupVehicles.emplace_back();
+        }
+        groupVehicles[inserted.first->second].push_back(idleVehicles[i]);
+    }
+
+    std::map<int, int> pickupIndex;
+    std::vector<int> pickupNodes;
+    std::vector<std::vector<const TransportJob*>> pickupJobs;   // Oldest first
+    for (size_t j = 0; j < jobCount; j++) {
+        auto inserted = pickupIndex.emplace(openJobs[j].pickupNodeId, static_cast<int>(pickupNodes.size()));
+        if (inserted.second) {
+            pickupNodes.push_back(openJobs[j].pickupNodeId);
+            pickupJobs.emplace_back();
+        }
+        pickupJobs[inserted.first->second].push_back(&openJobs[j]);
+    }
+
+    // Route lengths from every group's start node: one Dijkstra each, in parallel
+    const size_t rows = groupStart.size();
+    const size_t cols = pickupNodes.size();
+    std::vector<double> cost(rows * cols);
+    auto computeRows = [&](size_t begin, size_t end) {
+        for (size_t r = begin; r < end; r++) {
+            std::vector<float> distances = pathSystem->findDistancesFrom(groupStart[r]);
+            for (size_t c = 0; c < cols; c++) {
+                int pickupNodeId = pickupNodes[c];
+                bool reachable = pickupNodeId < static_cast<int>(distances.size()) && std::isfinite(distances[pickupNodeId]);
+                cost[r * cols + c] = reachable ? distances[pickupNodeId] / groupSpeed[r]
+                                               : std::numeric_limits<double>::infinity();
+            }
+        }
+    };
+    if (scheduler) scheduler->parallelFor(rows, 1, computeRows);
+    else computeRows(0, rows);
+
+    std::vector<int> supply(rows), demand(cols);
+    for (size_t r = 0; r < rows; r++) supply[r] = static_cast<int>(groupVehicles[r].size());
+    for (size_t c = 0; c < cols; c++) demand[c] = static_cast<int>(pickupJobs[c].size());
+    std::vector<int> flow = solveTransportation(cost, supply, demand);
+
+    // Back to single pairs: vehicles in dense order, jobs oldest first per pickup
+    std::vector<size_t> nextJob(cols, 0);
+    for (size_t r = 0; r < rows; r++) {
+        size_t nextVehicle = 0;
+        for (size_t c = 0; c < cols; c++) {
+            for (int k = 0; k < flow[r * cols + c]; k++) {
+                assignments.push_back({groupVehicles[r][nextVehicle++]->vehicleId, pickupJobs[c][nextJob[c]++]->jobId,
+                                       static_cast<float>(cost[r * cols + c])});
+            }
+        }
+    }
+    return assignments;
+}
+
+std::vector<JobAssignment> JobDispatcher::dispatch() {
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<JobAssignment> assignments = computeAssignments();
+    std::unordered_set<int> assignedJobs;
+    for (const JobAssignment& assignment : assignments) {
+        auto job = std::find_if(openJobs.begin(), openJobs.end(),
+                                [&assignment](const TransportJob& open) { return open.jobId == assignment.jobId; });
+        if (job == openJobs.end()) continue;
+
+        // Planned in the background if the controller has a RoutePlanner; a job whose
+        // pickup turns out unreachable goes back to the open queue in update()
+        ActiveJob& active = activeJobs[assignment.vehicleId];
+        active.job = *job;
+        active.loaded = false;
+        active.route = vehicleController->requestVehicleTarget(assignment.vehicleId, job->pickupNodeId);
+        vehicleController->setVehicleJobUrgency(assignment.vehicleId, job->urgency);
+        assignedJobs.insert(assignment.jobId);
+    }
+    if (!assignedJobs.empty()) {
+        openJobs.erase(std::remove_if(openJobs.begin(), openJobs.end(),
+                                      [&assignedJobs](const TransportJob& open) { return assignedJobs.count(open.jobId) != 0; }),
+                       openJobs.end());
+    }
+
+    lastDispatchMicros = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6;
+    return assignments;
+}
@@ -0,0 +1,132 @@
+#include "journal_replay.h"
+#include "factory_layout.h"
+#include <iostream>
+#include <iomanip>
+
+JournalReplayResult replayJournal(const std::vector<JournalEvent>& events, SegmentManager& manager, double untilTime) {
+    JournalReplayResult result;
+
+    for (const JournalEvent& event : events) {
+        if (event.time > untilTime) break;
+        result.reachedTime = event.time;
+        result.droppedEvents += event.droppedBefore;
+
+        if (event.flags & JOURNAL_DERIVED) {
+            result.derivedSkipped++;
+            continue;
+        }
+
+        switch (static_cast<JournalEventType>(event.type)) {
+            case JournalEventType::RESERVE: {
+                bool reserved = manager.reserveSegment(event.segmentId, event.vehicleId, event.nodeId);
+                bool recorded = (event.flags & JOURNAL_FAILED) == 0;
+                if (reserved != recorded) result.mismatches++;
+                break;
+            }
+            case JournalEventType::RELEASE:
+                manager.releaseSegment(event.segmentId, event.vehicleId);
+                break;
+            case JournalEventType::ENQUEUE:
+                manager.addToQueue(event.segmentId, event.vehicleId, event.nodeId);
+                break;
+            case JournalEventType::DEQUEUE:
+                manager.removeFromQueue(event.segmentId, event.vehicleId);
+                break;
+            case JournalEventType::PROCESS_QUEUE:
+                manager.processQueue(event.segmentId);
+                break;
+            case JournalEventType::UPDATE_QUEUES:
+                manager.updateQueues();
+                break;
+            case JournalEventType::CLOCK:
+                manager.update(event.value);
+                break;
+            case JournalEventType::REMOVE_VEHICLE:
+                manager.removeVehicle(event.vehicleId);
+                break;
+            case JournalEventType::QUEUE_INFO: {
+                SegmentManager::VehicleQueueInfo info;
+                info.urgency = event.value;
+                info.remainingRoute = event.value2;
+                manager.setVehicleQueueInfo(event.vehicleId, info);
+                break;
+            }
+            case JournalEventType::QUEUE_CONFIG: {
+                SegmentManager::QueueConfig config;
+                config.policy = static_cast<SegmentManager::QueuePolicy>(event.nodeId);
+                config.agingRate = event.value;
+                manager.setQueueConfig(config);
+                break;
+            }
+            case JournalEventType::PLATOON_CONFIG: {
+                SegmentManager::PlatoonConfig config;
+                config.enabled = event.nodeId != 0;
+                config.vehicleSpacing = event.value;
+                config.minHeadwayTime = event.value2;
+                manager.setPlatoonConfig(config);
+                break;
+            }
+            case JournalEventType::ROLLBACK:
+                result.rollbacks++;
+                break;
+            case JournalEventType::PATH_PLANNED:
+            case JournalEventType::PATH_FAILED:
+                break;   // Planner information only
+        }
+        result.applied++;
+    }
+    return result;
+}
+
+void printJournalEvents(const std::vector<JournalEvent>& events, double fromTime, double untilTime, std::ostream& out) {
+    for (const JournalEvent& event : events) {
+        if (event.time < fromTime) continue;
+        if (event.time > untilTime) break;
+
+        out << std::fixed << std::setprecision(2) << std::setw(9) << event.time << "  #" << event.sequence << "  "
+            << EventJournal::typeName(static_cast<JournalEventType>(event.type));
+        if (event.vehicleId != -1) out << " vehicle=" << event.vehicleId;
+        if (event.segmentId != -1) out << " segment=" << event.segmentId;
+        if (event.nodeId != -1) out << " node=" << event.nodeId;
+        if (event.value != 0.0f || event.value2 != 0.0f) out << " value=" << event.value << "/" << event.value2;
+        if (event.flags & JOURNAL_FAILED) out << " FAILED";
+        if (event.flags & JOURNAL_DERIVED) out << " (derived)";
+        if (event.droppedBefore > 0) out << " [" << event.droppedBefore << " lost before]";
+        out << "\n";
+    }
+}
+
+int runJournalReplay(const std::string& filename, double untilTime, bool listEvents) {
+    JournalFileHeader header;
+    std::vector<JournalEvent> events;
+    if (!EventJournal::readFile(filename, header, events)) {
+        std::cerr << "Journal " << filename << " kann nicht gelesen werden" << std::endl;
+        return 1;
+    }
+
+    PathSystem pathSystem;
+    createFactoryLayout(pathSystem);
+    if (header.nodeCount != pathSystem.getNodeCount() || header.segmentCount != pathSystem.getSegmentCount()) {
+        std::cerr << "Journal wurde auf einem anderen Layout aufgezeichnet ("
+                  << header.nodeCount << " Knoten, " << header.segmentCount << " Segmente)" << std::endl;
+        return 1;
+    }
+
+    SegmentManager manager(&pathSystem);
+    JournalReplayResult result = replayJournal(events, manager, untilTime);
+
+    std::cout << "Replay " << filename << ": " << events.size() << " events, t=" << result.reachedTime
+              << " s, " << result.applied << " applied, " << result.derivedSkipped << " derived, "
+              << result.mismatches << " mismatches" << std::endl;
+    if (result.droppedEvents > 0) {
+        std::cout << "Warnung: " << result.droppedEvents << " Events beim Aufzeichnen verloren (Ringpuffer voll)" << std::endl;
+    }
+    if (result.rollbacks > 0) {
+        std::cout << "Warnung: " << result.rollbacks << " Rollback(s) im Journal - Zustand danach nicht exakt" << std::endl;
+    }
+    if (listEvents) {
+        printJournalEvents(events, result.reachedTime - 1.0f, result.reachedTime, std::cout);
+    }
+    manager.printSegmentStatus();
+    return result.mismatches == 0 ? 0 : 2;
+}
@@ -0,0 +1,104 @@
+#include "latency_trace.h"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <ostream>
+
+namespace {
+
+int highestBit(uint64_t value) {
+#if defined(__GNUC__)
+    return 63 - __builtin_clzll(value);
+#else
+    int bit = 63;
+    while (!(value >> bit)) bit--;
+    return bit;
+#endif
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram() : maximum(0) {
+    for (std::atomic<uint64_t>& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+}
+
+int LatencyHistogram::bucketIndex(uint64_t nanos) {
+    if (nanos < 2 * SUB_BUCKET_HALF) return static_cast<int>(nanos);
+    int shift = highestBit(nanos) - 5;                    // nanos >> shift is in [32, 64)
+    if (shift > MAX_SHIFT) return BUCKET_COUNT - 1;
+    return SUB_BUCKET_HALF * shift + static_cast<int>(nanos >> shift);
+}
+
+int64_t LatencyHistogram::bucketMiddle(int index) {
+    if (index < 2 * SUB_BUCKET_HALF) return index;
+    int shift = index / SUB_BUCKET_HALF - 1;
+    int64_t lower = static_cast<int64_t>(index - SUB_BUCKET_HALF * shift) << shift;
+    return lower + (int64_t(1) << shift) / 2;
+}
+
+void LatencyHistogram::record(int64_t nanos) {
+    if (nanos < 0) nanos = 0;                             // Clock readings from two threads, never negative
+    buckets[bucketIndex(static_cast<uint64_t>(nanos))].fetch_add(1, std::memory_order_relaxed);
+    int64_t previous = maximum.load(std::memory_order_relaxed);
+    while (nanos > previous && !maximum.compare_exchange_weak(previous, nanos, std::memory_order_relaxed)) {
+    }
+}
+
+uint64_t LatencyHistogram::getCount() const {
+    uint64_t total = 0;
+    for (const std::atomic<uint64_t>& bucket : buckets) total += bucket.load(std::memory_order_relaxed);
+    return total;
+}
+
+int64_t LatencyHistogram::percentile(double percent) const {
+    uint64_t total = getCount();
+    if (total == 0) return 0;
+    uint64_t rank = static_cast<uint64_t>(std::ceil(std::min(std::max(percent, 0.0), 100.0) / 100.0 * total));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (int index = 0; index < BUCKET_COUNT; index++) {
+        seen += buckets[index].load(std::memory_order_relaxed);
+        if (seen >= rank) return std::min(bucketMiddle(index), getMax());
+    }
+    return getMax();                                      // Values recorded while reading
+}
+
+void LatencyHistogram::reset() {
+    for (std::atomic<uint64_t>& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+static LatencyHistogram stage_histograms[static_cast<int>(LatencyStage::COUNT)];
+
+const char* latencyStageName(LatencyStage stage) {
+    switch (stage) {
+        case LatencyStage::CAPTURE: return "capture";
+        case LatencyStage::DETECT: return "detect";
+        case LatencyStage::BRIDGE: return "bridge";
+        case LatencyStage::PAIRING: return "pairing";
+        case LatencyStage::PLANNING: return "planning";
+        case LatencyStage::COMMAND_WRITE: return "command write";
+        case LatencyStage::RENDER: return "render";
+        case LatencyStage::CAMERA_TO_COMMAND: return "camera -> command";
+        default: return "?";
+    }
+}
+
+LatencyHistogram& latencyHistogram(LatencyStage stage) {
+    return stage_histograms[static_cast<int>(stage)];
+}
+
+void printLatencyReport(std::ostream& out) {
+    out << "=== Latency per stage ===\n";
+    out << std::left << std::setw(20) << "Stage" << std::right << std::setw(10) << "Frames"
+        << std::setw(12) << "p50 [ms]" << std::setw(12) << "p99 [ms]" << std::setw(12) << "max [ms]" << "\n";
+    for (int i = 0; i < static_cast<int>(LatencyStage::COUNT); i++) {
+        const LatencyHistogram& histogram = stage_histograms[i];
+        if (histogram.getCount() == 0) continue;
+        out << std::left << std::setw(20) << latencyStageName(static_cast<LatencyStage>(i)) << std::right
+            << std::setw(10) << histogram.getCount() << std::fixed << std::setprecision(3)
+            << std::setw(12) << histogram.percentile(50.0) / 1e6 << std::setw(12) << histogram.percentile(99.0) / 1e6
+            << std::setw(12) << histogram.getMax() / 1e6 << "\n";
+    }
+    out << std::flush;
+}
@@ -1,12 +1,19 @@
 #include <iostream>
 #include <vector>
 #include <mutex>
+#include <algorithm>
+#include <cstdlib>
 #include <chrono>
 #include "raylib.h"
 #include "car_simulation.h"
 #include "py_runner.h"
 #include "test_window.h"
 #include "renderer.h"
+#include "traffic_benchmark.h"
+#include "detector_benchmark.h"
+#include "journal_replay.h"
+#include "headless_simulation.h"
+#include "latency_trace.h"
 
 // Dummy definitions for placeholders in the original code that are not provided
 // In a real scenario, these would be defined in appropriate header files.
@@ -29,6 +36,9 @@ int main(int argc, char* argv[]) {
     // Command-line Parameter parsen
     bool auto_fullscreen = false;
     bool auto_fullscreen_monitor2 = false;
+    unsigned worker_threads = 0;   // 0 = alle Hardware-Threads
+    bool run_benchmarks = false;
+    std::string statistics_csv;    // Leer = keine Segment-Statistik schreiben
 
     for (int i = 1; i < argc; i++) {
         std::string arg = argv[i];
@@ -36,15 +46,74 @@ int main(int argc, char* argv[]) {
             auto_fullscreen = true;
         } else if (arg == "--monitor2" || arg == "-m2") {
             auto_fullscreen_monitor2 = true;
+        } else if ((arg == "--threads" || arg == "-t") && i + 1 < argc) {
+            // Threads für das parallele Flotten-Update (1 = alles im Hauptthread)
+            worker_threads = static_cast<unsigned>(std::max(1, std::atoi(argv[++i])));
+        } else if (arg == "--native-detector" || arg == "-n") {
+            // Farberkennung im C++-MarkerDetector, Python liefert nur noch Kamerabild und Trackbars
+            set_detection_backend(DetectionBackend::NATIVE);
+        } else if (arg == "--roi-tracking") {
+            // Wie --native-detector, zwischen vollen Durchläufen nur um die vorhergesagten Marker suchen
+            set_detection_backend(DetectionBackend::NATIVE_TRACKING);
+        } else if (arg == "--pyramid" && i + 1 < argc) {
+            // Volle Durchläufe der nativen Erkennung erst auf jedem N-ten Pixel (4 oder 8)
+            set_native_pyramid_scale(std::atoi(argv[++i]));
+        } else if (arg == "--benchmark" || arg == "-b") {
+            // Headless Durchsatz-Vergleich auf dem Fabrik-Layout, kein Fenster
+            run_benchmarks = true;
+        } else if (arg == "--statistics-csv" && i + 1 < argc) {
+            statistics_csv = argv[++i];
+        } else if (arg == "--headless") {
+            // Flotte ohne Fenster und Kamera mit festem Zeitschritt simulieren: --headless [sekunden]
+            HeadlessSimulationConfig config;
+            config.threadCount = worker_threads;
+            if (i + 1 < argc && argv[i + 1][0] != '-') config.simulatedSeconds = std::stof(argv[++i]);
+            printHeadlessSimulationHeader();
+            printHeadlessSimulationResult(runHeadlessSimulation("headless", config));
+            return 0;
+        } else if ((arg == "--replay" || arg == "-r") && i + 1 < argc) {
+            // Reservierungs-Journal offline nachspielen: --replay <datei> [zeit]
+            std::string journalFile = argv[++i];
+            double untilTime = (i + 1 < argc) ? std::stod(argv[++i]) : 1e9;
+            return runJournalReplay(journalFile, untilTime, true);
         } else if (arg == "--help" || arg == "-h") {
             std::cout << "Verwendung: " << argv[0] << " [OPTIONEN]" << std::endl;
             std::cout << "  --fullscreen, -f     Vollbild auf aktuellem Monitor" << std::endl;
             std::cout << "  --monitor2, -m2      Vollbild auf Monitor 2" << std::endl;
+            std::cout << "  --threads, -t N      Threads für das Flotten-Update (Standard: alle Kerne)" << std::endl;
+            std::cout << "  --native-detector, -n  Farberkennung in C++ statt Python/OpenCV" << std::endl;
+            std::cout << "  --roi-tracking       Native Farberkennung nur in Fenstern um verfolgte Marker" << std::endl;
+            std::cout << "  --pyramid N          Native Farberkennung grob auf jedem N-ten Pixel, fein nur um Treffer" << std::endl;
+            std::cout << "  --benchmark, -b      Segment-Durchsatz-Benchmark (ohne Fenster)" << std::endl;
+            std::cout << "  --statistics-csv DATEI  Segment-Statistik des Benchmarks als CSV schreiben" << std::endl;
+            std::cout << "  --headless [SEK]     Flotte ohne Fenster simulieren (Standard: 3600 s)" << std::endl;
+            std::cout << "  --replay, -r DATEI [ZEIT]  Reservierungs-Journal bis ZEIT nachspielen" << std::endl;
             std::cout << "  --help, -h           Diese Hilfe anzeigen" << std::endl;
             return 0;
         }
     }
 
+    if (run_benchmarks) {
+        runPlatooningComparison(statistics_csv);
+        runQueuePolicyComparison();
+        runControllerQueuePolicyCheck();
+        runWorldSnapshotCheck();
+        runFleetUpdateBenchmark();
+        runDispatchBenchmark();
+        runCollisionBenchmark();
+        runMarkerBenchmark();
+        runMarkerClassLutBenchmark();
+        runMarkerLabellerBenchmark();
+        runMarkerContourCheck();
+        runMarkerDetectorBenchmark();
+        runMarkerTrackingBenchmark();
+        runMarkerPyramidBenchmark();
+        runFloorCalibrationBenchmark();
+        runLatencyTraceBenchmark();
+        run_python_bridge_benchmark();
+        return 0;
+    }
+
     // Standard-Fenstergröße
     int screenWidth = 1200;
     int screenHeight = 800;
@@ -151,6 +220,7 @@ int main(int argc, char* argv[]) {
 
     // Create car simulation with new point system
     CarSimulation car_simulation;
+    car_simulation.setWorkerThreadCount(worker_threads);
     car_simulation.initialize();
     car_simulation.setCarPointDistance(12.0f);  // Set distance between front and ID points
     car_simulation.setDistanceBuffer(4.0f);     // Set tolerance buffer for pairing
@@ -177,6 +247,10 @@ int main(int argc, char* argv[]) {
         pending_monitor_y = (int)monitor2Pos.y + 50;
     }
 
+    // Kamera und Farberkennung laufen ab hier im eigenen Thread
+    start_detection_thread();
+    DetectionFrame detection;
+
     // EINFACHE HAUPTSCHLEIFE
     while (!WindowShouldClose()) {
         // Nur ESC zum Beenden
@@ -186,12 +260,17 @@ int main(int argc, char* argv[]) {
 
         float deltaTime = GetFrameTime();
 
-        // Hole aktuelle Koordinaten von der Farberkennung
-        std::vector<DetectedObject> detected_objects = get_detected_coordinates();
+        // Neuestes Ergebnis der Farberkennung - wartet nie auf die Kamera
+        bool new_detection = get_latest_detections(detection);
+        if (new_detection) {
+            recordLatency(LatencyStage::BRIDGE, detection.publishTime, std::chrono::steady_clock::now());
+        }
 
         // Update Live-Koordinaten-Fenster
         #ifdef _WIN32
-        updateTestWindowCoordinates(detected_objects);
+        if (new_detection) {
+            updateTestWindowCoordinates(detection.objects);
+        }
         #endif
 
         // Konfiguriere Monitor-Position nachträglich, wenn nötig
@@ -211,9 +290,14 @@ int main(int argc, char* argv[]) {
             }
         }
 
-        // Update car simulation with real detected objects (mit Vollbild-Koordinaten)
-        car_simulation.updateFromDetectedObjects(detected_objects, field_transform);
+        // Update car simulation with real detected objects (mit Vollbild-Koordinaten), nur bei neuem Kamera-Frame
+        if (new_detection) {
+            car_simulation.updateFromDetectedObjects(detection.objects, field_transform);
+        }
+        auto planning_start = std::chrono::steady_clock::now();
         car_simulation.update(deltaTime);
+        auto render_start = std::chrono::steady_clock::now();
+        recordLatency(LatencyStage::PLANNING, planning_start, render_start);
 
         BeginDrawing();
         
@@ -222,8 +306,12 @@ int main(int argc, char* argv[]) {
         car_simulation.renderUI();
 
         EndDrawing();
+        recordLatency(LatencyStage::RENDER, render_start, std::chrono::steady_clock::now());
     }
 
+    stop_detection_thread();
+    printLatencyReport(std::cout);
+    cleanup_coordinate_detector();
     CloseWindow();
     return 0;
 }
\ No newline at end of file
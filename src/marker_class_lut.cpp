@@ -0,0 +1,198 @@
+#include "marker_class_lut.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+// Fixed-point division tables of OpenCV's 8-bit RGB2HSV
+const int HSV_SHIFT = 12;
+
+struct HsvTables {
+    int sdiv[256];
+    int hdiv[256];
+
+    HsvTables() {
+        sdiv[0] = hdiv[0] = 0;
+        for (int i = 1; i < 256; i++) {
+            sdiv[i] = static_cast<int>(std::lrint((255 << HSV_SHIFT) / (1.0 * i)));
+            hdiv[i] = static_cast<int>(std::lrint((180 << HSV_SHIFT) / (6.0 * i)));
+        }
+    }
+};
+
+const HsvTables& hsvTables() {
+    static const HsvTables tables;
+    return tables;
+}
+
+inline void convertPixel(const HsvTables& tables, int b, int g, int r, int& h, int& s, int& v) {
+    v = std::max(b, std::max(g, r));
+    int diff = v - std::min(b, std::min(g, r));
+    int vr = v == r ? -1 : 0;
+    int vg = v == g ? -1 : 0;
+
+    s = (diff * tables.sdiv[v] + (1 << (HSV_SHIFT - 1))) >> HSV_SHIFT;
+    h = (vr & (g - b)) + (~vr & ((vg & (b - r + 2 * diff)) + ((~vg) & (r - g + 4 * diff))));
+    h = (h * tables.hdiv[diff] + (1 << (HSV_SHIFT - 1))) >> HSV_SHIFT;
+    h += h < 0 ? 180 : 0;
+}
+
+int hueDistance(int h1, int h2) {
+    int dh = std::abs(h1 - h2);
+    return std::min(dh, 180 - dh);
+}
+
+// HSV extent of the colors in one table bin, independent of the tolerances
+struct BinRange {
+    uint8_t hueStart;        // Shortest circular H arc holding every hue of the bin
+    uint8_t hueLength;       // 1..180
+    uint8_t sMin, sMax;
+    uint8_t vMin, vMax;
+};
+
+std::vector<BinRange> computeBinRanges() {
+    const HsvTables& tables = hsvTables();
+    const int size = 1 << MarkerClassLut::BIN_BITS;
+    const int width = 256 / size;
+    std::vector<BinRange> ranges(MarkerClassLut::BINS);
+
+    for (int bin = 0; bin < MarkerClassLut::BINS; bin++) {
+        int b0 = (bin >> (2 * MarkerClassLut::BIN_BITS)) * width;
+        int g0 = ((bin >> MarkerClassLut::BIN_BITS) & (size - 1)) * width;
+        int r0 = (bin & (size - 1)) * width;
+
+        uint64_t hues[3] = {0, 0, 0};
+        int sMin = 255, sMax = 0, vMin = 255, vMax = 0;
+        for (int b = b0; b < b0 + width; b++) {
+            for (int g = g0; g < g0 + width; g++) {
+                for (int r = r0; r < r0 + width; r++) {
+                    int h, s, v;
+                    convertPixel(tables, b, g, r, h, s, v);
+                    hues[h >> 6] |= 1ull << (h & 63);
+                    sMin = std::min(sMin, s);
+                    sMax = std::max(sMax, s);
+                    vMin = std::min(vMin, v);
+                    vMax = std::max(vMax, v);
+                }
+            }
+        }
+
+        // The arc is the circle minus the largest gap between neighboring hues
+        int first = -1, previous = -1, gapEnd = -1, largestGap = 0;
+        for (int word = 0; word < 3; word++) {
+            for (uint64_t bits = hues[word]; bits; bits &= bits - 1) {
+                int h = word * 64 + __builtin_ctzll(bits);
+                if (first < 0) first = h;
+                else if (h - previous > largestGap) {
+                    largestGap = h - previous;
+                    gapEnd = h;
+                }
+                previous = h;
+            }
+        }
+        if (first + 180 - previous > largestGap) {
+            largestGap = first + 180 - previous;
+            gapEnd = first;
+        }
+
+        BinRange& range = ranges[bin];
+        range.hueStart = static_cast<uint8_t>(gapEnd);
+        range.hueLength = static_cast<uint8_t>(180 - largestGap + 1);
+        range.sMin = static_cast<uint8_t>(sMin);
+        range.sMax = static_cast<uint8_t>(sMax);
+        range.vMin = static_cast<uint8_t>(vMin);
+        range.vMax = static_cast<uint8_t>(vMax);
+    }
+    return ranges;
+}
+
+// Computed on first use (one HSV conversion per 8-bit color), shared by all tables
+const std::vector<BinRange>& binRanges() {
+    static const std::vector<BinRange> ranges = computeBinRanges();
+    return ranges;
+}
+
+} // namespace
+
+void bgrToHsv(uint8_t b, uint8_t g, uint8_t r, uint8_t& h, uint8_t& s, uint8_t& v) {
+    int hue, saturation, value;
+    convertPixel(hsvTables(), b, g, r, hue, saturation, value);
+    h = static_cast<uint8_t>(hue);
+    s = static_cast<uint8_t>(saturation);
+    v = static_cast<uint8_t>(value);
+}
+
+MarkerClassLut::MarkerClassLut() : table(BINS, 0), boundaryBins(0) {
+    std::fill(hueBits, hueBits + 256, 0);
+    std::fill(satBits, satBits + 256, 0);
+    std::fill(valBits, valBits + 256, 0);
+}
+
+void MarkerClassLut::build(const std::vector<MarkerColor>& colors) {
+    const int colorCount = std::min(static_cast<int>(colors.size()), MAX_MARKER_COLORS);
+    std::fill(hueBits, hueBits + 256, 0);
+    std::fill(satBits, satBits + 256, 0);
+    std::fill(valBits, valBits + 256, 0);
+    for (int c = 0; c < colorCount; c++) {
+        const MarkerColor& color = colors[c];
+        uint8_t bit = static_cast<uint8_t>(1 << c);
+        for (int i = 0; i < 256; i++) {
+            if (i < 180 && hueDistance(i, color.h) <= color.hTolerance) hueBits[i] |= bit;
+            if (std::abs(i - color.s) <= color.sTolerance) satBits[i] |= bit;
+            if (std::abs(i - color.v) <= color.vTolerance) valBits[i] |= bit;
+        }
+    }
+
+    // Matching hues per color summed over two turns, so an arc is one difference
+    std::vector<int> huePrefix(static_cast<size_t>(colorCount) * 361, 0);
+    std::vector<int> sLow(colorCount), sHigh(colorCount), vLow(colorCount), vHigh(colorCount);
+    for (int c = 0; c < colorCount; c++) {
+        int* prefix = &huePrefix[static_cast<size_t>(c) * 361];
+        for (int i = 0; i < 360; i++) prefix[i + 1] = prefix[i] + ((hueBits[i % 180] >> c) & 1);
+        sLow[c] = std::max(0, colors[c].s - colors[c].sTolerance);
+        sHigh[c] = std::min(255, colors[c].s + colors[c].sTolerance);
+        vLow[c] = std::max(0, colors[c].v - colors[c].vTolerance);
+        vHigh[c] = std::min(255, colors[c].v + colors[c].vTolerance);
+    }
+
+    const std::vector<BinRange>& ranges = binRanges();
+    boundaryBins = 0;
+    for (int bin = 0; bin < BINS; bin++) {
+        const BinRange& range = ranges[bin];
+        uint8_t all = 0, any = 0;
+        for (int c = 0; c < colorCount; c++) {
+            const int* prefix = &huePrefix[static_cast<size_t>(c) * 361];
+            int matchingHues = prefix[range.hueStart + range.hueLength] - prefix[range.hueStart];
+            uint8_t bit = static_cast<uint8_t>(1 << c);
+            if (matchingHues == range.hueLength && range.sMin >= sLow[c] && range.sMax <= sHigh[c] &&
+                range.vMin >= vLow[c] && range.vMax <= vHigh[c]) {
+                all |= bit;
+            }
+            if (matchingHues > 0 && range.sMax >= sLow[c] && range.sMin <= sHigh[c] &&
+                range.vMax >= vLow[c] && range.vMin <= vHigh[c]) {
+                any |= bit;
+            }
+        }
+        if (all == any) {
+            table[bin] = all;
+        } else {
+            table[bin] = BOUNDARY;
+            boundaryBins++;
+        }
+    }
+}
+
+void MarkerClassLut::classifyRow(const uint8_t* bgr, int count, uint8_t* classes) const {
+    const uint8_t* lut = table.data();
+    for (int x = 0; x < count; x++, bgr += 3) {
+        uint8_t binClasses = lut[binIndex(bgr[0], bgr[1], bgr[2])];
+        classes[x] = (binClasses & BOUNDARY) ? classifyExact(bgr[0], bgr[1], bgr[2]) : binClasses;
+    }
+}
+
+uint8_t MarkerClassLut::classifyExact(uint8_t b, uint8_t g, uint8_t r) const {
+    int h, s, v;
+    convertPixel(hsvTables(), b, g, r, h, s, v);
+    return hueBits[h] & satBits[s] & valBits[v];
+}
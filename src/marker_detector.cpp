@@ -0,0 +1,381 @@
+#include "marker_detector.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+
+namespace {
+
+int hueDistance(int h1, int h2) {
+    int dh = std::abs(h1 - h2);
+    return std::min(dh, 180 - dh);
+}
+
+} // namespace
+
+MarkerDetectorConfig::MarkerDetectorConfig()
+    : minSize(80), maxFrontMarkers(4), minFrontDistance(30.0f),
+      roiTracking(false), sweepInterval(30), roiRadius(32), trackRadius(40.0f), pyramidScale(1) {
+    colors = {
+        {MARKER_FRONT,  106, 255, 240, 15, 0, 255},
+        {heckMarker(1), 40, 255, 165, 6, 0, 134},
+        {heckMarker(2), 1, 255, 220, 5, 187, 151},
+        {heckMarker(3), 10, 255, 255, 5, 29, 129},
+        {heckMarker(4), 122, 185, 150, 75, 61, 61},
+    };
+}
+
+MarkerDetector::MarkerDetector(const MarkerDetectorConfig& config)
+    : config(config), lutCurrent(false), frame{nullptr, 0, 0, 0}, width(0), height(0),
+      framesSinceSweep(0), sweepRequested(false), lastSweep(false), lastPixelCount(0) {}
+
+void MarkerDetector::setConfig(const MarkerDetectorConfig& newConfig) {
+    if (!newConfig.roiTracking) resetTracking();
+    config = newConfig;
+    lutCurrent = false;
+}
+
+void MarkerDetector::resetTracking() {
+    tracks.clear();
+    framesSinceSweep = 0;
+    sweepRequested = false;
+}
+
+void MarkerDetector::detect(const BgrImageView& image, std::vector<DetectedObject>& objects) {
+    frame = image;
+    width = image.width;
+    height = image.height;
+    blobs.clear();
+    candidates.clear();
+    for (std::vector<MarkerBlob>& list : colorBlobs) list.clear();
+    lastPixelCount = 0;
+    if (width <= 0 || height <= 0) return;
+
+    if (!lutCurrent) {
+        lut.build(config.colors);
+        lutCurrent = true;
+    }
+
+    lastSweep = !config.roiTracking || tracks.empty() || sweepRequested ||
+                framesSinceSweep + 1 >= config.sweepInterval || !planRegions();
+    if (lastSweep) {
+        framesSinceSweep = 0;
+        sweepRequested = false;
+        if (config.pyramidScale > 1) planPyramidRegions();
+        else regions.assign(1, Region{0, 0, width, height});
+    } else {
+        framesSinceSweep++;
+    }
+    if (searchRegions()) {
+        if (lastSweep) {
+            // A coarse window cut a blob: search the full frame after all
+            for (std::vector<MarkerBlob>& list : colorBlobs) list.clear();
+            regions.assign(1, Region{0, 0, width, height});
+            searchRegions();
+        } else {
+            sweepRequested = true;
+        }
+    }
+
+    int nextId = 1;
+    int colorCount = std::min(static_cast<int>(config.colors.size()), MAX_MARKER_COLORS);
+    for (int c = 0; c < colorCount; c++) {
+        size_t firstBlob = blobs.size();
+        std::stable_sort(colorBlobs[c].begin(), colorBlobs[c].end(),
+                         [](const MarkerBlob& a, const MarkerBlob& b) { return a.score > b.score; });
+        blobs.insert(blobs.end(), colorBlobs[c].begin(), colorBlobs[c].end());
+        selectCandidates(config.colors[c], firstBlob, nextId);
+    }
+
+    // Most likely first; one spot per Heck color, then the Front spots
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [](const Candidate& a, const Candidate& b) { return a.blob.score > b.blob.score; });
+    const size_t firstObject = objects.size();
+    bool heckUsed[2 + MAX_HECK_MARKERS] = {};
+    for (const Candidate& candidate : candidates) {
+        MarkerId marker = candidate.blob.marker;
+        if (!isHeckMarker(marker) || heckUsed[marker]) continue;
+        heckUsed[marker] = true;
+
+        DetectedObject object;
+        object.id = candidate.id;
+        object.marker = marker;
+        object.coordinates = Point2D(std::min(std::max(candidate.blob.cx, 0.0f), static_cast<float>(width)),
+                                     std::min(std::max(candidate.blob.cy, 0.0f), static_cast<float>(height)));
+        object.area = candidate.blob.score;
+        object.crop_width = static_cast<float>(width);
+        object.crop_height = static_cast<float>(height);
+        objects.push_back(object);
+    }
+    int fronts = 0;
+    for (const Candidate& candidate : candidates) {
+        if (!isFrontMarker(candidate.blob.marker) || fronts >= config.maxFrontMarkers) continue;
+        fronts++;
+
+        DetectedObject object;
+        object.id = candidate.id;
+        object.marker = MARKER_FRONT;
+        object.coordinates = Point2D(std::min(std::max(candidate.blob.cx, 0.0f), static_cast<float>(width)),
+                                     std::min(std::max(candidate.blob.cy, 0.0f), static_cast<float>(height)));
+        object.area = candidate.blob.score;
+        object.crop_width = static_cast<float>(width);
+        object.crop_height = static_cast<float>(height);
+        objects.push_back(object);
+    }
+
+    if (config.roiTracking) updateTracks(objects, firstObject);
+}
+
+bool MarkerDetector::planRegions() {
+    // One window per track around its predicted position; false if a prediction left the frame
+    regions.clear();
+    auto now = std::chrono::steady_clock::now();
+    for (const FilteredPoint& track : tracks) {
+        float deltaTime = std::chrono::duration<float>(now - track.lastUpdate).count();
+        Point predicted = motionModel.predictNextPosition(track, deltaTime);
+        int cx = static_cast<int>(std::floor(predicted.x)), cy = static_cast<int>(std::floor(predicted.y));
+        int x0 = std::max(cx - config.roiRadius, 0), y0 = std::max(cy - config.roiRadius, 0);
+        int x1 = std::min(cx + config.roiRadius + 1, width), y1 = std::min(cy + config.roiRadius + 1, height);
+        if (x0 >= x1 || y0 >= y1) return false;
+        regions.push_back({x0, y0, x1 - x0, y1 - y0});
+    }
+
+    mergeRegions();
+    return true;
+}
+
+void MarkerDetector::planPyramidRegions() {
+    // Every pyramidScale-th pixel of every pyramidScale-th row, classified without opening
+    const int scale = config.pyramidScale;
+    const int coarseWidth = (width + scale - 1) / scale, coarseHeight = (height + scale - 1) / scale;
+    coarseClasses.resize(static_cast<size_t>(coarseWidth) * coarseHeight);
+    for (int y = 0; y < coarseHeight; y++) {
+        const uint8_t* pixel = frame.data + static_cast<size_t>(y) * scale * frame.stride;
+        uint8_t* out = &coarseClasses[static_cast<size_t>(y) * coarseWidth];
+        for (int x = 0; x < coarseWidth; x++, pixel += 3 * scale) out[x] = lut.classify(pixel[0], pixel[1], pixel[2]);
+    }
+    lastPixelCount += coarseWidth * coarseHeight;
+
+    // A blob reaches at most scale - 1 px past its outermost samples; the rest of the margin
+    // gives the opening its neighbors. The sampling may catch few pixels of a small blob, so a
+    // quarter of minSize is enough for a window.
+    const int margin = 2 * scale;
+    int colorCount = std::min(static_cast<int>(config.colors.size()), MAX_MARKER_COLORS);
+    labeller.label(coarseClasses.data(), coarseWidth, coarseHeight, colorCount, components);
+    regions.clear();
+    for (const ClassComponent& component : components) {
+        if (component.pixelCount * scale * scale * 4 < config.minSize) continue;
+        int x0 = std::max(component.minX * scale - margin, 0), y0 = std::max(component.minY * scale - margin, 0);
+        int x1 = std::min(component.maxX * scale + margin + 1, width), y1 = std::min(component.maxY * scale + margin + 1, height);
+        regions.push_back({x0, y0, x1 - x0, y1 - y0});
+    }
+    mergeRegions();
+}
+
+void MarkerDetector::mergeRegions() {
+    // Overlapping windows become their bounding box, otherwise a marker in both is found twice
+    for (bool merged = true; merged;) {
+        merged = false;
+        for (size_t i = 0; i < regions.size() && !merged; i++) {
+            for (size_t j = i + 1; j < regions.size(); j++) {
+                Region& a = regions[i];
+                const Region& b = regions[j];
+                if (a.x >= b.x + b.width || b.x >= a.x + a.width || a.y >= b.y + b.height || b.y >= a.y + a.height) continue;
+                int x1 = std::max(a.x + a.width, b.x + b.width), y1 = std::max(a.y + a.height, b.y + b.height);
+                a.x = std::min(a.x, b.x);
+                a.y = std::min(a.y, b.y);
+                a.width = x1 - a.x;
+                a.height = y1 - a.y;
+                regions.erase(regions.begin() + j);
+                merged = true;
+                break;
+            }
+        }
+    }
+}
+
+bool MarkerDetector::searchRegions() {
+    // Full-resolution classification, opening and blobs per window; true if a blob was cut off
+    bool cut = false;
+    for (const Region& region : regions) {
+        classifyPixels(region);
+        openClasses(region);
+        cut |= collectBlobs(region);
+        lastPixelCount += region.width * region.height;
+    }
+    return cut;
+}
+
+void MarkerDetector::updateTracks(const std::vector<DetectedObject>& objects, size_t firstObject) {
+    // Each detection continues the nearest track of its marker within trackRadius or starts one
+    auto now = std::chrono::steady_clock::now();
+    trackMatched.assign(tracks.size(), false);
+    for (size_t i = firstObject; i < objects.size(); i++) {
+        const DetectedObject& object = objects[i];
+        Point position(object.coordinates.x, object.coordinates.y,
+                       isFrontMarker(object.marker) ? PointType::FRONT : PointType::IDENTIFICATION, object.marker);
+        int best = -1;
+        float bestDistance = config.trackRadius;
+        for (size_t t = 0; t < tracks.size(); t++) {
+            if (trackMatched[t] || tracks[t].marker != object.marker) continue;
+            float distance = tracks[t].point.distanceTo(position);
+            if (distance <= bestDistance) {
+                best = static_cast<int>(t);
+                bestDistance = distance;
+            }
+        }
+        if (best < 0) {
+            tracks.emplace_back(position, object.marker);
+            trackMatched.push_back(true);
+            continue;
+        }
+
+        FilteredPoint& track = tracks[best];
+        track.totalDetections++;
+        motionModel.updateMotionModel(track, position);   // Measures dt from lastUpdate
+        track.point = position;
+        track.lastUpdate = now;
+        track.missedDetections = 0;
+        trackMatched[best] = true;
+    }
+
+    // A marker missing from its window may have left it: sweep next frame, and drop the track
+    // if even a sweep did not find it
+    size_t kept = 0;
+    for (size_t t = 0; t < tracks.size(); t++) {
+        if (!trackMatched[t]) {
+            if (lastSweep) continue;
+            tracks[t].missedDetections++;
+            sweepRequested = true;
+        }
+        if (kept != t) tracks[kept] = std::move(tracks[t]);
+        kept++;
+    }
+    tracks.resize(kept);
+}
+
+void MarkerDetector::classifyPixels(const Region& region) {
+    // One table lookup per pixel for all colors (exact HSV check only in boundary bins)
+    classes.resize(static_cast<size_t>(region.width) * region.height);
+    for (int y = 0; y < region.height; y++) {
+        const uint8_t* row = frame.data + static_cast<size_t>(region.y + y) * frame.stride + region.x * 3;
+        lut.classifyRow(row, region.width, &classes[static_cast<size_t>(y) * region.width]);
+    }
+}
+
+void MarkerDetector::openClasses(const Region& region) {
+    // Opening with the 3x3 ellipse (a cross), for all class bits at once. Outside the image the
+    // pixel itself stands in for its missing neighbor, which neither erodes nor dilates it.
+    // At a window edge that is not the frame edge this differs from the full frame only for
+    // blobs touching the edge, and those request a sweep.
+    const int width = region.width, height = region.height;
+    scratch.resize(classes.size());
+    for (int pass = 0; pass < 2; pass++) {
+        const bool erode = pass == 0;
+        const std::vector<uint8_t>& source = erode ? classes : scratch;
+        std::vector<uint8_t>& target = erode ? scratch : classes;
+        for (int y = 0; y < height; y++) {
+            const uint8_t* row = &source[static_cast<size_t>(y) * width];
+            const uint8_t* up = y > 0 ? row - width : row;
+            const uint8_t* down = y + 1 < height ? row + width : row;
+            uint8_t* out = &target[static_cast<size_t>(y) * width];
+            if (erode) {
+                for (int x = 0; x < width; x++) out[x] = row[x] & up[x] & down[x];
+                for (int x = 1; x + 1 < width; x++) out[x] &= row[x - 1] & row[x + 1];
+                if (width > 1) {
+                    out[0] &= row[1];
+                    out[width - 1] &= row[width - 2];
+                }
+            } else {
+                for (int x = 0; x < width; x++) out[x] = row[x] | up[x] | down[x];
+                for (int x = 1; x + 1 < width; x++) out[x] |= row[x - 1] | row[x + 1];
+                if (width > 1) {
+                    out[0] |= row[1];
+                    out[width - 1] |= row[width - 2];
+                }
+            }
+        }
+    }
+}
+
+bool MarkerDetector::collectBlobs(const Region& region) {
+    // All colors in one run-length pass over the opened class image, then into frame coordinates
+    int colorCount = std::min(static_cast<int>(config.colors.size()), MAX_MARKER_COLORS);
+    labeller.label(classes.data(), region.width, region.height, colorCount, components);
+    bool cut = false;
+    for (const ClassComponent& component : components) {
+        MarkerBlob blob;
+        if (!measureBlob(component, blob)) continue;
+
+        // Cut off by the window: the blob may continue outside, measure it on the full frame
+        if ((blob.minX == 0 && region.x > 0) || (blob.minY == 0 && region.y > 0) ||
+            (blob.maxX == region.width - 1 && region.x + region.width < width) ||
+            (blob.maxY == region.height - 1 && region.y + region.height < height)) {
+            cut = true;
+        }
+        blob.cx += region.x;
+        blob.cy += region.y;
+        blob.minX += region.x;
+        blob.maxX += region.x;
+        blob.minY += region.y;
+        blob.maxY += region.y;
+        colorBlobs[component.classIndex].push_back(blob);
+    }
+    return cut;
+}
+
+bool MarkerDetector::measureBlob(const ClassComponent& component, MarkerBlob& blob) const {
+    // Area and length of the contour through the border pixel centers, as cv2.contourArea and
+    // cv2.arcLength measure the findContours result (see ClassComponent)
+    const float pi = 3.14159265358979f;
+    blob.marker = config.colors[component.classIndex].marker;
+    blob.pixelCount = component.pixelCount;
+    blob.area = component.quadFull + component.quadThree / 2.0f;
+    blob.perimeter = component.quadSide + 1.41421356f * (component.quadThree + 2 * component.quadDiagonal);
+    blob.cx = static_cast<float>(static_cast<double>(component.sumX) / component.pixelCount);
+    blob.cy = static_cast<float>(static_cast<double>(component.sumY) / component.pixelCount);
+    blob.minX = component.minX;
+    blob.minY = component.minY;
+    blob.maxX = component.maxX;
+    blob.maxY = component.maxY;
+    if (blob.area < config.minSize || blob.perimeter <= 0.0f) return false;
+
+    float compactness = 4.0f * pi * blob.area / (blob.perimeter * blob.perimeter);
+    blob.score = blob.area * (1.0f + compactness);
+    return true;
+}
+
+bool MarkerDetector::hueMatches(const MarkerColor& color, float x, float y) const {
+    // H check at the (truncated) centroid like detect_colors
+    int px = static_cast<int>(x), py = static_cast<int>(y);
+    if (px < 0 || py < 0 || px >= width || py >= height) return false;
+    const uint8_t* pixel = frame.data + static_cast<size_t>(py) * frame.stride + px * 3;
+    uint8_t h, s, v;
+    bgrToHsv(pixel[0], pixel[1], pixel[2], h, s, v);
+    return hueDistance(h, color.h) <= color.hTolerance;
+}
+
+void MarkerDetector::selectCandidates(const MarkerColor& color, size_t firstBlob, int& nextId) {
+    if (firstBlob == blobs.size()) return;
+
+    if (isFrontMarker(color.marker)) {
+        // Best spots first, each at least minFrontDistance from the ones already taken
+        std::vector<const MarkerBlob*> selected;
+        for (size_t i = firstBlob; i < blobs.size() && static_cast<int>(selected.size()) < config.maxFrontMarkers; i++) {
+            bool tooClose = false;
+            for (const MarkerBlob* other : selected) {
+                float dx = blobs[i].cx - other->cx, dy = blobs[i].cy - other->cy;
+                if (std::sqrt(dx * dx + dy * dy) < config.minFrontDistance) {
+                    tooClose = true;
+                    break;
+                }
+            }
+            if (!tooClose) selected.push_back(&blobs[i]);
+        }
+        for (const MarkerBlob* blob : selected) {
+            if (hueMatches(color, blob->cx, blob->cy)) candidates.push_back({*blob, nextId++});
+        }
+    } else if (hueMatches(color, blobs[firstBlob].cx, blobs[firstBlob].cy)) {
+        candidates.push_back({blobs[firstBlob], nextId++});
+    }
+}
@@ -0,0 +1,34 @@
+#include "marker_id.h"
+#include <cstdio>
+#include <cstring>
+
+MarkerId internMarker(const char* name) {
+    if (!name) return MARKER_NONE;
+    if (std::strcmp(name, "Front") == 0) return MARKER_FRONT;
+    if (std::strncmp(name, "Heck", 4) != 0) return MARKER_NONE;
+
+    // "Heck" followed by 1-2 digits without a leading zero
+    const char* digits = name + 4;
+    int number = 0, length = 0;
+    while (digits[length] >= '0' && digits[length] <= '9' && length < 3) {
+        number = number * 10 + (digits[length] - '0');
+        length++;
+    }
+    if (length == 0 || length > 2 || digits[length] != '\0' || digits[0] == '0') return MARKER_NONE;
+    return heckMarker(number);
+}
+
+const char* markerName(MarkerId marker) {
+    struct NameTable {
+        char names[2 + MAX_HECK_MARKERS][8];
+        NameTable() {
+            std::snprintf(names[MARKER_NONE], sizeof(names[0]), "%s", "");
+            std::snprintf(names[MARKER_FRONT], sizeof(names[0]), "%s", "Front");
+            for (int number = 1; number <= MAX_HECK_MARKERS; number++) {
+                std::snprintf(names[heckMarker(number)], sizeof(names[0]), "Heck%d", number);
+            }
+        }
+    };
+    static const NameTable table;
+    return marker < 2 + MAX_HECK_MARKERS ? table.names[marker] : "";
+}
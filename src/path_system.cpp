@@ -5,13 +5,14 @@
 #include <unordered_set>
 #include <limits>
 
-PathSystem::PathSystem() : nextNodeId(0), nextSegmentId(0) {}
+PathSystem::PathSystem() : nextNodeId(0), nextSegmentId(0), layoutVersion(0) {}
 
 int PathSystem::addNode(float x, float y) {
     int nodeId = nextNodeId++;
     PathNode node(nodeId, x, y);
     nodes.push_back(node);
     nodeIdToIndex[nodeId] = nodes.size() - 1;
+    layoutVersion++;
     return nodeId;
 }
 
@@ -20,6 +21,7 @@ int PathSystem::addWaitingNode(float x, float y) {
     PathNode node(nodeId, x, y, true);
     nodes.push_back(node);
     nodeIdToIndex[nodeId] = nodes.size() - 1;
+    layoutVersion++;
     return nodeId;
 }
 
@@ -49,6 +51,7 @@ int PathSystem::addSegment(int startNodeId, int endNodeId) {
     // Connect nodes to segment
     connectNodeToSegment(startNodeId, nextSegmentId);
     connectNodeToSegment(endNodeId, nextSegmentId);
+    layoutVersion++;
 
     return nextSegmentId++;
 }
@@ -152,6 +155,41 @@ std::vector<int> PathSystem::findPath(int startNodeId, int endNodeId,
     return path;
 }
 
+std::vector<float> PathSystem::findDistancesFrom(int startNodeId) const {
+    // Dijkstra without target on plain arrays (node IDs are dense)
+    std::vector<float> distances(nextNodeId, std::numeric_limits<float>::infinity());
+    if (!getNode(startNodeId)) return distances;
+
+    std::priority_queue<std::pair<float, int>,
+                       std::vector<std::pair<float, int>>,
+                       std::greater<std::pair<float, int>>> pq;
+    distances[startNodeId] = 0.0f;
+    pq.push({0.0f, startNodeId});
+
+    while (!pq.empty()) {
+        float currentDist = pq.top().first;
+        int currentNode = pq.top().second;
+        pq.pop();
+        if (currentDist > distances[currentNode]) continue;
+
+        const PathNode* node = getNode(currentNode);
+        if (!node) continue;
+
+        for (int segmentId : node->connectedSegments) {
+            const PathSegment* segment = getSegment(segmentId);
+            if (!segment) continue;
+
+            int otherNode = (segment->startNodeId == currentNode) ? segment->endNodeId : segment->startNodeId;
+            float newDist = currentDist + segment->length;
+            if (newDist < distances[otherNode]) {
+                distances[otherNode] = newDist;
+                pq.push({newDist, otherNode});
+            }
+        }
+    }
+    return distances;
+}
+
 std::vector<Point> PathSystem::getPathPoints(const std::vector<int>& segmentIds) const {
     std::vector<Point> points;
 
@@ -1,10 +1,46 @@
 #include "py_runner.h"
 #include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
 #include <Python.h>
+#include "triple_buffer.h"
+#include "detection_ring.h"
+#include "marker_detector.h"
+#include "latency_trace.h"
 
 static bool python_initialized = false;
-static bool detector_initialized = false;
+static std::atomic<bool> detector_initialized(false);
 static bool monitor_configured = false;
+static PyThreadState* main_thread_state = nullptr;   // Nach Py_Initialize abgegeben, vor Py_Finalize zurückgeholt
+
+// Python nur mit GIL anfassen: nach initializePython hält ihn kein Thread dauerhaft,
+// damit Hauptschleife und Erkennungs-Thread abwechselnd zugreifen können
+class GilLock {
+public:
+    GilLock() : state(PyGILState_Ensure()) {}
+    ~GilLock() { PyGILState_Release(state); }
+    GilLock(const GilLock&) = delete;
+    GilLock& operator=(const GilLock&) = delete;
+private:
+    PyGILState_STATE state;
+};
+
+// Einmal geladene Python-Objekte (eigene Referenzen, freigegeben in cleanupPython)
+static PyObject* detector_module = nullptr;
+static PyObject* detect_packed_function = nullptr;
+static PyObject* capture_native_function = nullptr;     // Nur mit den NATIVE-Backends
+static PyObject* capture_time_function = nullptr;       // Optional: Aufnahmezeit des letzten Kamerabilds
+
+static DetectionBackend detection_backend = DetectionBackend::PYTHON;
+
+static bool nativeBackend() {
+    return detection_backend != DetectionBackend::PYTHON;
+}
 
 bool initializePython() {
     if (python_initialized) return true;
@@ -18,6 +54,7 @@ bool initializePython() {
         
         // Add current directory to Python path
         PyRun_SimpleString("import sys; sys.path.append('src')");
+        main_thread_state = PyEval_SaveThread();
         python_initialized = true;
         return true;
     } catch (...) {
@@ -28,12 +65,32 @@ bool initializePython() {
 
 void cleanupPython() {
     if (python_initialized) {
+        PyEval_RestoreThread(main_thread_state);
+        Py_XDECREF(detect_packed_function);
+        Py_XDECREF(capture_native_function);
+        Py_XDECREF(capture_time_function);
+        Py_XDECREF(detector_module);
+        detect_packed_function = nullptr;
+        capture_native_function = nullptr;
+        capture_time_function = nullptr;
+        detector_module = nullptr;
         Py_Finalize();
         python_initialized = false;
         detector_initialized = false;
     }
 }
 
+// Farberkennung wird nur beim ersten Aufruf importiert (geliehene Referenz)
+static PyObject* getDetectorModule() {
+    if (!detector_module) {
+        detector_module = PyImport_ImportModule("Farberkennung");
+        if (!detector_module) {
+            PyErr_Print();
+        }
+    }
+    return detector_module;
+}
+
 bool initializeDetector() {
     if (detector_initialized) return true;
     
@@ -42,10 +99,8 @@ bool initializeDetector() {
     }
     
     try {
-        // Import Farberkennung module
-        PyObject* pModule = PyImport_ImportModule("Farberkennung");
+        PyObject* pModule = getDetectorModule();
         if (!pModule) {
-            PyErr_Print();
             return false;
         }
         
@@ -53,7 +108,7 @@ bool initializeDetector() {
         PyObject* pFunc = PyObject_GetAttrString(pModule, "initialize_detector");
         if (!pFunc || !PyCallable_Check(pFunc)) {
             PyErr_Print();
-            Py_DECREF(pModule);
+            Py_XDECREF(pFunc);
             return false;
         }
         
@@ -66,7 +121,35 @@ bool initializeDetector() {
         }
         
         Py_DECREF(pFunc);
-        Py_DECREF(pModule);
+        
+        // Detektionsfunktion einmal holen, runPythonDetection ruft sie nur noch auf
+        if (success && !detect_packed_function) {
+            detect_packed_function = PyObject_GetAttrString(pModule, "detect_objects_packed");
+            if (!detect_packed_function || !PyCallable_Check(detect_packed_function)) {
+                PyErr_Print();
+                Py_XDECREF(detect_packed_function);
+                detect_packed_function = nullptr;
+                success = false;
+            }
+        }
+        if (success && nativeBackend() && !capture_native_function) {
+            capture_native_function = PyObject_GetAttrString(pModule, "capture_frame_native");
+            if (!capture_native_function || !PyCallable_Check(capture_native_function)) {
+                PyErr_Print();
+                Py_XDECREF(capture_native_function);
+                capture_native_function = nullptr;
+                success = false;
+            }
+        }
+        // Ältere Farberkennung.py ohne last_capture_time_ns: Aufnahmezeit = Frame-Start
+        if (success && !capture_time_function) {
+            capture_time_function = PyObject_GetAttrString(pModule, "last_capture_time_ns");
+            if (!capture_time_function || !PyCallable_Check(capture_time_function)) {
+                PyErr_Clear();
+                Py_XDECREF(capture_time_function);
+                capture_time_function = nullptr;
+            }
+        }
         
         if (success) {
             detector_initialized = true;
@@ -82,125 +165,268 @@ bool initializeDetector() {
     }
 }
 
-std::vector<DetectedObject> runPythonDetection() {
-    std::vector<DetectedObject> objects;
+// Gepacktes Ergebnis (bytes fester Datensätze): ein memcpy, dann Umwandlung ohne Python-Aufrufe
+static void readPackedDetections(PyObject* packed, std::vector<DetectedObject>& objects) {
+    Py_buffer view;
+    if (PyObject_GetBuffer(packed, &view, PyBUF_SIMPLE) != 0) {
+        PyErr_Print();
+        return;
+    }
+    std::vector<PackedDetection> records(static_cast<size_t>(view.len) / sizeof(PackedDetection));
+    if (!records.empty()) {
+        std::memcpy(records.data(), view.buf, records.size() * sizeof(PackedDetection));
+    }
+    PyBuffer_Release(&view);
+
+    objects.reserve(objects.size() + records.size());
+    for (const PackedDetection& record : records) {
+        char colorName[sizeof(record.color) + 1] = {};
+        std::memcpy(colorName, record.color, sizeof(record.color));
+
+        DetectedObject obj;
+        obj.id = record.id;
+        obj.marker = internMarker(colorName);   // Einmal hier, danach nur noch MarkerId
+        obj.coordinates.x = record.x;
+        obj.coordinates.y = record.y;
+        obj.area = record.area;
+        obj.crop_width = record.crop_width;
+        obj.crop_height = record.crop_height;
+        objects.push_back(obj);
+    }
+}
+
+// Bisheriges Format: Liste von Dictionaries (detect_objects), bis zu sechs Lookups pro Objekt
+static void parseDetectionDicts(PyObject* list, std::vector<DetectedObject>& objects) {
+    Py_ssize_t size = PyList_Size(list);
     
-    if (!initializePython()) {
-        return objects;
+    for (Py_ssize_t i = 0; i < size; i++) {
+        PyObject* item = PyList_GetItem(list, i);
+        if (PyDict_Check(item)) {
+            DetectedObject obj;
+            
+            // Get ID
+            PyObject* id = PyDict_GetItemString(item, "id");
+            if (id) {
+                obj.id = (int)PyLong_AsLong(id);
+            }
+            
+            // Get normalized coordinates - Python returns tuple
+            PyObject* coords = PyDict_GetItemString(item, "normalized_coords");
+            if (coords && PyTuple_Check(coords) && PyTuple_Size(coords) == 2) {
+                obj.coordinates.x = (float)PyFloat_AsDouble(PyTuple_GetItem(coords, 0));
+                obj.coordinates.y = (float)PyFloat_AsDouble(PyTuple_GetItem(coords, 1));
+            }
+            
+            // Get color, interned once here - downstream only sees the MarkerId
+            PyObject* color = PyDict_GetItemString(item, "classified_color");
+            if (color && PyUnicode_Check(color)) {
+                obj.marker = internMarker(PyUnicode_AsUTF8(color));
+            }
+            
+            // Get area
+            PyObject* area = PyDict_GetItemString(item, "area");
+            if (area) {
+                obj.area = (float)PyFloat_AsDouble(area);
+            }
+            
+            // Get crop dimensions - now from the object itself
+            PyObject* crop_width = PyDict_GetItemString(item, "crop_width");
+            if (crop_width) {
+                obj.crop_width = (float)PyFloat_AsDouble(crop_width);
+            }
+            
+            PyObject* crop_height = PyDict_GetItemString(item, "crop_height");
+            if (crop_height) {
+                obj.crop_height = (float)PyFloat_AsDouble(crop_height);
+            }
+            
+            objects.push_back(obj);
+        }
+    }
+}
+
+// Füllt objects mit dem Ergebnis eines Frames (Aufrufer hält den GIL)
+static void runPythonDetection(std::vector<DetectedObject>& objects) {
+    if (!detect_packed_function) {
+        return;
     }
     
     try {
-        // Import Farberkennung module
-        PyObject* pModule = PyImport_ImportModule("Farberkennung");
-        if (!pModule) {
-            PyErr_Print();
-            return objects;
-        }
-        
-        // Get the detection function
-        PyObject* pFunc = PyObject_GetAttrString(pModule, "detect_objects");
-        if (!pFunc || !PyCallable_Check(pFunc)) {
-            PyErr_Print();
-            Py_DECREF(pModule);
-            return objects;
-        }
-        
-        // Call the detection function
-        PyObject* pResult = PyObject_CallObject(pFunc, nullptr);
+        // Call the cached detection function
+        PyObject* pResult = PyObject_CallObject(detect_packed_function, nullptr);
         if (!pResult) {
             PyErr_Print();
-            Py_DECREF(pFunc);
-            Py_DECREF(pModule);
-            return objects;
+            return;
         }
         
-        // Parse results - expecting list of dictionaries
-        if (PyList_Check(pResult)) {
-            Py_ssize_t size = PyList_Size(pResult);
-            
-            for (Py_ssize_t i = 0; i < size; i++) {
-                PyObject* item = PyList_GetItem(pResult, i);
-                if (PyDict_Check(item)) {
-                    DetectedObject obj;
-                    
-                    // Get ID
-                    PyObject* id = PyDict_GetItemString(item, "id");
-                    if (id) {
-                        obj.id = (int)PyLong_AsLong(id);
-                    }
-                    
-                    // Get normalized coordinates - Python returns tuple
-                    PyObject* coords = PyDict_GetItemString(item, "normalized_coords");
-                    if (coords && PyTuple_Check(coords) && PyTuple_Size(coords) == 2) {
-                        obj.coordinates.x = (float)PyFloat_AsDouble(PyTuple_GetItem(coords, 0));
-                        obj.coordinates.y = (float)PyFloat_AsDouble(PyTuple_GetItem(coords, 1));
-                    }
-                    
-                    // Get color
-                    PyObject* color = PyDict_GetItemString(item, "classified_color");
-                    if (color && PyUnicode_Check(color)) {
-                        obj.color = PyUnicode_AsUTF8(color);
-                    }
-                    
-                    // Get area
-                    PyObject* area = PyDict_GetItemString(item, "area");
-                    if (area) {
-                        obj.area = (float)PyFloat_AsDouble(area);
-                    }
-                    
-                    // Get crop dimensions - now from the object itself
-                    PyObject* crop_width = PyDict_GetItemString(item, "crop_width");
-                    if (crop_width) {
-                        obj.crop_width = (float)PyFloat_AsDouble(crop_width);
-                    }
-                    
-                    PyObject* crop_height = PyDict_GetItemString(item, "crop_height");
-                    if (crop_height) {
-                        obj.crop_height = (float)PyFloat_AsDouble(crop_height);
-                    }
-                    
-                    // obj.is_valid = true; // Removed - field doesn't exist in DetectedObject
-                    objects.push_back(obj);
-                }
-            }
+        // bytes fester Datensätze; eine Liste von Dictionaries wird weiterhin verstanden
+        if (PyObject_CheckBuffer(pResult)) {
+            readPackedDetections(pResult, objects);
+        } else if (PyList_Check(pResult)) {
+            parseDetectionDicts(pResult, objects);
         }
         
         Py_DECREF(pResult);
-        Py_DECREF(pFunc);
-        Py_DECREF(pModule);
         
     } catch (...) {
         std::cerr << "Exception during Python detection" << std::endl;
     }
+}
+
+// === NATIVE ERKENNUNG ===
+static MarkerDetector native_detector;
+static std::string native_settings;     // Zuletzt übernommene Einstellungen (Bytes), nur bei Änderung neu setzen
+
+void set_detection_backend(DetectionBackend backend) {
+    detection_backend = backend;
+    MarkerDetectorConfig config = native_detector.getConfig();
+    config.roiTracking = backend == DetectionBackend::NATIVE_TRACKING;
+    native_detector.setConfig(config);
+}
+
+void set_native_pyramid_scale(int scale) {
+    MarkerDetectorConfig config = native_detector.getConfig();
+    config.pyramidScale = std::max(scale, 1);
+    native_detector.setConfig(config);
+}
+
+// Trackbar-Einstellungen übernehmen; unbekannte Farbnamen werden übersprungen
+static void applyNativeSettings(const char* data, size_t size) {
+    if (size < sizeof(PackedDetectorSettings)) return;
+    if (native_settings.size() == size && std::memcmp(native_settings.data(), data, size) == 0) return;
+    native_settings.assign(data, size);
+
+    PackedDetectorSettings header;
+    std::memcpy(&header, data, sizeof(header));
+    size_t count = std::min(static_cast<size_t>(std::max(header.colorCount, 0)),
+                            (size - sizeof(header)) / sizeof(PackedMarkerColor));
+
+    MarkerDetectorConfig config = native_detector.getConfig();
+    config.minSize = header.minSize;
+    config.colors.clear();
+    for (size_t i = 0; i < count; i++) {
+        PackedMarkerColor record;
+        std::memcpy(&record, data + sizeof(header) + i * sizeof(record), sizeof(record));
+        char colorName[sizeof(record.color) + 1] = {};
+        std::memcpy(colorName, record.color, sizeof(record.color));
+
+        MarkerId marker = internMarker(colorName);
+        if (marker == MARKER_NONE) continue;
+        config.colors.push_back({marker, record.h, record.s, record.v,
+                                 record.hTolerance, record.sTolerance, record.vTolerance});
+    }
+    native_detector.setConfig(config);
+}
+
+// Ein Frame mit dem C++-Detektor (Aufrufer hält den GIL; während detect() wird er freigegeben)
+static void runNativeDetection(std::vector<DetectedObject>& objects) {
+    if (!capture_native_function) {
+        return;
+    }
     
-    return objects;
+    PyObject* pResult = PyObject_CallObject(capture_native_function, nullptr);
+    if (!pResult) {
+        PyErr_Print();
+        return;
+    }
+    // None: kein Kamerabild
+    if (!PyTuple_Check(pResult) || PyTuple_Size(pResult) != 2) {
+        Py_DECREF(pResult);
+        return;
+    }
+    
+    Py_buffer settings;
+    if (PyObject_GetBuffer(PyTuple_GetItem(pResult, 1), &settings, PyBUF_SIMPLE) == 0) {
+        applyNativeSettings(static_cast<const char*>(settings.buf), static_cast<size_t>(settings.len));
+        PyBuffer_Release(&settings);
+    } else {
+        PyErr_Print();
+    }
+    
+    // Crop als Sicht auf das numpy-Bild (H x B x 3, uint8), ohne Kopie
+    Py_buffer frame;
+    if (PyObject_GetBuffer(PyTuple_GetItem(pResult, 0), &frame, PyBUF_STRIDED_RO) != 0) {
+        PyErr_Print();
+        Py_DECREF(pResult);
+        return;
+    }
+    if (frame.ndim == 3 && frame.itemsize == 1 && frame.shape[2] == 3 && frame.strides[2] == 1 &&
+        frame.strides[1] == 3 && frame.strides[0] > 0) {
+        BgrImageView view = {static_cast<const uint8_t*>(frame.buf), static_cast<int>(frame.shape[1]),
+                             static_cast<int>(frame.shape[0]), static_cast<int>(frame.strides[0])};
+        // Der Puffer bleibt bis PyBuffer_Release gültig; Python läuft derweil weiter
+        Py_BEGIN_ALLOW_THREADS
+        native_detector.detect(view, objects);
+        Py_END_ALLOW_THREADS
+    } else {
+        std::cerr << "capture_frame_native: erwartet ein BGR-Bild (H x B x 3, uint8)" << std::endl;
+    }
+    PyBuffer_Release(&frame);
+    Py_DECREF(pResult);
+}
+
+// Ein Frame mit dem gewählten Backend (Aufrufer hält den GIL)
+static void runDetection(std::vector<DetectedObject>& objects) {
+    if (nativeBackend()) {
+        runNativeDetection(objects);
+    } else {
+        runPythonDetection(objects);
+    }
+}
+
+// Zeitpunkt, zu dem cap.read() im letzten Aufruf das Bild lieferte (perf_counter_ns, gleiche
+// Uhr wie steady_clock); 0 ohne Kamerabild oder ohne die Python-Funktion (Aufrufer hält den GIL)
+static int64_t lastCaptureNanos() {
+    if (!capture_time_function) {
+        return 0;
+    }
+    PyObject* pResult = PyObject_CallObject(capture_time_function, nullptr);
+    if (!pResult) {
+        PyErr_Print();
+        return 0;
+    }
+    int64_t nanos = PyLong_Check(pResult) ? static_cast<int64_t>(PyLong_AsLongLong(pResult)) : 0;
+    Py_DECREF(pResult);
+    return nanos;
 }
 
 std::vector<DetectedObject> get_detected_coordinates() {
+    std::vector<DetectedObject> objects;
+    if (!initializePython()) {
+        return objects;
+    }
+    GilLock gil;
+    
     // Initialisiere Detektor beim ersten Aufruf
     if (!detector_initialized) {
         if (!initializeDetector()) {
-            return std::vector<DetectedObject>();
+            return objects;
         }
     }
     
-    return runPythonDetection();
+    runDetection(objects);
+    return objects;
 }
 
-// Neue Funktion um Monitor-Position nachträglich zu setzen
-void configure_monitor_position_delayed(int offset_x, int offset_y) {
-    if (!monitor_configured && detector_initialized) {
-        if (set_python_monitor3_position(offset_x, offset_y)) {
-            monitor_configured = true;
-            std::cout << "Monitor-Position nachträglich erfolgreich konfiguriert: " << offset_x << ", " << offset_y << std::endl;
-        }
-    }
-}
+// === ERKENNUNGS-THREAD ===
+static std::thread detection_thread;
+static std::atomic<bool> detection_thread_running(false);
+static TripleBuffer<DetectionFrame> detection_buffer;
 
-void cleanup_coordinate_detector() {
+// Monitor-Wunsch der Hauptschleife; die CV2-Fenster gehören dem Erkennungs-Thread,
+// der ihn zwischen zwei Frames anwendet
+static std::mutex monitor_request_mutex;
+static bool monitor_request_pending = false;
+static int monitor_request_x = 0;
+static int monitor_request_y = 0;
+
+static bool applyMonitor3Position(int offset_x, int offset_y);
+
+// Python-Detektor aufräumen (Fenster und Kamera) - im Thread, der ihn initialisiert hat
+static void shutdownDetector() {
+    GilLock gil;
     try {
-        // Import Farberkennung module
-        PyObject* pModule = PyImport_ImportModule("Farberkennung");
+        PyObject* pModule = getDetectorModule();
         if (pModule) {
             // Get the cleanup function
             PyObject* pFunc = PyObject_GetAttrString(pModule, "cleanup_detector");
@@ -210,13 +436,126 @@ void cleanup_coordinate_detector() {
                 if (pResult) {
                     Py_DECREF(pResult);
                 }
-                Py_DECREF(pFunc);
             }
-            Py_DECREF(pModule);
+            Py_XDECREF(pFunc);
         }
     } catch (...) {
         std::cerr << "Exception during detector cleanup" << std::endl;
     }
+    detector_initialized = false;
+}
+
+static void applyPendingMonitorRequest() {
+    int offset_x, offset_y;
+    {
+        std::lock_guard<std::mutex> lock(monitor_request_mutex);
+        if (!monitor_request_pending) return;
+        monitor_request_pending = false;
+        offset_x = monitor_request_x;
+        offset_y = monitor_request_y;
+    }
+    applyMonitor3Position(offset_x, offset_y);
+}
+
+static void detectionThreadMain() {
+    {
+        GilLock gil;
+        if (!initializeDetector()) {
+            std::cerr << "Erkennungs-Thread: Detektor konnte nicht initialisiert werden" << std::endl;
+            detection_thread_running = false;
+            return;
+        }
+    }
+    
+    // Erkennungs-Stream für externe Werkzeuge (ersetzt coordinates.json)
+    static DetectionRingWriter detection_ring;
+    if (!detection_ring.isOpen() && !detection_ring.open()) {
+        std::cerr << "Erkennungs-Thread: Shared-Memory-Ring " << DETECTION_RING_NAME << " nicht verfügbar" << std::endl;
+    }
+    
+    uint64_t sequence = 0;
+    while (detection_thread_running) {
+        applyPendingMonitorRequest();
+        
+        DetectionFrame& frame = detection_buffer.writeSlot();
+        frame.objects.clear();
+        auto frameStart = std::chrono::steady_clock::now();
+        int64_t captureNanos;
+        {
+            // GIL nur für den Aufruf; OpenCV gibt ihn während cap.read() und waitKey() selbst frei
+            GilLock gil;
+            runDetection(frame.objects);
+            captureNanos = lastCaptureNanos();
+        }
+        frame.publishTime = std::chrono::steady_clock::now();
+        frame.sequence = ++sequence;
+        frame.captureTime = frameStart;
+        if (captureNanos > 0) {
+            // Uhren beider Seiten sind dieselbe; nur gegen Rundung in den Frame einklemmen
+            frame.captureTime = std::min(std::max(fromRingNanos(captureNanos), frameStart), frame.publishTime);
+            recordLatency(LatencyStage::CAPTURE, frameStart, frame.captureTime);
+            recordLatency(LatencyStage::DETECT, frame.captureTime, frame.publishTime);
+        }
+        for (DetectedObject& object : frame.objects) {
+            object.stamp = FrameStamp(frame.sequence, frame.captureTime);
+        }
+        detection_ring.publish(frame);
+        detection_buffer.publish();
+        
+        // Ohne Kamerabild kehrt die Erkennung sofort zurück - dann nicht im Kreis drehen
+        if (frame.publishTime - frameStart < std::chrono::milliseconds(1)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+    
+    shutdownDetector();
+}
+
+bool start_detection_thread() {
+    if (detection_thread_running) return true;
+    if (detection_thread.joinable()) detection_thread.join();   // Nach fehlgeschlagener Initialisierung
+    if (!initializePython()) {
+        return false;
+    }
+    detection_thread_running = true;
+    detection_thread = std::thread(detectionThreadMain);
+    return true;
+}
+
+void stop_detection_thread() {
+    detection_thread_running = false;
+    if (detection_thread.joinable()) {
+        detection_thread.join();
+    }
+}
+
+bool get_latest_detections(DetectionFrame& frame) {
+    if (!detection_buffer.update()) {
+        return false;
+    }
+    frame = detection_buffer.readSlot();
+    return true;
+}
+
+// Neue Funktion um Monitor-Position nachträglich zu setzen
+void configure_monitor_position_delayed(int offset_x, int offset_y) {
+    if (!monitor_configured && (detector_initialized || detection_thread_running)) {
+        if (set_python_monitor3_position(offset_x, offset_y)) {
+            monitor_configured = true;
+            std::cout << "Monitor-Position nachträglich erfolgreich konfiguriert: " << offset_x << ", " << offset_y << std::endl;
+        }
+    }
+}
+
+void cleanup_coordinate_detector() {
+    // Ein laufender Erkennungs-Thread räumt seinen Detektor beim Beenden selbst auf
+    stop_detection_thread();
+    if (!python_initialized) {
+        return;
+    }
+    if (detector_initialized) {
+        shutdownDetector();
+    }
     cleanupPython();
 }
 
@@ -246,18 +585,18 @@ bool enable_python_monitor3_mode() {
     if (!initializePython()) {
         return false;
     }
+    GilLock gil;
     
     try {
-        PyObject* pModule = PyImport_ImportModule("Farberkennung");
+        PyObject* pModule = getDetectorModule();
         if (!pModule) {
-            PyErr_Print();
             return false;
         }
         
         PyObject* pFunc = PyObject_GetAttrString(pModule, "enable_monitor3_mode");
         if (!pFunc || !PyCallable_Check(pFunc)) {
             PyErr_Print();
-            Py_DECREF(pModule);
+            Py_XDECREF(pFunc);
             return false;
         }
         
@@ -269,7 +608,6 @@ bool enable_python_monitor3_mode() {
         }
         
         Py_DECREF(pFunc);
-        Py_DECREF(pModule);
         return success;
     } catch (...) {
         std::cerr << "Exception during enable_monitor3_mode" << std::endl;
@@ -281,18 +619,18 @@ bool disable_python_monitor3_mode() {
     if (!initializePython()) {
         return false;
     }
+    GilLock gil;
     
     try {
-        PyObject* pModule = PyImport_ImportModule("Farberkennung");
+        PyObject* pModule = getDetectorModule();
         if (!pModule) {
-            PyErr_Print();
             return false;
         }
         
         PyObject* pFunc = PyObject_GetAttrString(pModule, "disable_monitor3_mode");
         if (!pFunc || !PyCallable_Check(pFunc)) {
             PyErr_Print();
-            Py_DECREF(pModule);
+            Py_XDECREF(pFunc);
             return false;
         }
         
@@ -304,7 +642,6 @@ bool disable_python_monitor3_mode() {
         }
         
         Py_DECREF(pFunc);
-        Py_DECREF(pModule);
         return success;
     } catch (...) {
         std::cerr << "Exception during disable_monitor3_mode" << std::endl;
@@ -313,21 +650,33 @@ bool disable_python_monitor3_mode() {
 }
 
 bool set_python_monitor3_position(int offset_x, int offset_y) {
+    // Läuft der Erkennungs-Thread, verschiebt er die Fenster vor seinem nächsten Frame
+    if (detection_thread_running) {
+        std::lock_guard<std::mutex> lock(monitor_request_mutex);
+        monitor_request_pending = true;
+        monitor_request_x = offset_x;
+        monitor_request_y = offset_y;
+        return true;
+    }
+    return applyMonitor3Position(offset_x, offset_y);
+}
+
+static bool applyMonitor3Position(int offset_x, int offset_y) {
     if (!initializePython()) {
         return false;
     }
+    GilLock gil;
     
     try {
-        PyObject* pModule = PyImport_ImportModule("Farberkennung");
+        PyObject* pModule = getDetectorModule();
         if (!pModule) {
-            PyErr_Print();
             return false;
         }
         
         PyObject* pFunc = PyObject_GetAttrString(pModule, "set_monitor3_position");
         if (!pFunc || !PyCallable_Check(pFunc)) {
             PyErr_Print();
-            Py_DECREF(pModule);
+            Py_XDECREF(pFunc);
             return false;
         }
         
@@ -345,10 +694,85 @@ bool set_python_monitor3_position(int offset_x, int offset_y) {
         
         Py_DECREF(pArgs);
         Py_DECREF(pFunc);
-        Py_DECREF(pModule);
         return success;
     } catch (...) {
         std::cerr << "Exception during set_monitor3_position" << std::endl;
         return false;
     }
-}
\ No newline at end of file
+}
+
+// === BRÜCKEN-BENCHMARK ===
+void run_python_bridge_benchmark() {
+    if (!initializePython()) {
+        return;
+    }
+    GilLock gil;
+    
+    // detection_packing braucht weder OpenCV noch Kamera
+    PyObject* packing = PyImport_ImportModule("detection_packing");
+    PyObject* packFunc = packing ? PyObject_GetAttrString(packing, "pack_detections") : nullptr;
+    if (!packFunc) {
+        PyErr_Print();
+        Py_XDECREF(packing);
+        return;
+    }
+    
+    std::cout << "=== Python -> C++ Erkennungsbrücke pro Frame: Dictionary-Liste vs. gepackte Datensätze ===\n";
+    std::cout << std::left << std::setw(10) << "Objekte" << std::right << std::setw(16) << "Vorher [us]"
+              << std::setw(16) << "Nachher [us]" << std::setw(8) << "Same" << "\n";
+    
+    for (int count : {8, 32}) {
+        PyObject* detections = PyObject_CallMethod(packing, "benchmark_detections", "i", count);
+        if (!detections) {
+            PyErr_Print();
+            break;
+        }
+        PyObject* args = Py_BuildValue("(Oii)", detections, 640, 480);
+        const int frames = 20000;
+        
+        // Vorher: Modul und Funktion bei jedem Frame holen, Dictionaries einzeln auslesen
+        std::vector<DetectedObject> before;
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            before.clear();
+            PyObject* module = PyImport_ImportModule("detection_packing");
+            PyObject* func = PyObject_GetAttrString(module, "to_cpp_dicts");
+            PyObject* result = PyObject_CallObject(func, args);
+            parseDetectionDicts(result, before);
+            Py_DECREF(result);
+            Py_DECREF(func);
+            Py_DECREF(module);
+        }
+        double beforeMicros = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6 / frames;
+        
+        // Nachher: gecachte Funktion, bytes über das Buffer-Protokoll mit einem memcpy
+        std::vector<DetectedObject> after;
+        start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            after.clear();
+            PyObject* result = PyObject_CallObject(packFunc, args);
+            readPackedDetections(result, after);
+            Py_DECREF(result);
+        }
+        double afterMicros = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6 / frames;
+        
+        bool same = before.size() == after.size();
+        for (size_t i = 0; same && i < before.size(); i++) {
+            same = before[i].id == after[i].id && before[i].marker == after[i].marker &&
+                   before[i].coordinates.x == after[i].coordinates.x && before[i].coordinates.y == after[i].coordinates.y &&
+                   before[i].area == after[i].area && before[i].crop_width == after[i].crop_width &&
+                   before[i].crop_height == after[i].crop_height;
+        }
+        
+        std::cout << std::left << std::setw(10) << count << std::right << std::fixed << std::setprecision(2)
+                  << std::setw(16) << beforeMicros << std::setw(16) << afterMicros
+                  << std::setw(8) << (same ? "yes" : "NO") << "\n";
+        
+        Py_DECREF(args);
+        Py_DECREF(detections);
+    }
+    std::cout << std::flush;
+    
+    Py_DECREF(packFunc);
+    Py_DECREF(packing);
+}
@@ -49,21 +49,17 @@ void Renderer::drawPoint(const Point& point, int index, bool isSelected) {
     DrawCircle(static_cast<int>(point.x), static_cast<int>(point.y), 12, color);
     DrawCircleLines(static_cast<int>(point.x), static_cast<int>(point.y), 12, BLACK);
 
-    // Draw point type label based on color string
-    if (!point.color.empty()) {
-        if (point.color == "Front") {
+    // Draw point type label based on the marker
+    if (point.marker != MARKER_NONE) {
+        if (isFrontMarker(point.marker)) {
             DrawText("FRONT", static_cast<int>(point.x + 15), static_cast<int>(point.y - 15), 18, BLACK);
-        } else if (point.color.find("Heck") == 0) {
-            // For Heck points, show actual Heck number from color
+        } else if (isHeckMarker(point.marker)) {
+            // For Heck points, show actual Heck number from the marker
             static char heckLabel[16];
-            if (point.color == "Heck1") snprintf(heckLabel, sizeof(heckLabel), "HECK1");
-            else if (point.color == "Heck2") snprintf(heckLabel, sizeof(heckLabel), "HECK2");
-            else if (point.color == "Heck3") snprintf(heckLabel, sizeof(heckLabel), "HECK3");
-            else if (point.color == "Heck4") snprintf(heckLabel, sizeof(heckLabel), "HECK4");
-            else snprintf(heckLabel, sizeof(heckLabel), "HECK?");
+            snprintf(heckLabel, sizeof(heckLabel), "HECK%d", heckNumber(point.marker));
             DrawText(heckLabel, static_cast<int>(point.x + 15), static_cast<int>(point.y - 15), 18, BLACK);
         } else {
-            // Fallback for unknown colors
+            // Fallback for unknown markers
             DrawText("UNKNOWN", static_cast<int>(point.x + 15), static_cast<int>(point.y - 15), 18, BLACK);
         }
     } else {
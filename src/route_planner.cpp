@@ -0,0 +1,95 @@
+#include "route_planner.h"
+#include <algorithm>
+
+RoutePlanner::RoutePlanner(const PathSystem* pathSys, const SegmentManager* segmentMgr, unsigned threadCount)
+    : pathSystem(pathSys), segmentManager(segmentMgr), inFlight(0), stopping(false) {
+    for (unsigned i = 0; i < std::max(1u, threadCount); i++) {
+        workers.emplace_back(&RoutePlanner::workerLoop, this);
+    }
+}
+
+RoutePlanner::~RoutePlanner() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+void RoutePlanner::submit(const RouteRequest& request) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.push_back(request);
+        inFlight++;
+    }
+    wake.notify_one();
+}
+
+std::vector<RouteResult> RoutePlanner::takeCompleted() {
+    std::vector<RouteResult> results;
+    std::lock_guard<std::mutex> lock(mutex);
+    results.swap(completed);
+    inFlight -= results.size();
+    return results;
+}
+
+size_t RoutePlanner::getPendingCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return inFlight;
+}
+
+void RoutePlanner::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wake.wait(lock, [this] { return stopping || !requests.empty(); });
+        if (stopping) return;   // Pending requests are dropped with the planner
+
+        RouteRequest request = requests.front();
+        requests.pop_front();
+
+        lock.unlock();
+        RouteResult result = computeRoute(*pathSystem, *segmentManager, request);
+        lock.lock();
+
+        completed.push_back(std::move(result));
+    }
+}
+
+int RoutePlanner::findStartNode(const PathSystem& pathSystem, const Point& position) {
+    // Nearest node to the vehicle, widening the search radius if needed
+    int nodeId = pathSystem.findNearestNode(position, 300.0f);
+    if (nodeId == -1) nodeId = pathSystem.findNearestNode(position, 500.0f);
+    return nodeId;
+}
+
+RouteResult RoutePlanner::computeRoute(const PathSystem& pathSystem, const SegmentManager& segmentManager,
+                                       const RouteRequest& request) {
+    RouteResult result;
+    result.requestId = request.requestId;
+    result.vehicleId = request.vehicleId;
+    result.targetNodeId = request.targetNodeId;
+    result.layoutVersion = request.layoutVersion;
+
+    result.startNodeId = findStartNode(pathSystem, request.startPosition);
+    if (result.startNodeId == -1 || !pathSystem.getNode(request.targetNodeId)) return result;
+
+    result.nodePath.push_back(result.startNodeId);
+    if (result.startNodeId == request.targetNodeId) return result;
+
+    std::vector<int> segmentPath = segmentManager.findOptimalPath(result.startNodeId, request.targetNodeId,
+                                                                  request.vehicleId);
+    if (segmentPath.empty()) {
+        result.nodePath.clear();
+        return result;
+    }
+
+    // Segment path -> node path: each segment leads to its "other" node
+    for (int segmentId : segmentPath) {
+        const PathSegment* segment = pathSystem.getSegment(segmentId);
+        if (!segment) continue;
+        int lastNode = result.nodePath.back();
+        result.nodePath.push_back(segment->startNodeId == lastNode ? segment->endNodeId : segment->startNodeId);
+    }
+    return result;
+}
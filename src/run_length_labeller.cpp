@@ -0,0 +1,124 @@
+#include "run_length_labeller.h"
+#include <algorithm>
+#include <cstring>
+
+int RunLengthLabeller::findRoot(int run) {
+    while (runs[run].parent != run) {
+        runs[run].parent = runs[runs[run].parent].parent;   // Path halving
+        run = runs[run].parent;
+    }
+    return run;
+}
+
+void RunLengthLabeller::mergeRows(size_t previousBegin, size_t rowBegin) {
+    // Both rows are sorted by (class, x0); walk them like a merge
+    size_t above = previousBegin, current = rowBegin;
+    const size_t rowEnd = runs.size();
+    while (above < rowBegin && current < rowEnd) {
+        Run& upper = runs[above];
+        Run& lower = runs[current];
+        if (upper.classIndex != lower.classIndex) {
+            if (upper.classIndex < lower.classIndex) above++;
+            else current++;
+            continue;
+        }
+        if (upper.x0 <= lower.x1 + 1 && lower.x0 <= upper.x1 + 1) {
+            int rootUpper = findRoot(static_cast<int>(above));
+            int rootLower = findRoot(static_cast<int>(current));
+            if (rootUpper != rootLower) {
+                runs[std::max(rootUpper, rootLower)].parent = std::min(rootUpper, rootLower);
+            }
+            int overlap = std::min(upper.x1, lower.x1) - std::max(upper.x0, lower.x0) + 1;
+            if (overlap > 0) {
+                lower.verticalPairs += overlap;
+                lower.fullQuads += overlap - 1;
+            }
+            // Upper pixel x with lower pixel x + 1, and upper x + 1 with lower x
+            lower.diagonalPairs += std::max(0, std::min(upper.x1, lower.x1 - 1) - std::max(upper.x0, lower.x0 - 1) + 1) +
+                                   std::max(0, std::min(upper.x1 - 1, lower.x1) - std::max(upper.x0 - 1, lower.x0) + 1);
+            lower.diagonalQuads += (lower.x0 == upper.x1 + 1) + (upper.x0 == lower.x1 + 1);
+        }
+        if (upper.x1 < lower.x1) above++;
+        else current++;
+    }
+}
+
+void RunLengthLabeller::label(const uint8_t* classes, int width, int height, int classCount,
+                              std::vector<ClassComponent>& components) {
+    components.clear();
+    runs.clear();
+    const uint8_t classMask = static_cast<uint8_t>((1 << classCount) - 1);
+
+    int runStart[8] = {};
+    size_t previousBegin = 0;
+    for (int y = 0; y < height; y++) {
+        const size_t rowBegin = runs.size();
+        const uint8_t* row = classes + static_cast<size_t>(y) * width;
+        uint8_t previous = 0;
+        for (int x = 0; x <= width; x++) {
+            // Outside any run, skip empty pixels eight at a time
+            if (!previous) {
+                uint64_t word;
+                while (x + 8 <= width && (std::memcpy(&word, row + x, 8), word == 0)) x += 8;
+            }
+            uint8_t value = x < width ? (row[x] & classMask) : 0;
+            if (value == previous) continue;
+            uint8_t ended = previous & ~value;
+            uint8_t started = value & ~previous;
+            for (int c = 0; ended; c++, ended >>= 1) {
+                if (ended & 1) {
+                    int index = static_cast<int>(runs.size());
+                    runs.push_back({runStart[c], x - 1, y, c, index, 0, 0, 0, 0});
+                }
+            }
+            for (int c = 0; started; c++, started >>= 1) {
+                if (started & 1) runStart[c] = x;
+            }
+            previous = value;
+        }
+
+        // Runs closed in x1 order across classes; the merge wants them grouped per class
+        std::sort(runs.begin() + rowBegin, runs.end(), [](const Run& a, const Run& b) {
+            return a.classIndex != b.classIndex ? a.classIndex < b.classIndex : a.x0 < b.x0;
+        });
+        for (size_t i = rowBegin; i < runs.size(); i++) runs[i].parent = static_cast<int>(i);
+        if (y > 0) mergeRows(previousBegin, rowBegin);
+        previousBegin = rowBegin;
+    }
+
+    // Roots are the lowest run index of their component, so they come before all its other runs
+    componentOfRun.resize(runs.size());
+    for (size_t i = 0; i < runs.size(); i++) {
+        int root = findRoot(static_cast<int>(i));
+        const Run& run = runs[i];
+        if (root == static_cast<int>(i)) {
+            componentOfRun[i] = static_cast<int>(components.size());
+            components.push_back({run.classIndex, 0, 0, 0, run.x0, run.y, run.x1, run.y, 0, 0, 0, 0});
+        } else {
+            componentOfRun[i] = componentOfRun[root];
+        }
+
+        ClassComponent& component = components[componentOfRun[i]];
+        int length = run.x1 - run.x0 + 1;
+        component.pixelCount += length;
+        // A full window holds 4 straight and 2 diagonal pixel pairs, three set 2 and 1, side by
+        // side 1 and 0, diagonal 0 and 1. Each straight pair lies in two windows, each diagonal
+        // pair in one, so the window kinds follow linearly from the pair counts
+        int threeQuads = run.diagonalPairs - 2 * run.fullQuads - run.diagonalQuads;
+        component.quadFull += run.fullQuads;
+        component.quadThree += threeQuads;
+        component.quadDiagonal += run.diagonalQuads;
+        component.quadSide += 2 * (length - 1) + 2 * run.verticalPairs - 4 * run.fullQuads - 2 * threeQuads;
+        component.sumX += static_cast<int64_t>(run.x0 + run.x1) * length / 2;
+        component.sumY += static_cast<int64_t>(run.y) * length;
+        component.minX = std::min(component.minX, run.x0);
+        component.maxX = std::max(component.maxX, run.x1);
+        component.minY = std::min(component.minY, run.y);
+        component.maxY = std::max(component.maxY, run.y);
+    }
+
+    // Per class in raster order of the first pixel (the root run's row and x0)
+    std::stable_sort(components.begin(), components.end(), [](const ClassComponent& a, const ClassComponent& b) {
+        return a.classIndex < b.classIndex;
+    });
+}
@@ -2,114 +2,462 @@
 #include "segment_manager.h"
 #include <algorithm>
 #include <iostream>
+#include <cmath>
+#include <limits>
 
-SegmentManager::SegmentManager(PathSystem* pathSys) : pathSystem(pathSys) {}
+namespace {
+
+const SegmentQueue::Entry* findQueueEntry(const SegmentReservationState& state, int vehicleId) {
+    for (const auto& entry : state.queue) {
+        if (entry.vehicleId == vehicleId) return &entry;
+    }
+    return nullptr;
+}
+
+// Snapshot counterpart of SegmentManager::leaveQueue: the entry may be anywhere in the queue
+bool removeQueueEntry(SegmentReservationState& state, int vehicleId) {
+    auto it = std::find_if(state.queue.begin(), state.queue.end(),
+                           [vehicleId](const SegmentQueue::Entry& entry) { return entry.vehicleId == vehicleId; });
+    if (it == state.queue.end()) return false;
+    state.queue.erase(it);
+    return true;
+}
+
+} // namespace
+
+SegmentManager::SegmentManager(PathSystem* pathSys)
+    : pathSystem(pathSys), currentTime(0.0), journal(nullptr), journalDepth(0), queueSequence(0),
+      segmentQueues(pathSys->getSegmentCount()),
+      statistics(pathSys->getSegmentCount()), fallbackSpeed(100.0f) {
+    reservations.segments.resize(pathSys->getSegmentCount());
+}
+
+int SegmentManager::getSegmentCapacity(int segmentId) const {
+    const PathSegment* segment = pathSystem->getSegment(segmentId);
+    if (!segment) return 0;
+    if (!platoonConfig.enabled || platoonConfig.vehicleSpacing <= 0.0f) return 1;
+
+    int capacity = static_cast<int>(segment->length / platoonConfig.vehicleSpacing);
+    return std::max(1, capacity);
+}
 
 bool SegmentManager::canVehicleEnterSegment(int segmentId, int vehicleId) const {
-    PathSegment* segment = pathSystem->getSegment(segmentId);
-    if (!segment) return false;
-    
-    // Vehicle can enter if segment is free or already occupied by this vehicle
-    return !segment->isOccupied || segment->occupiedByVehicleId == vehicleId;
+    return canVehicleEnterSegment(segmentId, vehicleId, -1);
+}
+
+bool SegmentManager::canVehicleEnterSegment(int segmentId, int vehicleId, int fromNodeId) const {
+    if (!pathSystem->getSegment(segmentId)) return false;
+
+    // Every segment of the corridor ahead must admit the vehicle. Segments added since
+    // the last update() have no mirrored state yet, i.e. they are free.
+    static const SegmentReservationState freeSegment;
+    const SegmentQueue::Entry* queued = nullptr;
+    for (const auto& [memberId, memberFromNodeId] : getCorridorAhead(segmentId, fromNodeId)) {
+        bool mirrored = memberId < static_cast<int>(reservations.segments.size());
+        const SegmentReservationState& state = mirrored ? reservations.segments.get(memberId) : freeSegment;
+        if (!admits(state, memberId, vehicleId, memberFromNodeId, currentTime, queued)) return false;
+        if (memberId == segmentId) queued = findQueueEntry(state, vehicleId);
+    }
+    return true;
+}
+
+bool SegmentManager::admits(const SegmentReservationState& state, int segmentId, int vehicleId,
+                            int fromNodeId, double now, const SegmentQueue::Entry* corridorEntry) const {
+    const auto& occupants = state.occupantVehicleIds;
+    if (std::find(occupants.begin(), occupants.end(), vehicleId) != occupants.end()) {
+        return true;
+    }
+
+    // Waiting vehicles go first - only the head of the queue (by policy) may enter.
+    // Further corridor members may also be taken by the head of the entered segment's
+    // queue if it queued earlier; two heads in one group would otherwise wait on each other.
+    if (!state.queue.empty() && state.queue.front().vehicleId != vehicleId &&
+        (!corridorEntry || corridorEntry->sequence > state.queue.front().sequence)) {
+        return false;
+    }
+
+    if (occupants.empty()) {
+        return true;
+    }
+
+    // Join an existing platoon: same direction, capacity left, headway respected
+    if (fromNodeId == -1 || state.occupiedFromNodeId != fromNodeId) {
+        return false;
+    }
+    if (static_cast<int>(occupants.size()) >= getSegmentCapacity(segmentId)) {
+        return false;
+    }
+    return now - state.lastEntryTime >= platoonConfig.minHeadwayTime;
 }
 
 bool SegmentManager::reserveSegment(int segmentId, int vehicleId) {
+    return reserveSegment(segmentId, vehicleId, -1);
+}
+
+bool SegmentManager::reserveSegment(int segmentId, int vehicleId, int fromNodeId) {
+    JournalDepthGuard depth(journalDepth);
+    bool reserved = reserveCorridor(segmentId, vehicleId, fromNodeId);
+    journalEvent(JournalEventType::RESERVE, vehicleId, segmentId, fromNodeId, 0.0f, 0.0f,
+                 reserved ? 0 : JOURNAL_FAILED);
+    return reserved;
+}
+
+bool SegmentManager::reserveCorridor(int segmentId, int vehicleId, int fromNodeId) {
     PathSegment* segment = pathSystem->getSegment(segmentId);
     if (!segment) return false;
+
+    // Already reserved together with the corridor: just enter it
+    if (enterHeldSegment(segmentId, vehicleId)) {
+        leaveQueue(segmentId, vehicleId);
+        return true;
+    }
     
-    // Check if segment can be reserved
-    if (segment->isOccupied && segment->occupiedByVehicleId != vehicleId) {
+    // Check if the whole corridor can be reserved
+    if (!canVehicleEnterSegment(segmentId, vehicleId, fromNodeId)) {
         return false;
     }
-    
-    // Reserve segment
+
+    auto& occupants = segment->occupantVehicleIds;
+    if (std::find(occupants.begin(), occupants.end(), vehicleId) != occupants.end()) {
+        leaveQueue(segmentId, vehicleId);
+        return true;
+    }
+
+    leaveQueue(segmentId, vehicleId);
+
+    // Reserve the entered segment and hold the rest of its group in one step
+    std::vector<std::pair<int, int>> corridor = getCorridorAhead(segmentId, fromNodeId);
+    for (size_t i = 0; i < corridor.size(); i++) {
+        occupySegment(corridor[i].first, vehicleId, corridor[i].second, i == 0);
+    }
+
+    // Holds from an earlier corridor the vehicle did not follow are given back
+    // (afterwards, as releasing admits queued vehicles)
+    dropHeldSegments(vehicleId, corridor);
+    return true;
+}
+
+void SegmentManager::occupySegment(int segmentId, int vehicleId, int fromNodeId, bool entered) {
+    PathSegment* segment = pathSystem->getSegment(segmentId);
+    if (!segment) return;
+
+    auto& occupants = segment->occupantVehicleIds;
+    if (std::find(occupants.begin(), occupants.end(), vehicleId) != occupants.end()) return;
+
+    if (occupants.empty()) {
+        segment->occupiedFromNodeId = fromNodeId;
+        segment->occupiedByVehicleId = vehicleId;
+    }
+    occupants.push_back(vehicleId);
     segment->isOccupied = true;
-    segment->occupiedByVehicleId = vehicleId;
+    segment->lastEntryTime = currentTime;
+
+    if (entered) {
+        vehicleToSegment[vehicleId] = segmentId;
+        vehicleEntryTime[vehicleId] = currentTime;
+    } else {
+        heldSegments[vehicleId].push_back(segmentId);
+    }
+    publishSegment(segmentId);
+}
+
+void SegmentManager::leaveQueue(int segmentId, int vehicleId) {
+    SegmentQueue* queue = getQueue(segmentId);
+    if (!queue || !queue->contains(vehicleId)) return;
+
+    // Admitted from the head of the queue: record the dwell time
+    if (queue->top().vehicleId == vehicleId) {
+        statistics.recordDwell(segmentId, currentTime - queue->top().enqueueTime);
+    }
+    queue->remove(vehicleId);
+    publishSegment(segmentId);
+}
+
+bool SegmentManager::isHeldBy(int segmentId, int vehicleId) const {
+    auto held = heldSegments.find(vehicleId);
+    if (held == heldSegments.end()) return false;
+    return std::find(held->second.begin(), held->second.end(), segmentId) != held->second.end();
+}
+
+bool SegmentManager::enterHeldSegment(int segmentId, int vehicleId) {
+    auto held = heldSegments.find(vehicleId);
+    if (held == heldSegments.end()) return false;
+    auto it = std::find(held->second.begin(), held->second.end(), segmentId);
+    if (it == held->second.end()) return false;
+
+    held->second.erase(it);
+    if (held->second.empty()) heldSegments.erase(held);
+
     vehicleToSegment[vehicleId] = segmentId;
-    
-    std::cout << "Vehicle " << vehicleId << " reserved segment " << segmentId << std::endl;
+    vehicleEntryTime[vehicleId] = currentTime;
+    publishSegment(segmentId);
     return true;
 }
 
+void SegmentManager::dropHeldSegments(int vehicleId, const std::vector<std::pair<int, int>>& keep) {
+    auto held = heldSegments.find(vehicleId);
+    if (held == heldSegments.end()) return;
+
+    std::vector<int> stale;
+    for (int segmentId : held->second) {
+        bool kept = std::any_of(keep.begin(), keep.end(),
+                                [segmentId](const std::pair<int, int>& member) { return member.first == segmentId; });
+        if (!kept) stale.push_back(segmentId);
+    }
+    for (int segmentId : stale) {
+        releaseSegment(segmentId, vehicleId);
+    }
+}
+
 void SegmentManager::releaseSegment(int segmentId, int vehicleId) {
+    JournalDepthGuard depth(journalDepth);
+    journalEvent(JournalEventType::RELEASE, vehicleId, segmentId, -1);
+
     PathSegment* segment = pathSystem->getSegment(segmentId);
     if (!segment) return;
     
     // Only release if this vehicle actually occupies it
-    if (segment->isOccupied && segment->occupiedByVehicleId == vehicleId) {
+    auto& occupants = segment->occupantVehicleIds;
+    auto it = std::find(occupants.begin(), occupants.end(), vehicleId);
+    if (it == occupants.end()) return;
+
+    occupants.erase(it);
+    if (occupants.empty()) {
         segment->isOccupied = false;
         segment->occupiedByVehicleId = -1;
-        vehicleToSegment.erase(vehicleId);
-        
-        // Process any queued vehicles for this segment
-        processQueue(segmentId);
-        
-        std::cout << "Vehicle " << vehicleId << " released segment " << segmentId << std::endl;
+        segment->occupiedFromNodeId = -1;
+    } else {
+        segment->occupiedByVehicleId = occupants.front();
+    }
+
+    auto mapping = vehicleToSegment.find(vehicleId);
+    if (mapping != vehicleToSegment.end() && mapping->second == segmentId) {
+        vehicleToSegment.erase(mapping);
+
+        auto entered = vehicleEntryTime.find(vehicleId);
+        if (entered != vehicleEntryTime.end()) {
+            statistics.recordTraversal(segmentId, currentTime - entered->second);
+            vehicleEntryTime.erase(entered);
+        }
+    }
+
+    auto held = heldSegments.find(vehicleId);
+    if (held != heldSegments.end()) {
+        held->second.erase(std::remove(held->second.begin(), held->second.end(), segmentId), held->second.end());
+        if (held->second.empty()) heldSegments.erase(held);
+    }
+    publishSegment(segmentId);
+    
+    // Process queued vehicles of the whole group (their corridor may have included this segment)
+    for (int memberId : getConsolidatedSegmentGroup(segmentId)) {
+        processQueue(memberId);
     }
 }
 
 void SegmentManager::addToQueue(int segmentId, int vehicleId) {
-    PathSegment* segment = pathSystem->getSegment(segmentId);
-    if (!segment) return;
+    addToQueue(segmentId, vehicleId, -1);
+}
+
+void SegmentManager::addToQueue(int segmentId, int vehicleId, int fromNodeId) {
+    JournalDepthGuard depth(journalDepth);
+    journalEvent(JournalEventType::ENQUEUE, vehicleId, segmentId, fromNodeId);
+
+    SegmentQueue* queue = getQueue(segmentId);
+    if (!queue) return;
     
-    // Check if vehicle is already in queue
-    auto& queue = segment->queuedVehicles;
-    if (std::find(queue.begin(), queue.end(), vehicleId) == queue.end()) {
-        queue.push_back(vehicleId);
+    // Already queued: keep the position, only refresh the entry node
+    if (SegmentQueue::Entry* existing = queue->find(vehicleId)) {
+        if (existing->fromNodeId != fromNodeId) {
+            existing->fromNodeId = fromNodeId;
+            publishSegment(segmentId);
+        }
+        return;
     }
+
+    SegmentQueue::Entry entry;
+    entry.vehicleId = vehicleId;
+    entry.fromNodeId = fromNodeId;
+    entry.enqueueTime = currentTime;
+    entry.key = queueKey(vehicleId, currentTime);
+    entry.sequence = queueSequence++;
+    queue->push(entry);
+    publishSegment(segmentId);
 }
 
 void SegmentManager::removeFromQueue(int segmentId, int vehicleId) {
-    PathSegment* segment = pathSystem->getSegment(segmentId);
-    if (!segment) return;
-    
-    auto& queue = segment->queuedVehicles;
-    queue.erase(std::remove(queue.begin(), queue.end(), vehicleId), queue.end());
+    JournalDepthGuard depth(journalDepth);
+    journalEvent(JournalEventType::DEQUEUE, vehicleId, segmentId, -1);
+
+    SegmentQueue* queue = getQueue(segmentId);
+    if (queue && queue->remove(vehicleId)) {
+        publishSegment(segmentId);
+    }
 }
 
 void SegmentManager::processQueue(int segmentId) {
-    PathSegment* segment = pathSystem->getSegment(segmentId);
-    if (!segment || segment->isOccupied || segment->queuedVehicles.empty()) return;
-    
-    // Try to assign segment to first vehicle in queue
-    int nextVehicleId = segment->queuedVehicles.front();
-    segment->queuedVehicles.erase(segment->queuedVehicles.begin());
+    JournalDepthGuard depth(journalDepth);
+    journalEvent(JournalEventType::PROCESS_QUEUE, -1, segmentId, -1);
+
+    SegmentQueue* queue = getQueue(segmentId);
+    if (!queue) return;
     
-    if (reserveSegment(segmentId, nextVehicleId)) {
-        std::cout << "Segment " << segmentId << " assigned to queued vehicle " << nextVehicleId << std::endl;
-    } else {
-        // If reservation failed, put vehicle back at front of queue
-        segment->queuedVehicles.insert(segment->queuedVehicles.begin(), nextVehicleId);
+    // Admit vehicles from the head of the queue as long as they fit (several for platoons)
+    while (!queue->empty()) {
+        int nextVehicleId = queue->top().vehicleId;
+        int fromNodeId = queue->top().fromNodeId;
+
+        // Reserving from the head of the queue also dequeues the vehicle
+        if (!reserveSegment(segmentId, nextVehicleId, fromNodeId)) break;
     }
 }
 
 void SegmentManager::updateQueues() {
-    // Process all segment queues
-    for (const auto& segment : pathSystem->getSegments()) {
-        if (!segment.isOccupied && !segment.queuedVehicles.empty()) {
-            processQueue(segment.segmentId);
+    JournalDepthGuard depth(journalDepth);
+    journalEvent(JournalEventType::UPDATE_QUEUES, -1, -1, -1);
+
+    // Process all segment queues (occupied segments may still admit platoon followers)
+    for (size_t segmentId = 0; segmentId < segmentQueues.size(); segmentId++) {
+        if (!segmentQueues[segmentId].empty()) {
+            processQueue(static_cast<int>(segmentId));
         }
     }
 }
 
+const SegmentQueue* SegmentManager::getSegmentQueue(int segmentId) const {
+    if (segmentId < 0 || segmentId >= static_cast<int>(segmentQueues.size())) return nullptr;
+    return &segmentQueues[segmentId];
+}
+
+SegmentQueue* SegmentManager::getQueue(int segmentId) {
+    if (segmentId < 0 || segmentId >= static_cast<int>(pathSystem->getSegmentCount())) return nullptr;
+    if (segmentId >= static_cast<int>(segmentQueues.size())) {
+        segmentQueues.resize(pathSystem->getSegmentCount());
+        reservations.segments.resize(pathSystem->getSegmentCount());
+    }
+    return &segmentQueues[segmentId];
+}
+
+double SegmentManager::queueKey(int vehicleId, double enqueueTime) const {
+    VehicleQueueInfo info;
+    auto it = vehicleQueueInfo.find(vehicleId);
+    if (it != vehicleQueueInfo.end()) info = it->second;
+
+    switch (queueConfig.policy) {
+        case QueuePolicy::PRIORITY:
+            return -info.urgency;
+        case QueuePolicy::SHORTEST_REMAINING_ROUTE:
+            return info.remainingRoute;
+        case QueuePolicy::AGING:
+            // urgency + agingRate * (now - enqueueTime) compared at any common "now"
+            return queueConfig.agingRate * enqueueTime - info.urgency;
+        case QueuePolicy::FIFO:
+        default:
+            return enqueueTime;
+    }
+}
+
+void SegmentManager::setVehicleQueueInfo(int vehicleId, const VehicleQueueInfo& info) {
+    JournalDepthGuard depth(journalDepth);
+    journalEvent(JournalEventType::QUEUE_INFO, vehicleId, -1, -1, info.urgency, info.remainingRoute);
+    vehicleQueueInfo[vehicleId] = info;
+}
+
+void SegmentManager::setPlatoonConfig(const PlatoonConfig& config) {
+    JournalDepthGuard depth(journalDepth);
+    journalEvent(JournalEventType::PLATOON_CONFIG, -1, -1, config.enabled ? 1 : 0,
+                 config.vehicleSpacing, config.minHeadwayTime);
+    platoonConfig = config;
+}
+
+void SegmentManager::setQueueConfig(const QueueConfig& config) {
+    JournalDepthGuard depth(journalDepth);
+    journalEvent(JournalEventType::QUEUE_CONFIG, -1, -1, static_cast<int>(config.policy), config.agingRate);
+    queueConfig = config;
+    for (size_t segmentId = 0; segmentId < segmentQueues.size(); segmentId++) {
+        if (segmentQueues[segmentId].empty()) continue;
+        segmentQueues[segmentId].rekey([this](const SegmentQueue::Entry& entry) {
+            return queueKey(entry.vehicleId, entry.enqueueTime);
+        });
+        publishSegment(static_cast<int>(segmentId));
+    }
+}
+
+void SegmentManager::update(float deltaTime) {
+    JournalDepthGuard depth(journalDepth);
+    currentTime += deltaTime;
+    journalEvent(JournalEventType::CLOCK, -1, -1, -1, deltaTime);
+
+    // Segment IDs are contiguous, so the statistics only need resizing when the layout grew
+    if (statistics.getSegmentCount() != pathSystem->getSegmentCount()) {
+        statistics.reset(pathSystem->getSegmentCount());
+    }
+    if (segmentQueues.size() < pathSystem->getSegmentCount()) {
+        segmentQueues.resize(pathSystem->getSegmentCount());
+        reservations.segments.resize(pathSystem->getSegmentCount());
+    }
+    // Rebuild lookup tables here rather than lazily inside const queries that may run in parallel
+    getLookupTables();
+
+    updateQueues();
+}
+
+void SegmentManager::journalEvent(JournalEventType type, int vehicleId, int segmentId, int nodeId,
+                                  float value, float value2, uint16_t flags) const {
+    if (!journal) return;
+
+    // Cascades that did not change anything are reproduced by replay and only add noise
+    bool derived = journalDepth > 1;
+    if (derived && (type == JournalEventType::UPDATE_QUEUES || type == JournalEventType::PROCESS_QUEUE ||
+                    (type == JournalEventType::RESERVE && (flags & JOURNAL_FAILED)))) {
+        return;
+    }
+
+    JournalEvent event;
+    event.sequence = 0;
+    event.time = currentTime;
+    event.type = static_cast<uint16_t>(type);
+    event.flags = flags | (derived ? JOURNAL_DERIVED : 0);
+    event.vehicleId = vehicleId;
+    event.segmentId = segmentId;
+    event.nodeId = nodeId;
+    event.value = value;
+    event.value2 = value2;
+    event.droppedBefore = 0;
+    journal->record(event);
+}
+
 int SegmentManager::getVehicleSegment(int vehicleId) const {
     auto it = vehicleToSegment.find(vehicleId);
     return (it != vehicleToSegment.end()) ? it->second : -1;
 }
 
 void SegmentManager::removeVehicle(int vehicleId) {
+    JournalDepthGuard depth(journalDepth);
+    journalEvent(JournalEventType::REMOVE_VEHICLE, vehicleId, -1, -1);
+
     // Release any occupied segment
     int currentSegment = getVehicleSegment(vehicleId);
     if (currentSegment != -1) {
         releaseSegment(currentSegment, vehicleId);
     }
 
+    // Give back corridor holds
+    auto held = heldSegments.find(vehicleId);
+    if (held != heldSegments.end()) {
+        std::vector<int> heldCopy = held->second;
+        for (int segmentId : heldCopy) releaseSegment(segmentId, vehicleId);
+    }
+
     // Remove from all queues
-    for (const auto& segment : pathSystem->getSegments()) {
-        removeFromQueue(segment.segmentId, vehicleId);
+    for (size_t segmentId = 0; segmentId < segmentQueues.size(); segmentId++) {
+        if (segmentQueues[segmentId].remove(vehicleId)) {
+            publishSegment(static_cast<int>(segmentId));
+        }
     }
 
     vehicleToSegment.erase(vehicleId);
+    vehicleEntryTime.erase(vehicleId);
+    vehicleQueueInfo.erase(vehicleId);
 }
 
 std::vector<int> SegmentManager::findAvailablePath(int startNodeId, int endNodeId, int vehicleId) const {
@@ -164,21 +512,34 @@ std::vector<int> SegmentManager::getOccupiedSegments() const {
     return occupied;
 }
 
+std::vector<int> SegmentManager::getHeldSegments(int vehicleId) const {
+    auto held = heldSegments.find(vehicleId);
+    if (held == heldSegments.end()) return {};
+    std::vector<int> segmentIds = held->second;
+    std::sort(segmentIds.begin(), segmentIds.end());
+    return segmentIds;
+}
+
 void SegmentManager::printSegmentStatus() const {
     std::cout << "=== Segment Status ===" << std::endl;
     for (const auto& segment : pathSystem->getSegments()) {
         std::cout << "Segment " << segment.segmentId << ": ";
         if (segment.isOccupied) {
             std::cout << "OCCUPIED by vehicle " << segment.occupiedByVehicleId;
+            if (segment.occupantVehicleIds.size() > 1) {
+                std::cout << " (+" << (segment.occupantVehicleIds.size() - 1) << " following)";
+            }
         } else {
             std::cout << "FREE";
         }
         
-        if (!segment.queuedVehicles.empty()) {
+        const SegmentQueue* queue = getSegmentQueue(segment.segmentId);
+        if (queue && !queue->empty()) {
+            std::vector<SegmentQueue::Entry> waiting = queue->ordered();
             std::cout << " (Queue: ";
-            for (size_t i = 0; i < segment.queuedVehicles.size(); i++) {
-                std::cout << segment.queuedVehicles[i];
-                if (i < segment.queuedVehicles.size() - 1) std::cout << ", ";
+            for (size_t i = 0; i < waiting.size(); i++) {
+                std::cout << waiting[i].vehicleId;
+                if (i < waiting.size() - 1) std::cout << ", ";
             }
             std::cout << ")";
         }
@@ -187,31 +548,707 @@ void SegmentManager::printSegmentStatus() const {
     std::cout << "===================" << std::endl;
 }
 
+// === Time estimation ===
+
+float SegmentManager::estimateSegmentTime(int segmentId) const {
+    float observed = statistics.getTraversalEstimate(segmentId);
+    if (observed >= 0.0f) return observed;
+
+    const PathSegment* segment = pathSystem->getSegment(segmentId);
+    if (!segment || fallbackSpeed <= 0.0f) return 0.0f;
+    return segment->length / fallbackSpeed;
+}
+
+float SegmentManager::estimatePathTime(const std::vector<int>& path, int vehicleId) const {
+    float total = 0.0f;
+    for (int segmentId : path) {
+        total += estimateSegmentTime(segmentId);
+    }
+    return total;
+}
+
+float SegmentManager::estimateWaitTime(int segmentId, int vehicleId) const {
+    const PathSegment* segment = pathSystem->getSegment(segmentId);
+    if (!segment) return 0.0f;
+
+    const auto& occupants = segment->occupantVehicleIds;
+    if (std::find(occupants.begin(), occupants.end(), vehicleId) != occupants.end()) return 0.0f;
+
+    // Vehicles ahead of us: our queue position, or the whole queue if we are not queued yet
+    const SegmentQueue* queue = getSegmentQueue(segmentId);
+    size_t vehiclesAhead = queue ? queue->countAhead(vehicleId) : 0;
+
+    if (occupants.empty() && vehiclesAhead == 0) return 0.0f;
+
+    float traversal = estimateSegmentTime(segmentId);
+
+    // Remaining time of the current occupants (the last one to enter leaves last)
+    float remaining = 0.0f;
+    if (!occupants.empty()) {
+        remaining = std::max(0.0f, traversal - static_cast<float>(currentTime - segment->lastEntryTime));
+    }
+
+    // Each further "round" admits up to capacity vehicles, one traversal each
+    int capacity = getSegmentCapacity(segmentId);
+    float rounds = std::ceil(static_cast<float>(vehiclesAhead) / std::max(1, capacity));
+    float modelled = remaining + rounds * traversal;
+
+    // Never promise less than the typical observed dwell once the segment is contested
+    float observedDwell = statistics.getDwellEstimate(segmentId);
+    return std::max(modelled, observedDwell);
+}
+
+bool SegmentManager::shouldWaitOrReroute(int currentNodeId, int targetNodeId, int blockedSegmentId, int vehicleId) const {
+    // true = wait for the blocked segment, false = take the detour
+    std::vector<int> directPath = pathSystem->findPath(currentNodeId, targetNodeId);
+    std::vector<int> detour = pathSystem->findPath(currentNodeId, targetNodeId, {blockedSegmentId});
+    if (detour.empty()) return true;
+
+    float waitCost = estimateWaitTime(blockedSegmentId, vehicleId) + estimatePathTime(directPath, vehicleId);
+    float rerouteCost = estimatePathTime(detour, vehicleId);
+
+    // Detour occupancy also costs time
+    for (int segmentId : detour) {
+        rerouteCost += estimateWaitTime(segmentId, vehicleId);
+    }
+    if (waitCost <= rerouteCost) return true;
+
+    // The estimates favor the detour; take it only if a speculative reservation gets in now.
+    // Leaving through the junction's evasion segment, the whole evasion route must be drivable,
+    // any other detour must at least get its first corridor.
+    if (detour.front() == findEvasionSegment(currentNodeId, blockedSegmentId)) {
+        return !canUseEvasionRoute(currentNodeId, targetNodeId, blockedSegmentId, vehicleId);
+    }
+    ReservationSnapshot whatIf = snapshot();
+    return !reserveSegment(whatIf, detour.front(), vehicleId, currentNodeId);
+}
+
+// === Copy-on-write snapshots ===
+
+ReservationSnapshot SegmentManager::snapshot() const {
+    ReservationSnapshot copy = reservations;
+    copy.currentTime = currentTime;
+    copy.queueSequence = queueSequence;
+    return copy;
+}
+
+void SegmentManager::publishSegment(int segmentId) {
+    const PathSegment* segment = pathSystem->getSegment(segmentId);
+    if (!segment) return;
+    if (segmentId >= static_cast<int>(reservations.segments.size())) {
+        reservations.segments.resize(pathSystem->getSegmentCount());
+    }
+
+    SegmentReservationState state;
+    state.occupantVehicleIds = segment->occupantVehicleIds;
+    for (int vehicleId : segment->occupantVehicleIds) {
+        auto entered = vehicleEntryTime.find(vehicleId);
+        state.occupantEntryTimes.push_back(entered != vehicleEntryTime.end() ? entered->second : currentTime);
+    }
+    for (int vehicleId : segment->occupantVehicleIds) {
+        if (isHeldBy(segmentId, vehicleId)) state.heldVehicleIds.push_back(vehicleId);
+    }
+    state.occupiedFromNodeId = segment->occupiedFromNodeId;
+    state.lastEntryTime = segment->lastEntryTime;
+    if (const SegmentQueue* queue = getSegmentQueue(segmentId)) {
+        state.queue = queue->ordered();
+    }
+    reservations.segments.set(segmentId, state);
+}
+
+void SegmentManager::restoreSegment(int segmentId, const SegmentReservationState& state) {
+    PathSegment* segment = pathSystem->getSegment(segmentId);
+    SegmentQueue* queue = getQueue(segmentId);
+    if (!segment || !queue) return;
+
+    // Drop the current occupants' mappings, then install the snapshot's
+    for (int vehicleId : segment->occupantVehicleIds) {
+        auto mapping = vehicleToSegment.find(vehicleId);
+        if (mapping != vehicleToSegment.end() && mapping->second == segmentId) {
+            vehicleToSegment.erase(mapping);
+            vehicleEntryTime.erase(vehicleId);
+        }
+        auto held = heldSegments.find(vehicleId);
+        if (held != heldSegments.end()) {
+            held->second.erase(std::remove(held->second.begin(), held->second.end(), segmentId), held->second.end());
+            if (held->second.empty()) heldSegments.erase(held);
+        }
+    }
+
+    segment->occupantVehicleIds = state.occupantVehicleIds;
+    segment->isOccupied = !state.occupantVehicleIds.empty();
+    segment->occupiedByVehicleId = segment->isOccupied ? state.occupantVehicleIds.front() : -1;
+    segment->occupiedFromNodeId = state.occupiedFromNodeId;
+    segment->lastEntryTime = state.lastEntryTime;
+    for (size_t i = 0; i < state.occupantVehicleIds.size(); i++) {
+        int vehicleId = state.occupantVehicleIds[i];
+        const auto& heldIds = state.heldVehicleIds;
+        if (std::find(heldIds.begin(), heldIds.end(), vehicleId) != heldIds.end()) {
+            heldSegments[vehicleId].push_back(segmentId);
+        } else {
+            vehicleToSegment[vehicleId] = segmentId;
+            vehicleEntryTime[vehicleId] = state.occupantEntryTimes[i];
+        }
+    }
+
+    queue->clear();
+    for (const SegmentQueue::Entry& entry : state.queue) {
+        queue->push(entry);
+    }
+}
+
+void SegmentManager::rollback(const ReservationSnapshot& snapshot) {
+    JournalDepthGuard depth(journalDepth);
+    journalEvent(JournalEventType::ROLLBACK, -1, -1, -1, snapshot.currentTime);
+
+    // Only chunks that diverged since the snapshot need to be written back.
+    // The layout must not have changed in between.
+    size_t segmentCount = std::min(snapshot.segments.size(), reservations.segments.size());
+    const size_t chunkSize = PersistentArray<SegmentReservationState>::CHUNK_SIZE;
+
+    for (size_t chunk = 0; chunk * chunkSize < segmentCount; chunk++) {
+        if (reservations.segments.sharesChunk(snapshot.segments, chunk)) continue;
+
+        size_t end = std::min(segmentCount, (chunk + 1) * chunkSize);
+        for (size_t segmentId = chunk * chunkSize; segmentId < end; segmentId++) {
+            restoreSegment(static_cast<int>(segmentId), snapshot.segments.get(segmentId));
+        }
+    }
+
+    reservations.segments = snapshot.segments;
+    reservations.segments.resize(pathSystem->getSegmentCount());
+    currentTime = snapshot.currentTime;
+    queueSequence = snapshot.queueSequence;
+}
+
+bool SegmentManager::canVehicleEnterSegment(const ReservationSnapshot& state, int segmentId, int vehicleId,
+                                            int fromNodeId) const {
+    if (segmentId < 0 || segmentId >= static_cast<int>(state.segments.size())) return false;
+
+    const SegmentQueue::Entry* queued = nullptr;
+    for (const auto& [memberId, memberFromNodeId] : getCorridorAhead(segmentId, fromNodeId)) {
+        if (memberId >= static_cast<int>(state.segments.size())) return false;
+        const SegmentReservationState& member = state.segments.get(memberId);
+        if (!admits(member, memberId, vehicleId, memberFromNodeId, state.currentTime, queued)) {
+            return false;
+        }
+        if (memberId == segmentId) queued = findQueueEntry(member, vehicleId);
+    }
+    return true;
+}
+
+bool SegmentManager::reserveSegment(ReservationSnapshot& state, int segmentId, int vehicleId, int fromNodeId) const {
+    if (segmentId < 0 || segmentId >= static_cast<int>(state.segments.size())) return false;
+
+    // Mirrors reserveCorridor(): entering a held corridor member
+    const auto& heldIds = state.segments.get(segmentId).heldVehicleIds;
+    if (std::find(heldIds.begin(), heldIds.end(), vehicleId) != heldIds.end()) {
+        SegmentReservationState segment = state.segments.get(segmentId);
+        auto held = std::find(segment.heldVehicleIds.begin(), segment.heldVehicleIds.end(), vehicleId);
+        segment.heldVehicleIds.erase(held);
+        auto occupant = std::find(segment.occupantVehicleIds.begin(), segment.occupantVehicleIds.end(), vehicleId);
+        segment.occupantEntryTimes[occupant - segment.occupantVehicleIds.begin()] = state.currentTime;
+        removeQueueEntry(segment, vehicleId);
+        state.segments.set(segmentId, segment);
+        return true;
+    }
+
+    if (!canVehicleEnterSegment(state, segmentId, vehicleId, fromNodeId)) return false;
+
+    const auto& occupants = state.segments.get(segmentId).occupantVehicleIds;
+    if (std::find(occupants.begin(), occupants.end(), vehicleId) != occupants.end()) {
+        SegmentReservationState segment = state.segments.get(segmentId);
+        if (removeQueueEntry(segment, vehicleId)) state.segments.set(segmentId, segment);
+        return true;
+    }
+
+    // Dequeue from the entered segment (at any position, e.g. a platoon follower), occupy the
+    // entered segment and hold the rest of the group
+    std::vector<std::pair<int, int>> corridor = getCorridorAhead(segmentId, fromNodeId);
+    for (size_t i = 0; i < corridor.size(); i++) {
+        SegmentReservationState segment = state.segments.get(corridor[i].first);
+        auto& members = segment.occupantVehicleIds;
+        if (std::find(members.begin(), members.end(), vehicleId) != members.end()) continue;
+
+        if (i == 0) removeQueueEntry(segment, vehicleId);
+        if (members.empty()) {
+            segment.occupiedFromNodeId = corridor[i].second;
+        }
+        members.push_back(vehicleId);
+        segment.occupantEntryTimes.push_back(state.currentTime);
+        if (i > 0) segment.heldVehicleIds.push_back(vehicleId);
+        segment.lastEntryTime = state.currentTime;
+        state.segments.set(corridor[i].first, segment);
+    }
+
+    dropHeldSegments(state, vehicleId, corridor);
+    return true;
+}
+
+void SegmentManager::releaseSegment(ReservationSnapshot& state, int segmentId, int vehicleId) const {
+    if (segmentId < 0 || segmentId >= static_cast<int>(state.segments.size())) return;
+
+    SegmentReservationState segment = state.segments.get(segmentId);
+    auto& occupants = segment.occupantVehicleIds;
+    auto it = std::find(occupants.begin(), occupants.end(), vehicleId);
+    if (it == occupants.end()) return;
+
+    segment.occupantEntryTimes.erase(segment.occupantEntryTimes.begin() + (it - occupants.begin()));
+    occupants.erase(it);
+    auto& heldIds = segment.heldVehicleIds;
+    heldIds.erase(std::remove(heldIds.begin(), heldIds.end(), vehicleId), heldIds.end());
+    if (occupants.empty()) {
+        segment.occupiedFromNodeId = -1;
+    }
+    state.segments.set(segmentId, segment);
+
+    // As on the live state: queued vehicles of the whole group may have waited for this segment
+    for (int memberId : getConsolidatedSegmentGroup(segmentId)) {
+        processQueue(state, memberId);
+    }
+}
+
+void SegmentManager::processQueue(ReservationSnapshot& state, int segmentId) const {
+    if (segmentId < 0 || segmentId >= static_cast<int>(state.segments.size())) return;
+
+    while (!state.segments.get(segmentId).queue.empty()) {
+        SegmentQueue::Entry next = state.segments.get(segmentId).queue.front();
+        if (!reserveSegment(state, segmentId, next.vehicleId, next.fromNodeId)) break;
+    }
+}
+
+void SegmentManager::dropHeldSegments(ReservationSnapshot& state, int vehicleId,
+                                      const std::vector<std::pair<int, int>>& keep) const {
+    std::vector<int> stale;
+    for (size_t segmentId = 0; segmentId < state.segments.size(); segmentId++) {
+        const auto& heldIds = state.segments.get(segmentId).heldVehicleIds;
+        if (std::find(heldIds.begin(), heldIds.end(), vehicleId) == heldIds.end()) continue;
+        bool kept = std::any_of(keep.begin(), keep.end(),
+                                [segmentId](const std::pair<int, int>& member) { return member.first == static_cast<int>(segmentId); });
+        if (!kept) stale.push_back(static_cast<int>(segmentId));
+    }
+    for (int segmentId : stale) {
+        releaseSegment(state, segmentId, vehicleId);
+    }
+}
+
+std::vector<int> SegmentManager::findEvasionRoute(int currentNodeId, int targetNodeId, int blockedSegmentId, int vehicleId) const {
+    int evasionSegmentId = findEvasionSegment(currentNodeId, blockedSegmentId);
+    const PathSegment* evasion = pathSystem->getSegment(evasionSegmentId);
+    if (!evasion) return {};
+
+    int evasionEndId = (evasion->startNodeId == currentNodeId) ? evasion->endNodeId : evasion->startNodeId;
+    std::vector<int> route = {evasionSegmentId};
+    if (evasionEndId == targetNodeId) return route;
+
+    std::vector<int> rest = pathSystem->findPath(evasionEndId, targetNodeId, {blockedSegmentId});
+    if (rest.empty()) return {};
+    route.insert(route.end(), rest.begin(), rest.end());
+    return route;
+}
+
+bool SegmentManager::canUseEvasionRoute(int currentNodeId, int targetNodeId, int blockedSegmentId, int vehicleId) const {
+    std::vector<int> route = findEvasionRoute(currentNodeId, targetNodeId, blockedSegmentId, vehicleId);
+    if (route.empty()) return false;
+
+    // Drive the route on a throwaway copy: every segment must be reservable in turn
+    // (other vehicles are frozen, so this is conservative)
+    ReservationSnapshot whatIf = snapshot();
+    int nodeId = currentNodeId;
+    int previousSegmentId = getVehicleSegment(vehicleId);
+    for (int segmentId : route) {
+        if (!reserveSegment(whatIf, segmentId, vehicleId, nodeId)) return false;
+        if (previousSegmentId != -1) releaseSegment(whatIf, previousSegmentId, vehicleId);
+
+        const PathSegment* segment = pathSystem->getSegment(segmentId);
+        nodeId = (segment->startNodeId == nodeId) ? segment->endNodeId : segment->startNodeId;
+        whatIf.currentTime += estimateSegmentTime(segmentId);
+        previousSegmentId = segmentId;
+    }
+    return true;
+}
+
+// === Precomputed node lookup tables ===
+// All node classification and waiting/evasion relations are derived from the static
+// layout, so they are computed once per PathSystem layout version and then only looked up.
+
+int SegmentManager::segmentSideIndex(const PathSegment& segment, int nodeId) {
+    if (segment.startNodeId == nodeId) return segment.segmentId * 2;
+    if (segment.endNodeId == nodeId) return segment.segmentId * 2 + 1;
+    return -1;
+}
+
+const SegmentManager::LookupTables& SegmentManager::getLookupTables() const {
+    if (!lookupTables.valid || lookupTables.layoutVersion != pathSystem->getLayoutVersion()) {
+        rebuildLookupTables();
+    }
+    return lookupTables;
+}
+
+void SegmentManager::rebuildLookupTables() const {
+    const auto& nodes = pathSystem->getNodes();
+    const auto& segments = pathSystem->getSegments();
+
+    int maxNodeId = -1;
+    for (const auto& node : nodes) maxNodeId = std::max(maxNodeId, node.nodeId);
+    int maxSegmentId = -1;
+    for (const auto& segment : segments) maxSegmentId = std::max(maxSegmentId, segment.segmentId);
+
+    LookupTables tables;
+    tables.nodeType.assign(maxNodeId + 1, NodeType::REGULAR);
+    tables.waitingNodeJunction.assign(maxNodeId + 1, -1);
+    tables.nearestWaitingNode.assign(maxNodeId + 1, -1);
+    tables.evasionSegment.assign((maxSegmentId + 1) * 2, -1);
+    tables.approachWaitingNode.assign((maxSegmentId + 1) * 2, -1);
+
+    // Unit direction from one node towards another
+    auto directionBetween = [this](int fromNodeId, int toNodeId, float& dx, float& dy) {
+        const PathNode* from = pathSystem->getNode(fromNodeId);
+        const PathNode* to = pathSystem->getNode(toNodeId);
+        dx = dy = 0.0f;
+        if (!from || !to) return;
+        dx = to->position.x - from->position.x;
+        dy = to->position.y - from->position.y;
+        float len = std::sqrt(dx * dx + dy * dy);
+        if (len > 0.0f) {
+            dx /= len;
+            dy /= len;
+        }
+    };
+
+    // 1) Node types from the directions of non-waiting neighbours
+    for (const auto& node : nodes) {
+        if (node.isWaitingNode) {
+            tables.nodeType[node.nodeId] = NodeType::WAITING;
+            continue;
+        }
+
+        std::vector<std::pair<float, float>> directions;
+        for (int neighborId : pathSystem->getConnectedNodes(node.nodeId)) {
+            const PathNode* neighbor = pathSystem->getNode(neighborId);
+            if (!neighbor || neighbor->isWaitingNode) continue;
+            float dx, dy;
+            directionBetween(node.nodeId, neighborId, dx, dy);
+            directions.emplace_back(dx, dy);
+        }
+
+        NodeType type = NodeType::REGULAR;
+        if (directions.size() >= 4) {
+            type = NodeType::JUNCTION;
+        } else if (directions.size() == 3) {
+            type = NodeType::T_JUNCTION;
+        } else if (directions.size() == 2) {
+            // Two neighbours that are not (anti-)parallel form a curve
+            float dot = directions[0].first * directions[1].first + directions[0].second * directions[1].second;
+            if (dot > -0.7f) type = NodeType::CURVE;
+        }
+        tables.nodeType[node.nodeId] = type;
+    }
+
+    auto isJunctionType = [&tables](int nodeId) {
+        if (nodeId < 0 || nodeId >= static_cast<int>(tables.nodeType.size())) return false;
+        NodeType type = tables.nodeType[nodeId];
+        return type == NodeType::JUNCTION || type == NodeType::T_JUNCTION;
+    };
+
+    // 2) Associated junction per waiting node (nearest adjacent junction for merged waiting nodes)
+    for (const auto& node : nodes) {
+        if (!node.isWaitingNode) continue;
+
+        float bestLength = std::numeric_limits<float>::infinity();
+        for (int segmentId : node.connectedSegments) {
+            const PathSegment* segment = pathSystem->getSegment(segmentId);
+            if (!segment) continue;
+            int otherNodeId = (segment->startNodeId == node.nodeId) ? segment->endNodeId : segment->startNodeId;
+            if (isJunctionType(otherNodeId) && segment->length < bestLength) {
+                bestLength = segment->length;
+                tables.waitingNodeJunction[node.nodeId] = otherNodeId;
+            }
+        }
+    }
+
+    // 3) Nearest waiting node per node: multi-source Dijkstra from all waiting nodes
+    {
+        std::vector<float> distance(maxNodeId + 1, std::numeric_limits<float>::infinity());
+        std::priority_queue<std::pair<float, int>,
+                            std::vector<std::pair<float, int>>,
+                            std::greater<std::pair<float, int>>> pq;
+
+        for (const auto& node : nodes) {
+            if (node.isWaitingNode) {
+                distance[node.nodeId] = 0.0f;
+                tables.nearestWaitingNode[node.nodeId] = node.nodeId;
+                pq.push({0.0f, node.nodeId});
+            }
+        }
+
+        while (!pq.empty()) {
+            float currentDist = pq.top().first;
+            int currentNode = pq.top().second;
+            pq.pop();
+            if (currentDist > distance[currentNode]) continue;
+
+            const PathNode* node = pathSystem->getNode(currentNode);
+            if (!node) continue;
+
+            for (int segmentId : node->connectedSegments) {
+                const PathSegment* segment = pathSystem->getSegment(segmentId);
+                if (!segment) continue;
+                int otherNode = (segment->startNodeId == currentNode) ? segment->endNodeId : segment->startNodeId;
+                float newDist = currentDist + segment->length;
+                if (newDist < distance[otherNode]) {
+                    distance[otherNode] = newDist;
+                    tables.nearestWaitingNode[otherNode] = tables.nearestWaitingNode[currentNode];
+                    pq.push({newDist, otherNode});
+                }
+            }
+        }
+    }
+
+    // 4) Per (junction, segment): approach waiting node and evasion segment
+    for (const auto& node : nodes) {
+        if (!isJunctionType(node.nodeId)) continue;
+
+        // Waiting spurs of this junction with their directions
+        struct Spur { int segmentId; int waitingNodeId; float dx; float dy; float length; };
+        std::vector<Spur> spurs;
+        for (int segmentId : node.connectedSegments) {
+            const PathSegment* segment = pathSystem->getSegment(segmentId);
+            if (!segment) continue;
+            int otherNodeId = (segment->startNodeId == node.nodeId) ? segment->endNodeId : segment->startNodeId;
+            const PathNode* other = pathSystem->getNode(otherNodeId);
+            if (!other || !other->isWaitingNode) continue;
+            Spur spur{segmentId, otherNodeId, 0.0f, 0.0f, segment->length};
+            directionBetween(node.nodeId, otherNodeId, spur.dx, spur.dy);
+            spurs.push_back(spur);
+        }
+
+        for (int segmentId : node.connectedSegments) {
+            const PathSegment* segment = pathSystem->getSegment(segmentId);
+            if (!segment) continue;
+            int side = segmentSideIndex(*segment, node.nodeId);
+            if (side < 0) continue;
+            int otherNodeId = (segment->startNodeId == node.nodeId) ? segment->endNodeId : segment->startNodeId;
+
+            float dx, dy;
+            directionBetween(node.nodeId, otherNodeId, dx, dy);
+
+            int approachWaiting = -1;
+            int evasionSegment = -1;
+            float bestEvasionScore = std::numeric_limits<float>::infinity();
+
+            for (const Spur& spur : spurs) {
+                float dot = dx * spur.dx + dy * spur.dy;
+
+                // The spur pointing along this segment is where vehicles coming from it wait
+                if (dot > 0.9f && approachWaiting == -1) {
+                    approachWaiting = spur.waitingNodeId;
+                    continue;
+                }
+
+                // Evade into the spur most perpendicular to the blocked direction (shorter wins ties)
+                if (spur.segmentId == segmentId) continue;
+                float score = std::fabs(dot) * 10000.0f + spur.length;
+                if (score < bestEvasionScore) {
+                    bestEvasionScore = score;
+                    evasionSegment = spur.segmentId;
+                }
+            }
+
+            tables.approachWaitingNode[side] = approachWaiting;
+            tables.evasionSegment[side] = evasionSegment;
+        }
+    }
+
+    // 5) Segment groups: union the segments meeting at merged waiting nodes
+    std::vector<int> parent(maxSegmentId + 1);
+    std::vector<int> rank(maxSegmentId + 1, 0);
+    for (int i = 0; i <= maxSegmentId; i++) parent[i] = i;
+
+    auto findRoot = [&parent](int segmentId) {
+        while (parent[segmentId] != segmentId) {
+            parent[segmentId] = parent[parent[segmentId]];   // Path halving
+            segmentId = parent[segmentId];
+        }
+        return segmentId;
+    };
+    auto unite = [&](int a, int b) {
+        a = findRoot(a);
+        b = findRoot(b);
+        if (a == b) return;
+        if (rank[a] < rank[b]) std::swap(a, b);
+        parent[b] = a;
+        if (rank[a] == rank[b]) rank[a]++;
+    };
+
+    for (const auto& node : nodes) {
+        if (!node.isWaitingNode || node.connectedSegments.size() != 2) continue;
+        unite(node.connectedSegments[0], node.connectedSegments[1]);
+    }
+
+    tables.segmentGroup.assign(maxSegmentId + 1, -1);
+    std::vector<int> groupOfRoot(maxSegmentId + 1, -1);
+    for (int segmentId = 0; segmentId <= maxSegmentId; segmentId++) {
+        int root = findRoot(segmentId);
+        if (groupOfRoot[root] == -1) {
+            groupOfRoot[root] = static_cast<int>(tables.groupMembers.size());
+            tables.groupMembers.emplace_back();
+        }
+        tables.segmentGroup[segmentId] = groupOfRoot[root];
+        tables.groupMembers[groupOfRoot[root]].push_back(segmentId);
+    }
+
+    tables.layoutVersion = pathSystem->getLayoutVersion();
+    tables.valid = true;
+    lookupTables = std::move(tables);
+}
+
+SegmentManager::NodeType SegmentManager::getNodeType(int nodeId) const {
+    const LookupTables& tables = getLookupTables();
+    if (nodeId < 0 || nodeId >= static_cast<int>(tables.nodeType.size())) return NodeType::REGULAR;
+    return tables.nodeType[nodeId];
+}
+
+bool SegmentManager::isJunctionNode(int nodeId) const {
+    NodeType type = getNodeType(nodeId);
+    return type == NodeType::JUNCTION || type == NodeType::T_JUNCTION;
+}
+
+bool SegmentManager::isWaitingNode(int nodeId) const {
+    return getNodeType(nodeId) == NodeType::WAITING;
+}
+
+bool SegmentManager::isCurveNode(int nodeId) const {
+    return getNodeType(nodeId) == NodeType::CURVE;
+}
+
+bool SegmentManager::isCurvePoint(int nodeId) const {
+    return isCurveNode(nodeId);
+}
+
+bool SegmentManager::isTJunction(int nodeId) const {
+    return getNodeType(nodeId) == NodeType::T_JUNCTION;
+}
+
+int SegmentManager::getWaitingNodeJunction(int waitingNodeId) const {
+    const LookupTables& tables = getLookupTables();
+    if (waitingNodeId < 0 || waitingNodeId >= static_cast<int>(tables.waitingNodeJunction.size())) return -1;
+    return tables.waitingNodeJunction[waitingNodeId];
+}
+
+int SegmentManager::getNearestWaitingNode(int nodeId) const {
+    const LookupTables& tables = getLookupTables();
+    if (nodeId < 0 || nodeId >= static_cast<int>(tables.nearestWaitingNode.size())) return -1;
+    return tables.nearestWaitingNode[nodeId];
+}
+
+int SegmentManager::getApproachWaitingNode(int junctionId, int segmentId) const {
+    const LookupTables& tables = getLookupTables();
+    const PathSegment* segment = pathSystem->getSegment(segmentId);
+    if (!segment) return -1;
+    int side = segmentSideIndex(*segment, junctionId);
+    if (side < 0 || side >= static_cast<int>(tables.approachWaitingNode.size())) return -1;
+    return tables.approachWaitingNode[side];
+}
+
+int SegmentManager::findEvasionSegment(int currentNodeId, int blockedSegmentId) const {
+    const LookupTables& tables = getLookupTables();
+    const PathSegment* segment = pathSystem->getSegment(blockedSegmentId);
+    if (!segment) return -1;
+    int side = segmentSideIndex(*segment, currentNodeId);
+    if (side < 0 || side >= static_cast<int>(tables.evasionSegment.size())) return -1;
+    return tables.evasionSegment[side];
+}
+
+int SegmentManager::getVehicleWaitingNode(int currentNodeId, int vehicleId) const {
+    // Prefer the waiting node on the approach the vehicle currently occupies
+    int segmentId = getVehicleSegment(vehicleId);
+    if (segmentId != -1) {
+        int approachWaiting = getApproachWaitingNode(currentNodeId, segmentId);
+        if (approachWaiting != -1) return approachWaiting;
+    }
+    return getNearestWaitingNode(currentNodeId);
+}
+
+int SegmentManager::getSegmentGroupId(int segmentId) const {
+    const LookupTables& tables = getLookupTables();
+    if (segmentId < 0 || segmentId >= static_cast<int>(tables.segmentGroup.size())) return -1;
+    return tables.segmentGroup[segmentId];
+}
+
+std::vector<int> SegmentManager::getConsolidatedSegmentGroup(int segmentId) const {
+    const LookupTables& tables = getLookupTables();
+    int groupId = getSegmentGroupId(segmentId);
+    if (groupId == -1) return {segmentId};
+    return tables.groupMembers[groupId];
+}
+
+std::vector<std::pair<int, int>> SegmentManager::getCorridorAhead(int segmentId, int fromNodeId) const {
+    const LookupTables& tables = getLookupTables();
+    int groupId = getSegmentGroupId(segmentId);
+    if (groupId == -1 || tables.groupMembers[groupId].size() == 1) return {{segmentId, fromNodeId}};
+    const std::vector<int>& members = tables.groupMembers[groupId];
+
+    // Without a direction the whole group is reserved exclusively
+    std::vector<std::pair<int, int>> corridor = {{segmentId, fromNodeId}};
+    if (fromNodeId == -1) {
+        for (int memberId : members) {
+            if (memberId != segmentId) corridor.emplace_back(memberId, -1);
+        }
+        return corridor;
+    }
+
+    // Otherwise follow the chain through the merged waiting nodes in travel direction
+    int currentId = segmentId;
+    int entryNodeId = fromNodeId;
+    while (true) {
+        const PathSegment* current = pathSystem->getSegment(currentId);
+        int exitNodeId = (current->startNodeId == entryNodeId) ? current->endNodeId : current->startNodeId;
+
+        int nextId = -1;
+        for (int memberId : members) {
+            bool visited = std::any_of(corridor.begin(), corridor.end(),
+                                       [memberId](const std::pair<int, int>& entry) { return entry.first == memberId; });
+            const PathSegment* member = pathSystem->getSegment(memberId);
+            if (!visited && (member->startNodeId == exitNodeId || member->endNodeId == exitNodeId)) {
+                nextId = memberId;
+                break;
+            }
+        }
+        if (nextId == -1) break;
+
+        corridor.emplace_back(nextId, exitNodeId);
+        currentId = nextId;
+        entryNodeId = exitNodeId;
+    }
+    return corridor;
+}
+
+void SegmentManager::checkAndAddConnectedSegments(int nodeId, std::vector<int>& toProcess, std::set<int>& processed) const {
+    // Neighbour walk kept for callers that expand a group step by step; groups themselves
+    // come precomputed from the lookup tables
+    const PathNode* node = pathSystem->getNode(nodeId);
+    if (!node || !node->isWaitingNode || node->connectedSegments.size() != 2) return;
+
+    for (int segmentId : node->connectedSegments) {
+        if (processed.insert(segmentId).second) {
+            toProcess.push_back(segmentId);
+        }
+    }
+}
+
 // Stub implementations for complex methods
-float SegmentManager::estimatePathTime(const std::vector<int>& path, int vehicleId) const { return 0.0f; }
-float SegmentManager::estimateWaitTime(int segmentId, int vehicleId) const { return 1.0f; }
-bool SegmentManager::shouldWaitOrReroute(int currentNodeId, int targetNodeId, int blockedSegmentId, int vehicleId) const { return true; }
-bool SegmentManager::isCurvePoint(int nodeId) const { return false; }
 std::vector<int> SegmentManager::getCombinedCurveSegments(int nodeId) const { return {}; }
-SegmentManager::NodeType SegmentManager::getNodeType(int nodeId) const { return NodeType::REGULAR; }
-bool SegmentManager::isJunctionNode(int nodeId) const { return false; }
-bool SegmentManager::isWaitingNode(int nodeId) const { return false; }
-bool SegmentManager::isCurveNode(int nodeId) const { return false; }
 std::vector<SegmentManager::ConflictInfo> SegmentManager::detectPotentialConflicts(int vehicleId, const std::vector<int>& plannedPath) const { return {}; }
 bool SegmentManager::shouldWaitAtWaitingNode(int vehicleId, const std::vector<ConflictInfo>& conflicts) const { return false; }
 std::vector<int> SegmentManager::findVehiclesApproachingJunction(int junctionId, int excludeVehicleId, float timeWindow) const { return {}; }
 bool SegmentManager::isJunctionCurrentlyOccupied(int junctionId, int excludeVehicleId) const { return false; }
 bool SegmentManager::hasOpposingTraffic(int junctionId, int vehicleId) const { return false; }
 bool SegmentManager::negotiatePassage(int vehicleId, int junctionId, const std::vector<int>& conflictingVehicles) const { return true; }
-bool SegmentManager::isTJunction(int nodeId) const { return false; }
-bool SegmentManager::canUseEvasionRoute(int currentNodeId, int targetNodeId, int blockedSegmentId, int vehicleId) const { return false; }
-std::vector<int> SegmentManager::findEvasionRoute(int currentNodeId, int targetNodeId, int blockedSegmentId, int vehicleId) const { return {}; }
 bool SegmentManager::handleTJunctionConflict(int currentNodeId, int targetNodeId, int blockedSegmentId, int vehicleId) const { return true; }
 int SegmentManager::findConflictingVehicle(int currentNodeId, int vehicleId) const { return -1; }
 bool SegmentManager::vehiclesWantOppositeDirections(int currentNodeId, int vehicleId1, int vehicleId2) const { return false; }
 bool SegmentManager::shouldUseEvasionSegment(int currentNodeId, int vehicleId, int conflictingVehicleId) const { return false; }
-int SegmentManager::findEvasionSegment(int currentNodeId, int blockedSegmentId) const { return -1; }
-int SegmentManager::getVehicleWaitingNode(int currentNodeId, int vehicleId) const { return -1; }
 bool SegmentManager::isDeadlockSituation(int nodeId, int vehicleId, int otherVehicleId) const { return false; }
 bool SegmentManager::hasConflictingTJunctionReservation(int tJunctionId, int vehicleId, int requestedSegmentId) const { return false; }
 bool SegmentManager::detectDeadlock(const std::vector<int>& segmentsToReserve, int vehicleId) const { return false; }
@@ -222,5 +1259,3 @@ bool SegmentManager::findCycleRecursive(int startVehicleId, int currentVehicleId
 void SegmentManager::clearDeadlockQueues(const std::set<int>& deadlockVehicles) {}
 bool SegmentManager::isVehicleWaitingForOurSegments(int waitingVehicleId, int ourVehicleId) const { return false; }
 bool SegmentManager::segmentsConflict(int seg1, int seg2, int vehicle1, int vehicle2) const { return false; }
-std::vector<int> SegmentManager::getConsolidatedSegmentGroup(int segmentId) const { return {segmentId}; }
-void SegmentManager::checkAndAddConnectedSegments(int nodeId, std::vector<int>& toProcess, std::set<int>& processed) const {}
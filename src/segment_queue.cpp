@@ -0,0 +1,93 @@
+#include "segment_queue.h"
+#include <algorithm>
+
+SegmentQueue::Entry* SegmentQueue::find(int vehicleId) {
+    auto it = position.find(vehicleId);
+    return (it != position.end()) ? &heap[it->second] : nullptr;
+}
+
+bool SegmentQueue::push(const Entry& entry) {
+    if (contains(entry.vehicleId)) return false;
+
+    heap.push_back(entry);
+    position[entry.vehicleId] = heap.size() - 1;
+    siftUp(heap.size() - 1);
+    return true;
+}
+
+void SegmentQueue::pop() {
+    if (heap.empty()) return;
+    remove(heap.front().vehicleId);
+}
+
+bool SegmentQueue::remove(int vehicleId) {
+    auto it = position.find(vehicleId);
+    if (it == position.end()) return false;
+
+    size_t index = it->second;
+    size_t last = heap.size() - 1;
+    if (index != last) {
+        swapEntries(index, last);
+    }
+    heap.pop_back();
+    position.erase(vehicleId);
+
+    // The moved entry may belong further up or further down
+    if (index < heap.size()) {
+        siftUp(index);
+        siftDown(index);
+    }
+    return true;
+}
+
+void SegmentQueue::clear() {
+    heap.clear();
+    position.clear();
+}
+
+size_t SegmentQueue::countAhead(int vehicleId) const {
+    auto it = position.find(vehicleId);
+    if (it == position.end()) return heap.size();
+
+    const Entry& self = heap[it->second];
+    size_t ahead = 0;
+    for (const Entry& entry : heap) {
+        if (before(entry, self)) ahead++;
+    }
+    return ahead;
+}
+
+std::vector<SegmentQueue::Entry> SegmentQueue::ordered() const {
+    std::vector<Entry> entries = heap;
+    std::sort(entries.begin(), entries.end(), before);
+    return entries;
+}
+
+void SegmentQueue::swapEntries(size_t a, size_t b) {
+    std::swap(heap[a], heap[b]);
+    position[heap[a].vehicleId] = a;
+    position[heap[b].vehicleId] = b;
+}
+
+void SegmentQueue::siftUp(size_t index) {
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!before(heap[index], heap[parent])) break;
+        swapEntries(index, parent);
+        index = parent;
+    }
+}
+
+void SegmentQueue::siftDown(size_t index) {
+    const size_t count = heap.size();
+    while (true) {
+        size_t smallest = index;
+        size_t left = 2 * index + 1;
+        size_t right = left + 1;
+        if (left < count && before(heap[left], heap[smallest])) smallest = left;
+        if (right < count && before(heap[right], heap[smallest])) smallest = right;
+        if (smallest == index) break;
+        swapEntries(index, smallest);
+        index = smallest;
+    }
+}
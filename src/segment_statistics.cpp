@@ -0,0 +1,174 @@
+#include "segment_statistics.h"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace {
+
+uint32_t floatToBits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bitsToFloat(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+} // namespace
+
+SegmentStatistics::SegmentStatistics(size_t segmentCount, float ewmaAlpha)
+    : segmentCount(0), alpha(ewmaAlpha) {
+    reset(segmentCount);
+}
+
+void SegmentStatistics::reset(size_t count) {
+    counters.reset(count > 0 ? new SegmentCounters[count] : nullptr);
+    segmentCount = count;
+
+    for (size_t i = 0; i < count; i++) {
+        for (Series* series : {&counters[i].traversal, &counters[i].dwell}) {
+            series->count.store(0, std::memory_order_relaxed);
+            series->ewmaBits.store(floatToBits(0.0f), std::memory_order_relaxed);
+            for (auto& bin : series->bins) {
+                bin.store(0, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+int SegmentStatistics::binIndex(float seconds) {
+    if (seconds <= BIN_BASE) return 0;
+    int bin = 1 + static_cast<int>(std::log(seconds / BIN_BASE) / std::log(BIN_GROWTH));
+    return bin < BIN_COUNT ? bin : BIN_COUNT - 1;
+}
+
+float SegmentStatistics::binValue(int bin) {
+    // Geometric middle of the bin [BASE * G^(bin-1), BASE * G^bin]
+    if (bin == 0) return BIN_BASE * 0.5f;
+    return BIN_BASE * std::pow(BIN_GROWTH, bin - 0.5f);
+}
+
+void SegmentStatistics::record(Series& series, float seconds, float alpha) {
+    if (!(seconds >= 0.0f)) return;  // Also rejects NaN
+
+    uint64_t previousCount = series.count.fetch_add(1, std::memory_order_relaxed);
+    series.bins[binIndex(seconds)].fetch_add(1, std::memory_order_relaxed);
+
+    // First sample initialises the average, later ones blend in
+    uint32_t expected = series.ewmaBits.load(std::memory_order_relaxed);
+    uint32_t desired;
+    do {
+        float current = bitsToFloat(expected);
+        float updated = (previousCount == 0) ? seconds : current + alpha * (seconds - current);
+        desired = floatToBits(updated);
+    } while (!series.ewmaBits.compare_exchange_weak(expected, desired, std::memory_order_relaxed));
+}
+
+float SegmentStatistics::ewma(const Series& series) {
+    if (series.count.load(std::memory_order_relaxed) == 0) return -1.0f;
+    return bitsToFloat(series.ewmaBits.load(std::memory_order_relaxed));
+}
+
+float SegmentStatistics::quantile(const Series& series, float q) {
+    uint32_t binCounts[BIN_COUNT];
+    uint64_t total = 0;
+    for (int i = 0; i < BIN_COUNT; i++) {
+        binCounts[i] = series.bins[i].load(std::memory_order_relaxed);
+        total += binCounts[i];
+    }
+    if (total == 0) return -1.0f;
+
+    uint64_t rank = static_cast<uint64_t>(std::ceil(q * total));
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (int i = 0; i < BIN_COUNT; i++) {
+        seen += binCounts[i];
+        if (seen >= rank) return binValue(i);
+    }
+    return binValue(BIN_COUNT - 1);
+}
+
+const SegmentStatistics::Series* SegmentStatistics::traversalSeries(int segmentId) const {
+    if (segmentId < 0 || static_cast<size_t>(segmentId) >= segmentCount) return nullptr;
+    return &counters[segmentId].traversal;
+}
+
+const SegmentStatistics::Series* SegmentStatistics::dwellSeries(int segmentId) const {
+    if (segmentId < 0 || static_cast<size_t>(segmentId) >= segmentCount) return nullptr;
+    return &counters[segmentId].dwell;
+}
+
+void SegmentStatistics::recordTraversal(int segmentId, float seconds) {
+    if (segmentId < 0 || static_cast<size_t>(segmentId) >= segmentCount) return;
+    record(counters[segmentId].traversal, seconds, alpha);
+}
+
+void SegmentStatistics::recordDwell(int segmentId, float seconds) {
+    if (segmentId < 0 || static_cast<size_t>(segmentId) >= segmentCount) return;
+    record(counters[segmentId].dwell, seconds, alpha);
+}
+
+float SegmentStatistics::getTraversalEstimate(int segmentId) const {
+    const Series* series = traversalSeries(segmentId);
+    return series ? ewma(*series) : -1.0f;
+}
+
+float SegmentStatistics::getTraversalQuantile(int segmentId, float q) const {
+    const Series* series = traversalSeries(segmentId);
+    return series ? quantile(*series, q) : -1.0f;
+}
+
+float SegmentStatistics::getDwellEstimate(int segmentId) const {
+    const Series* series = dwellSeries(segmentId);
+    return series ? ewma(*series) : -1.0f;
+}
+
+float SegmentStatistics::getDwellQuantile(int segmentId, float q) const {
+    const Series* series = dwellSeries(segmentId);
+    return series ? quantile(*series, q) : -1.0f;
+}
+
+uint64_t SegmentStatistics::getTraversalCount(int segmentId) const {
+    const Series* series = traversalSeries(segmentId);
+    return series ? series->count.load(std::memory_order_relaxed) : 0;
+}
+
+std::vector<SegmentStatistics::SegmentSnapshot> SegmentStatistics::snapshot() const {
+    std::vector<SegmentSnapshot> result;
+    result.reserve(segmentCount);
+
+    for (size_t i = 0; i < segmentCount; i++) {
+        const SegmentCounters& c = counters[i];
+        SegmentSnapshot s;
+        s.segmentId = static_cast<int>(i);
+        s.traversalCount = c.traversal.count.load(std::memory_order_relaxed);
+        s.traversalEwma = ewma(c.traversal);
+        s.traversalP50 = quantile(c.traversal, 0.5f);
+        s.traversalP90 = quantile(c.traversal, 0.9f);
+        s.traversalP99 = quantile(c.traversal, 0.99f);
+        s.dwellCount = c.dwell.count.load(std::memory_order_relaxed);
+        s.dwellEwma = ewma(c.dwell);
+        s.dwellP50 = quantile(c.dwell, 0.5f);
+        s.dwellP99 = quantile(c.dwell, 0.99f);
+        result.push_back(s);
+    }
+    return result;
+}
+
+bool SegmentStatistics::writeCsv(const std::string& filename) const {
+    std::ofstream file(filename);
+    if (!file) return false;
+
+    file << "segment,traversal_count,traversal_ewma,traversal_p50,traversal_p90,traversal_p99,"
+            "dwell_count,dwell_ewma,dwell_p50,dwell_p99\n";
+    for (const SegmentSnapshot& s : snapshot()) {
+        file << s.segmentId << ',' << s.traversalCount << ',' << s.traversalEwma << ','
+             << s.traversalP50 << ',' << s.traversalP90 << ',' << s.traversalP99 << ','
+             << s.dwellCount << ',' << s.dwellEwma << ',' << s.dwellP50 << ',' << s.dwellP99 << '\n';
+    }
+    return static_cast<bool>(file);
+}
@@ -0,0 +1,109 @@
+#include "task_scheduler.h"
+#include <algorithm>
+
+TaskScheduler::TaskScheduler(unsigned threadCount)
+    : batchNumber(0), stopping(false), currentTask(nullptr), remainingChunks(0), steals(0) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (unsigned i = 0; i < threadCount; i++) {
+        queues.push_back(std::unique_ptr<WorkerQueue>(new WorkerQueue()));
+    }
+    for (unsigned i = 1; i < threadCount; i++) {
+        workers.emplace_back(&TaskScheduler::workerLoop, this, static_cast<size_t>(i));
+    }
+}
+
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void TaskScheduler::parallelFor(size_t count, size_t grainSize, const RangeTask& task) {
+    if (count == 0) return;
+    grainSize = std::max<size_t>(1, grainSize);
+
+    if (queues.size() == 1 || count <= grainSize) {
+        task(0, count);
+        return;
+    }
+
+    size_t chunkCount = (count + grainSize - 1) / grainSize;
+    currentTask = &task;
+    remainingChunks.store(chunkCount, std::memory_order_relaxed);
+
+    for (size_t i = 0; i < chunkCount; i++) {
+        WorkerQueue& queue = *queues[i % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.chunks.push_back({i * grainSize, std::min(count, (i + 1) * grainSize)});
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        batchNumber++;
+    }
+    wake.notify_all();
+
+    // The caller works too, then waits for chunks still running on workers
+    while (runOne(0)) {}
+
+    std::unique_lock<std::mutex> lock(wakeMutex);
+    finished.wait(lock, [this]() { return remainingChunks.load(std::memory_order_acquire) == 0; });
+    currentTask = nullptr;
+}
+
+bool TaskScheduler::popLocal(size_t worker, Chunk& chunk) {
+    WorkerQueue& queue = *queues[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.chunks.empty()) return false;
+    chunk = queue.chunks.back();
+    queue.chunks.pop_back();
+    return true;
+}
+
+bool TaskScheduler::steal(size_t thief, Chunk& chunk) {
+    for (size_t offset = 1; offset < queues.size(); offset++) {
+        WorkerQueue& victim = *queues[(thief + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.chunks.empty()) continue;
+
+        chunk = victim.chunks.front();
+        victim.chunks.pop_front();
+        steals.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+bool TaskScheduler::runOne(size_t worker) {
+    Chunk chunk;
+    if (!popLocal(worker, chunk) && !steal(worker, chunk)) return false;
+
+    (*currentTask)(chunk.begin, chunk.end);
+
+    if (remainingChunks.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        finished.notify_all();
+    }
+    return true;
+}
+
+void TaskScheduler::workerLoop(size_t worker) {
+    uint64_t seenBatch = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(wakeMutex);
+            wake.wait(lock, [this, seenBatch]() { return stopping || batchNumber != seenBatch; });
+            if (stopping) return;
+            seenBatch = batchNumber;
+        }
+        while (runOne(worker)) {}
+    }
+}
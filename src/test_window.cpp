@@ -3,6 +3,7 @@
 #include <chrono>
 #include <vector>
 #include <mutex>
+#include <atomic>
 #include <sstream>
 #include <iomanip>
 #include <cmath>
@@ -15,6 +16,8 @@
 #include "point.h"
 #include "path_system.h"
 #include "vehicle_controller.h"
+#include "floor_calibration.h"
+#include "latency_trace.h"
 
 // Alternative: Einfaches Windows API Fenster (ohne Raylib Includes hier)
 #ifdef _WIN32
@@ -60,6 +63,7 @@ struct PersistentVehicle {
     PersistentVehicle(const Auto& v) : vehicle(v), lastSeen(std::chrono::steady_clock::now()), justUpdated(true) {}
 };
 static std::vector<PersistentVehicle> g_persistent_vehicles;
+static std::atomic<uint64_t> g_last_traced_sequence(0);   // Neuester Kamera-Frame mit geschriebenem Befehl
 static std::mutex g_persistent_mutex;
 static const auto MAX_VEHICLE_AGE = std::chrono::seconds(3); // Fahrzeuge 3 Sekunden merken
 
@@ -131,7 +135,7 @@ void simulateDetectedObjectFromManualVehicle() {
         DetectedObject obj;
         Point pos = g_manual_vehicle.getCenter();
         obj.coordinates = Point2D(pos.x, pos.y);  // Convert Point to Point2D
-        obj.color = "Heck1";
+        obj.marker = heckMarker(1);
         obj.crop_width = FULLSCREEN_WIDTH;
         obj.crop_height = FULLSCREEN_HEIGHT;
         simulated.push_back(obj);
@@ -139,7 +143,7 @@ void simulateDetectedObjectFromManualVehicle() {
         // Front-Point simulieren (10 Pixel nach vorn)
         DetectedObject frontObj;
         frontObj.coordinates = Point2D(pos.x, pos.y - 10);  // Convert Point to Point2D
-        frontObj.color = "Front";
+        frontObj.marker = MARKER_FRONT;
         frontObj.crop_width = FULLSCREEN_WIDTH;
         frontObj.crop_height = FULLSCREEN_HEIGHT;
         simulated.push_back(frontObj);
@@ -372,43 +376,82 @@ void createCalibrationWindow() {
     }
 }
 
-// Direkte Crop-zu-Vollbild Koordinaten-Transformation
-void transformCropToFullscreen(float crop_x, float crop_y, float crop_width, float crop_height, float& fullscreen_x, float& fullscreen_y) {
-    // Die crop_x und crop_y sind bereits Pixel-Koordinaten im Crop-Bereich
-    // Diese werden direkt auf 1920x1200 Vollbild skaliert
-
-    if (crop_width > 0 && crop_height > 0 && crop_x >= 0 && crop_y >= 0) {
-        // Normalisiere auf 0.0 bis 1.0 basierend auf Crop-Größe
-        float norm_x = crop_x / crop_width;
-        float norm_y = crop_y / crop_height;
-
-        // Skaliere direkt auf 1920x1200 Vollbild mit Kalibrierung
-        fullscreen_x = (norm_x * FULLSCREEN_WIDTH * g_x_scale) + g_x_offset;
-        fullscreen_y = (norm_y * FULLSCREEN_HEIGHT * g_y_scale) + g_y_offset;
-
-        // Kurvenkorrektur anwenden
-        float center_x = FULLSCREEN_WIDTH / 2.0f;
-        float center_y = FULLSCREEN_HEIGHT / 2.0f;
-        float x_diff = fullscreen_x - center_x;
-        float y_diff = fullscreen_y - center_y;
-
-        fullscreen_x += x_diff * g_x_curve;
-        fullscreen_y += y_diff * g_y_curve;
-
-        // Gültigkeitsprüfung - verhindere 0/0 Sprünge
-        if (fullscreen_x < 0 || fullscreen_x > FULLSCREEN_WIDTH || 
-            fullscreen_y < 0 || fullscreen_y > FULLSCREEN_HEIGHT) {
-            printf("WARNING: Invalid transformed coordinates (%.2f, %.2f) - using fallback\n", fullscreen_x, fullscreen_y);
-            fullscreen_x = center_x;  // Fallback zur Mitte statt 0/0
-            fullscreen_y = center_y;
+// Kamera-Kalibrierung aus Referenzmarkern (Homographie + Linsenverzeichnung), ersetzt die
+// Trackbar-Werte sobald floor_calibration.txt existiert. Format: eine Zeile pro Marker
+// "crop_x crop_y vollbild_x vollbild_y", mindestens vier Marker, '#' leitet Kommentare ein.
+static const char* const FLOOR_CALIBRATION_FILE = "floor_calibration.txt";
+static const int FLOOR_REMAP_CELL = 4;   // Stützstellen alle 4 px, Fehler weit unter dem Detektionsrauschen
+static std::mutex g_floor_mutex;
+static std::vector<CalibrationPair> g_floor_pairs;
+static FloorCalibration g_floor_calibration;
+static FloorRemapTable g_floor_table;
+static bool g_floor_loaded = false;
+
+// Lädt die Referenzmarker einmal; Modell und Tabelle werden pro Crop-Größe neu aufgebaut
+static bool prepareFloorCalibration(int crop_width, int crop_height) {
+    if (!g_floor_loaded) {
+        g_floor_loaded = true;
+        if (FloorCalibration::loadPairs(FLOOR_CALIBRATION_FILE, g_floor_pairs)) {
+            std::cout << "Boden-Kalibrierung: " << g_floor_pairs.size() << " Referenzmarker aus "
+                      << FLOOR_CALIBRATION_FILE << std::endl;
         }
-    } else {
-        printf("WARNING: Invalid input coordinates: crop_x=%.2f, crop_y=%.2f, crop_size=(%.2f, %.2f)\n", 
-               crop_x, crop_y, crop_width, crop_height);
-        // Fallback zur Mitte statt 0/0
-        fullscreen_x = FULLSCREEN_WIDTH / 2.0f;
-        fullscreen_y = FULLSCREEN_HEIGHT / 2.0f;
     }
+    if (g_floor_pairs.empty()) return false;
+    if (g_floor_table.isBuilt() && g_floor_table.getCropWidth() == crop_width &&
+        g_floor_table.getCropHeight() == crop_height) {
+        return true;
+    }
+    if (!g_floor_calibration.fit(g_floor_pairs, crop_width, crop_height)) {
+        std::cout << "Boden-Kalibrierung fehlgeschlagen (mindestens 4 Marker, nicht auf einer Linie) - "
+                  << "verwende Trackbar-Kalibrierung" << std::endl;
+        g_floor_pairs.clear();
+        return false;
+    }
+    g_floor_table.build(g_floor_calibration, crop_width, crop_height, FLOOR_REMAP_CELL);
+    printf("Boden-Kalibrierung fuer Crop %dx%d: RMS %.2f px, k1 %.4f, k2 %.4f\n", crop_width, crop_height,
+           g_floor_calibration.rmsError(g_floor_pairs), g_floor_calibration.getK1(), g_floor_calibration.getK2());
+    return true;
+}
+
+// Crop-zu-Vollbild Koordinaten-Transformation. Liefert false für Punkte außerhalb des Crops
+// oder des Vollbilds - diese werden verworfen statt auf die Bildmitte gesetzt, sonst springen
+// Tracks und Fahrzeugzuordnung dorthin.
+bool transformCropToFullscreen(float crop_x, float crop_y, float crop_width, float crop_height, float& fullscreen_x, float& fullscreen_y) {
+    if (!(crop_width > 0 && crop_height > 0 && crop_x >= 0 && crop_y >= 0)) {
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(g_floor_mutex);
+        if (prepareFloorCalibration(static_cast<int>(crop_width), static_cast<int>(crop_height))) {
+            // Eine bilineare Tabellenabfrage statt Modellauswertung pro Punkt
+            return g_floor_table.lookup(crop_x, crop_y, fullscreen_x, fullscreen_y) &&
+                   fullscreen_x >= 0 && fullscreen_x <= FULLSCREEN_WIDTH &&
+                   fullscreen_y >= 0 && fullscreen_y <= FULLSCREEN_HEIGHT;
+        }
+    }
+
+    // Ohne Referenzmarker: Trackbar-Kalibrierung
+    // Normalisiere auf 0.0 bis 1.0 basierend auf Crop-Größe
+    float norm_x = crop_x / crop_width;
+    float norm_y = crop_y / crop_height;
+
+    // Skaliere direkt auf 1920x1200 Vollbild mit Kalibrierung
+    fullscreen_x = (norm_x * FULLSCREEN_WIDTH * g_x_scale) + g_x_offset;
+    fullscreen_y = (norm_y * FULLSCREEN_HEIGHT * g_y_scale) + g_y_offset;
+
+    // Kurvenkorrektur anwenden
+    float center_x = FULLSCREEN_WIDTH / 2.0f;
+    float center_y = FULLSCREEN_HEIGHT / 2.0f;
+    float x_diff = fullscreen_x - center_x;
+    float y_diff = fullscreen_y - center_y;
+
+    fullscreen_x += x_diff * g_x_curve;
+    fullscreen_y += y_diff * g_y_curve;
+
+    // Gültigkeitsprüfung - außerhalb des Vollbilds gibt es keine sinnvolle Position
+    return fullscreen_x >= 0 && fullscreen_x <= FULLSCREEN_WIDTH &&
+           fullscreen_y >= 0 && fullscreen_y <= FULLSCREEN_HEIGHT;
 }
 
 // Helper-Funktionen für Auto-Erkennung (wie in car_simulation.cpp)
@@ -569,14 +612,12 @@ void drawPointGDI(HDC hdc, const Point& point, bool isSelected) {
     SetBkMode(hdc, TRANSPARENT);
     SetTextColor(hdc, RGB(0, 0, 0));
 
-    if (!point.color.empty()) {
-        if (point.color == "Front") {
-            TextOutA(hdc, static_cast<int>(fullscreenPoint.x + 15), static_cast<int>(fullscreenPoint.y - 15), "FRONT", 5);
-        } else if (point.color.find("Heck") == 0) {
-            std::string label = point.color;
-            std::transform(label.begin(), label.end(), label.begin(), ::toupper);
-            TextOutA(hdc, static_cast<int>(fullscreenPoint.x + 15), static_cast<int>(fullscreenPoint.y - 15), label.c_str(), label.length());
-        }
+    if (isFrontMarker(point.marker)) {
+        TextOutA(hdc, static_cast<int>(fullscreenPoint.x + 15), static_cast<int>(fullscreenPoint.y - 15), "FRONT", 5);
+    } else if (isHeckMarker(point.marker)) {
+        char label[16];
+        int length = snprintf(label, sizeof(label), "HECK%d", heckNumber(point.marker));
+        TextOutA(hdc, static_cast<int>(fullscreenPoint.x + 15), static_cast<int>(fullscreenPoint.y - 15), label, length);
     }
 }
 
@@ -656,6 +697,8 @@ void updateVehicleCommands() {
         return;
     }
 
+    auto write_start = std::chrono::steady_clock::now();
+
     // JSON-Datei erstellen/überschreiben
     std::ofstream jsonFile("vehicle_commands.json");
     jsonFile << "{\n  \"vehicles\": [\n";
@@ -671,6 +714,11 @@ void updateVehicleCommands() {
 
     // Aktualisiere Daten
 
+    // Kamera-Frames, deren Befehl in diesem Durchlauf zum ersten Mal geschrieben wird
+    const uint64_t last_traced = g_last_traced_sequence.load();
+    std::vector<std::chrono::steady_clock::time_point> traced_captures;
+    uint64_t newest_sequence = last_traced;
+
     for (const Auto& auto_ : current_autos) {
         if (!auto_.isValid()) continue;
 
@@ -678,65 +726,61 @@ void updateVehicleCommands() {
         firstVehicle = false;
 
         // Finde das entsprechende Vehicle im Controller
-        const auto& vehicles = g_vehicle_controller->getAllVehicles();
         int command = 5; // 5 = stehen (default)
         int nextNodeId = -1;
 
-        for (const auto& [vehicleId, controllerVehicle] : vehicles) {
-            if (controllerVehicle.vehicleId == auto_.getId()) {
-                Point currentPos = auto_.getCenter();
-                
-                // Prüfe ob Fahrzeug eine aktive Route hat
-                if (!controllerVehicle.currentNodePath.empty() && 
-                    controllerVehicle.currentNodeIndex < controllerVehicle.currentNodePath.size()) {
+        if (const Auto* controllerVehicle = g_vehicle_controller->getVehicle(auto_.getId())) {
+            Point currentPos = auto_.getCenter();
+            
+            // Prüfe ob Fahrzeug eine aktive Route hat
+            if (!controllerVehicle->currentNodePath.empty() && 
+                controllerVehicle->currentNodeIndex < controllerVehicle->currentNodePath.size()) {
 
-                    nextNodeId = controllerVehicle.currentNodePath[controllerVehicle.currentNodeIndex];
+                nextNodeId = controllerVehicle->currentNodePath[controllerVehicle->currentNodeIndex];
+                
+                // Hole den Zielknoten für Richtungsberechnung
+                const PathNode* targetNode = g_path_system->getNode(nextNodeId);
+                if (targetNode) {
+                    // Berechne gewünschte Richtung zur Route
+                    Point targetPos = targetNode->position;
                     
-                    // Hole den Zielknoten für Richtungsberechnung
-                    const PathNode* targetNode = g_path_system->getNode(nextNodeId);
-                    if (targetNode) {
-                        // Berechne gewünschte Richtung zur Route
-                        Point targetPos = targetNode->position;
+                    float routeDx = targetPos.x - currentPos.x;
+                    float routeDy = targetPos.y - currentPos.y;
+                    float distanceToTarget = sqrt(routeDx * routeDx + routeDy * routeDy);
+                    
+                    // Prüfe ob Ziel erreicht ist (30px Toleranz)
+                    if (distanceToTarget < 30.0f) {
+                        command = 0; // Anhalten - Ziel erreicht
+                    } else {
+                        // Berechne gewünschte Richtung (in Grad)
+                        float desiredAngle = atan2(routeDy, routeDx) * 180.0f / M_PI;
+                        if (desiredAngle < 0) desiredAngle += 360.0f;
+                        
+                        // Aktuelle Fahrzeugrichtung
+                        Point frontPoint = auto_.getFrontPoint();
+                        Point centerPoint = auto_.getCenter();
+                        float currentDx = frontPoint.x - centerPoint.x;
+                        float currentDy = frontPoint.y - centerPoint.y;
+                        float currentAngle = atan2(currentDy, currentDx) * 180.0f / M_PI;
+                        if (currentAngle < 0) currentAngle += 360.0f;
                         
-                        float routeDx = targetPos.x - currentPos.x;
-                        float routeDy = targetPos.y - currentPos.y;
-                        float distanceToTarget = sqrt(routeDx * routeDx + routeDy * routeDy);
+                        // Berechne Winkeldifferenz
+                        float angleDiff = desiredAngle - currentAngle;
+                        if (angleDiff > 180.0f) angleDiff -= 360.0f;
+                        if (angleDiff < -180.0f) angleDiff += 360.0f;
                         
-                        // Prüfe ob Ziel erreicht ist (30px Toleranz)
-                        if (distanceToTarget < 30.0f) {
-                            command = 0; // Anhalten - Ziel erreicht
+                        // Entscheidung basierend auf Winkeldifferenz
+                        if (abs(angleDiff) <= 3.0f) {
+                            command = 1; // Vorwärts - Richtung stimmt (3° Toleranz)
+                        } else if (angleDiff > 0) {
+                            command = 4; // Rechts drehen
                         } else {
-                            // Berechne gewünschte Richtung (in Grad)
-                            float desiredAngle = atan2(routeDy, routeDx) * 180.0f / M_PI;
-                            if (desiredAngle < 0) desiredAngle += 360.0f;
-                            
-                            // Aktuelle Fahrzeugrichtung
-                            Point frontPoint = auto_.getFrontPoint();
-                            Point centerPoint = auto_.getCenter();
-                            float currentDx = frontPoint.x - centerPoint.x;
-                            float currentDy = frontPoint.y - centerPoint.y;
-                            float currentAngle = atan2(currentDy, currentDx) * 180.0f / M_PI;
-                            if (currentAngle < 0) currentAngle += 360.0f;
-                            
-                            // Berechne Winkeldifferenz
-                            float angleDiff = desiredAngle - currentAngle;
-                            if (angleDiff > 180.0f) angleDiff -= 360.0f;
-                            if (angleDiff < -180.0f) angleDiff += 360.0f;
-                            
-                            // Entscheidung basierend auf Winkeldifferenz
-                            if (abs(angleDiff) <= 3.0f) {
-                                command = 1; // Vorwärts - Richtung stimmt (3° Toleranz)
-                            } else if (angleDiff > 0) {
-                                command = 4; // Rechts drehen
-                            } else {
-                                command = 3; // Links drehen
-                            }
+                            command = 3; // Links drehen
                         }
                     }
-                } else {
-                    command = 0; // Anhalten - keine Route
                 }
-                break;
+            } else {
+                command = 0; // Anhalten - keine Route
             }
         }
 
@@ -745,12 +789,33 @@ void updateVehicleCommands() {
 
         jsonFile << "    {\n";
         jsonFile << "      \"id\": " << auto_.getId() << ",\n";
-        jsonFile << "      \"command\": " << command << "\n";
-        jsonFile << "    }";
+        jsonFile << "      \"command\": " << command;
+        if (auto_.stamp.isSet()) {
+            // Kamera-Frame, aus dem der Befehl stammt, und sein Alter beim Schreiben
+            double age_ms = std::chrono::duration<double, std::milli>(write_start - auto_.stamp.captureTime).count();
+            jsonFile << ",\n      \"frame\": " << auto_.stamp.sequence;
+            jsonFile << ",\n      \"age_ms\": " << std::fixed << std::setprecision(1) << age_ms;
+            if (auto_.stamp.sequence > last_traced) {
+                traced_captures.push_back(auto_.stamp.captureTime);
+                newest_sequence = std::max(newest_sequence, auto_.stamp.sequence);
+            }
+        }
+        jsonFile << "\n    }";
     }
 
     jsonFile << "\n  ]\n}";
     jsonFile.close();
+
+    // Befehl steht in der Datei: Kamera -> Befehl einmal pro Fahrzeug und Frame
+    auto written = std::chrono::steady_clock::now();
+    recordLatency(LatencyStage::COMMAND_WRITE, write_start, written);
+    for (const auto& capture : traced_captures) {
+        recordLatency(LatencyStage::CAMERA_TO_COMMAND, capture, written);
+    }
+    // Hauptschleife und Fenster-Timer schreiben beide; der Zähler läuft nur vorwärts
+    uint64_t previous = last_traced;
+    while (newest_sequence > previous && !g_last_traced_sequence.compare_exchange_weak(previous, newest_sequence)) {
+    }
 }
 
 // Zeichne ein Auto als kompakten Punkt mit Richtungspfeil
@@ -854,20 +919,20 @@ void drawAutoGDI(HDC hdc, const Auto& auto_) {
         
         for (const auto& vehicle : vehicles) {
             // Versuche zuerst direkte ID-Zuordnung
-            bool isMatchingVehicle = (vehicle.second.vehicleId == auto_.getId());
+            bool isMatchingVehicle = (vehicle.vehicleId == auto_.getId());
             
             // Falls ID=0, versuche Position-basiertes Matching
             if (!isMatchingVehicle && auto_.getId() == 0) {
                 Point autoPos = auto_.getCenter();
-                float distance = sqrt(pow(vehicle.second.position.x - autoPos.x, 2) + pow(vehicle.second.position.y - autoPos.y, 2));
+                float distance = sqrt(pow(vehicle.position.x - autoPos.x, 2) + pow(vehicle.position.y - autoPos.y, 2));
                 if (distance < 100.0f) { // Wenn Auto näher als 100 Pixel zu Controller-Vehicle
                     isMatchingVehicle = true;
                 }
             }
             
-            if (isMatchingVehicle && vehicle.second.targetNodeId != -1) {
+            if (isMatchingVehicle && vehicle.targetNodeId != -1) {
                 // Hole den finalen Zielknoten
-                const PathNode* targetNode = g_path_system->getNode(vehicle.second.targetNodeId);
+                const PathNode* targetNode = g_path_system->getNode(vehicle.targetNodeId);
                 if (targetNode) {
                     Point targetPos = mapToFullscreenCoordinates(targetNode->position.x, targetNode->position.y);
                     
@@ -912,14 +977,14 @@ void drawAutoGDI(HDC hdc, const Auto& auto_) {
                 }
                 
                 // === NEUER ROUTENPFEIL: Zeigt zum nächsten Wegpunkt in der Route ===
-                if (!vehicle.second.currentNodePath.empty() && vehicle.second.currentNodeIndex < vehicle.second.currentNodePath.size()) {
+                if (!vehicle.currentNodePath.empty() && vehicle.currentNodeIndex < vehicle.currentNodePath.size()) {
                     // Hole den nächsten Knoten aus der Route
-                    int currentNodeId = vehicle.second.currentNodePath[vehicle.second.currentNodeIndex];
+                    int currentNodeId = vehicle.currentNodePath[vehicle.currentNodeIndex];
                     const PathNode* targetNode = g_path_system->getNode(currentNodeId);
                     
                     if (targetNode) {
                         // In node-based navigation, we navigate directly to the target node
-                        Point vehiclePos = mapToFullscreenCoordinates(vehicle.second.position.x, vehicle.second.position.y);
+                        Point vehiclePos = mapToFullscreenCoordinates(vehicle.position.x, vehicle.position.y);
                         Point targetPos = mapToFullscreenCoordinates(targetNode->position.x, targetNode->position.y);
                         
                         // Berechne Vektor zum nächsten Wegpunkt
@@ -985,194 +1050,190 @@ void drawVehicleRouteGDI(HDC hdc, const Auto& vehicle, const PathSystem& pathSys
     if (!g_vehicle_controller) return;
 
     // Finde das entsprechende Vehicle im Controller
-    const auto& vehicles = g_vehicle_controller->getAllVehicles();
-    for (const auto& controllerVehicle : vehicles) {
-        if (controllerVehicle.second.vehicleId == vehicle.getId()) {
-            if (controllerVehicle.second.currentNodePath.empty()) continue; // Updated to new logic
-
-            // Spezielle Hervorhebung für ausgewähltes Fahrzeug
-            COLORREF routeColor;
-            int routeWidth;
-
-            if (vehicle.getId() == g_selected_vehicle_id) {
-                routeColor = RGB(255, 50, 255);  // Helles Magenta für ausgewähltes Fahrzeug
-                routeWidth = 12;                 // Extra dick für bessere Sichtbarkeit
-            } else {
-                // Standard-Routenfarben (nur schwach sichtbar wenn nicht ausgewählt)
-                COLORREF routeColors[] = {
-                    RGB(100, 200, 100),   // Schwaches Grün
-                    RGB(200, 200, 100),   // Schwaches Gelb  
-                    RGB(200, 150, 100),   // Schwaches Orange
-                    RGB(150, 100, 150)    // Schwaches Lila
-                };
-                routeColor = routeColors[vehicle.getId() % 4];
-                routeWidth = 4; // Dünner für unausgewählte Fahrzeuge
-            }
+    if (const Auto* controllerVehicle = g_vehicle_controller->getVehicle(vehicle.getId())) {
+        if (controllerVehicle->currentNodePath.empty()) return; // Updated to new logic
+
+        // Spezielle Hervorhebung für ausgewähltes Fahrzeug
+        COLORREF routeColor;
+        int routeWidth;
+
+        if (vehicle.getId() == g_selected_vehicle_id) {
+            routeColor = RGB(255, 50, 255);  // Helles Magenta für ausgewähltes Fahrzeug
+            routeWidth = 12;                 // Extra dick für bessere Sichtbarkeit
+        } else {
+            // Standard-Routenfarben (nur schwach sichtbar wenn nicht ausgewählt)
+            COLORREF routeColors[] = {
+                RGB(100, 200, 100),   // Schwaches Grün
+                RGB(200, 200, 100),   // Schwaches Gelb  
+                RGB(200, 150, 100),   // Schwaches Orange
+                RGB(150, 100, 150)    // Schwaches Lila
+            };
+            routeColor = routeColors[vehicle.getId() % 4];
+            routeWidth = 4; // Dünner für unausgewählte Fahrzeuge
+        }
 
-            HPEN routePen = CreatePen(PS_SOLID, routeWidth, routeColor);
-            HGDIOBJ oldPen = SelectObject(hdc, routePen);
+        HPEN routePen = CreatePen(PS_SOLID, routeWidth, routeColor);
+        HGDIOBJ oldPen = SelectObject(hdc, routePen);
 
-            // ROUTE DRAWING - Neue Knoten-basierte Logik
-            Point currentPos = mapToFullscreenCoordinates(vehicle.getCenter().x, vehicle.getCenter().y);
+        // ROUTE DRAWING - Neue Knoten-basierte Logik
+        Point currentPos = mapToFullscreenCoordinates(vehicle.getCenter().x, vehicle.getCenter().y);
+        
+        // Zeichne Route durch alle Knoten im currentNodePath
+        for (size_t i = controllerVehicle->currentNodeIndex; i < controllerVehicle->currentNodePath.size(); i++) {
+            int nodeId = controllerVehicle->currentNodePath[i];
+            const PathNode* node = pathSystem.getNode(nodeId);
             
-            // Zeichne Route durch alle Knoten im currentNodePath
-            for (size_t i = controllerVehicle.second.currentNodeIndex; i < controllerVehicle.second.currentNodePath.size(); i++) {
-                int nodeId = controllerVehicle.second.currentNodePath[i];
-                const PathNode* node = pathSystem.getNode(nodeId);
+            if (node) {
+                Point nodePos = mapToFullscreenCoordinates(node->position.x, node->position.y);
                 
-                if (node) {
-                    Point nodePos = mapToFullscreenCoordinates(node->position.x, node->position.y);
-                    
-                    // Aktueller Wegpunkt extra hervorheben bei ausgewähltem Fahrzeug
-                    if (i == controllerVehicle.second.currentNodeIndex && vehicle.getId() == g_selected_vehicle_id) {
-                        SelectObject(hdc, oldPen);
-                        DeleteObject(routePen);
-                        routePen = CreatePen(PS_SOLID, 16, RGB(255, 100, 255)); // Extra dick und hell
-                        SelectObject(hdc, routePen);
-                    }
-                    
-                    // Zeichne Linie von aktueller Position zum Knoten
-                    MoveToEx(hdc, static_cast<int>(currentPos.x), 
-                            static_cast<int>(currentPos.y), nullptr);
-                    LineTo(hdc, static_cast<int>(nodePos.x), 
-                           static_cast<int>(nodePos.y));
-                    
-                    // Zurück zur normalen Linienbreite nach aktuellem Wegpunkt
-                    if (i == controllerVehicle.second.currentNodeIndex && vehicle.getId() == g_selected_vehicle_id) {
-                        SelectObject(hdc, oldPen);
-                        DeleteObject(routePen);
-                        routePen = CreatePen(PS_SOLID, routeWidth, routeColor);
-                        SelectObject(hdc, routePen);
-                    }
-                    
-                    // Aktualisiere Position für nächste Iteration
-                    currentPos = nodePos;
+                // Aktueller Wegpunkt extra hervorheben bei ausgewähltem Fahrzeug
+                if (i == controllerVehicle->currentNodeIndex && vehicle.getId() == g_selected_vehicle_id) {
+                    SelectObject(hdc, oldPen);
+                    DeleteObject(routePen);
+                    routePen = CreatePen(PS_SOLID, 16, RGB(255, 100, 255)); // Extra dick und hell
+                    SelectObject(hdc, routePen);
+                }
+                
+                // Zeichne Linie von aktueller Position zum Knoten
+                MoveToEx(hdc, static_cast<int>(currentPos.x), 
+                        static_cast<int>(currentPos.y), nullptr);
+                LineTo(hdc, static_cast<int>(nodePos.x), 
+                       static_cast<int>(nodePos.y));
+                
+                // Zurück zur normalen Linienbreite nach aktuellem Wegpunkt
+                if (i == controllerVehicle->currentNodeIndex && vehicle.getId() == g_selected_vehicle_id) {
+                    SelectObject(hdc, oldPen);
+                    DeleteObject(routePen);
+                    routePen = CreatePen(PS_SOLID, routeWidth, routeColor);
+                    SelectObject(hdc, routePen);
                 }
+                
+                // Aktualisiere Position für nächste Iteration
+                currentPos = nodePos;
             }
+        }
 
-            SelectObject(hdc, oldPen);
-            DeleteObject(routePen);
-
-            // Zeichne Zielknoten extra prominent für ausgewähltes Fahrzeug
-            if (controllerVehicle.second.targetNodeId != -1) {
-                const PathNode* targetNode = pathSystem.getNode(controllerVehicle.second.targetNodeId);
-                if (targetNode) {
-                    Point targetPos = mapToFullscreenCoordinates(targetNode->position.x, targetNode->position.y);
-
-                    // Größerer und auffälligerer Zielknoten für ausgewähltes Fahrzeug
-                    int targetRadius = (vehicle.getId() == g_selected_vehicle_id) ? 30 : 15;
-                    COLORREF targetColor = (vehicle.getId() == g_selected_vehicle_id) ? 
-                                          RGB(255, 50, 255) : routeColor;
-
-                    HBRUSH targetBrush = CreateSolidBrush(targetColor);
-                    HPEN targetPen = CreatePen(PS_SOLID, 3, RGB(255, 255, 255)); // Weißer Rand
-                    HGDIOBJ oldBrush = SelectObject(hdc, targetBrush);
-                    HGDIOBJ oldTargetPen = SelectObject(hdc, targetPen);
-
-                    Ellipse(hdc, 
-                            static_cast<int>(targetPos.x - targetRadius), 
-                            static_cast<int>(targetPos.y - targetRadius),
-                            static_cast<int>(targetPos.x + targetRadius), 
-                            static_cast<int>(targetPos.y + targetRadius));
-
-                    SelectObject(hdc, oldBrush);
-                    SelectObject(hdc, oldTargetPen);
-                    DeleteObject(targetBrush);
-                    DeleteObject(targetPen);
-
-                    // Label für Zielknoten bei ausgewähltem Fahrzeug
-                    if (vehicle.getId() == g_selected_vehicle_id) {
-                        SetBkMode(hdc, TRANSPARENT);
-                        SetTextColor(hdc, RGB(255, 255, 255));
-                        char targetLabel[32];
-                        snprintf(targetLabel, sizeof(targetLabel), "ZIEL: %d", controllerVehicle.second.targetNodeId);
-                        TextOutA(hdc, static_cast<int>(targetPos.x + 35), static_cast<int>(targetPos.y - 10), 
-                                targetLabel, strlen(targetLabel));
-                    }
+        SelectObject(hdc, oldPen);
+        DeleteObject(routePen);
+
+        // Zeichne Zielknoten extra prominent für ausgewähltes Fahrzeug
+        if (controllerVehicle->targetNodeId != -1) {
+            const PathNode* targetNode = pathSystem.getNode(controllerVehicle->targetNodeId);
+            if (targetNode) {
+                Point targetPos = mapToFullscreenCoordinates(targetNode->position.x, targetNode->position.y);
+
+                // Größerer und auffälligerer Zielknoten für ausgewähltes Fahrzeug
+                int targetRadius = (vehicle.getId() == g_selected_vehicle_id) ? 30 : 15;
+                COLORREF targetColor = (vehicle.getId() == g_selected_vehicle_id) ? 
+                                      RGB(255, 50, 255) : routeColor;
+
+                HBRUSH targetBrush = CreateSolidBrush(targetColor);
+                HPEN targetPen = CreatePen(PS_SOLID, 3, RGB(255, 255, 255)); // Weißer Rand
+                HGDIOBJ oldBrush = SelectObject(hdc, targetBrush);
+                HGDIOBJ oldTargetPen = SelectObject(hdc, targetPen);
+
+                Ellipse(hdc, 
+                        static_cast<int>(targetPos.x - targetRadius), 
+                        static_cast<int>(targetPos.y - targetRadius),
+                        static_cast<int>(targetPos.x + targetRadius), 
+                        static_cast<int>(targetPos.y + targetRadius));
+
+                SelectObject(hdc, oldBrush);
+                SelectObject(hdc, oldTargetPen);
+                DeleteObject(targetBrush);
+                DeleteObject(targetPen);
+
+                // Label für Zielknoten bei ausgewähltem Fahrzeug
+                if (vehicle.getId() == g_selected_vehicle_id) {
+                    SetBkMode(hdc, TRANSPARENT);
+                    SetTextColor(hdc, RGB(255, 255, 255));
+                    char targetLabel[32];
+                    snprintf(targetLabel, sizeof(targetLabel), "ZIEL: %d", controllerVehicle->targetNodeId);
+                    TextOutA(hdc, static_cast<int>(targetPos.x + 35), static_cast<int>(targetPos.y - 10), 
+                            targetLabel, strlen(targetLabel));
                 }
             }
+        }
 
-            // RICHTUNGSPFEIL: Zeichne Pfeil vom Fahrzeug zum nächsten Wegpunkt
-            Point nextTargetPos;
-            bool hasTarget = false;
+        // RICHTUNGSPFEIL: Zeichne Pfeil vom Fahrzeug zum nächsten Wegpunkt
+        Point nextTargetPos;
+        bool hasTarget = false;
+        
+        // NEUE LOGIK: Knoten-basierte Navigation
+        if (!controllerVehicle->currentNodePath.empty() && controllerVehicle->currentNodeIndex < controllerVehicle->currentNodePath.size()) {
+            // Zeige zum nächsten Knoten in der Route
+            int nextNodeId = controllerVehicle->currentNodePath[controllerVehicle->currentNodeIndex];
+            const PathNode* nextNode = pathSystem.getNode(nextNodeId);
             
-            // NEUE LOGIK: Knoten-basierte Navigation
-            if (!controllerVehicle.second.currentNodePath.empty() && controllerVehicle.second.currentNodeIndex < controllerVehicle.second.currentNodePath.size()) {
-                // Zeige zum nächsten Knoten in der Route
-                int nextNodeId = controllerVehicle.second.currentNodePath[controllerVehicle.second.currentNodeIndex];
-                const PathNode* nextNode = pathSystem.getNode(nextNodeId);
+            if (nextNode) {
+                nextTargetPos = mapToFullscreenCoordinates(nextNode->position.x, nextNode->position.y);
+                hasTarget = true;
+                
+            }
+        } else if (controllerVehicle->targetNodeId != -1) {
+            // Keine aktive Route, aber Ziel gesetzt: zeige zum finalen Zielknoten
+            const PathNode* finalTargetNode = pathSystem.getNode(controllerVehicle->targetNodeId);
+            if (finalTargetNode) {
+                nextTargetPos = mapToFullscreenCoordinates(finalTargetNode->position.x, finalTargetNode->position.y);
+                Point vehiclePos = vehicle.getCenter();
+                float distanceToFinalTarget = vehiclePos.distanceTo(nextTargetPos);
                 
-                if (nextNode) {
-                    nextTargetPos = mapToFullscreenCoordinates(nextNode->position.x, nextNode->position.y);
+                // Nur zeigen wenn noch nicht am finalen Ziel angekommen
+                if (distanceToFinalTarget > 40.0f) {
                     hasTarget = true;
-                    
-                }
-            } else if (controllerVehicle.second.targetNodeId != -1) {
-                // Keine aktive Route, aber Ziel gesetzt: zeige zum finalen Zielknoten
-                const PathNode* finalTargetNode = pathSystem.getNode(controllerVehicle.second.targetNodeId);
-                if (finalTargetNode) {
-                    nextTargetPos = mapToFullscreenCoordinates(finalTargetNode->position.x, finalTargetNode->position.y);
-                    Point vehiclePos = vehicle.getCenter();
-                    float distanceToFinalTarget = vehiclePos.distanceTo(nextTargetPos);
-                    
-                    // Nur zeigen wenn noch nicht am finalen Ziel angekommen
-                    if (distanceToFinalTarget > 40.0f) {
-                        hasTarget = true;
-                    }
                 }
             }
+        }
+        
+        if (hasTarget) {
+            Point vehiclePos = vehicle.getCenter();
             
-            if (hasTarget) {
-                Point vehiclePos = vehicle.getCenter();
+            // Berechne Richtungsvektor
+            float dx = nextTargetPos.x - vehiclePos.x;
+            float dy = nextTargetPos.y - vehiclePos.y;
+            float length = sqrt(dx*dx + dy*dy);
+            
+            if (length > 10.0f) { // Nur zeichnen wenn nächster Punkt weit genug weg ist
+                // Normalisiere Richtung
+                dx /= length;
+                dy /= length;
                 
-                // Berechne Richtungsvektor
-                float dx = nextTargetPos.x - vehiclePos.x;
-                float dy = nextTargetPos.y - vehiclePos.y;
-                float length = sqrt(dx*dx + dy*dy);
+                // Pfeil-Parameter
+                float arrowLength = 80.0f;  // Länge des Pfeils
+                float arrowHeadSize = 20.0f; // Größe der Pfeilspitze
                 
-                if (length > 10.0f) { // Nur zeichnen wenn nächster Punkt weit genug weg ist
-                    // Normalisiere Richtung
-                    dx /= length;
-                    dy /= length;
-                    
-                    // Pfeil-Parameter
-                    float arrowLength = 80.0f;  // Länge des Pfeils
-                    float arrowHeadSize = 20.0f; // Größe der Pfeilspitze
-                    
-                    // Pfeil-Ende-Position
-                    Point arrowEnd;
-                    arrowEnd.x = vehiclePos.x + dx * arrowLength;
-                    arrowEnd.y = vehiclePos.y + dy * arrowLength;
-                    
-                    // Zeichne Pfeil-Linie (dick und gut sichtbar)
-                    HPEN arrowPen = CreatePen(PS_SOLID, 6, RGB(0, 255, 255)); // Cyan für gute Sichtbarkeit
-                    HGDIOBJ oldArrowPen = SelectObject(hdc, arrowPen);
-                            
-                    MoveToEx(hdc, static_cast<int>(vehiclePos.x), static_cast<int>(vehiclePos.y), nullptr);
-                    LineTo(hdc, static_cast<int>(arrowEnd.x), static_cast<int>(arrowEnd.y));
-                    
-                    // Zeichne Pfeilspitze
-                    float headAngle = 0.5f; // Winkel der Pfeilspitze
-                    Point head1, head2;
-                    
-                    head1.x = arrowEnd.x - dx * arrowHeadSize * cos(headAngle) + dy * arrowHeadSize * sin(headAngle);
-                    head1.y = arrowEnd.y - dy * arrowHeadSize * cos(headAngle) - dx * arrowHeadSize * sin(headAngle);
-                    
-                    head2.x = arrowEnd.x - dx * arrowHeadSize * cos(headAngle) - dy * arrowHeadSize * sin(headAngle);
-                    head2.y = arrowEnd.y - dy * arrowHeadSize * cos(headAngle) + dx * arrowHeadSize * sin(headAngle);
-                    
-                    // Zeichne Pfeilspitze-Linien
-                    MoveToEx(hdc, static_cast<int>(arrowEnd.x), static_cast<int>(arrowEnd.y), nullptr);
-                    LineTo(hdc, static_cast<int>(head1.x), static_cast<int>(head1.y));
-                    
-                    MoveToEx(hdc, static_cast<int>(arrowEnd.x), static_cast<int>(arrowEnd.y), nullptr);
-                    LineTo(hdc, static_cast<int>(head2.x), static_cast<int>(head2.y));
-                    
-                    SelectObject(hdc, oldArrowPen);
-                    DeleteObject(arrowPen);
-                }
+                // Pfeil-Ende-Position
+                Point arrowEnd;
+                arrowEnd.x = vehiclePos.x + dx * arrowLength;
+                arrowEnd.y = vehiclePos.y + dy * arrowLength;
+                
+                // Zeichne Pfeil-Linie (dick und gut sichtbar)
+                HPEN arrowPen = CreatePen(PS_SOLID, 6, RGB(0, 255, 255)); // Cyan für gute Sichtbarkeit
+                HGDIOBJ oldArrowPen = SelectObject(hdc, arrowPen);
+                        
+                MoveToEx(hdc, static_cast<int>(vehiclePos.x), static_cast<int>(vehiclePos.y), nullptr);
+                LineTo(hdc, static_cast<int>(arrowEnd.x), static_cast<int>(arrowEnd.y));
+                
+                // Zeichne Pfeilspitze
+                float headAngle = 0.5f; // Winkel der Pfeilspitze
+                Point head1, head2;
+                
+                head1.x = arrowEnd.x - dx * arrowHeadSize * cos(headAngle) + dy * arrowHeadSize * sin(headAngle);
+                head1.y = arrowEnd.y - dy * arrowHeadSize * cos(headAngle) - dx * arrowHeadSize * sin(headAngle);
+                
+                head2.x = arrowEnd.x - dx * arrowHeadSize * cos(headAngle) - dy * arrowHeadSize * sin(headAngle);
+                head2.y = arrowEnd.y - dy * arrowHeadSize * cos(headAngle) + dx * arrowHeadSize * sin(headAngle);
+                
+                // Zeichne Pfeilspitze-Linien
+                MoveToEx(hdc, static_cast<int>(arrowEnd.x), static_cast<int>(arrowEnd.y), nullptr);
+                LineTo(hdc, static_cast<int>(head1.x), static_cast<int>(head1.y));
+                
+                MoveToEx(hdc, static_cast<int>(arrowEnd.x), static_cast<int>(arrowEnd.y), nullptr);
+                LineTo(hdc, static_cast<int>(head2.x), static_cast<int>(head2.y));
+                
+                SelectObject(hdc, oldArrowPen);
+                DeleteObject(arrowPen);
             }
-            break;
         }
     }
 }
@@ -1408,8 +1469,8 @@ LRESULT CALLBACK TestWindowProc(HWND hwnd, UINT uMsg, WPARAM wParam, LPARAM lPar
                 if (g_path_system && g_vehicle_controller) {
                     int nearestNodeId = g_path_system->findNearestNode(clickPos, 80.0f);
                     if (nearestNodeId != -1) {
-                        // Ziel für das ausgewählte Fahrzeug setzen
-                        const_cast<VehicleController*>(g_vehicle_controller)->setVehicleTargetNode(g_selected_vehicle_id, nearestNodeId);
+                        // Ziel für das ausgewählte Fahrzeug setzen (Fenster-Thread: wird im nächsten Frame geplant)
+                        const_cast<VehicleController*>(g_vehicle_controller)->postVehicleTarget(g_selected_vehicle_id, nearestNodeId);
                         std::cout << "Fahrzeug " << g_selected_vehicle_id << " Ziel gesetzt auf Knoten " << nearestNodeId << std::endl;
                         
                         // Aktualisiere Fahrzeug-Befehle für die nächste Iteration
@@ -1607,8 +1668,8 @@ void setTestWindowPathSystem(const PathSystem* pathSystem, const VehicleControll
 
 // Update-Funktion für Live-Koordinaten und Auto-Erkennung
 // Öffentliche Funktion für kalibrierte Koordinaten-Transformation
-void getCalibratedTransform(float crop_x, float crop_y, float crop_width, float crop_height, float& fullscreen_x, float& fullscreen_y) {
-    transformCropToFullscreen(crop_x, crop_y, crop_width, crop_height, fullscreen_x, fullscreen_y);
+bool getCalibratedTransform(float crop_x, float crop_y, float crop_width, float crop_height, float& fullscreen_x, float& fullscreen_y) {
+    return transformCropToFullscreen(crop_x, crop_y, crop_width, crop_height, fullscreen_x, fullscreen_y);
 }
 
 void updateTestWindowCoordinates(const std::vector<DetectedObject>& detected_objects) {
@@ -1629,21 +1690,26 @@ void updateTestWindowCoordinates(const std::vector<DetectedObject>& detected_obj
             }
 
             float fullscreen_x, fullscreen_y;
-            transformCropToFullscreen(obj.coordinates.x, obj.coordinates.y, 
-                                    obj.crop_width, obj.crop_height, 
-                                    fullscreen_x, fullscreen_y);
+            if (!transformCropToFullscreen(obj.coordinates.x, obj.coordinates.y, 
+                                           obj.crop_width, obj.crop_height, 
+                                           fullscreen_x, fullscreen_y)) {
+                continue;
+            }
 
             // Erweiterte Gültigkeitsprüfung
             bool isValid = (fullscreen_x >= 50 && fullscreen_x <= FULLSCREEN_WIDTH - 50 && 
                            fullscreen_y >= 50 && fullscreen_y <= FULLSCREEN_HEIGHT - 50);
 
             if (isValid) {
-                // Create point with correct type and color
-                if (obj.color == "Front") {
-                    g_points.emplace_back(fullscreen_x, fullscreen_y, PointType::FRONT, obj.color);
-                } else if (obj.color.find("Heck") == 0) {
-                    g_points.emplace_back(fullscreen_x, fullscreen_y, PointType::IDENTIFICATION, obj.color);
+                // Create point with correct type and marker
+                if (isFrontMarker(obj.marker)) {
+                    g_points.emplace_back(fullscreen_x, fullscreen_y, PointType::FRONT, obj.marker);
+                } else if (isHeckMarker(obj.marker)) {
+                    g_points.emplace_back(fullscreen_x, fullscreen_y, PointType::IDENTIFICATION, obj.marker);
+                } else {
+                    continue;
                 }
+                g_points.back().stamp = obj.stamp;
             }
         }
 
@@ -0,0 +1,842 @@
+#include "traffic_benchmark.h"
+#include "factory_layout.h"
+#include "job_dispatcher.h"
+#include "marker_id.h"
+#include "vehicle_controller.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct SimVehicle {
+    int vehicleId;
+    int currentNodeId;
+    std::vector<int> segmentPath;
+    size_t segmentIndex;
+    bool onSegment;
+    float progress;          // px travelled on the current segment
+    double tripStartTime;
+    float tripWaitTime;
+    float predictedTripTime; // ETA from the segment statistics at trip start
+    float urgency;           // Random per trip, used by the queue policies
+    double waitStartTime;    // Start of the current queue wait (-1 = not waiting)
+    int jobsDone;
+};
+
+float remainingRouteLength(const SimVehicle& vehicle, const PathSystem& pathSystem) {
+    float remaining = 0.0f;
+    for (size_t i = vehicle.segmentIndex; i < vehicle.segmentPath.size(); i++) {
+        remaining += pathSystem.getSegment(vehicle.segmentPath[i])->length;
+    }
+    return remaining - vehicle.progress;
+}
+
+float percentile(std::vector<float> samples, float p) {
+    if (samples.empty()) return 0.0f;
+    size_t index = static_cast<size_t>(p * (samples.size() - 1));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+void startNewTrip(SimVehicle& vehicle, const PathSystem& pathSystem, const SegmentManager& segmentManager,
+                  std::mt19937& rng, double now) {
+    vehicle.segmentPath.clear();
+    vehicle.segmentIndex = 0;
+    vehicle.onSegment = false;
+    vehicle.progress = 0.0f;
+    vehicle.tripStartTime = now;
+    vehicle.tripWaitTime = 0.0f;
+    vehicle.waitStartTime = -1.0f;
+    vehicle.urgency = std::uniform_real_distribution<float>(0.0f, 1.0f)(rng);
+
+    while (vehicle.segmentPath.empty()) {
+        int target = pickRandomTarget(pathSystem, vehicle.currentNodeId, rng);
+        if (target == -1) return;
+        vehicle.segmentPath = pathSystem.findPath(vehicle.currentNodeId, target);
+    }
+    vehicle.predictedTripTime = segmentManager.estimatePathTime(vehicle.segmentPath, vehicle.vehicleId);
+}
+
+} // namespace
+
+int pickRandomTarget(const PathSystem& pathSystem, int currentNodeId, std::mt19937& rng) {
+    std::vector<int> candidates;
+    for (const auto& node : pathSystem.getNodes()) {
+        if (!node.isWaitingNode && node.nodeId != currentNodeId) {
+            candidates.push_back(node.nodeId);
+        }
+    }
+    if (candidates.empty()) return -1;
+    std::uniform_int_distribution<size_t> dist(0, candidates.size() - 1);
+    return candidates[dist(rng)];
+}
+
+TrafficBenchmarkResult runTrafficBenchmark(const std::string& label, const TrafficBenchmarkConfig& config) {
+    PathSystem pathSystem;
+    createFactoryLayout(pathSystem);
+
+    SegmentManager segmentManager(&pathSystem);
+    segmentManager.setPlatoonConfig(config.platoon);
+    segmentManager.setQueueConfig(config.queue);
+
+    std::mt19937 rng(config.seed);
+
+    // Spread the fleet over the main nodes
+    std::vector<int> mainNodes;
+    for (const auto& node : pathSystem.getNodes()) {
+        if (!node.isWaitingNode) mainNodes.push_back(node.nodeId);
+    }
+
+    std::vector<SimVehicle> fleet(config.vehicleCount);
+    for (int i = 0; i < config.vehicleCount; i++) {
+        fleet[i].vehicleId = i + 1;
+        fleet[i].currentNodeId = mainNodes[i % mainNodes.size()];
+        fleet[i].jobsDone = 0;
+        startNewTrip(fleet[i], pathSystem, segmentManager, rng, 0.0f);
+    }
+
+    int completedTrips = 0;
+    double totalTripTime = 0.0;
+    double totalWaitTime = 0.0;
+    double totalEtaError = 0.0;
+    std::vector<float> waitSamples;
+    float makespan = config.simulatedSeconds;
+    int finishedVehicles = 0;
+
+    const int steps = static_cast<int>(config.simulatedSeconds / config.timeStep);
+    for (int step = 0; step < steps; step++) {
+        segmentManager.update(config.timeStep);
+        double now = segmentManager.getCurrentTime();
+
+        for (SimVehicle& vehicle : fleet) {
+            if (vehicle.segmentIndex >= vehicle.segmentPath.size()) continue;
+            int segmentId = vehicle.segmentPath[vehicle.segmentIndex];
+            const PathSegment* segment = pathSystem.getSegment(segmentId);
+
+            if (!vehicle.onSegment) {
+                // Admitted from the queue during update(), or reserve directly
+                if (segmentManager.getVehicleSegment(vehicle.vehicleId) == segmentId ||
+                    segmentManager.reserveSegment(segmentId, vehicle.vehicleId, vehicle.currentNodeId)) {
+                    vehicle.onSegment = true;
+                    vehicle.progress = 0.0f;
+                    if (vehicle.waitStartTime >= 0.0f) {
+                        waitSamples.push_back(now - vehicle.waitStartTime);
+                        vehicle.waitStartTime = -1.0f;
+                    }
+                } else {
+                    if (vehicle.waitStartTime < 0.0f) {
+                        SegmentManager::VehicleQueueInfo info;
+                        info.urgency = vehicle.urgency;
+                        info.remainingRoute = remainingRouteLength(vehicle, pathSystem);
+                        segmentManager.setVehicleQueueInfo(vehicle.vehicleId, info);
+                        vehicle.waitStartTime = now;
+                    }
+                    segmentManager.addToQueue(segmentId, vehicle.vehicleId, vehicle.currentNodeId);
+                    vehicle.tripWaitTime += config.timeStep;
+                    continue;
+                }
+            }
+
+            vehicle.progress += config.vehicleSpeed * config.timeStep;
+            if (vehicle.progress < segment->length) continue;
+
+            // End of segment reached
+            segmentManager.releaseSegment(segmentId, vehicle.vehicleId);
+            vehicle.currentNodeId = (segment->startNodeId == vehicle.currentNodeId) ? segment->endNodeId
+                                                                                   : segment->startNodeId;
+            vehicle.onSegment = false;
+            vehicle.segmentIndex++;
+
+            if (vehicle.segmentIndex >= vehicle.segmentPath.size()) {
+                completedTrips++;
+                totalTripTime += now - vehicle.tripStartTime;
+                totalWaitTime += vehicle.tripWaitTime;
+                totalEtaError += std::fabs((now - vehicle.tripStartTime) - vehicle.predictedTripTime);
+                vehicle.jobsDone++;
+
+                if (config.jobsPerVehicle > 0 && vehicle.jobsDone >= config.jobsPerVehicle) {
+                    vehicle.segmentPath.clear();   // Parked; the last node stays free
+                    finishedVehicles++;
+                } else {
+                    startNewTrip(vehicle, pathSystem, segmentManager, rng, now);
+                }
+            }
+        }
+
+        if (config.jobsPerVehicle > 0 && finishedVehicles == config.vehicleCount) {
+            makespan = static_cast<float>(now);
+            break;
+        }
+    }
+
+    if (!config.statisticsCsv.empty()) {
+        segmentManager.getStatistics().writeCsv(config.statisticsCsv);
+    }
+
+    TrafficBenchmarkResult result;
+    result.label = label;
+    result.completedTrips = completedTrips;
+    result.tripsPerMinute = completedTrips / (config.simulatedSeconds / 60.0f);
+    result.averageTripTime = completedTrips > 0 ? static_cast<float>(totalTripTime / completedTrips) : 0.0f;
+    result.averageWaitPerTrip = completedTrips > 0 ? static_cast<float>(totalWaitTime / completedTrips) : 0.0f;
+    result.averageEtaError = completedTrips > 0 ? static_cast<float>(totalEtaError / completedTrips) : 0.0f;
+    result.makespan = makespan;
+    result.p99Wait = percentile(waitSamples, 0.99f);
+    result.maxWait = waitSamples.empty() ? 0.0f : *std::max_element(waitSamples.begin(), waitSamples.end());
+    return result;
+}
+
+void printTrafficBenchmarkResult(const TrafficBenchmarkResult& result) {
+    std::cout << std::left << std::setw(28) << result.label << std::right << std::fixed << std::setprecision(1)
+              << std::setw(8) << result.completedTrips
+              << std::setw(12) << result.tripsPerMinute
+              << std::setw(12) << result.averageTripTime
+              << std::setw(12) << result.averageWaitPerTrip
+              << std::setw(12) << result.averageEtaError << "\n";
+}
+
+void runPlatooningComparison(const std::string& statisticsCsv) {
+    std::cout << "=== Segment throughput: exclusive vs. platooning (factory layout) ===\n";
+    std::cout << std::left << std::setw(28) << "Mode" << std::right
+              << std::setw(8) << "Trips" << std::setw(12) << "Trips/min"
+              << std::setw(12) << "Trip [s]" << std::setw(12) << "Wait [s]"
+              << std::setw(12) << "ETA err [s]" << "\n";
+
+    for (int vehicleCount : {4, 8, 16}) {
+        TrafficBenchmarkConfig config;
+        config.vehicleCount = vehicleCount;
+
+        config.platoon.enabled = false;
+        printTrafficBenchmarkResult(runTrafficBenchmark("exclusive, " + std::to_string(vehicleCount) + " vehicles", config));
+
+        config.platoon.enabled = true;
+        if (vehicleCount == 16) config.statisticsCsv = statisticsCsv;
+        printTrafficBenchmarkResult(runTrafficBenchmark("platooning, " + std::to_string(vehicleCount) + " vehicles", config));
+    }
+    std::cout << std::flush;
+}
+
+void runQueuePolicyComparison() {
+    std::cout << "=== Queue policies: fixed job set, platooning on (factory layout) ===\n";
+    std::cout << std::left << std::setw(34) << "Policy" << std::right
+              << std::setw(12) << "Makespan" << std::setw(12) << "Wait [s]"
+              << std::setw(12) << "p99 [s]" << std::setw(12) << "max [s]" << "\n";
+
+    const std::pair<SegmentManager::QueuePolicy, const char*> policies[] = {
+        {SegmentManager::QueuePolicy::FIFO, "FIFO"},
+        {SegmentManager::QueuePolicy::PRIORITY, "priority"},
+        {SegmentManager::QueuePolicy::SHORTEST_REMAINING_ROUTE, "shortest remaining"},
+        {SegmentManager::QueuePolicy::AGING, "aging"},
+    };
+
+    for (int vehicleCount : {8, 16}) {
+        for (const auto& policy : policies) {
+            TrafficBenchmarkConfig config;
+            config.vehicleCount = vehicleCount;
+            config.jobsPerVehicle = 40;
+            config.simulatedSeconds = 7200.0f;
+            config.queue.policy = policy.first;
+
+            TrafficBenchmarkResult result = runTrafficBenchmark(
+                std::string(policy.second) + ", " + std::to_string(vehicleCount) + " vehicles", config);
+            std::cout << std::left << std::setw(34) << result.label << std::right << std::fixed << std::setprecision(1)
+                      << std::setw(12) << result.makespan
+                      << std::setw(12) << result.averageWaitPerTrip
+                      << std::setw(12) << result.p99Wait
+                      << std::setw(12) << result.maxWait << "\n";
+        }
+    }
+    std::cout << std::flush;
+}
+
+void runControllerQueuePolicyCheck() {
+    std::cout << "=== Queue policies through the VehicleController (3 vehicles blocked at one segment) ===\n";
+    std::cout << std::left << std::setw(22) << "Policy" << std::right << std::setw(18) << "Admission order"
+              << std::setw(18) << "Differs from FIFO" << "\n";
+
+    // Three arms into a hub, one shared segment hub -> gate, then a tail of its own per vehicle.
+    // Vehicle i arrives at the hub after i seconds; urgency and remaining route rank them differently.
+    const float armLength[] = {100.0f, 200.0f, 300.0f};
+    const float tailLength[] = {400.0f, 300.0f, 200.0f};   // Vehicle 3 has the shortest remaining route
+    const float urgency[] = {0.0f, 1.0f, 0.5f};            // Vehicle 2 has the most urgent job
+
+    const std::pair<SegmentManager::QueuePolicy, const char*> policies[] = {
+        {SegmentManager::QueuePolicy::FIFO, "FIFO"},
+        {SegmentManager::QueuePolicy::PRIORITY, "priority"},
+        {SegmentManager::QueuePolicy::SHORTEST_REMAINING_ROUTE, "shortest remaining"},
+        {SegmentManager::QueuePolicy::AGING, "aging"},
+    };
+
+    std::vector<int> fifoOrder;
+    for (const auto& policy : policies) {
+        PathSystem pathSystem;
+        int hub = pathSystem.addNode(1000.0f, 1000.0f);
+        int gate = pathSystem.addNode(1200.0f, 1000.0f);
+        int sharedSegment = pathSystem.addSegment(hub, gate);
+        const Point armDirection[] = {Point(0.0f, -1.0f), Point(-1.0f, 0.0f), Point(0.0f, 1.0f)};
+        const Point tailDirection[] = {Point(0.0f, -1.0f), Point(0.0f, 1.0f), Point(1.0f, 0.0f)};
+        int armNodes[3], tailNodes[3];
+        for (int i = 0; i < 3; i++) {
+            armNodes[i] = pathSystem.addNode(1000.0f + armDirection[i].x * armLength[i], 1000.0f + armDirection[i].y * armLength[i]);
+            tailNodes[i] = pathSystem.addNode(1200.0f + tailDirection[i].x * tailLength[i], 1000.0f + tailDirection[i].y * tailLength[i]);
+            pathSystem.addSegment(armNodes[i], hub);
+            pathSystem.addSegment(gate, tailNodes[i]);
+        }
+
+        SegmentManager segmentManager(&pathSystem);
+        SegmentManager::PlatoonConfig platoon = segmentManager.getPlatoonConfig();
+        platoon.enabled = false;
+        segmentManager.setPlatoonConfig(platoon);
+        SegmentManager::QueueConfig queue;
+        queue.policy = policy.first;
+        segmentManager.setQueueConfig(queue);
+
+        VehicleController controller(&pathSystem, &segmentManager);
+        controller.setSimulatedMovement(true);
+        controller.setLoggingEnabled(false);
+
+        std::vector<int> admissionOrder;
+        controller.getEventBus().subscribe<NodeReachedEvent>([&](const std::vector<NodeReachedEvent>& batch) {
+            for (const NodeReachedEvent& event : batch) {
+                if (event.nodeId == gate) admissionOrder.push_back(event.vehicleId);
+            }
+        });
+
+        for (int i = 0; i < 3; i++) {
+            int vehicleId = controller.addVehicle(pathSystem.getNode(armNodes[i])->position);
+            Auto* vehicle = controller.getVehicle(vehicleId);
+            vehicle->currentNodeId = armNodes[i];
+            vehicle->realWorldCoordinates = vehicle->position;
+            vehicle->speed = 100.0f;
+            controller.setVehicleTargetNode(vehicleId, tailNodes[i]);
+            controller.setVehicleJobUrgency(vehicleId, urgency[i]);
+        }
+
+        // Hold the shared segment until all three wait at the hub, then let the queue drain
+        const int blockerId = 1000;
+        segmentManager.reserveSegment(sharedSegment, blockerId, gate);
+        for (int step = 0; step < 20 * 60 && admissionOrder.size() < 3; step++) {
+            if (step == 4 * 60) segmentManager.releaseSegment(sharedSegment, blockerId);
+            controller.updateVehicles(1.0f / 60.0f);
+        }
+
+        std::string order;
+        for (int vehicleId : admissionOrder) order += (order.empty() ? "" : " ") + std::to_string(vehicleId);
+        if (policy.first == SegmentManager::QueuePolicy::FIFO) fifoOrder = admissionOrder;
+        std::cout << std::left << std::setw(22) << policy.second << std::right << std::setw(18) << order
+                  << std::setw(18) << (admissionOrder.size() == 3 ? (admissionOrder != fifoOrder ? "yes" : "no") : "incomplete") << "\n";
+    }
+    std::cout << std::flush;
+}
+
+namespace {
+
+// Live reservation and fleet state as seen through the public interfaces
+struct SegmentView {
+    std::vector<int> occupants;
+    int occupiedFromNodeId;
+    double lastEntryTime;
+    std::vector<SegmentQueue::Entry> queue;
+
+    bool operator==(const SegmentView& other) const {
+        if (occupants != other.occupants || occupiedFromNodeId != other.occupiedFromNodeId ||
+            lastEntryTime != other.lastEntryTime || queue.size() != other.queue.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < queue.size(); i++) {
+            const SegmentQueue::Entry& a = queue[i];
+            const SegmentQueue::Entry& b = other.queue[i];
+            if (a.vehicleId != b.vehicleId || a.fromNodeId != b.fromNodeId || a.enqueueTime != b.enqueueTime ||
+                a.key != b.key || a.sequence != b.sequence) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+struct VehicleView {
+    bool exists;
+    int segmentId;                 // SegmentManager::getVehicleSegment
+    std::vector<int> heldSegments;
+    Auto record;
+
+    bool operator==(const VehicleView& other) const {
+        if (exists != other.exists) return false;
+        if (!exists) return true;
+        const Auto& a = record;
+        const Auto& b = other.record;
+        return segmentId == other.segmentId && heldSegments == other.heldSegments &&
+               a.position.x == b.position.x && a.position.y == b.position.y && a.getDirection() == b.getDirection() &&
+               a.currentNodeId == b.currentNodeId && a.targetNodeId == b.targetNodeId &&
+               a.pendingTargetNodeId == b.pendingTargetNodeId && a.currentNodePath == b.currentNodePath &&
+               a.currentNodeIndex == b.currentNodeIndex && a.state == b.state && a.speed == b.speed &&
+               a.jobUrgency == b.jobUrgency && a.isMoving == b.isMoving && a.isWaitingInQueue == b.isWaitingInQueue &&
+               a.currentSegmentId == b.currentSegmentId;
+    }
+};
+
+struct WorldView {
+    double time;
+    std::vector<SegmentView> segments;   // In PathSystem::getSegments() order
+    std::vector<VehicleView> vehicles;   // Indexed by vehicle ID
+};
+
+WorldView captureWorld(const PathSystem& pathSystem, const SegmentManager& segmentManager,
+                       const VehicleController& controller, int maxVehicleId) {
+    WorldView view;
+    view.time = segmentManager.getCurrentTime();
+    view.segments.resize(pathSystem.getSegmentCount());
+    for (size_t i = 0; i < view.segments.size(); i++) {
+        const PathSegment& segment = pathSystem.getSegments()[i];
+        SegmentView& state = view.segments[i];
+        state.occupants = segment.occupantVehicleIds;
+        state.occupiedFromNodeId = segment.occupiedFromNodeId;
+        state.lastEntryTime = segment.lastEntryTime;
+        if (const SegmentQueue* queue = segmentManager.getSegmentQueue(segment.segmentId)) {
+            state.queue = queue->ordered();
+        }
+    }
+    view.vehicles.resize(maxVehicleId + 1);
+    for (int vehicleId = 1; vehicleId <= maxVehicleId; vehicleId++) {
+        VehicleView& state = view.vehicles[vehicleId];
+        const Auto* vehicle = controller.getVehicle(vehicleId);
+        state.exists = vehicle != nullptr;
+        state.segmentId = segmentManager.getVehicleSegment(vehicleId);
+        state.heldSegments = segmentManager.getHeldSegments(vehicleId);
+        if (vehicle) state.record = *vehicle;
+    }
+    return view;
+}
+
+template <typename T>
+int countDifferences(const std::vector<T>& a, const std::vector<T>& b) {
+    int differences = 0;
+    for (size_t i = 0; i < std::min(a.size(), b.size()); i++) {
+        if (!(a[i] == b[i])) differences++;
+    }
+    return differences;
+}
+
+} // namespace
+
+void runWorldSnapshotCheck() {
+    std::cout << "=== World snapshot: reserve/release/move, then rollback (factory layout, platooning on) ===\n";
+    std::cout << std::left << std::setw(12) << "Vehicles" << std::right << std::setw(8) << "Held"
+              << std::setw(9) << "Queued" << std::setw(15) << "Seg. changed" << std::setw(15) << "Veh. changed"
+              << std::setw(8) << "Same" << "\n";
+
+    const float timeStep = 0.05f;
+    for (int vehicleCount : {8, 16, 32}) {
+        PathSystem pathSystem;
+        createFactoryLayout(pathSystem);
+        SegmentManager segmentManager(&pathSystem);
+        VehicleController controller(&pathSystem, &segmentManager);
+        controller.setSimulatedMovement(true);
+        controller.setLoggingEnabled(false);
+
+        std::vector<int> mainNodes;
+        for (const auto& node : pathSystem.getNodes()) {
+            if (!node.isWaitingNode) mainNodes.push_back(node.nodeId);
+        }
+        auto addVehicle = [&](int nodeId) {
+            const PathNode* start = pathSystem.getNode(nodeId);
+            int vehicleId = controller.addVehicle(start->position);
+            Auto* vehicle = controller.getVehicle(vehicleId);
+            vehicle->currentNodeId = nodeId;
+            vehicle->realWorldCoordinates = start->position;
+            vehicle->speed = 100.0f;
+            return vehicleId;
+        };
+        for (int i = 0; i < vehicleCount; i++) addVehicle(mainNodes[i % mainNodes.size()]);
+
+        // Random trips, a new one whenever a vehicle arrives
+        std::mt19937 rng(42);
+        auto drive = [&](float seconds) {
+            for (int step = 0; step < static_cast<int>(seconds / timeStep); step++) {
+                std::vector<int> arrived;
+                for (const Auto& vehicle : controller.getAllVehicles()) {
+                    if (vehicle.state == VehicleState::ARRIVED) arrived.push_back(vehicle.vehicleId);
+                }
+                for (int vehicleId : arrived) {
+                    int target = pickRandomTarget(pathSystem, controller.getVehicle(vehicleId)->currentNodeId, rng);
+                    if (target != -1) controller.setVehicleTargetNode(vehicleId, target);
+                }
+                controller.updateVehicles(timeStep);
+            }
+        };
+
+        drive(30.0f);
+        WorldSnapshot world = controller.snapshotWorld();
+        const int maxVehicleId = vehicleCount + 1;   // One vehicle is added after the snapshot
+        WorldView before = captureWorld(pathSystem, segmentManager, controller, maxVehicleId);
+
+        int held = 0, queued = 0;
+        for (const VehicleView& vehicle : before.vehicles) held += static_cast<int>(vehicle.heldSegments.size());
+        for (const SegmentView& segment : before.segments) queued += static_cast<int>(segment.queue.size());
+
+        // Diverge: keep driving, remove one vehicle (releases its reservations), add one on a trip
+        drive(10.0f);
+        controller.removeVehicle(1);
+        int addedId = addVehicle(mainNodes.back());
+        controller.setVehicleTargetNode(addedId, mainNodes.front());
+        drive(5.0f);
+        WorldView diverged = captureWorld(pathSystem, segmentManager, controller, maxVehicleId);
+
+        controller.rollbackWorld(world);
+        WorldView after = captureWorld(pathSystem, segmentManager, controller, maxVehicleId);
+        bool same = after.time == before.time && countDifferences(after.segments, before.segments) == 0 &&
+                    countDifferences(after.vehicles, before.vehicles) == 0;
+
+        // The restored state must also drive on
+        drive(5.0f);
+
+        std::cout << std::left << std::setw(12) << vehicleCount << std::right << std::setw(8) << held
+                  << std::setw(9) << queued << std::setw(15) << countDifferences(diverged.segments, before.segments)
+                  << std::setw(15) << countDifferences(diverged.vehicles, before.vehicles)
+                  << std::setw(8) << (same ? "yes" : "no") << "\n";
+    }
+    std::cout << std::flush;
+}
+
+namespace {
+volatile float benchmarkSink;   // Keeps the lookups in the fleet benchmark from being optimized away
+}
+
+void runFleetUpdateBenchmark() {
+    std::cout << "=== Fleet update cost per frame (VehicleController, simulated movement, factory layout) ===\n";
+    std::cout << std::left << std::setw(12) << "Vehicles" << std::right << std::setw(9) << "Threads"
+              << std::setw(14) << "Frame [us]" << std::setw(14) << "Vehicle [ns]" << std::setw(12) << "Moving [%]"
+              << std::setw(11) << "Sync [us]" << std::setw(13) << "Kernel [us]" << std::setw(13) << "Replan [us]"
+              << std::setw(16) << "Conflicts [us]" << std::setw(11) << "Conflicts" << "\n";
+
+    const int frames = 2000;
+    const float timeStep = 1.0f / 60.0f;
+    std::vector<unsigned> threadCounts = {1};
+    if (std::thread::hardware_concurrency() > 1) threadCounts.push_back(std::thread::hardware_concurrency());
+
+    for (int vehicleCount : {10, 100, 1000}) {
+        for (unsigned threads : threadCounts) {
+            PathSystem pathSystem;
+            createFactoryLayout(pathSystem);
+            SegmentManager segmentManager(&pathSystem);
+            VehicleController controller(&pathSystem, &segmentManager);
+            TaskScheduler scheduler(threads);
+            controller.setTaskScheduler(&scheduler);
+            controller.setSimulatedMovement(true);
+            controller.setLoggingEnabled(false);
+
+            const auto& nodes = pathSystem.getNodes();
+            for (int i = 0; i < vehicleCount; i++) {
+                const PathNode& start = nodes[i % nodes.size()];
+                Auto* vehicle = controller.getVehicle(controller.addVehicle(start.position));
+                vehicle->currentNodeId = start.nodeId;
+                vehicle->realWorldCoordinates = start.position;
+                vehicle->speed = 100.0f;
+            }
+
+            // Same random trips for every thread count; arrived vehicles get their next trip
+            // between frames, outside the measured time
+            std::mt19937 rng(42);
+            std::vector<int> arrived;
+            const VehicleController& reader = controller;
+            float checksum = 0.0f;
+            double measured = 0.0, sync = 0.0, kernel = 0.0, replanning = 0.0;
+            size_t moving = 0;
+            auto frame = [&]() {
+                arrived.clear();
+                for (const Auto& vehicle : reader.getAllVehicles()) {
+                    if (vehicle.state == VehicleState::ARRIVED) arrived.push_back(vehicle.vehicleId);
+                    if (vehicle.state == VehicleState::MOVING) moving++;
+                }
+                for (int vehicleId : arrived) {
+                    int target = pickRandomTarget(pathSystem, reader.getVehicle(vehicleId)->currentNodeId, rng);
+                    if (target != -1) controller.setVehicleTargetNode(vehicleId, target);
+                }
+
+                // One frame: advance, then what rendering and the command export read back
+                auto start = std::chrono::steady_clock::now();
+                controller.updateVehicles(timeStep);
+                const VehicleController::UpdateTiming& timing = reader.getLastUpdateTiming();
+                sync += std::chrono::duration<double>(timing.sync).count();
+                kernel += std::chrono::duration<double>(timing.movement).count();
+                replanning += std::chrono::duration<double>(timing.replanning).count();
+                for (int vehicleId : controller.getActiveVehicleIds()) {
+                    const Auto* vehicle = reader.getVehicle(vehicleId);
+                    checksum += vehicle->position.x + static_cast<float>(vehicle->currentNodeIndex);
+                }
+                measured += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            };
+
+            for (int i = 0; i < frames / 10; i++) frame();   // Warm-up
+            measured = sync = kernel = replanning = 0.0;
+            moving = 0;
+            for (int i = 0; i < frames; i++) frame();
+            double frameMicros = measured * 1e6 / frames;
+            double movingPercent = 100.0 * moving / (static_cast<double>(frames) * vehicleCount);
+
+            const int conflictRuns = std::max(3, 20000 / vehicleCount);
+            size_t conflictCount = 0;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < conflictRuns; i++) conflictCount = controller.detectUpcomingConflicts().size();
+            double conflictMicros = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6 / conflictRuns;
+
+            std::cout << std::left << std::setw(12) << vehicleCount << std::right << std::setw(9) << scheduler.getThreadCount()
+                      << std::fixed << std::setprecision(2)
+                      << std::setw(14) << frameMicros
+                      << std::setw(14) << frameMicros * 1000.0 / vehicleCount
+                      << std::setprecision(1) << std::setw(12) << movingPercent << std::setprecision(2)
+                      << std::setw(11) << sync * 1e6 / frames << std::setw(13) << kernel * 1e6 / frames
+                      << std::setw(13) << replanning * 1e6 / frames
+                      << std::setw(16) << conflictMicros
+                      << std::setw(11) << conflictCount << "\n";
+            benchmarkSink = checksum;
+        }
+    }
+    std::cout << std::flush;
+}
+
+void runDispatchBenchmark() {
+    std::cout << "=== Job dispatch latency (optimal assignment, factory layout) ===\n";
+    std::cout << std::left << std::setw(12) << "Vehicles" << std::right << std::setw(8) << "Jobs"
+              << std::setw(9) << "Threads" << std::setw(13) << "Assign [us]" << std::setw(15) << "Dispatch [us]"
+              << std::setw(15) << "Optimal [s]" << std::setw(14) << "Greedy [s]" << "\n";
+
+    std::vector<unsigned> threadCounts = {1};
+    if (std::thread::hardware_concurrency() > 1) threadCounts.push_back(std::thread::hardware_concurrency());
+
+    const std::pair<int, int> sizes[] = {{10, 10}, {100, 100}, {100, 20}, {20, 100}, {200, 200}};
+    for (const auto& size : sizes) {
+        for (unsigned threads : threadCounts) {
+            PathSystem pathSystem;
+            createFactoryLayout(pathSystem);
+            SegmentManager segmentManager(&pathSystem);
+            VehicleController controller(&pathSystem, &segmentManager);
+            controller.setLoggingEnabled(false);
+            TaskScheduler scheduler(threads);
+            JobDispatcher dispatcher(&pathSystem, &controller);
+            dispatcher.setTaskScheduler(&scheduler);
+
+            std::mt19937 rng(42);
+            std::vector<int> mainNodes;
+            for (const auto& node : pathSystem.getNodes()) {
+                if (!node.isWaitingNode) mainNodes.push_back(node.nodeId);
+            }
+            std::uniform_int_distribution<size_t> pickNode(0, mainNodes.size() - 1);
+            for (int i = 0; i < size.first; i++) {
+                const PathNode* start = pathSystem.getNode(mainNodes[pickNode(rng)]);
+                Auto* vehicle = controller.getVehicle(controller.addVehicle(start->position));
+                vehicle->currentNodeId = start->nodeId;
+                vehicle->realWorldCoordinates = start->position;
+                vehicle->speed = 100.0f;
+            }
+            std::vector<int> pickups;
+            for (int i = 0; i < size.second; i++) {
+                pickups.push_back(mainNodes[pickNode(rng)]);
+                dispatcher.submitJob(pickups.back(), pickRandomTarget(pathSystem, pickups.back(), rng), 0.0f);
+            }
+
+            // Decision only (distance matrix + assignment), repeated on the same state
+            const int runs = 200;
+            std::vector<JobAssignment> assignments;
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < runs; i++) assignments = dispatcher.computeAssignments();
+            double assignMicros = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6 / runs;
+
+            double optimal = 0.0;
+            for (const JobAssignment& assignment : assignments) optimal += assignment.travelTime;
+
+            // Baseline: every vehicle in turn takes the nearest job still open
+            double greedy = 0.0;
+            std::vector<bool> taken(size.second, false);
+            for (const Auto& vehicle : controller.getAllVehicles()) {
+                std::vector<float> distances = pathSystem.findDistancesFrom(vehicle.currentNodeId);
+                int best = -1;
+                for (int j = 0; j < size.second; j++) {
+                    if (!taken[j] && (best == -1 || distances[pickups[j]] < distances[pickups[best]])) best = j;
+                }
+                if (best == -1) break;
+                taken[best] = true;
+                greedy += distances[pickups[best]] / vehicle.speed;
+            }
+
+            // Full batch including route planning for every assigned vehicle
+            dispatcher.update();
+
+            std::cout << std::left << std::setw(12) << size.first << std::right << std::setw(8) << size.second
+                      << std::setw(9) << scheduler.getThreadCount() << std::fixed << std::setprecision(1)
+                      << std::setw(13) << assignMicros << std::setw(15) << dispatcher.getLastDispatchMicros()
+                      << std::setw(15) << optimal << std::setw(14) << greedy << "\n";
+        }
+    }
+    std::cout << std::flush;
+}
+
+void runCollisionBenchmark() {
+    std::cout << "=== Collision corridors: spatial hash vs. all pairs (2 s look-ahead, "
+              << VehicleController::MIN_VEHICLE_DISTANCE << " px) ===\n";
+    std::cout << std::left << std::setw(12) << "Vehicles" << std::right << std::setw(13) << "Build [us]"
+              << std::setw(13) << "Hash [us]" << std::setw(16) << "All pairs [us]"
+              << std::setw(9) << "Risks" << std::setw(8) << "Same" << "\n";
+
+    const float horizon = VehicleController::COLLISION_LOOKAHEAD;
+    for (int vehicleCount : {100, 1000, 10000}) {
+        // Constant density: one vehicle per 200 x 200 px, driving along the axes with one
+        // turn inside the look-ahead; every third vehicle stands
+        std::mt19937 rng(42);
+        const float side = std::sqrt(static_cast<float>(vehicleCount)) * 200.0f;
+        std::uniform_real_distribution<float> coordinate(0.0f, side);
+        std::uniform_real_distribution<float> speed(80.0f, 120.0f);
+        std::uniform_int_distribution<int> direction(0, 3);
+        const float dx[] = {1.0f, 0.0f, -1.0f, 0.0f};
+        const float dy[] = {0.0f, 1.0f, 0.0f, -1.0f};
+
+        std::vector<VehicleCorridor> corridors(vehicleCount);
+        for (int i = 0; i < vehicleCount; i++) {
+            VehicleCorridor& corridor = corridors[i];
+            corridor.vehicleId = i + 1;
+            corridor.points.push_back(Point(coordinate(rng), coordinate(rng)));
+            corridor.times.push_back(0.0f);
+            if (i % 3 == 0) continue;
+
+            float v = speed(rng);
+            int first = direction(rng), second = (first + 1 + 2 * (direction(rng) % 2)) % 4;
+            const Point& start = corridor.points[0];
+            Point turn(start.x + dx[first] * v * horizon / 2, start.y + dy[first] * v * horizon / 2);
+            corridor.points.push_back(turn);
+            corridor.points.push_back(Point(turn.x + dx[second] * v * horizon / 2, turn.y + dy[second] * v * horizon / 2));
+            corridor.times.push_back(horizon / 2);
+            corridor.times.push_back(horizon);
+        }
+
+        const int runs = std::max(3, 100000 / vehicleCount);
+        VehicleSpatialHash hash;
+        auto start = std::chrono::steady_clock::now();
+        for (int run = 0; run < runs; run++) hash.build(corridors, horizon);
+        double buildMicros = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6 / runs;
+
+        std::vector<CollisionRisk> risks;
+        start = std::chrono::steady_clock::now();
+        for (int run = 0; run < runs; run++) risks = hash.findRisks(VehicleController::MIN_VEHICLE_DISTANCE);
+        double hashMicros = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6 / runs;
+
+        std::vector<CollisionRisk> reference;
+        const int referenceRuns = std::max(1, runs / vehicleCount);
+        start = std::chrono::steady_clock::now();
+        for (int run = 0; run < referenceRuns; run++) reference = hash.findRisksBruteForce(VehicleController::MIN_VEHICLE_DISTANCE);
+        double allPairsMicros = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e6 / referenceRuns;
+
+        bool same = risks.size() == reference.size();
+        for (size_t i = 0; same && i < risks.size(); i++) {
+            same = risks[i].vehicleId1 == reference[i].vehicleId1 && risks[i].vehicleId2 == reference[i].vehicleId2;
+        }
+
+        std::cout << std::left << std::setw(12) << vehicleCount << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(13) << buildMicros << std::setw(13) << hashMicros << std::setw(16) << allPairsMicros
+                  << std::setw(9) << risks.size() << std::setw(8) << (same ? "yes" : "NO") << "\n";
+    }
+    std::cout << std::flush;
+}
+
+void runMarkerBenchmark() {
+    std::cout << "=== Marker identity per camera frame: color strings vs. interned MarkerId ===\n";
+    std::cout << std::left << std::setw(12) << "Markers" << std::right << std::setw(17) << "Strings [ns]"
+              << std::setw(17) << "MarkerId [ns]" << std::setw(16) << "Strings/Frame" << std::setw(8) << "Same" << "\n";
+
+    const char* heckNames[] = {"Heck1", "Heck2", "Heck3", "Heck4", "Heck5", "Heck6", "Heck7", "Heck8"};
+    for (int vehicleCount : {4, 8}) {
+        // One Front and one Heck marker per vehicle, as the detector reports them
+        std::vector<const char*> names;
+        for (int i = 0; i < vehicleCount; i++) {
+            names.push_back("Front");
+            names.push_back(heckNames[i]);
+        }
+        const int frames = 200000;
+
+        // Identity handling of the former string pipeline: DetectedObject copy, Front/Heck
+        // comparison, Point and colors vector copies, filter key and part type, "HeckN" -> ID
+        // via substr + stoi, controller lookup by color
+        std::map<std::string, int> filterKeys;
+        std::unordered_map<std::string, int> colorToVehicleId;
+        for (int i = 0; i < vehicleCount; i++) {
+            filterKeys["Front_" + std::to_string(i + 1)] = i;
+            filterKeys[heckNames[i]] = i;
+            colorToVehicleId[heckNames[i]] = i + 1;
+        }
+        long long stringChecksum = 0;
+        size_t stringsPerFrame = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            std::vector<std::pair<Point, std::string>> points;
+            std::vector<std::string> colors;
+            int frontIndex = 0;
+            size_t strings = 0;
+            for (const char* name : names) {
+                std::string color = name; strings++;
+                if (color == "Front" || color.find("Heck") == 0) {
+                    points.emplace_back(Point(1.0f, 2.0f), color); strings++;
+                    colors.push_back(color); strings++;
+                }
+            }
+            for (const auto& [point, color] : points) {
+                std::string partType = color.find("Heck") == 0 ? "heck" : "front"; strings++;
+                std::string key = partType == "front" ? "Front_" + std::to_string(++frontIndex) : color; strings += 2;
+                auto filtered = filterKeys.find(key);
+                if (filtered != filterKeys.end()) stringChecksum += filtered->second;
+                if (partType == "heck") {
+                    stringChecksum += std::stoi(color.substr(4)); strings++;
+                    auto mapped = colorToVehicleId.find(color);
+                    if (mapped != colorToVehicleId.end()) stringChecksum += mapped->second;
+                }
+            }
+            stringsPerFrame = strings;
+        }
+        double stringNanos = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / frames;
+
+        // Same steps on MarkerId: interned once at the boundary, everything else is integer work
+        std::map<int, int> markerKeys;
+        int markerToVehicleId[2 + MAX_HECK_MARKERS] = {};
+        for (int i = 0; i < vehicleCount; i++) {
+            markerKeys[256 + i + 1] = i;
+            markerKeys[heckMarker(i + 1)] = i;
+            markerToVehicleId[heckMarker(i + 1)] = i + 1;
+        }
+        long long markerChecksum = 0;
+        std::vector<Point> points;
+        start = std::chrono::steady_clock::now();
+        for (int frame = 0; frame < frames; frame++) {
+            points.clear();
+            int frontIndex = 0;
+            for (const char* name : names) {
+                MarkerId marker = internMarker(name);
+                if (isFrontMarker(marker) || isHeckMarker(marker)) {
+                    points.emplace_back(1.0f, 2.0f, isFrontMarker(marker) ? PointType::FRONT : PointType::IDENTIFICATION, marker);
+                }
+            }
+            for (const Point& point : points) {
+                int key = isFrontMarker(point.marker) ? 256 + ++frontIndex : point.marker;
+                auto filtered = markerKeys.find(key);
+                if (filtered != markerKeys.end()) markerChecksum += filtered->second;
+                if (isHeckMarker(point.marker)) {
+                    markerChecksum += heckNumber(point.marker);
+                    markerChecksum += markerToVehicleId[point.marker];
+                }
+            }
+        }
+        double markerNanos = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() * 1e9 / frames;
+
+        std::cout << std::left << std::setw(12) << names.size() << std::right << std::fixed << std::setprecision(1)
+                  << std::setw(17) << stringNanos << std::setw(17) << markerNanos << std::setw(16) << stringsPerFrame
+                  << std::setw(8) << (stringChecksum == markerChecksum ? "yes" : "NO") << "\n";
+    }
+    std::cout << std::flush;
+}
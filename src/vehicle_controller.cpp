@@ -1,9 +1,36 @@
+#define _USE_MATH_DEFINES
 #include "vehicle_controller.h"
 #include <iostream>
 #include <cmath>
+#include <algorithm>
+#include <cstdint>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
 
 VehicleController::VehicleController(PathSystem* pathSys, SegmentManager* segMgr) 
-    : pathSystem(pathSys), segmentManager(segMgr), nextVehicleId(1) {}
+    : pathSystem(pathSys), segmentManager(segMgr), scheduler(nullptr), lastUpdateTiming(), markerToVehicleId(), nextVehicleId(1),
+      loggingEnabled(true), simulatedMovement(false), targetRng(42), planner(nullptr), nextRouteRequestId(1),
+      spatialHashValid(false) {
+    vehicles.setPathSystem(pathSystem);
+
+    // Console progress log, fed by the same events as every other consumer
+    events.subscribe<NodeReachedEvent>([this](const std::vector<NodeReachedEvent>& batch) {
+        if (!loggingEnabled) return;
+        for (const NodeReachedEvent& event : batch) {
+            std::cout << "Vehicle " << event.vehicleId << " reached node " << event.nodeId
+                      << " (step " << event.routeIndex + 1 << " of " << event.routeLength << ")" << std::endl;
+        }
+    });
+    events.subscribe<RouteCompletedEvent>([this](const std::vector<RouteCompletedEvent>& batch) {
+        if (!loggingEnabled) return;
+        for (const RouteCompletedEvent& event : batch) {
+            std::cout << "Vehicle " << event.vehicleId << " completed full route and arrived at final target "
+                      << event.targetNodeId << std::endl;
+        }
+    });
+}
 
 int VehicleController::addVehicle(const Point& position) {
     Auto vehicle;
@@ -15,19 +42,44 @@ int VehicleController::addVehicle(const Point& position) {
     vehicle.currentNodePath.clear();
     vehicle.currentNodeIndex = 0;
 
-    vehicles[vehicle.vehicleId] = vehicle;
+    vehicles.insert(vehicle);
+    markDirty(vehicle.vehicleId);
     
     return vehicle.vehicleId;
 }
 
+void VehicleController::removeVehicle(int vehicleId) {
+    if (!vehicles.erase(vehicleId)) return;
+    segmentManager->removeVehicle(vehicleId);
+    markDirty(vehicleId);
+}
+
 Auto* VehicleController::getVehicle(int vehicleId) {
-    auto it = vehicles.find(vehicleId);
-    return (it != vehicles.end()) ? &it->second : nullptr;
+    int index = vehicles.indexOf(vehicleId);
+    if (index == -1) return nullptr;
+    markDirty(vehicleId);
+    return &vehicles.editRecord(index);
 }
 
 const Auto* VehicleController::getVehicle(int vehicleId) const {
-    auto it = vehicles.find(vehicleId);
-    return (it != vehicles.end()) ? &it->second : nullptr;
+    int index = vehicles.indexOf(vehicleId);
+    return (index != -1) ? &vehicles.record(index) : nullptr;
+}
+
+const Auto* VehicleController::getVehicle(VehicleHandle handle) const {
+    int index = vehicles.indexOf(handle);
+    return (index != -1) ? &vehicles.record(index) : nullptr;
+}
+
+void VehicleController::markDirty(int vehicleId) {
+    spatialHashValid = false;
+    if (vehicleId >= static_cast<int>(dirtyFlags.size())) {
+        dirtyFlags.resize(vehicleId + 1, 0);
+    }
+    if (!dirtyFlags[vehicleId]) {
+        dirtyFlags[vehicleId] = 1;
+        dirtyVehicles.push_back(vehicleId);
+    }
 }
 
 void VehicleController::updateVehicleFromRealCoordinates(int vehicleId, const Point& realPosition, float confidence) {
@@ -45,7 +97,7 @@ void VehicleController::updateVehicleFromRealCoordinates(int vehicleId, const Po
         }
         if (nearestNode != -1) {
             vehicle->currentNodeId = nearestNode;
-            std::cout << "Vehicle " << vehicleId << " assigned to nearest node " << nearestNode << std::endl;
+            if (loggingEnabled) std::cout << "Vehicle " << vehicleId << " assigned to nearest node " << nearestNode << std::endl;
         }
     }
 
@@ -62,25 +114,19 @@ void VehicleController::updateVehicleFromRealCoordinates(int vehicleId, const Po
             float reachTolerance = 40.0f; // Toleranz für Knotenerreichung
             
             if (distanceToTarget < reachTolerance) {
-                // Knoten erreicht!
+                // Knoten erreicht! Abnehmer (Log, Aufträge) reagieren auf die Events
+                double now = segmentManager->getCurrentTime();
+                events.publish(NodeReachedEvent{vehicleId, currentTargetNodeId, vehicle->currentNodeIndex,
+                                                vehicle->currentNodePath.size(), now});
                 vehicle->currentNodeId = currentTargetNodeId;
                 vehicle->currentNodeIndex++; // Gehe zum nächsten Knoten
-                
-                std::cout << "Vehicle " << vehicleId << " reached node " << currentTargetNodeId 
-                          << " (distance: " << distanceToTarget << ")" << std::endl;
-                
+
                 if (vehicle->currentNodeIndex >= vehicle->currentNodePath.size()) {
                     // Route vollständig abgefahren
                     vehicle->state = VehicleState::ARRIVED;
                     vehicle->currentNodePath.clear();
                     vehicle->currentNodeIndex = 0;
-                    std::cout << "Vehicle " << vehicleId << " completed full route and arrived at final target " 
-                              << vehicle->targetNodeId << std::endl;
-                } else {
-                    // Nächster Knoten in der Route
-                    int nextNodeId = vehicle->currentNodePath[vehicle->currentNodeIndex];
-                    std::cout << "Vehicle " << vehicleId << " now targeting next node " << nextNodeId 
-                              << " (step " << vehicle->currentNodeIndex << " of " << vehicle->currentNodePath.size() << ")" << std::endl;
+                    events.publish(RouteCompletedEvent{vehicleId, vehicle->targetNodeId, now});
                 }
             }
         }
@@ -93,18 +139,107 @@ bool VehicleController::setVehicleTargetNode(int vehicleId, int targetNodeId) {
 
     const PathNode* targetNode = pathSystem->getNode(targetNodeId);
     if (!targetNode) {
-        std::cout << "Vehicle " << vehicleId << " target node " << targetNodeId << " does not exist" << std::endl;
+        if (loggingEnabled) std::cout << "Vehicle " << vehicleId << " target node " << targetNodeId << " does not exist" << std::endl;
         return false;
     }
 
-    vehicle->targetNodeId = targetNodeId;
-    
-    if (planPath(vehicleId, targetNodeId)) {
-        std::cout << "Vehicle " << vehicleId << " target set to node " << targetNodeId << std::endl;
+    // A synchronous target wins over routes still being planned in the background
+    latestRouteRequest.erase(vehicleId);
+    vehicle->pendingTargetNodeId = -1;
+    return applyRoute(*vehicle, RoutePlanner::computeRoute(*pathSystem, *segmentManager, makeRouteRequest(*vehicle, targetNodeId)));
+}
+
+std::future<bool> VehicleController::requestVehicleTarget(int vehicleId, int targetNodeId) {
+    std::promise<bool> promise;
+    std::future<bool> future = promise.get_future();
+
+    Auto* vehicle = getVehicle(vehicleId);
+    if (!planner || !vehicle || !pathSystem->getNode(targetNodeId)) {
+        promise.set_value(setVehicleTargetNode(vehicleId, targetNodeId));
+        return future;
+    }
+
+    // The vehicle keeps its current route until the new one is committed
+    RouteRequest request = makeRouteRequest(*vehicle, targetNodeId);
+    request.requestId = nextRouteRequestId++;
+    vehicle->pendingTargetNodeId = targetNodeId;
+    latestRouteRequest[vehicleId] = request.requestId;
+    pendingRoutes.emplace(request.requestId, std::move(promise));
+    planner->submit(request);
+    return future;
+}
+
+void VehicleController::postVehicleTarget(int vehicleId, int targetNodeId) {
+    std::lock_guard<std::mutex> lock(postedTargetsMutex);
+    postedTargets.emplace_back(vehicleId, targetNodeId);
+}
+
+void VehicleController::setVehicleJobUrgency(int vehicleId, float urgency) {
+    int index = vehicles.indexOf(vehicleId);
+    if (index == -1 || vehicles.record(index).jobUrgency == urgency) return;
+    markDirty(vehicleId);
+    vehicles.editRecord(index).jobUrgency = urgency;
+}
+
+void VehicleController::applyPlannedRoutes() {
+    std::vector<std::pair<int, int>> posted;
+    {
+        std::lock_guard<std::mutex> lock(postedTargetsMutex);
+        posted.swap(postedTargets);
+    }
+    for (const auto& target : posted) {
+        requestVehicleTarget(target.first, target.second);
+    }
+
+    if (!planner) return;
+    for (const RouteResult& route : planner->takeCompleted()) {
+        auto pending = pendingRoutes.find(route.requestId);
+        if (pending == pendingRoutes.end()) continue;
+
+        // Superseded by a newer request or a synchronous target, or the vehicle is gone
+        auto latest = latestRouteRequest.find(route.vehicleId);
+        Auto* vehicle = getVehicle(route.vehicleId);
+        if (!vehicle || latest == latestRouteRequest.end() || latest->second != route.requestId) {
+            pending->second.set_value(false);
+            pendingRoutes.erase(pending);
+            continue;
+        }
+
+        // Planned against an old layout or from a node the vehicle has left: plan again
+        if (route.layoutVersion != pathSystem->getLayoutVersion() ||
+            route.startNodeId != RoutePlanner::findStartNode(*pathSystem, vehicle->realWorldCoordinates)) {
+            RouteRequest request = makeRouteRequest(*vehicle, route.targetNodeId);
+            request.requestId = route.requestId;
+            planner->submit(request);
+            continue;
+        }
+
+        latestRouteRequest.erase(latest);
+        vehicle->pendingTargetNodeId = -1;
+        pending->second.set_value(applyRoute(*vehicle, route));
+        pendingRoutes.erase(pending);
+    }
+}
+
+RouteRequest VehicleController::makeRouteRequest(const Auto& vehicle, int targetNodeId) const {
+    RouteRequest request;
+    request.requestId = 0;
+    request.vehicleId = vehicle.vehicleId;
+    request.startPosition = vehicle.realWorldCoordinates;
+    request.targetNodeId = targetNodeId;
+    request.layoutVersion = pathSystem->getLayoutVersion();
+    return request;
+}
+
+bool VehicleController::applyRoute(Auto& vehicle, const RouteResult& route) {
+    vehicle.targetNodeId = route.targetNodeId;
+
+    if (commitRoute(vehicle, route)) {
+        if (loggingEnabled) std::cout << "Vehicle " << vehicle.vehicleId << " target set to node " << route.targetNodeId << std::endl;
         return true;
     } else {
-        vehicle->state = VehicleState::WAITING;
-        std::cout << "Vehicle " << vehicleId << " cannot reach target node " << targetNodeId << std::endl;
+        vehicle.state = VehicleState::WAITING;
+        if (loggingEnabled) std::cout << "Vehicle " << vehicle.vehicleId << " cannot reach target node " << route.targetNodeId << std::endl;
         return false;
     }
 }
@@ -115,152 +250,539 @@ bool VehicleController::planPath(int vehicleId, int targetNodeId) {
 
     const PathNode* targetNode = pathSystem->getNode(targetNodeId);
     if (!targetNode) {
-        std::cout << "Vehicle " << vehicleId << " cannot plan path to non-existent node " << targetNodeId << std::endl;
+        if (loggingEnabled) std::cout << "Vehicle " << vehicleId << " cannot plan path to non-existent node " << targetNodeId << std::endl;
         return false;
     }
 
-    // NEUE LOGIK: Finde IMMER den nächstgelegenen Knoten als Startpunkt
-    Point currentPos = vehicle->realWorldCoordinates;
-    int nearestStartNodeId = pathSystem->findNearestNode(currentPos, 300.0f);
-    
-    if (nearestStartNodeId == -1) {
-        // Erweitere Suchradius falls nötig
-        nearestStartNodeId = pathSystem->findNearestNode(currentPos, 500.0f);
-    }
-    
-    if (nearestStartNodeId == -1) {
-        vehicle->state = VehicleState::WAITING;
-        std::cout << "Vehicle " << vehicleId << " cannot find nearest start node from position (" 
-                  << currentPos.x << ", " << currentPos.y << ")" << std::endl;
+    return commitRoute(*vehicle, RoutePlanner::computeRoute(*pathSystem, *segmentManager, makeRouteRequest(*vehicle, targetNodeId)));
+}
+
+bool VehicleController::commitRoute(Auto& vehicle, const RouteResult& route) {
+    int vehicleId = vehicle.vehicleId;
+    int targetNodeId = route.targetNodeId;
+
+    // NEUE LOGIK: Start ist IMMER der nächstgelegene Knoten
+    if (route.startNodeId == -1) {
+        vehicle.state = VehicleState::WAITING;
+        if (loggingEnabled) std::cout << "Vehicle " << vehicleId << " cannot find nearest start node from position ("
+                  << vehicle.realWorldCoordinates.x << ", " << vehicle.realWorldCoordinates.y << ")" << std::endl;
         return false;
     }
 
     // Aktualisiere currentNodeId auf den nächstgelegenen Knoten
-    vehicle->currentNodeId = nearestStartNodeId;
-    std::cout << "Vehicle " << vehicleId << " using nearest node " << nearestStartNodeId 
+    vehicle.currentNodeId = route.startNodeId;
+    if (loggingEnabled) std::cout << "Vehicle " << vehicleId << " using nearest node " << route.startNodeId
               << " as start point for route to " << targetNodeId << std::endl;
 
     // Already at target?
-    if (nearestStartNodeId == targetNodeId) {
-        vehicle->state = VehicleState::ARRIVED;
-        vehicle->currentNodePath.clear();
-        vehicle->currentNodeIndex = 0;
-        std::cout << "Vehicle " << vehicleId << " already at target node " << targetNodeId << std::endl;
+    if (route.nodePath.size() == 1) {
+        vehicle.state = VehicleState::ARRIVED;
+        vehicle.currentNodePath.clear();
+        vehicle.currentNodeIndex = 0;
+        events.publish(RouteCompletedEvent{vehicleId, targetNodeId, segmentManager->getCurrentTime()});
+        if (loggingEnabled) std::cout << "Vehicle " << vehicleId << " already at target node " << targetNodeId << std::endl;
         return true;
     }
 
-    // Finde optimalen Pfad vom nächstgelegenen Knoten zum Ziel
-    std::vector<int> segmentPath = segmentManager->findOptimalPath(nearestStartNodeId, targetNodeId, vehicleId);
-    
-    if (segmentPath.empty()) {
-        vehicle->state = VehicleState::WAITING;
-        std::cout << "Vehicle " << vehicleId << " no path found to target" << std::endl;
+    if (route.nodePath.empty()) {
+        vehicle.state = VehicleState::WAITING;
+        segmentManager->journalEvent(JournalEventType::PATH_FAILED, vehicleId, -1, targetNodeId);
+        if (loggingEnabled) std::cout << "Vehicle " << vehicleId << " no path found to target" << std::endl;
         return false;
     }
 
-    // Konvertiere Segment-Pfad zu Knoten-Pfad
-    std::vector<int> nodePath;
-    
-    // Füge Startknoten hinzu
-    nodePath.push_back(vehicle->currentNodeId);
-    
-    // Füge alle Zwischenknoten und Endknoten hinzu
-    for (int segmentId : segmentPath) {
-        const PathSegment* segment = pathSystem->getSegment(segmentId);
-        if (segment) {
-            // Finde den "anderen" Knoten (nicht den letzten in nodePath)
-            int lastNode = nodePath.back();
-            int nextNode = (segment->startNodeId == lastNode) ? segment->endNodeId : segment->startNodeId;
-            nodePath.push_back(nextNode);
+    // Setze neue Route
+    vehicle.currentNodePath = route.nodePath;
+    vehicle.currentNodeIndex = 1; // Index 0 ist der aktuelle Knoten, 1 ist das erste Ziel
+    vehicle.targetNodeId = targetNodeId;
+    vehicle.state = VehicleState::IDLE;
+    segmentManager->journalEvent(JournalEventType::PATH_PLANNED, vehicleId, -1, targetNodeId,
+                                 static_cast<float>(route.nodePath.size()));
+    events.publish(RouteReplannedEvent{vehicleId, targetNodeId, route.nodePath.size(), false, segmentManager->getCurrentTime()});
+
+    if (loggingEnabled) {
+        std::cout << "Vehicle " << vehicleId << " planned node path with " << route.nodePath.size() << " nodes: ";
+        for (size_t i = 0; i < route.nodePath.size(); i++) {
+            std::cout << route.nodePath[i];
+            if (i < route.nodePath.size() - 1) std::cout << " -> ";
         }
+        std::cout << std::endl;
     }
 
-    // Setze neue Route
-    vehicle->currentNodePath = nodePath;
-    vehicle->currentNodeIndex = 1; // Index 0 ist der aktuelle Knoten, 1 ist das erste Ziel
-    vehicle->targetNodeId = targetNodeId;
-    vehicle->state = VehicleState::IDLE;
-    
-    std::cout << "Vehicle " << vehicleId << " planned node path with " << nodePath.size() << " nodes: ";
-    for (size_t i = 0; i < nodePath.size(); i++) {
-        std::cout << nodePath[i];
-        if (i < nodePath.size() - 1) std::cout << " -> ";
-    }
-    std::cout << std::endl;
-    
     return true;
 }
 
-int VehicleController::mapRealVehicleToSystem(const Point& realPosition, const std::string& vehicleColor) {
-    // Check if we already have a mapping for this color
-    auto it = colorToVehicleId.find(vehicleColor);
-    if (it != colorToVehicleId.end()) {
-        return it->second;
+int VehicleController::mapRealVehicleToSystem(const Point& realPosition, MarkerId vehicleMarker) {
+    // Check if we already have a mapping for this marker
+    if (vehicleMarker < 2 + MAX_HECK_MARKERS && markerToVehicleId[vehicleMarker] != 0) {
+        return markerToVehicleId[vehicleMarker];
     }
 
-    // Create new vehicle for this color
+    // Create new vehicle for this marker
     int vehicleId = addVehicle(realPosition);
-    colorToVehicleId[vehicleColor] = vehicleId;
+    if (vehicleMarker < 2 + MAX_HECK_MARKERS) markerToVehicleId[vehicleMarker] = vehicleId;
 
-    std::cout << "Mapped new vehicle " << vehicleColor << " to ID " << vehicleId << std::endl;
+    if (loggingEnabled) std::cout << "Mapped new vehicle " << markerName(vehicleMarker) << " to ID " << vehicleId << std::endl;
     return vehicleId;
 }
 
 void VehicleController::syncRealVehiclesWithSystem(const std::vector<Auto>& detectedAutos) {
     for (const Auto& detectedVehicle : detectedAutos) {
-        std::string vehicleColor = detectedVehicle.colorValue;
         Point realPosition = detectedVehicle.realWorldCoordinates;
         
-        int systemVehicleId = mapRealVehicleToSystem(realPosition, vehicleColor);
+        int systemVehicleId = mapRealVehicleToSystem(realPosition, detectedVehicle.marker);
         updateVehicleFromRealCoordinates(systemVehicleId, realPosition, 1.0f);
     }
 }
 
 void VehicleController::assignRandomTargetsToAllVehicles() {
-    if (pathSystem->getNodeCount() == 0) return;
-
-    for (auto& [vehicleId, vehicle] : vehicles) {
-        if (vehicle.state == VehicleState::ARRIVED || vehicle.targetNodeId == -1) {
-            // Find available target node (any node type is valid)
-            std::vector<int> availableNodes;
-            for (const auto& node : pathSystem->getNodes()) {
-                if (node.nodeId != vehicle.currentNodeId) {
-                    availableNodes.push_back(node.nodeId);
-                }
-            }
-            
-            if (!availableNodes.empty()) {
-                int randomIndex = rand() % availableNodes.size();
-                int targetNode = availableNodes[randomIndex];
-                
-                if (setVehicleTargetNode(vehicleId, targetNode)) {
-                    std::cout << "Vehicle " << vehicleId << " assigned random target: node " << targetNode << std::endl;
-                } else {
-                    vehicle.state = VehicleState::ARRIVED;
+    // Manual test helper; real transport orders go through the JobDispatcher
+    const auto& nodes = pathSystem->getNodes();
+    if (nodes.size() < 2) return;
+    std::uniform_int_distribution<size_t> pickNode(0, nodes.size() - 2);
+
+    // Requesting targets does not add or remove vehicles, so dense indices stay valid
+    for (size_t index = 0; index < vehicles.size(); index++) {
+        const Auto& current = vehicles.record(index);
+        bool needsTarget = current.state == VehicleState::ARRIVED || current.targetNodeId == -1 ||
+                           (current.state == VehicleState::WAITING && current.currentNodePath.empty());
+        if (needsTarget && !hasPendingRoute(current.vehicleId)) {
+            int vehicleId = current.vehicleId;
+
+            // Any node except the current one (drawn from n-1 slots, the current node's slot maps to the last)
+            size_t nodeIndex = pickNode(targetRng);
+            if (nodes[nodeIndex].nodeId == current.currentNodeId) nodeIndex = nodes.size() - 1;
+            int targetNode = nodes[nodeIndex].nodeId;
+
+            requestVehicleTarget(vehicleId, targetNode);
+            if (loggingEnabled) std::cout << "Vehicle " << vehicleId << " assigned random target: node " << targetNode << std::endl;
+        }
+    }
+}
+
+std::vector<int> VehicleController::toNodePath(int startNodeId, const std::vector<int>& segmentPath) const {
+    // Füge Startknoten hinzu
+    std::vector<int> nodePath;
+    nodePath.push_back(startNodeId);
+
+    // Füge alle Zwischenknoten und Endknoten hinzu
+    for (int segmentId : segmentPath) {
+        const PathSegment* segment = pathSystem->getSegment(segmentId);
+        if (segment) {
+            // Finde den "anderen" Knoten (nicht den letzten in nodePath)
+            int lastNode = nodePath.back();
+            int nextNode = (segment->startNodeId == lastNode) ? segment->endNodeId : segment->startNodeId;
+            nodePath.push_back(nextNode);
+        }
+    }
+    return nodePath;
+}
+
+int VehicleController::nextSegmentOnRoute(const Auto& vehicle, int& fromNodeId) const {
+    if (vehicle.currentNodeIndex == 0 || vehicle.currentNodeIndex >= vehicle.currentNodePath.size()) return -1;
+
+    fromNodeId = vehicle.currentNodePath[vehicle.currentNodeIndex - 1];
+    const PathSegment* segment = pathSystem->getSegmentBetweenNodes(fromNodeId, vehicle.currentNodePath[vehicle.currentNodeIndex]);
+    return segment ? segment->segmentId : -1;
+}
+
+float VehicleController::remainingRouteLength(const Auto& vehicle) const {
+    float length = 0.0f;
+    for (size_t i = std::max<size_t>(vehicle.currentNodeIndex, 1); i < vehicle.currentNodePath.size(); i++) {
+        const PathSegment* segment = pathSystem->getSegmentBetweenNodes(vehicle.currentNodePath[i - 1], vehicle.currentNodePath[i]);
+        if (segment) length += segment->length;
+    }
+    return length;
+}
+
+bool VehicleController::isPathBlocked(int vehicleId) const {
+    const Auto* vehicle = getVehicle(vehicleId);
+    if (!vehicle) return false;
+
+    int fromNodeId = -1;
+    int segmentId = nextSegmentOnRoute(*vehicle, fromNodeId);
+    if (segmentId == -1 || segmentId == vehicle->currentSegmentId) return false;   // Nothing ahead or already on it
+    return !segmentManager->canVehicleEnterSegment(segmentId, vehicleId, fromNodeId);
+}
+
+bool VehicleController::needsPathRecalculation(int vehicleId) const {
+    const Auto* vehicle = getVehicle(vehicleId);
+    return vehicle && !planDetour(*vehicle).empty();
+}
+
+std::vector<int> VehicleController::planDetour(const Auto& vehicle) const {
+    if (vehicle.targetNodeId == -1 || !isPathBlocked(vehicle.vehicleId)) return {};
+
+    int fromNodeId = -1;
+    int blockedSegmentId = nextSegmentOnRoute(vehicle, fromNodeId);
+    if (segmentManager->shouldWaitOrReroute(fromNodeId, vehicle.targetNodeId, blockedSegmentId, vehicle.vehicleId)) {
+        return {};
+    }
+
+    std::vector<int> detour = pathSystem->findPath(fromNodeId, vehicle.targetNodeId, {blockedSegmentId});
+    if (detour.empty()) return {};
+    return toNodePath(fromNodeId, detour);
+}
+
+void VehicleController::updateVehiclePaths() {
+    // Decide in parallel (read-only), then apply in dense order
+    const size_t count = vehicles.size();
+    std::vector<std::vector<int>> detours(count);
+    runParallel(count, 16, [this, &detours](size_t begin, size_t end) {
+        for (size_t index = begin; index < end; index++) {
+            detours[index] = planDetour(vehicles.record(index));
+        }
+    });
+
+    for (size_t index = 0; index < count; index++) {
+        if (detours[index].empty()) continue;
+
+        Auto& vehicle = vehicles.editRecord(index);
+        int fromNodeId = -1;
+        int blockedSegmentId = nextSegmentOnRoute(vehicle, fromNodeId);
+        const SegmentQueue* queue = segmentManager->getSegmentQueue(blockedSegmentId);
+        if (queue && queue->contains(vehicle.vehicleId)) {
+            segmentManager->removeFromQueue(blockedSegmentId, vehicle.vehicleId);
+        }
+
+        vehicle.currentNodePath = detours[index];
+        vehicle.currentNodeIndex = 1;
+        vehicle.isWaitingInQueue = false;
+        markDirty(vehicle.vehicleId);
+        segmentManager->journalEvent(JournalEventType::PATH_PLANNED, vehicle.vehicleId, -1, vehicle.targetNodeId,
+                                     static_cast<float>(vehicle.currentNodePath.size()));
+        events.publish(RouteReplannedEvent{vehicle.vehicleId, vehicle.targetNodeId, vehicle.currentNodePath.size(), true,
+                                           segmentManager->getCurrentTime()});
+        if (loggingEnabled) std::cout << "Vehicle " << vehicle.vehicleId << " rerouted around blocked segment " << blockedSegmentId << std::endl;
+    }
+}
+
+std::vector<VehicleController::VehicleConflict> VehicleController::detectUpcomingConflicts() const {
+    const float conflictWindow = 2.0f;   // Seconds between both arrivals that still count as a conflict
+    const size_t count = vehicles.size();
+
+    // Phase 1: expected arrival at every junction still ahead, per vehicle
+    std::vector<std::vector<JunctionArrival>> arrivals(count);
+    runParallel(count, 16, [this, &arrivals](size_t begin, size_t end) {
+        for (size_t index = begin; index < end; index++) {
+            arrivals[index] = getJunctionArrivals(vehicles.record(index));
+        }
+    });
+
+    // Phase 2: bucket each vehicle's first arrival at every junction by node ID, sorted by arrival
+    // time, so a vehicle only meets the others that reach the same junction within the window
+    struct BucketEntry {
+        float time;
+        size_t index;
+    };
+    int maxNodeId = -1;
+    for (const auto& perVehicle : arrivals) {
+        for (const JunctionArrival& arrival : perVehicle) maxNodeId = std::max(maxNodeId, arrival.nodeId);
+    }
+    std::vector<std::vector<BucketEntry>> buckets(maxNodeId + 1);
+    for (size_t index = 0; index < count; index++) {
+        for (const JunctionArrival& arrival : arrivals[index]) {
+            std::vector<BucketEntry>& bucket = buckets[arrival.nodeId];
+            if (bucket.empty() || bucket.back().index != index) bucket.push_back({arrival.time, index});
+        }
+    }
+    runParallel(buckets.size(), 4, [&buckets](size_t begin, size_t end) {
+        for (size_t nodeId = begin; nodeId < end; nodeId++) {
+            std::sort(buckets[nodeId].begin(), buckets[nodeId].end(), [](const BucketEntry& a, const BucketEntry& b) {
+                return a.time < b.time || (a.time == b.time && a.index < b.index);
+            });
+        }
+    });
+
+    // Phase 3: the task owning i walks i's junctions in route order and reports each j > i once,
+    // at the earliest junction both reach within the window; results are joined in (i, j) order
+    std::vector<std::vector<VehicleConflict>> found(count);
+    runParallel(count, 8, [this, count, conflictWindow, &arrivals, &buckets, &found](size_t begin, size_t end) {
+        std::vector<size_t> reportedFor(count, SIZE_MAX);
+        std::vector<std::pair<size_t, VehicleConflict>> pairs;
+        for (size_t i = begin; i < end; i++) {
+            pairs.clear();
+            for (const JunctionArrival& first : arrivals[i]) {
+                // The range is widened a little; the exact test below decides, as in the pairwise search
+                const std::vector<BucketEntry>& bucket = buckets[first.nodeId];
+                const float earliest = first.time - conflictWindow * 1.001f;
+                const float latest = first.time + conflictWindow * 1.001f;
+                auto second = std::lower_bound(bucket.begin(), bucket.end(), earliest,
+                                               [](const BucketEntry& entry, float time) { return entry.time < time; });
+                for (; second != bucket.end() && second->time <= latest; ++second) {
+                    if (second->index <= i || reportedFor[second->index] == i) continue;
+                    if (std::fabs(first.time - second->time) > conflictWindow) continue;
+                    reportedFor[second->index] = i;
+
+                    VehicleConflict conflict;
+                    conflict.vehicleId1 = vehicles.record(i).vehicleId;
+                    conflict.vehicleId2 = vehicles.record(second->index).vehicleId;
+                    conflict.conflictJunctionId = first.nodeId;
+                    conflict.estimatedConflictTime = std::min(first.time, second->time);
+                    conflict.canNegotiate = segmentManager->getNearestWaitingNode(first.nodeId) != -1;
+                    pairs.emplace_back(second->index, conflict);
                 }
             }
+            std::sort(pairs.begin(), pairs.end(),
+                      [](const std::pair<size_t, VehicleConflict>& a, const std::pair<size_t, VehicleConflict>& b) { return a.first < b.first; });
+            for (const auto& pair : pairs) found[i].push_back(pair.second);
         }
+    });
+
+    std::vector<VehicleConflict> conflicts;
+    for (const auto& perVehicle : found) {
+        conflicts.insert(conflicts.end(), perVehicle.begin(), perVehicle.end());
     }
+    return conflicts;
 }
 
-void VehicleController::updateVehiclePaths() {
-    // Simplified - paths are managed by planPath function
+std::vector<VehicleController::JunctionArrival> VehicleController::getJunctionArrivals(const Auto& vehicle) const {
+    std::vector<JunctionArrival> arrivals;
+    if (vehicle.currentNodeIndex == 0) return arrivals;
+
+    float time = 0.0f;
+    for (size_t i = vehicle.currentNodeIndex; i < vehicle.currentNodePath.size(); i++) {
+        const PathSegment* segment = pathSystem->getSegmentBetweenNodes(vehicle.currentNodePath[i - 1], vehicle.currentNodePath[i]);
+        if (segment) time += segmentManager->estimateSegmentTime(segment->segmentId);
+
+        const PathNode* node = pathSystem->getNode(vehicle.currentNodePath[i]);
+        if (node && node->connectedSegments.size() >= 3) {
+            arrivals.push_back({node->nodeId, time});
+        }
+    }
+    return arrivals;
+}
+
+int VehicleController::findCommonJunctionInPaths(const Auto& vehicle1, const Auto& vehicle2) const {
+    // First junction (3+ segments) still ahead of vehicle1 that vehicle2 will also pass
+    if (vehicle2.currentNodeIndex >= vehicle2.currentNodePath.size()) return -1;
+
+    for (size_t i = vehicle1.currentNodeIndex; i < vehicle1.currentNodePath.size(); i++) {
+        int nodeId = vehicle1.currentNodePath[i];
+        const PathNode* node = pathSystem->getNode(nodeId);
+        if (!node || node->connectedSegments.size() < 3) continue;
+
+        auto begin = vehicle2.currentNodePath.begin() + vehicle2.currentNodeIndex;
+        if (std::find(begin, vehicle2.currentNodePath.end(), nodeId) != vehicle2.currentNodePath.end()) {
+            return nodeId;
+        }
+    }
+    return -1;
+}
+
+float VehicleController::estimateTimeToJunction(const Auto& vehicle, int junctionId) const {
+    // Sum of expected segment times along the remaining route, -1 if the junction is not on it
+    if (vehicle.currentNodeIndex == 0) return -1.0f;
+
+    float time = 0.0f;
+    for (size_t i = vehicle.currentNodeIndex; i < vehicle.currentNodePath.size(); i++) {
+        const PathSegment* segment = pathSystem->getSegmentBetweenNodes(vehicle.currentNodePath[i - 1], vehicle.currentNodePath[i]);
+        if (segment) time += segmentManager->estimateSegmentTime(segment->segmentId);
+        if (vehicle.currentNodePath[i] == junctionId) return time;
+    }
+    return -1.0f;
+}
+
+Point VehicleController::interpolatePosition(const Point& start, const Point& end, float t) const {
+    return Point(start.x + (end.x - start.x) * t, start.y + (end.y - start.y) * t);
+}
+
+VehicleCorridor VehicleController::sweepCorridor(int vehicleId, const std::vector<Point>& waypoints, float speed) const {
+    // Arrival time at every waypoint, cut off at the look-ahead
+    VehicleCorridor corridor;
+    corridor.vehicleId = vehicleId;
+    corridor.points.push_back(waypoints.front());
+    corridor.times.push_back(0.0f);
+    if (speed <= 0.0f) return corridor;
+
+    for (size_t i = 1; i < waypoints.size(); i++) {
+        const Point& from = corridor.points.back();
+        float arrival = corridor.times.back() + pathSystem->calculateDistance(from, waypoints[i]) / speed;
+        if (arrival >= COLLISION_LOOKAHEAD) {
+            float t = (COLLISION_LOOKAHEAD - corridor.times.back()) / (arrival - corridor.times.back());
+            corridor.points.push_back(interpolatePosition(from, waypoints[i], t));
+            corridor.times.push_back(COLLISION_LOOKAHEAD);
+            break;
+        }
+        corridor.points.push_back(waypoints[i]);
+        corridor.times.push_back(arrival);
+    }
+    return corridor;
+}
+
+VehicleCorridor VehicleController::buildCorridor(const Auto& vehicle) const {
+    std::vector<Point> waypoints(1, vehicle.position);
+    if (vehicle.state == VehicleState::MOVING) {
+        for (size_t i = vehicle.currentNodeIndex; i < vehicle.currentNodePath.size(); i++) {
+            const PathNode* node = pathSystem->getNode(vehicle.currentNodePath[i]);
+            if (!node) break;
+            waypoints.push_back(node->position);
+        }
+    }
+    return sweepCorridor(vehicle.vehicleId, waypoints, vehicle.speed);
+}
+
+const VehicleSpatialHash& VehicleController::getSpatialHash() const {
+    // Built serially: the first query may itself run inside a scheduler task
+    std::lock_guard<std::mutex> lock(spatialHashMutex);
+    if (!spatialHashValid) {
+        std::vector<VehicleCorridor> corridors;
+        corridors.reserve(vehicles.size());
+        for (const Auto& vehicle : vehicles.allRecords()) {
+            corridors.push_back(buildCorridor(vehicle));
+        }
+        spatialHash.build(std::move(corridors), COLLISION_LOOKAHEAD);
+        spatialHashValid = true;
+    }
+    return spatialHash;
+}
+
+std::vector<int> VehicleController::getVehiclesAtPosition(const Point& position, float radius) const {
+    return getSpatialHash().queryRadius(position, radius);
+}
+
+std::vector<CollisionRisk> VehicleController::detectCollisionRisks(float minDistance) const {
+    return getSpatialHash().findRisks(minDistance);
+}
+
+bool VehicleController::hasMinimumDistanceToOtherVehicles(const Auto& vehicle, float minDistance) const {
+    for (int vehicleId : getVehiclesAtPosition(vehicle.position, minDistance)) {
+        if (vehicleId != vehicle.vehicleId) return false;
+    }
+    return true;
+}
+
+bool VehicleController::canMoveWithoutViolatingDistance(const Auto& vehicle, const Point& targetPosition,
+                                                        float minDistance) const {
+    VehicleCorridor move = sweepCorridor(vehicle.vehicleId, {vehicle.position, targetPosition}, vehicle.speed);
+    return getSpatialHash().findRisks(move, minDistance).empty();
+}
+
+bool VehicleController::checkCollisionRisk(const Auto& vehicle, int segmentId) const {
+    const PathSegment* segment = pathSystem->getSegment(segmentId);
+    if (!segment) return false;
+    const PathNode* start = pathSystem->getNode(segment->startNodeId);
+    const PathNode* end = pathSystem->getNode(segment->endNodeId);
+    if (!start || !end) return false;
+
+    // Enter at the nearer node, drive to the far one
+    if (pathSystem->calculateDistance(vehicle.position, start->position) >
+        pathSystem->calculateDistance(vehicle.position, end->position)) {
+        std::swap(start, end);
+    }
+    VehicleCorridor drive = sweepCorridor(vehicle.vehicleId, {vehicle.position, start->position, end->position}, vehicle.speed);
+    return !getSpatialHash().findRisks(drive, MIN_VEHICLE_DISTANCE).empty();
+}
+
+void VehicleController::runParallel(size_t count, size_t grainSize, const TaskScheduler::RangeTask& task) const {
+    if (scheduler) {
+        scheduler->parallelFor(count, grainSize, task);
+    } else {
+        task(0, count);
+    }
 }
 
 void VehicleController::coordinateVehicleMovements() {
     // Simplified - coordination happens in planPath
 }
 
-void VehicleController::updateVehicleMovement(Auto& vehicle, float deltaTime) {
-    // Movement simulation - simplified
+bool VehicleController::updateVehicleMovement(size_t index, float deltaTime) {
+    // Kinematics only: drive toward the next route node on the segment already held.
+    // Node transitions need the SegmentManager and run serially in moveVehicleAlongPath.
+    // Reads only hot columns: the target node and speed are mirrored there, the record stays cold.
+    VehicleHotData& hot = vehicles.hot();
+    if (!simulatedMovement || hot.state[index] != VehicleState::MOVING || hot.targetNodeId[index] == -1) return false;
+
+    float dx = hot.targetX[index] - hot.x[index];
+    float dy = hot.targetY[index] - hot.y[index];
+    float distance = std::sqrt(dx * dx + dy * dy);
+    float step = hot.speed[index] * deltaTime;
+
+    if (distance > 0.0f) {
+        float heading = std::atan2(dy, dx) * 180.0f / static_cast<float>(M_PI);
+        hot.heading[index] = (heading < 0.0f) ? heading + 360.0f : heading;
+    }
+    if (step >= distance) {
+        hot.x[index] = hot.targetX[index];
+        hot.y[index] = hot.targetY[index];
+        nodeReached[index] = 1;
+    } else {
+        hot.x[index] += dx / distance * step;
+        hot.y[index] += dy / distance * step;
+    }
+    return true;
 }
 
 void VehicleController::moveVehicleAlongPath(Auto& vehicle, float deltaTime) {
-    // Path following - simplified
+    if (vehicle.currentNodeIndex >= vehicle.currentNodePath.size()) return;
+
+    if (vehicle.state == VehicleState::MOVING) {
+        // Called when the next node was reached: leave the segment, advance the route
+        int nodeId = vehicle.currentNodePath[vehicle.currentNodeIndex];
+        double now = segmentManager->getCurrentTime();
+        events.publish(NodeReachedEvent{vehicle.vehicleId, nodeId, vehicle.currentNodeIndex, vehicle.currentNodePath.size(), now});
+        releaseCurrentSegment(vehicle);
+        vehicle.currentNodeId = nodeId;
+        vehicle.realWorldCoordinates = vehicle.position;   // Simulated measurement for planPath
+        vehicle.currentNodeIndex++;
+
+        if (vehicle.currentNodeIndex >= vehicle.currentNodePath.size()) {
+            vehicle.state = VehicleState::ARRIVED;
+            vehicle.isMoving = false;
+            vehicle.currentNodePath.clear();
+            vehicle.currentNodeIndex = 0;
+            events.publish(RouteCompletedEvent{vehicle.vehicleId, vehicle.targetNodeId, now});
+            return;
+        }
+    }
+
+    if (!tryReserveNextSegment(vehicle)) {
+        handleBlockedVehicle(vehicle);
+    }
+}
+
+bool VehicleController::tryReserveNextSegment(Auto& vehicle) {
+    int fromNodeId = -1;
+    int segmentId = nextSegmentOnRoute(vehicle, fromNodeId);
+    if (segmentId == -1) return false;
+
+    // Admitted from the queue during SegmentManager::update(), or reserve directly
+    if (segmentManager->getVehicleSegment(vehicle.vehicleId) != segmentId &&
+        !segmentManager->reserveSegment(segmentId, vehicle.vehicleId, fromNodeId)) {
+        return false;
+    }
+
+    vehicle.currentSegmentId = segmentId;
+    vehicle.state = VehicleState::MOVING;
+    vehicle.isMoving = true;
+    vehicle.isWaitingInQueue = false;
+    return true;
+}
+
+void VehicleController::releaseCurrentSegment(Auto& vehicle) {
+    if (vehicle.currentSegmentId == -1) return;
+    segmentManager->releaseSegment(vehicle.currentSegmentId, vehicle.vehicleId);
+    vehicle.currentSegmentId = -1;
 }
 
 void VehicleController::handleBlockedVehicle(Auto& vehicle) {
-    // Blocking handling - simplified
+    // Wait at the node, queued for the next segment (admission happens in SegmentManager::update)
+    int fromNodeId = -1;
+    int segmentId = nextSegmentOnRoute(vehicle, fromNodeId);
+    if (segmentId == -1) return;
+
+    vehicle.state = VehicleState::WAITING;
+    vehicle.isMoving = false;
+    if (!vehicle.isWaitingInQueue) {
+        // The queue key is fixed on entry: urgency and remaining route as of now
+        SegmentManager::VehicleQueueInfo info;
+        info.urgency = vehicle.jobUrgency;
+        info.remainingRoute = remainingRouteLength(vehicle);
+        segmentManager->setVehicleQueueInfo(vehicle.vehicleId, info);
+        segmentManager->addToQueue(segmentId, vehicle.vehicleId, fromNodeId);
+        vehicle.isWaitingInQueue = true;
+        events.publish(VehicleBlockedEvent{vehicle.vehicleId, fromNodeId, segmentId, segmentManager->getCurrentTime()});
+    }
 }
 
 std::string VehicleController::getVehicleStateString(VehicleState state) const {
@@ -284,8 +806,9 @@ bool VehicleController::hasVehicleArrived(int vehicleId) const {
 
 std::vector<int> VehicleController::getActiveVehicleIds() const {
     std::vector<int> activeIds;
-    for (const auto& [vehicleId, vehicle] : vehicles) {
-        activeIds.push_back(vehicleId);
+    activeIds.reserve(vehicles.size());
+    for (const Auto& vehicle : vehicles.allRecords()) {
+        activeIds.push_back(vehicle.vehicleId);
     }
     return activeIds;
 }
@@ -294,9 +817,137 @@ bool VehicleController::replanPathIfBlocked(int vehicleId) {
     return false; 
 }
 
+int VehicleController::findNearestWaitingNode(int currentNodeId) {
+    return segmentManager->getNearestWaitingNode(currentNodeId);
+}
+
+int VehicleController::findTJunctionForWaitingNode(int waitingNodeId) {
+    int junctionId = segmentManager->getWaitingNodeJunction(waitingNodeId);
+    return segmentManager->isTJunction(junctionId) ? junctionId : -1;
+}
+
+int VehicleController::findAssociatedTJunction(int nodeId) {
+    if (segmentManager->isWaitingNode(nodeId)) {
+        return findTJunctionForWaitingNode(nodeId);
+    }
+    return segmentManager->isTJunction(nodeId) ? nodeId : -1;
+}
+
 void VehicleController::updateVehicles(float deltaTime) {
-    // Update all vehicles in the new node-based system
-    for (auto& [vehicleId, vehicle] : vehicles) {
-        updateVehicleMovement(vehicle, deltaTime);
+    // Frame boundary: commit routes finished in the background
+    applyPlannedRoutes();
+
+    // Advance the reservation clock (headway, queue admission)
+    segmentManager->update(deltaTime);
+
+    // Per-frame loop runs on the hot columns in parallel; vehicles that changed are
+    // written back to their records and marked for the next snapshot in dense order
+    auto syncStart = std::chrono::steady_clock::now();
+    vehicles.syncHot();
+    auto movementStart = std::chrono::steady_clock::now();
+    lastUpdateTiming.sync = movementStart - syncStart;
+    const size_t count = vehicles.size();
+    movementChanged.assign(count, 0);
+    nodeReached.assign(count, 0);
+    runParallel(count, 64, [this, deltaTime](size_t begin, size_t end) {
+        for (size_t index = begin; index < end; index++) {
+            movementChanged[index] = updateVehicleMovement(index, deltaTime) ? 1 : 0;
+        }
+    });
+
+    auto transitionStart = std::chrono::steady_clock::now();
+    lastUpdateTiming.movement = transitionStart - movementStart;
+
+    const VehicleHotData& hot = vehicles.hot();
+    for (size_t index = 0; index < count; index++) {
+        if (movementChanged[index]) {
+            vehicles.commitHot(index);
+            markDirty(hot.vehicleId[index]);
+        }
+
+        // Simulated node transitions, segment reservations and queueing
+        if (simulatedMovement) {
+            VehicleState state = hot.state[index];
+            bool waitingToStart = (state == VehicleState::IDLE || state == VehicleState::WAITING) &&
+                                  !vehicles.record(index).currentNodePath.empty();
+            if (nodeReached[index] || waitingToStart) {
+                moveVehicleAlongPath(vehicles.editRecord(index), deltaTime);
+                markDirty(hot.vehicleId[index]);
+            }
+        }
+    }
+
+    // Reroute vehicles whose next segment is blocked when a detour is cheaper than waiting
+    auto replanStart = std::chrono::steady_clock::now();
+    lastUpdateTiming.transitions = replanStart - transitionStart;
+    updateVehiclePaths();
+    lastUpdateTiming.replanning = std::chrono::steady_clock::now() - replanStart;
+
+    // This frame's progress to the subscribers, one batch per event type
+    events.dispatch();
+}
+
+VehicleSnapshot VehicleController::snapshot() {
+    for (int vehicleId : dirtyVehicles) {
+        if (vehicleId >= static_cast<int>(publishedVehicles.vehicles.size())) {
+            publishedVehicles.vehicles.resize(vehicleId + 1);
+        }
+        int index = vehicles.indexOf(vehicleId);
+        std::shared_ptr<const Auto> published;
+        if (index != -1) published = std::make_shared<const Auto>(vehicles.record(index));
+        publishedVehicles.vehicles.set(vehicleId, published);
+        dirtyFlags[vehicleId] = 0;
+    }
+    dirtyVehicles.clear();
+    return publishedVehicles;
+}
+
+void VehicleController::rollback(const VehicleSnapshot& snapshot) {
+    // Bring the published state up to date, then write back only what differs
+    this->snapshot();
+
+    const auto& current = publishedVehicles.vehicles;
+    const auto& target = snapshot.vehicles;
+    const size_t chunkSize = PersistentArray<std::shared_ptr<const Auto>>::CHUNK_SIZE;
+    size_t count = std::max(current.size(), target.size());
+
+    for (size_t chunk = 0; chunk * chunkSize < count; chunk++) {
+        if (current.sharesChunk(target, chunk)) continue;
+
+        size_t end = std::min(count, (chunk + 1) * chunkSize);
+        for (size_t vehicleId = chunk * chunkSize; vehicleId < end; vehicleId++) {
+            const Auto* now = publishedVehicles.getVehicle(static_cast<int>(vehicleId));
+            const Auto* then = snapshot.getVehicle(static_cast<int>(vehicleId));
+            if (now == then) continue;
+
+            int index = vehicles.indexOf(static_cast<int>(vehicleId));
+            if (then && index != -1) {
+                vehicles.editRecord(index) = *then;
+            } else if (then) {
+                vehicles.insert(*then);
+            } else {
+                vehicles.erase(static_cast<int>(vehicleId));
+            }
+        }
     }
+    publishedVehicles = snapshot;
+    spatialHashValid = false;
+
+    // Marker mappings of vehicles that did not exist at snapshot time are dropped;
+    // vehicle IDs are not reused (nextVehicleId stays monotonic)
+    for (int& mappedId : markerToVehicleId) {
+        if (mappedId != 0 && vehicles.indexOf(mappedId) == -1) mappedId = 0;
+    }
+}
+
+WorldSnapshot VehicleController::snapshotWorld() {
+    WorldSnapshot world;
+    world.reservations = segmentManager->snapshot();
+    world.vehicles = snapshot();
+    return world;
+}
+
+void VehicleController::rollbackWorld(const WorldSnapshot& snapshot) {
+    segmentManager->rollback(snapshot.reservations);
+    rollback(snapshot.vehicles);
 }
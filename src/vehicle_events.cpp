@@ -0,0 +1,25 @@
+#include "vehicle_events.h"
+#include <algorithm>
+
+void VehicleEventBus::unsubscribe(int subscriptionId) {
+    std::apply([subscriptionId](auto&... channel) {
+        auto remove = [subscriptionId](auto& subscribers) {
+            subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(),
+                                             [subscriptionId](const auto& s) { return s.first == subscriptionId; }),
+                              subscribers.end());
+        };
+        (remove(channel.subscribers), ...);
+    }, channels);
+}
+
+void VehicleEventBus::dispatch() {
+    std::apply([](auto&... channel) { (deliver(channel), ...); }, channels);
+}
+
+void VehicleEventBus::clear() {
+    std::apply([](auto&... channel) { (channel.pending.clear(), ...); }, channels);
+}
+
+size_t VehicleEventBus::getPendingCount() const {
+    return std::apply([](const auto&... channel) { return (channel.pending.size() + ...); }, channels);
+}
@@ -0,0 +1,223 @@
+#include "vehicle_spatial_hash.h"
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+Point positionAt(const VehicleCorridor& corridor, size_t piece, float time) {
+    const Point& from = corridor.points[piece];
+    const Point& to = corridor.points[piece + 1];
+    float duration = corridor.times[piece + 1] - corridor.times[piece];
+    if (duration <= 0.0f) return to;
+    float t = (time - corridor.times[piece]) / duration;
+    return Point(from.x + (to.x - from.x) * t, from.y + (to.y - from.y) * t);
+}
+
+} // namespace
+
+VehicleSpatialHash::VehicleSpatialHash(float cellSize) : cellSize(cellSize), horizon(0.0f) {}
+
+void VehicleSpatialHash::clear() {
+    corridors.clear();
+    bounds.clear();
+    bucketStart.assign(1, 0);
+    entries.clear();
+}
+
+void VehicleSpatialHash::build(std::vector<VehicleCorridor> newCorridors, float lookAhead) {
+    corridors = std::move(newCorridors);
+    horizon = lookAhead;
+
+    // Every corridor spans [0, horizon]: a vehicle stays where its corridor ends
+    bounds.resize(corridors.size());
+    size_t entryCount = 0;
+    for (size_t i = 0; i < corridors.size(); i++) {
+        VehicleCorridor& corridor = corridors[i];
+        if (corridor.points.empty()) corridor.points.push_back(Point());
+        corridor.times.resize(corridor.points.size(), 0.0f);
+        if (corridor.points.size() == 1 || corridor.times.back() < horizon) {
+            corridor.points.push_back(corridor.points.back());
+            corridor.times.push_back(horizon);
+        }
+
+        bounds[i] = boundsOf(corridor);
+        CellRange cells = cellsOf(bounds[i], 0.0f);
+        entryCount += static_cast<size_t>(cells.maxX - cells.minX + 1) * (cells.maxY - cells.minY + 1);
+    }
+
+    size_t tableSize = 16;
+    while (tableSize < entryCount * 2) tableSize *= 2;
+
+    // Counting sort of (cell, corridor) pairs into the bucket table
+    bucketStart.assign(tableSize + 1, 0);
+    for (size_t i = 0; i < corridors.size(); i++) {
+        CellRange cells = cellsOf(bounds[i], 0.0f);
+        for (int y = cells.minY; y <= cells.maxY; y++) {
+            for (int x = cells.minX; x <= cells.maxX; x++) bucketStart[bucketOf(x, y) + 1]++;
+        }
+    }
+    for (size_t b = 0; b < tableSize; b++) bucketStart[b + 1] += bucketStart[b];
+
+    entries.resize(entryCount);
+    std::vector<uint32_t> fill(bucketStart.begin(), bucketStart.end() - 1);
+    for (size_t i = 0; i < corridors.size(); i++) {
+        CellRange cells = cellsOf(bounds[i], 0.0f);
+        for (int y = cells.minY; y <= cells.maxY; y++) {
+            for (int x = cells.minX; x <= cells.maxX; x++) entries[fill[bucketOf(x, y)]++] = static_cast<uint32_t>(i);
+        }
+    }
+}
+
+VehicleSpatialHash::Bounds VehicleSpatialHash::boundsOf(const VehicleCorridor& corridor) {
+    Bounds result = {corridor.points[0].x, corridor.points[0].y, corridor.points[0].x, corridor.points[0].y};
+    for (const Point& point : corridor.points) {
+        result.minX = std::min(result.minX, point.x);
+        result.minY = std::min(result.minY, point.y);
+        result.maxX = std::max(result.maxX, point.x);
+        result.maxY = std::max(result.maxY, point.y);
+    }
+    return result;
+}
+
+bool VehicleSpatialHash::overlaps(const Bounds& a, const Bounds& b, float margin) {
+    return a.minX - margin <= b.maxX && b.minX <= a.maxX + margin &&
+           a.minY - margin <= b.maxY && b.minY <= a.maxY + margin;
+}
+
+VehicleSpatialHash::CellRange VehicleSpatialHash::cellsOf(const Bounds& box, float margin) const {
+    return {static_cast<int>(std::floor((box.minX - margin) / cellSize)),
+            static_cast<int>(std::floor((box.minY - margin) / cellSize)),
+            static_cast<int>(std::floor((box.maxX + margin) / cellSize)),
+            static_cast<int>(std::floor((box.maxY + margin) / cellSize))};
+}
+
+size_t VehicleSpatialHash::bucketOf(int cellX, int cellY) const {
+    uint32_t hash = (static_cast<uint32_t>(cellX) * 73856093u) ^ (static_cast<uint32_t>(cellY) * 19349663u);
+    return hash & (bucketStart.size() - 2);   // Table size is a power of two
+}
+
+void VehicleSpatialHash::collectCandidates(const Bounds& box, float margin, std::vector<uint32_t>& candidates) const {
+    candidates.clear();
+    if (corridors.empty()) return;
+
+    // Cells sharing a bucket only add candidates; the bounds test drops them again
+    CellRange cells = cellsOf(box, margin);
+    for (int y = cells.minY; y <= cells.maxY; y++) {
+        for (int x = cells.minX; x <= cells.maxX; x++) {
+            size_t bucket = bucketOf(x, y);
+            for (uint32_t e = bucketStart[bucket]; e < bucketStart[bucket + 1]; e++) {
+                if (overlaps(bounds[entries[e]], box, margin)) candidates.push_back(entries[e]);
+            }
+        }
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+}
+
+std::vector<int> VehicleSpatialHash::queryRadius(const Point& position, float radius) const {
+    std::vector<int> vehicleIds;
+    std::vector<uint32_t> candidates;
+    collectCandidates({position.x, position.y, position.x, position.y}, radius, candidates);
+    for (uint32_t index : candidates) {
+        float dx = corridors[index].points[0].x - position.x;
+        float dy = corridors[index].points[0].y - position.y;
+        if (dx * dx + dy * dy <= radius * radius) vehicleIds.push_back(corridors[index].vehicleId);
+    }
+    return vehicleIds;
+}
+
+std::vector<CollisionRisk> VehicleSpatialHash::findRisks(const VehicleCorridor& probe, float minDistance) const {
+    std::vector<CollisionRisk> risks;
+    if (probe.points.empty()) return risks;
+
+    // Same normalization as build(), so the walk over both corridors ends at the horizon
+    VehicleCorridor normalized = probe;
+    normalized.times.resize(normalized.points.size(), 0.0f);
+    if (normalized.points.size() == 1 || normalized.times.back() < horizon) {
+        normalized.points.push_back(normalized.points.back());
+        normalized.times.push_back(horizon);
+    }
+
+    std::vector<uint32_t> candidates;
+    collectCandidates(boundsOf(normalized), minDistance, candidates);
+    for (uint32_t index : candidates) {
+        CollisionRisk risk;
+        if (corridors[index].vehicleId != probe.vehicleId &&
+            closestApproach(normalized, corridors[index], minDistance, risk)) {
+            risks.push_back(risk);
+        }
+    }
+    return risks;
+}
+
+std::vector<CollisionRisk> VehicleSpatialHash::findRisks(float minDistance) const {
+    std::vector<CollisionRisk> risks;
+    std::vector<uint32_t> candidates;
+    for (size_t i = 0; i < corridors.size(); i++) {
+        collectCandidates(bounds[i], minDistance, candidates);
+        for (uint32_t j : candidates) {
+            CollisionRisk risk;
+            if (j > i && closestApproach(corridors[i], corridors[j], minDistance, risk)) risks.push_back(risk);
+        }
+    }
+    return risks;
+}
+
+std::vector<CollisionRisk> VehicleSpatialHash::findRisksBruteForce(float minDistance) const {
+    std::vector<CollisionRisk> risks;
+    for (size_t i = 0; i < corridors.size(); i++) {
+        for (size_t j = i + 1; j < corridors.size(); j++) {
+            CollisionRisk risk;
+            if (closestApproach(corridors[i], corridors[j], minDistance, risk)) risks.push_back(risk);
+        }
+    }
+    return risks;
+}
+
+bool VehicleSpatialHash::closestApproach(const VehicleCorridor& a, const VehicleCorridor& b, float minDistance,
+                                         CollisionRisk& risk) {
+    risk.vehicleId1 = a.vehicleId;
+    risk.vehicleId2 = b.vehicleId;
+    risk.time = -1.0f;
+    risk.distance = INFINITY;
+    if (a.points.size() < 2 || b.points.size() < 2) return false;
+
+    // Walk both corridors in time; on each common interval both move linearly, so the
+    // squared distance is a quadratic in the interval parameter s in [0, 1]
+    size_t pieceA = 0, pieceB = 0;
+    while (pieceA + 1 < a.points.size() && pieceB + 1 < b.points.size()) {
+        float start = std::max(a.times[pieceA], b.times[pieceB]);
+        float end = std::min(a.times[pieceA + 1], b.times[pieceB + 1]);
+
+        if (end >= start) {
+            Point startA = positionAt(a, pieceA, start), endA = positionAt(a, pieceA, end);
+            Point startB = positionAt(b, pieceB, start), endB = positionAt(b, pieceB, end);
+            float dx = startA.x - startB.x, dy = startA.y - startB.y;
+            float vx = (endA.x - endB.x) - dx, vy = (endA.y - endB.y) - dy;
+
+            float qa = vx * vx + vy * vy;
+            float qb = 2.0f * (dx * vx + dy * vy);
+            float qc = dx * dx + dy * dy;
+
+            float s = (qa > 0.0f) ? std::min(1.0f, std::max(0.0f, -qb / (2.0f * qa))) : 0.0f;
+            float closest = std::sqrt(std::max(0.0f, qc + s * (qb + s * qa)));
+            risk.distance = std::min(risk.distance, closest);
+
+            if (risk.time < 0.0f && closest < minDistance) {
+                // First s with |d(s)| = minDistance
+                float first = 0.0f;
+                float c = qc - minDistance * minDistance;
+                if (c > 0.0f) {
+                    float discriminant = qb * qb - 4.0f * qa * c;
+                    first = (-qb - std::sqrt(std::max(0.0f, discriminant))) / (2.0f * qa);
+                }
+                risk.time = start + std::min(1.0f, std::max(0.0f, first)) * (end - start);
+            }
+        }
+
+        if (a.times[pieceA + 1] < b.times[pieceB + 1]) pieceA++;
+        else if (b.times[pieceB + 1] < a.times[pieceA + 1]) pieceB++;
+        else { pieceA++; pieceB++; }
+    }
+    return risk.time >= 0.0f;
+}
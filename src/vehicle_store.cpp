@@ -0,0 +1,177 @@
+#include "vehicle_store.h"
+
+VehicleHandle VehicleStore::insert(const Auto& vehicle) {
+    if (vehicle.vehicleId <= 0 || indexOf(vehicle.vehicleId) != -1) return VehicleHandle();
+
+    uint32_t slotIndex;
+    if (!freeSlots.empty()) {
+        slotIndex = freeSlots.back();
+        freeSlots.pop_back();
+    } else {
+        slotIndex = static_cast<uint32_t>(slots.size());
+        slots.push_back({0, 1});
+    }
+
+    Slot& slot = slots[slotIndex];
+    slot.denseIndex = static_cast<uint32_t>(records.size());
+    VehicleHandle handle(slotIndex, slot.generation);
+
+    if (vehicle.vehicleId >= static_cast<int>(handleById.size())) {
+        handleById.resize(vehicle.vehicleId + 1);
+    }
+    handleById[vehicle.vehicleId] = handle;
+
+    denseToSlot.push_back(slotIndex);
+    records.push_back(vehicle);
+    recordEdited.push_back(0);
+    pushBackHot(vehicle);
+    return handle;
+}
+
+bool VehicleStore::erase(int vehicleId) {
+    int index = indexOf(vehicleId);
+    if (index == -1) return false;
+
+    // Pending edits refer to dense indices, which change below
+    syncHot();
+
+    size_t last = records.size() - 1;
+    uint32_t slotIndex = denseToSlot[index];
+    if (static_cast<size_t>(index) != last) {
+        records[index] = std::move(records[last]);
+        denseToSlot[index] = denseToSlot[last];
+        slots[denseToSlot[index]].denseIndex = static_cast<uint32_t>(index);
+        moveHot(last, index);
+    }
+    records.pop_back();
+    denseToSlot.pop_back();
+    recordEdited.pop_back();
+    popBackHot();
+
+    // Bump the generation so outstanding handles go stale
+    Slot& slot = slots[slotIndex];
+    slot.generation = (slot.generation == UINT32_MAX) ? 1 : slot.generation + 1;
+    freeSlots.push_back(slotIndex);
+    handleById[vehicleId] = VehicleHandle();
+    return true;
+}
+
+void VehicleStore::clear() {
+    while (!records.empty()) {
+        erase(records.back().vehicleId);
+    }
+}
+
+VehicleHandle VehicleStore::handleOf(int vehicleId) const {
+    if (vehicleId <= 0 || vehicleId >= static_cast<int>(handleById.size())) return VehicleHandle();
+    return handleById[vehicleId];
+}
+
+bool VehicleStore::isValid(VehicleHandle handle) const {
+    return !handle.isNull() && handle.index < slots.size() && slots[handle.index].generation == handle.generation;
+}
+
+int VehicleStore::indexOf(VehicleHandle handle) const {
+    return isValid(handle) ? static_cast<int>(slots[handle.index].denseIndex) : -1;
+}
+
+int VehicleStore::indexOf(int vehicleId) const {
+    return indexOf(handleOf(vehicleId));
+}
+
+Auto& VehicleStore::editRecord(size_t index) {
+    if (!recordEdited[index]) {
+        recordEdited[index] = 1;
+        editedIndices.push_back(static_cast<uint32_t>(index));
+    }
+    return records[index];
+}
+
+void VehicleStore::syncHot() {
+    for (uint32_t index : editedIndices) {
+        pullHot(index);
+        recordEdited[index] = 0;
+    }
+    editedIndices.clear();
+}
+
+void VehicleStore::commitHot(size_t index) {
+    Auto& vehicle = records[index];
+    if (vehicle.position.x != hotData.x[index] || vehicle.position.y != hotData.y[index]) {
+        vehicle.setPosition(Point(hotData.x[index], hotData.y[index]));
+    }
+    vehicle.setDirection(hotData.heading[index]);
+    vehicle.state = hotData.state[index];
+    vehicle.currentNodeIndex = hotData.routeCursor[index];
+    vehicle.currentSegmentId = hotData.segmentId[index];
+}
+
+void VehicleStore::pullHot(size_t index) {
+    const Auto& vehicle = records[index];
+    hotData.vehicleId[index] = vehicle.vehicleId;
+    hotData.x[index] = vehicle.position.x;
+    hotData.y[index] = vehicle.position.y;
+    hotData.heading[index] = vehicle.getDirection();
+    hotData.state[index] = vehicle.state;
+    hotData.routeCursor[index] = static_cast<uint32_t>(vehicle.currentNodeIndex);
+    hotData.segmentId[index] = vehicle.currentSegmentId;
+    hotData.speed[index] = vehicle.speed;
+    resolveTarget(vehicle, hotData.targetNodeId[index], hotData.targetX[index], hotData.targetY[index]);
+}
+
+void VehicleStore::pushBackHot(const Auto& vehicle) {
+    hotData.vehicleId.push_back(vehicle.vehicleId);
+    hotData.x.push_back(vehicle.position.x);
+    hotData.y.push_back(vehicle.position.y);
+    hotData.heading.push_back(vehicle.getDirection());
+    hotData.state.push_back(vehicle.state);
+    hotData.routeCursor.push_back(static_cast<uint32_t>(vehicle.currentNodeIndex));
+    hotData.segmentId.push_back(vehicle.currentSegmentId);
+    hotData.speed.push_back(vehicle.speed);
+    hotData.targetNodeId.push_back(-1);
+    hotData.targetX.push_back(0.0f);
+    hotData.targetY.push_back(0.0f);
+    size_t index = hotData.targetNodeId.size() - 1;
+    resolveTarget(vehicle, hotData.targetNodeId[index], hotData.targetX[index], hotData.targetY[index]);
+}
+
+void VehicleStore::moveHot(size_t from, size_t to) {
+    hotData.vehicleId[to] = hotData.vehicleId[from];
+    hotData.x[to] = hotData.x[from];
+    hotData.y[to] = hotData.y[from];
+    hotData.heading[to] = hotData.heading[from];
+    hotData.state[to] = hotData.state[from];
+    hotData.routeCursor[to] = hotData.routeCursor[from];
+    hotData.segmentId[to] = hotData.segmentId[from];
+    hotData.speed[to] = hotData.speed[from];
+    hotData.targetNodeId[to] = hotData.targetNodeId[from];
+    hotData.targetX[to] = hotData.targetX[from];
+    hotData.targetY[to] = hotData.targetY[from];
+}
+
+void VehicleStore::popBackHot() {
+    hotData.vehicleId.pop_back();
+    hotData.x.pop_back();
+    hotData.y.pop_back();
+    hotData.heading.pop_back();
+    hotData.state.pop_back();
+    hotData.routeCursor.pop_back();
+    hotData.segmentId.pop_back();
+    hotData.speed.pop_back();
+    hotData.targetNodeId.pop_back();
+    hotData.targetX.pop_back();
+    hotData.targetY.pop_back();
+}
+
+void VehicleStore::resolveTarget(const Auto& vehicle, int& nodeId, float& x, float& y) const {
+    int wanted = -1;
+    if (pathSystem && vehicle.currentNodeIndex < vehicle.currentNodePath.size()) {
+        wanted = vehicle.currentNodePath[vehicle.currentNodeIndex];
+    }
+    if (wanted == nodeId && wanted != -1) return;   // Same node, same position: skip the lookup
+
+    const PathNode* node = (wanted != -1) ? pathSystem->getNode(wanted) : nullptr;
+    nodeId = node ? node->nodeId : -1;
+    x = node ? node->position.x : 0.0f;
+    y = node ? node->position.y : 0.0f;
+}